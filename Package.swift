@@ -1,8 +1,14 @@
 // swift-tools-version: 5.9
 // The swift-tools-version declares the minimum version of Swift required to build this package.
 
+import Foundation
 import PackageDescription
 
+// AUDIO_PLAYING_RTSAN=1でテストをビルドすると、render_guard_test::scopeの中のロックやシステムコールを
+// RealtimeSanitizerで検出する。実行時はclangのlibclang_rt.rtsan_osx_dynamic.dylibをDYLD_INSERT_LIBRARIESに渡す
+let realtimeSanitizerFlags: [String] =
+    ProcessInfo.processInfo.environment["AUDIO_PLAYING_RTSAN"] != nil ? ["-fsanitize=realtime"] : []
+
 let package = Package(
     name: "audio-playing",
     platforms: [.macOS(.v14), .iOS(.v17), .macCatalyst(.v17)],
@@ -23,6 +29,9 @@ let package = Package(
             ],
             cSettings: [
                 .unsafeFlags(["-fmodules"]),
+            ],
+            linkerSettings: [
+                .linkedFramework("Accelerate"),
             ]
         ),
         .testTarget(
@@ -31,7 +40,10 @@ let package = Package(
                 "audio-playing",
             ],
             cxxSettings: [
-                .unsafeFlags(["-fcxx-modules"]),
+                .unsafeFlags(["-fcxx-modules"] + realtimeSanitizerFlags),
+            ],
+            linkerSettings: [
+                .unsafeFlags(realtimeSanitizerFlags),
             ]
         ),
     ],
@@ -0,0 +1,356 @@
+//
+//  bouncer.cpp
+//
+
+#include "bouncer.h"
+
+#include <audio-engine/common/types.h>
+#include <audio-playing/common/math.h>
+#include <audio-playing/timeline/timeline_utils.h>
+#include <audio-playing/wave_file/wave_file.h>
+
+#include <audio-processing/umbrella.hpp>
+
+#include <algorithm>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <thread>
+
+using namespace yas;
+using namespace yas::playing;
+
+namespace yas::playing::bouncer_utils {
+static std::size_t sample_byte_count(audio::pcm_format const pcm_format) {
+    switch (pcm_format) {
+        case audio::pcm_format::float64:
+            return 8;
+        case audio::pcm_format::float32:
+        case audio::pcm_format::fixed824:
+            return 4;
+        case audio::pcm_format::int16:
+            return 2;
+        case audio::pcm_format::other:
+            return 0;
+    }
+}
+
+static std::vector<proc::time::range> chunk_ranges(proc::time::range const &range, sample_rate_t const frag_length) {
+    std::vector<proc::time::range> ranges;
+
+    frame_index_t frame = range.frame;
+    frame_index_t const next_frame = range.next_frame();
+
+    while (frame < next_frame) {
+        frame_index_t const chunk_next_frame =
+            std::min(math::floor_int(frame, frag_length) + static_cast<frame_index_t>(frag_length), next_frame);
+        ranges.emplace_back(frame, static_cast<length_t>(chunk_next_frame - frame));
+        frame = chunk_next_frame;
+    }
+
+    return ranges;
+}
+
+static std::vector<channel_index_t> file_channel_indices(uint32_t const out_ch_count,
+                                                         channel_mapping const &ch_mapping) {
+    std::vector<channel_index_t> indices;
+    indices.reserve(out_ch_count);
+
+    for (uint32_t out_idx = 0; out_idx < out_ch_count; ++out_idx) {
+        indices.emplace_back(ch_mapping.file_index(out_idx, out_ch_count).value());
+    }
+
+    return indices;
+}
+
+static void remove_file(std::filesystem::path const &path) {
+    std::error_code error_code;
+    std::filesystem::remove(path, error_code);
+}
+}  // namespace yas::playing::bouncer_utils
+
+bouncer::bouncer(std::vector<proc::timeline_ptr> &&timelines, sample_rate_t const sample_rate)
+    : _timelines(std::move(timelines)), _sample_rate(sample_rate) {
+}
+
+bouncer::result_t bouncer::bounce_to_file(proc::time::range const &range, std::filesystem::path const &path,
+                                          audio::pcm_format const pcm_format, uint32_t const out_ch_count,
+                                          channel_mapping const &ch_mapping) const {
+    // 書き出せないものはファイルを作る前に弾く
+    if (auto validation_result = this->_validate(range, pcm_format); !validation_result) {
+        return validation_result;
+    }
+
+    auto const file_ch_indices = bouncer_utils::file_channel_indices(out_ch_count, ch_mapping);
+
+    auto make_result = wave_file::make_created(path, this->_sample_rate, out_ch_count, pcm_format);
+    if (!make_result) {
+        switch (make_result.error()) {
+            case wave_file_error::invalid_format:
+                return result_t{error_t::invalid_format};
+            case wave_file_error::write_to_stream_failed:
+                bouncer_utils::remove_file(path);
+                return result_t{error_t::create_file_failed};
+            default:
+                return result_t{error_t::create_file_failed};
+        }
+    }
+
+    auto const &file = make_result.value();
+    std::size_t const sample_byte_count = bouncer_utils::sample_byte_count(pcm_format);
+    std::vector<char> interleaved;
+
+    auto result = this->_bounce(range, pcm_format, file_ch_indices, [&](chunk const &chunk) {
+        std::size_t const ch_byte_count = chunk.range.length * sample_byte_count;
+        interleaved.resize(ch_byte_count * out_ch_count);
+
+        for (uint32_t ch_idx = 0; ch_idx < out_ch_count; ++ch_idx) {
+            char const *src_ptr = &chunk.data[ch_idx * ch_byte_count];
+            char *dst_ptr = &interleaved[ch_idx * sample_byte_count];
+
+            for (length_t frame = 0; frame < chunk.range.length; ++frame) {
+                std::copy_n(&src_ptr[frame * sample_byte_count], sample_byte_count,
+                            &dst_ptr[frame * sample_byte_count * out_ch_count]);
+            }
+        }
+
+        if (!file->write(interleaved.data(), chunk.range.length)) {
+            return result_t{error_t::write_file_failed};
+        }
+
+        return result_t{nullptr};
+    });
+
+    if (!result) {
+        // 途中まで書き込んだファイルは閉じてから消す。閉じられなくても消すので結果は見ない
+        auto const close_result = file->close();
+        bouncer_utils::remove_file(path);
+        return result;
+    }
+
+    if (!file->close()) {
+        bouncer_utils::remove_file(path);
+        return result_t{error_t::close_file_failed};
+    }
+
+    return result_t{nullptr};
+}
+
+bouncer::result_t bouncer::bounce_to_buffer(proc::time::range const &range, audio::pcm_buffer &buffer,
+                                            channel_mapping const &ch_mapping) const {
+    auto const &format = buffer.format();
+
+    if (format.is_interleaved() || format.sample_rate() != this->_sample_rate ||
+        buffer.frame_length() < range.length) {
+        return result_t{error_t::invalid_format};
+    }
+
+    auto const pcm_format = format.pcm_format();
+    uint32_t const out_ch_count = format.channel_count();
+    auto const file_ch_indices = bouncer_utils::file_channel_indices(out_ch_count, ch_mapping);
+    std::size_t const sample_byte_count = bouncer_utils::sample_byte_count(pcm_format);
+
+    buffer.clear();
+
+    return this->_bounce(range, pcm_format, file_ch_indices, [&](chunk const &chunk) {
+        std::size_t const ch_byte_count = chunk.range.length * sample_byte_count;
+        std::size_t const buf_byte_offset = (chunk.range.frame - range.frame) * sample_byte_count;
+
+        for (uint32_t ch_idx = 0; ch_idx < out_ch_count; ++ch_idx) {
+            std::copy_n(&chunk.data[ch_idx * ch_byte_count], ch_byte_count,
+                        &timeline_utils::char_data(buffer, ch_idx)[buf_byte_offset]);
+        }
+
+        return result_t{nullptr};
+    });
+}
+
+sample_rate_t bouncer::sample_rate() const {
+    return this->_sample_rate;
+}
+
+std::size_t bouncer::thread_count() const {
+    return this->_timelines.size();
+}
+
+bouncer::result_t bouncer::_bounce(proc::time::range const &range, audio::pcm_format const pcm_format,
+                                   std::vector<channel_index_t> const &file_ch_indices,
+                                   chunk_writing_f const &writing_handler) const {
+    if (auto validation_result = this->_validate(range, pcm_format); !validation_result) {
+        return validation_result;
+    }
+
+    auto const chunk_ranges = bouncer_utils::chunk_ranges(range, this->_sample_rate);
+    // 書き込み待ちのチャンクが溜まりすぎないように先行して処理する数を制限する
+    std::size_t const max_pending_count = this->_timelines.size() * 2;
+
+    std::mutex mutex;
+    std::condition_variable condition;
+    std::map<std::size_t, chunk> rendered_chunks;
+    std::size_t next_chunk_idx = 0;
+    std::size_t written_count = 0;
+    bool is_aborted = false;
+
+    std::vector<std::thread> threads;
+    threads.reserve(this->_timelines.size());
+
+    for (auto const &timeline : this->_timelines) {
+        threads.emplace_back([&, timeline] {
+            while (true) {
+                std::size_t chunk_idx;
+
+                {
+                    std::unique_lock<std::mutex> lock(mutex);
+                    condition.wait(lock, [&] {
+                        return is_aborted || next_chunk_idx < written_count + max_pending_count;
+                    });
+
+                    if (is_aborted || chunk_ranges.size() <= next_chunk_idx) {
+                        return;
+                    }
+
+                    chunk_idx = next_chunk_idx++;
+                }
+
+                auto chunk = this->_render_chunk(timeline, chunk_ranges.at(chunk_idx), pcm_format, file_ch_indices);
+
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    rendered_chunks.emplace(chunk_idx, std::move(chunk));
+                }
+
+                condition.notify_all();
+            }
+        });
+    }
+
+    result_t result{nullptr};
+
+    // 書き込みは呼び出したスレッドでフレーム順に行う
+    while (written_count < chunk_ranges.size()) {
+        chunk chunk;
+
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            condition.wait(lock, [&] { return rendered_chunks.contains(written_count); });
+            auto node = rendered_chunks.extract(written_count);
+            chunk = std::move(node.mapped());
+        }
+
+        if (auto writing_result = writing_handler(chunk); !writing_result) {
+            result = std::move(writing_result);
+            std::lock_guard<std::mutex> lock(mutex);
+            is_aborted = true;
+        } else {
+            std::lock_guard<std::mutex> lock(mutex);
+            ++written_count;
+        }
+
+        condition.notify_all();
+
+        if (!result) {
+            break;
+        }
+    }
+
+    for (auto &thread : threads) {
+        thread.join();
+    }
+
+    return result;
+}
+
+bouncer::result_t bouncer::_validate(proc::time::range const &range, audio::pcm_format const pcm_format) const {
+    if (range.length == 0) {
+        return result_t{error_t::invalid_range};
+    }
+
+    if (bouncer_utils::sample_byte_count(pcm_format) == 0) {
+        return result_t{error_t::invalid_format};
+    }
+
+    return result_t{nullptr};
+}
+
+bouncer::chunk bouncer::_render_chunk(proc::timeline_ptr const &timeline, proc::time::range const &chunk_range,
+                                      audio::pcm_format const pcm_format,
+                                      std::vector<channel_index_t> const &file_ch_indices) const {
+    std::size_t const sample_byte_count = bouncer_utils::sample_byte_count(pcm_format);
+    std::size_t const ch_byte_count = chunk_range.length * sample_byte_count;
+    std::type_info const &sample_type = yas::to_sample_type(pcm_format);
+
+    chunk chunk{.range = chunk_range, .data = std::vector<char>(ch_byte_count * file_ch_indices.size(), 0)};
+
+    proc::sync_source const sync_source{this->_sample_rate, this->_sample_rate};
+
+    timeline->process(chunk_range, sync_source, [&](proc::time::range const &range, proc::stream const &stream) {
+        auto const &channels = stream.channels();
+
+        for (std::size_t out_idx = 0; out_idx < file_ch_indices.size(); ++out_idx) {
+            auto const ch_iterator = channels.find(file_ch_indices.at(out_idx));
+            if (ch_iterator == channels.end()) {
+                continue;
+            }
+
+            char *ch_data = &chunk.data[out_idx * ch_byte_count];
+
+            // 出力のフォーマットとサンプルの型が一致するシグナルだけを書き込む
+            for (auto const &event_pair : ch_iterator->second.filtered_events<proc::signal_event>()) {
+                auto const &event_range = event_pair.first;
+                auto const &event = event_pair.second;
+
+                if (event->sample_type() != sample_type) {
+                    continue;
+                }
+
+                auto const overlapped = event_range.intersected(range);
+                if (!overlapped.has_value()) {
+                    continue;
+                }
+
+                char const *event_data = timeline_utils::char_data(*event);
+                std::copy_n(&event_data[(overlapped->frame - event_range.frame) * sample_byte_count],
+                            overlapped->length * sample_byte_count,
+                            &ch_data[(overlapped->frame - chunk_range.frame) * sample_byte_count]);
+            }
+        }
+
+        return proc::continuation::keep;
+    });
+
+    return chunk;
+}
+
+bouncer_ptr bouncer::make_shared(proc::timeline_ptr const &timeline, sample_rate_t const sample_rate,
+                                 std::size_t const thread_count) {
+    std::size_t const count = std::max(thread_count, std::size_t(1));
+
+    std::vector<proc::timeline_ptr> timelines;
+    timelines.reserve(count);
+
+    for (std::size_t idx = 0; idx < count; ++idx) {
+        timelines.emplace_back(proc::timeline::make_shared(proc::copy_tracks(timeline->tracks())));
+    }
+
+    return bouncer_ptr(new bouncer{std::move(timelines), sample_rate});
+}
+
+std::string yas::to_string(bouncer_error const &error) {
+    switch (error) {
+        case bouncer_error::invalid_range:
+            return "invalid_range";
+        case bouncer_error::invalid_format:
+            return "invalid_format";
+        case bouncer_error::create_file_failed:
+            return "create_file_failed";
+        case bouncer_error::write_file_failed:
+            return "write_file_failed";
+        case bouncer_error::close_file_failed:
+            return "close_file_failed";
+    }
+}
+
+std::ostream &operator<<(std::ostream &os, yas::playing::bouncer_error const &value) {
+    os << to_string(value);
+    return os;
+}
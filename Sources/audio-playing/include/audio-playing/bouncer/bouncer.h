@@ -0,0 +1,67 @@
+//
+//  bouncer.h
+//
+
+#pragma once
+
+#include <audio-engine/pcm_buffer/pcm_buffer.h>
+#include <audio-playing/bouncer/bouncer_types.h>
+#include <audio-playing/common/channel_mapping.h>
+#include <audio-playing/common/ptr.h>
+#include <audio-processing/timeline/timeline.h>
+
+#include <filesystem>
+#include <functional>
+#include <ostream>
+#include <vector>
+
+namespace yas::playing {
+// タイムラインの範囲をデバイスを通さずに書き出す
+// フラグメント単位に分けて複数スレッドで処理する
+struct bouncer final {
+    using error_t = bouncer_error;
+    using result_t = bouncer_result_t;
+
+    // out_ch_countの出力チャンネルをchannel_mappingでタイムラインのチャンネルに割り当てて
+    // waveファイルに書き出す。失敗したら書き出し途中のファイルは残さない
+    [[nodiscard]] result_t bounce_to_file(proc::time::range const &, std::filesystem::path const &,
+                                          audio::pcm_format const, uint32_t const out_ch_count,
+                                          channel_mapping const &) const;
+    // bufferはnon-interleavedで、rangeの長さ以上のframe_lengthが必要
+    [[nodiscard]] result_t bounce_to_buffer(proc::time::range const &, audio::pcm_buffer &,
+                                            channel_mapping const &) const;
+
+    [[nodiscard]] sample_rate_t sample_rate() const;
+    [[nodiscard]] std::size_t thread_count() const;
+
+    // timelineは作成時にスレッドの数だけコピーされ、以降の編集は反映されない
+    [[nodiscard]] static bouncer_ptr make_shared(proc::timeline_ptr const &, sample_rate_t const,
+                                                 std::size_t const thread_count);
+
+   private:
+    struct chunk final {
+        proc::time::range range;
+        // チャンネルごとに並べたnon-interleavedのデータ
+        std::vector<char> data;
+    };
+
+    using chunk_writing_f = std::function<result_t(chunk const &)>;
+
+    std::vector<proc::timeline_ptr> const _timelines;
+    sample_rate_t const _sample_rate;
+
+    bouncer(std::vector<proc::timeline_ptr> &&, sample_rate_t const);
+
+    [[nodiscard]] result_t _validate(proc::time::range const &, audio::pcm_format const) const;
+    [[nodiscard]] result_t _bounce(proc::time::range const &, audio::pcm_format const,
+                                   std::vector<channel_index_t> const &file_ch_indices, chunk_writing_f const &) const;
+    [[nodiscard]] chunk _render_chunk(proc::timeline_ptr const &, proc::time::range const &, audio::pcm_format const,
+                                      std::vector<channel_index_t> const &file_ch_indices) const;
+};
+}  // namespace yas::playing
+
+namespace yas {
+std::string to_string(playing::bouncer_error const &);
+}  // namespace yas
+
+std::ostream &operator<<(std::ostream &, yas::playing::bouncer_error const &);
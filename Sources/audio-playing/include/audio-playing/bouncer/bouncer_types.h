@@ -0,0 +1,20 @@
+//
+//  bouncer_types.h
+//
+
+#pragma once
+
+#include <audio-playing/common/types.h>
+#include <cpp-utils/result.h>
+
+namespace yas::playing {
+enum class bouncer_error {
+    invalid_range,
+    invalid_format,
+    create_file_failed,
+    write_file_failed,
+    close_file_failed,
+};
+
+using bouncer_result_t = result<std::nullptr_t, bouncer_error>;
+}  // namespace yas::playing
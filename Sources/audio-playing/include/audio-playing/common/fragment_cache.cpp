@@ -0,0 +1,118 @@
+//
+//  fragment_cache.cpp
+//
+
+#include "fragment_cache.h"
+
+#include <audio-processing/umbrella.hpp>
+
+#include <algorithm>
+
+using namespace yas;
+using namespace yas::playing;
+
+fragment_cache::fragment_cache() {
+}
+
+void fragment_cache::set_capacity(std::size_t const capacity) {
+    std::lock_guard<std::mutex> lock(this->_mutex);
+
+    this->_capacity = capacity;
+
+    if (capacity == 0) {
+        this->_entries.clear();
+    } else {
+        this->_evict_if_needed();
+    }
+}
+
+std::size_t fragment_cache::capacity() const {
+    std::lock_guard<std::mutex> lock(this->_mutex);
+
+    return this->_capacity;
+}
+
+bool fragment_cache::is_enabled() const {
+    return this->capacity() > 0;
+}
+
+void fragment_cache::store(std::string const &frag_path, signal_events_t const &events) {
+    std::lock_guard<std::mutex> lock(this->_mutex);
+
+    if (this->_capacity == 0) {
+        return;
+    }
+
+    this->_entries.insert_or_assign(
+        frag_path, entry{.signal_events = events, .is_persisted = false, .used_count = ++this->_used_count});
+
+    this->_evict_if_needed();
+}
+
+void fragment_cache::persist(std::string const &frag_path) {
+    std::lock_guard<std::mutex> lock(this->_mutex);
+
+    if (auto iterator = this->_entries.find(frag_path); iterator != this->_entries.end()) {
+        iterator->second.is_persisted = true;
+    }
+
+    this->_evict_if_needed();
+}
+
+std::optional<fragment_cache::signal_events_t> fragment_cache::find(std::string const &frag_path) {
+    std::lock_guard<std::mutex> lock(this->_mutex);
+
+    auto iterator = this->_entries.find(frag_path);
+    if (iterator == this->_entries.end()) {
+        return std::nullopt;
+    }
+
+    iterator->second.used_count = ++this->_used_count;
+
+    return iterator->second.signal_events;
+}
+
+void fragment_cache::erase(std::string const &frag_path) {
+    std::lock_guard<std::mutex> lock(this->_mutex);
+
+    this->_entries.erase(frag_path);
+}
+
+void fragment_cache::clear() {
+    std::lock_guard<std::mutex> lock(this->_mutex);
+
+    this->_entries.clear();
+}
+
+std::size_t fragment_cache::size() const {
+    std::lock_guard<std::mutex> lock(this->_mutex);
+
+    return this->_entries.size();
+}
+
+void fragment_cache::_evict_if_needed() {
+    // ファイルに書き終わったものの中から、使われてから一番時間の経ったものを消す
+    while (this->_entries.size() > this->_capacity) {
+        auto oldest = this->_entries.end();
+
+        for (auto iterator = this->_entries.begin(); iterator != this->_entries.end(); ++iterator) {
+            if (!iterator->second.is_persisted) {
+                continue;
+            }
+
+            if (oldest == this->_entries.end() || iterator->second.used_count < oldest->second.used_count) {
+                oldest = iterator;
+            }
+        }
+
+        if (oldest == this->_entries.end()) {
+            return;
+        }
+
+        this->_entries.erase(oldest);
+    }
+}
+
+fragment_cache_ptr fragment_cache::make_shared() {
+    return fragment_cache_ptr(new fragment_cache{});
+}
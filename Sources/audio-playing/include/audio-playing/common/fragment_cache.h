@@ -0,0 +1,58 @@
+//
+//  fragment_cache.h
+//
+
+#pragma once
+
+#include <audio-playing/common/ptr.h>
+#include <audio-playing/common/types.h>
+#include <audio-processing/event/signal_event.h>
+#include <audio-processing/time/time.h>
+
+#include <map>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace yas::playing {
+// 書き出したばかりのフラグメントのsignal_eventをメモリに置いておく
+// 再生側はファイルより先にここを見るので、
+// 書き込んでから読み直すのを待たずに鳴らせる
+struct fragment_cache final {
+    using signal_events_t = std::vector<std::pair<proc::time::range, proc::signal_event_ptr>>;
+
+    // 保持するフラグメントの数。0なら使わない
+    void set_capacity(std::size_t const);
+    [[nodiscard]] std::size_t capacity() const;
+    [[nodiscard]] bool is_enabled() const;
+
+    // キーはpath::fragmentのパス。入れた後にsignal_eventの中身は書き換えない
+    // ファイルに書き終わってpersistするまではcapacityを超えても消さない
+    void store(std::string const &frag_path, signal_events_t const &);
+    void persist(std::string const &frag_path);
+    [[nodiscard]] std::optional<signal_events_t> find(std::string const &frag_path);
+    void erase(std::string const &frag_path);
+    void clear();
+
+    [[nodiscard]] std::size_t size() const;
+
+    [[nodiscard]] static fragment_cache_ptr make_shared();
+
+   private:
+    struct entry final {
+        signal_events_t signal_events;
+        bool is_persisted;
+        uint64_t used_count;
+    };
+
+    std::size_t _capacity = 0;
+    std::map<std::string, entry> _entries;
+    uint64_t _used_count = 0;
+    mutable std::mutex _mutex;
+
+    fragment_cache();
+
+    void _evict_if_needed();
+};
+}  // namespace yas::playing
@@ -16,12 +16,17 @@ using namespace yas::playing::path;
 
 std::filesystem::path timeline::value() const {
     auto path = this->root_path;
-    return path.append(timeline_name(this->identifier, this->sample_rate));
+    return path.append(timeline_name(this->identifier, this->sample_rate, this->fragment_length));
+}
+
+sample_rate_t timeline::resolved_fragment_length() const {
+    return this->fragment_length > 0 ? this->fragment_length : this->sample_rate;
 }
 
 bool timeline::operator==(timeline const &rhs) const {
     return this->root_path == rhs.root_path && this->identifier == rhs.identifier &&
-           this->sample_rate == rhs.sample_rate;
+           this->sample_rate == rhs.sample_rate &&
+           this->resolved_fragment_length() == rhs.resolved_fragment_length();
 }
 
 bool timeline::operator!=(timeline const &rhs) const {
@@ -84,10 +89,62 @@ bool number_events::operator!=(number_events const &rhs) const {
     return !(*this == rhs);
 }
 
+#pragma mark - path::manifest
+
+std::filesystem::path manifest::value() const {
+    auto path = this->timeline_path.root_path;
+    auto const &tl_path = this->timeline_path;
+    return path.append(manifest_name(tl_path.identifier, tl_path.sample_rate, tl_path.fragment_length));
+}
+
+bool manifest::operator==(manifest const &rhs) const {
+    return this->timeline_path == rhs.timeline_path;
+}
+
+bool manifest::operator!=(manifest const &rhs) const {
+    return !(*this == rhs);
+}
+
+#pragma mark - path::history
+
+std::filesystem::path history::value() const {
+    auto path = this->timeline_path.root_path;
+    auto const &tl_path = this->timeline_path;
+    return path.append(history_name(tl_path.identifier, tl_path.sample_rate, tl_path.fragment_length));
+}
+
+bool history::operator==(history const &rhs) const {
+    return this->timeline_path == rhs.timeline_path;
+}
+
+bool history::operator!=(history const &rhs) const {
+    return !(*this == rhs);
+}
+
+#pragma mark - path::history_version
+
+std::filesystem::path history_version::value() const {
+    auto path = this->history_path.value();
+    return path.append(std::to_string(this->serial));
+}
+
+bool history_version::operator==(history_version const &rhs) const {
+    return this->history_path == rhs.history_path && this->serial == rhs.serial;
+}
+
+bool history_version::operator!=(history_version const &rhs) const {
+    return !(*this == rhs);
+}
+
 #pragma mark - name
 
-std::string path::timeline_name(std::string const &identifier, sample_rate_t const sr) {
-    return identifier + "_" + std::to_string(sr);
+std::string path::timeline_name(std::string const &identifier, sample_rate_t const sr,
+                                sample_rate_t const frag_length) {
+    if (frag_length == 0 || frag_length == sr) {
+        return identifier + "_" + std::to_string(sr);
+    } else {
+        return identifier + "_" + std::to_string(sr) + "_" + std::to_string(frag_length);
+    }
 }
 
 std::string path::channel_name(channel_index_t const ch_idx) {
@@ -97,3 +154,13 @@ std::string path::channel_name(channel_index_t const ch_idx) {
 std::string path::fragment_name(fragment_index_t const frag_idx) {
     return std::to_string(frag_idx);
 }
+
+std::string path::manifest_name(std::string const &identifier, sample_rate_t const sr,
+                                sample_rate_t const frag_length) {
+    return timeline_name(identifier, sr, frag_length) + ".manifest";
+}
+
+std::string path::history_name(std::string const &identifier, sample_rate_t const sr,
+                               sample_rate_t const frag_length) {
+    return timeline_name(identifier, sr, frag_length) + ".history";
+}
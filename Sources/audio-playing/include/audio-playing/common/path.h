@@ -15,8 +15,11 @@ struct [[nodiscard]] timeline final {
     std::filesystem::path root_path;
     std::string identifier;
     sample_rate_t sample_rate;
+    // 1フラグメントのフレーム数。0ならsample_rateと同じ1秒
+    sample_rate_t fragment_length = 0;
 
     [[nodiscard]] std::filesystem::path value() const;
+    [[nodiscard]] sample_rate_t resolved_fragment_length() const;
 
     bool operator==(timeline const &rhs) const;
     bool operator!=(timeline const &rhs) const;
@@ -62,7 +65,45 @@ struct [[nodiscard]] number_events final {
     bool operator!=(number_events const &rhs) const;
 };
 
-[[nodiscard]] std::string timeline_name(std::string const &identifier, sample_rate_t const);
+// タイムラインのディレクトリと並べて置く
+struct [[nodiscard]] manifest final {
+    timeline timeline_path;
+
+    [[nodiscard]] std::filesystem::path value() const;
+
+    bool operator==(manifest const &rhs) const;
+    bool operator!=(manifest const &rhs) const;
+};
+
+// 書き出し直す前のフラグメントを残しておくところ
+// タイムラインのディレクトリと並べて置く
+struct [[nodiscard]] history final {
+    timeline timeline_path;
+
+    [[nodiscard]] std::filesystem::path value() const;
+
+    bool operator==(history const &rhs) const;
+    bool operator!=(history const &rhs) const;
+};
+
+// 残したフラグメントひとつ分。中にチャンネルごとのディレクトリを置く
+struct [[nodiscard]] history_version final {
+    history history_path;
+    uint64_t serial;
+
+    [[nodiscard]] std::filesystem::path value() const;
+
+    bool operator==(history_version const &rhs) const;
+    bool operator!=(history_version const &rhs) const;
+};
+
+// フラグメントの長さが1秒でなければ名前に含めて、1秒のものと混ざらないようにする
+[[nodiscard]] std::string timeline_name(std::string const &identifier, sample_rate_t const,
+                                        sample_rate_t const frag_length = 0);
 [[nodiscard]] std::string channel_name(channel_index_t const ch_idx);
 [[nodiscard]] std::string fragment_name(fragment_index_t const frag_idx);
+[[nodiscard]] std::string manifest_name(std::string const &identifier, sample_rate_t const,
+                                        sample_rate_t const frag_length = 0);
+[[nodiscard]] std::string history_name(std::string const &identifier, sample_rate_t const,
+                                       sample_rate_t const frag_length = 0);
 }  // namespace yas::playing::path
@@ -9,6 +9,11 @@
 namespace yas::playing {
 class exporter;
 class exporter_resource;
+class exporter_history;
+class exporter_profiler;
+class exporter_track_cache;
+class exporter_trash;
+class fragment_cache;
 class timeline_container;
 class timeline_canceller;
 class cancel_id;
@@ -18,20 +23,27 @@ class player;
 class buffering_resource;
 class buffering_channel;
 class buffering_element;
-class reading_resource;
+class buffering_loader;
+class buffering_render_core;
 class player_resource;
+class bouncer;
+class wave_file;
 
 class player_for_coordinator;
 class renderer_for_coordinator;
 class buffering_element_for_buffering_channel;
 class buffering_channel_for_buffering_resource;
 class buffering_resource_for_player_resource;
-class reading_resource_for_player_resource;
 class player_resource_for_player;
 class exporter_for_coordinator;
 
 using exporter_ptr = std::shared_ptr<exporter>;
 using exporter_resource_ptr = std::shared_ptr<exporter_resource>;
+using exporter_history_ptr = std::shared_ptr<exporter_history>;
+using exporter_profiler_ptr = std::shared_ptr<exporter_profiler>;
+using exporter_track_cache_ptr = std::shared_ptr<exporter_track_cache>;
+using exporter_trash_ptr = std::shared_ptr<exporter_trash>;
+using fragment_cache_ptr = std::shared_ptr<fragment_cache>;
 using timeline_container_ptr = std::shared_ptr<timeline_container>;
 using coordinator_ptr = std::shared_ptr<coordinator>;
 using timeline_cancel_matcher_ptr = std::shared_ptr<timeline_canceller>;
@@ -41,6 +53,9 @@ using cancel_id_ptr = std::shared_ptr<cancel_id>;
 using buffering_resource_ptr = std::shared_ptr<buffering_resource>;
 using buffering_channel_ptr = std::shared_ptr<buffering_channel>;
 using buffering_element_ptr = std::shared_ptr<buffering_element>;
-using reading_resource_ptr = std::shared_ptr<reading_resource>;
+using buffering_loader_ptr = std::shared_ptr<buffering_loader>;
+using buffering_render_core_ptr = std::shared_ptr<buffering_render_core>;
 using player_resource_ptr = std::shared_ptr<player_resource>;
+using bouncer_ptr = std::shared_ptr<bouncer>;
+using wave_file_ptr = std::shared_ptr<wave_file>;
 }  // namespace yas::playing
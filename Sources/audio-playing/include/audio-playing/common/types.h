@@ -39,9 +39,11 @@ struct fragment_range {
 struct element_address {
     std::optional<channel_index_t> file_channel_index;  // nulloptは全ch
     fragment_range fragment_range;
+    bool keeps_reading = false;  // trueならレンダリングで読み込み中のエレメントは上書きしない
 
     bool operator==(element_address const &rhs) const {
-        return this->file_channel_index == rhs.file_channel_index && this->fragment_range == rhs.fragment_range;
+        return this->file_channel_index == rhs.file_channel_index && this->fragment_range == rhs.fragment_range &&
+               this->keeps_reading == rhs.keeps_reading;
     }
 
     bool operator!=(element_address const &rhs) const {
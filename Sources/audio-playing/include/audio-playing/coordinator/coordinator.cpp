@@ -7,20 +7,29 @@
 #include <audio-playing/common/channel_mapping.h>
 #include <audio-playing/common/types.h>
 #include <audio-playing/exporter/exporter.h>
+#include <audio-playing/exporter/exporter_storage.h>
 #include <audio-playing/player/buffering_channel.h>
 #include <audio-playing/player/buffering_element.h>
+#include <audio-playing/player/buffering_loader.h>
 #include <audio-playing/player/buffering_resource.h>
 #include <audio-playing/player/player_resource.h>
-#include <audio-playing/player/reading_resource.h>
 #include <audio-playing/timeline/timeline_utils.h>
 #include <cpp-utils/fast_each.h>
+#include <cpp-utils/stl_utils.h>
+#include <cpp-utils/thread.h>
 
+#include <atomic>
 #include <iostream>
 #include <thread>
 
 using namespace yas;
 using namespace yas::playing;
 
+namespace yas::playing::coordinator_utils {
+// playerのタスクより後に処理する
+static uint32_t constexpr playhead_task_priority = 2;
+}  // namespace yas::playing::coordinator_utils
+
 coordinator::coordinator(workable_ptr const &worker, std::shared_ptr<renderer_for_coordinator> const &renderer,
                          std::shared_ptr<player_for_coordinator> const &player,
                          std::shared_ptr<exporter_for_coordinator> const &exporter)
@@ -32,6 +41,13 @@ coordinator::coordinator(workable_ptr const &worker, std::shared_ptr<renderer_fo
                     if (event.range.has_value()) {
                         this->overwrite(event.range.value());
                     }
+                } else if (event.result.value() == exporter_method::export_progressed) {
+                    // 途中まで渡されたときも読み直して、処理したところから鳴らす
+                    // 再生中のエレメントを読み直すと音が途切れるので、読み込み中のものは書き出し終わりを待つ
+                    if (event.range.has_value()) {
+                        this->_player->overwrite_keeping_reading(std::nullopt,
+                                                                 this->_fragment_range(event.range.value()));
+                    }
                 }
             }
         })
@@ -40,12 +56,50 @@ coordinator::coordinator(workable_ptr const &worker, std::shared_ptr<renderer_fo
 
     this->_renderer->observe_format([this](auto const &) { this->_update_exporter(); }).end()->add_to(this->_pool);
 
+    // 再生位置が変わったらメインスレッドで書き出す範囲を追従させる。反映されるまでは次を送らない
+    this->_worker->add_task(
+        coordinator_utils::playhead_task_priority,
+        [weak_player = to_weak(player), weak_exporter = to_weak(exporter),
+         prev_frame = std::optional<frame_index_t>{std::nullopt},
+         is_sending = std::make_shared<std::atomic<bool>>(false)]() mutable {
+            auto const player = weak_player.lock();
+            if (!player || is_sending->load()) {
+                return worker::task_result::unprocessed;
+            }
+
+            auto const frame = player->current_frame();
+            if (prev_frame == frame) {
+                return worker::task_result::unprocessed;
+            }
+
+            prev_frame = frame;
+            is_sending->store(true);
+
+            thread::perform_async_on_main([weak_player, weak_exporter, is_sending] {
+                is_sending->store(false);
+
+                auto const player = weak_player.lock();
+                auto const exporter = weak_exporter.lock();
+                if (player && exporter) {
+                    exporter->set_playhead_frame(player->current_frame());
+                }
+            });
+
+            return worker::task_result::unprocessed;
+        });
+
     this->_worker->start();
 }
 
 void coordinator::set_timeline(proc::timeline_ptr const &timeline, std::string const &identifier) {
+    this->set_timeline(timeline, identifier, std::nullopt);
+}
+
+void coordinator::set_timeline(proc::timeline_ptr const &timeline, std::string const &identifier,
+                               std::optional<std::string> const &fingerprint) {
     this->_timeline = timeline;
     this->_identifier = identifier;
+    this->_fingerprint = fingerprint;
 
     this->_update_exporter();
     this->_player->set_identifier(identifier);
@@ -54,6 +108,7 @@ void coordinator::set_timeline(proc::timeline_ptr const &timeline, std::string c
 void coordinator::reset_timeline() {
     this->_timeline = std::nullopt;
     this->_identifier = "";
+    this->_fingerprint = std::nullopt;
 
     this->_update_exporter();
     this->_player->set_identifier("");
@@ -64,8 +119,16 @@ void coordinator::set_timeline_format(sample_rate_t const sample_rate, audio::pc
     this->_renderer->set_rendering_pcm_format(pcm_format);
 }
 
+void coordinator::set_fragment_length(sample_rate_t const frag_length) {
+    this->_fragment_length = frag_length;
+
+    this->_update_exporter();
+    this->_player->set_fragment_length(frag_length);
+}
+
 void coordinator::set_channel_mapping(playing::channel_mapping const &ch_mapping) {
     this->_player->set_channel_mapping(ch_mapping);
+    this->_update_export_channel_policy(ch_mapping);
 }
 
 void coordinator::set_rendering(bool const is_rendering) {
@@ -82,19 +145,74 @@ void coordinator::set_playing(bool const is_playing) {
 
 void coordinator::seek(frame_index_t const frame) {
     this->_player->seek(frame);
+    this->_exporter->set_playhead_frame(frame);
 }
 
 void coordinator::overwrite(proc::time::range const &range) {
-    auto &player = this->_player;
-    auto const sample_rate = this->format().sample_rate;
+    this->_player->overwrite(std::nullopt, this->_fragment_range(range));
+}
 
-    proc::time::range const frags_range = timeline_utils::fragments_range(range, sample_rate);
+void coordinator::set_buffering_element_count(std::size_t const element_count) {
+    this->_player->set_buffering_element_count(element_count);
+}
 
-    auto const begin_frag_idx = frags_range.frame / sample_rate;
-    auto const next_frag_idx = frags_range.next_frame() / sample_rate;
-    auto const length = static_cast<length_t>(next_frag_idx - begin_frag_idx);
+void coordinator::set_buffering_depth_policy(std::optional<buffering_depth_policy> const &policy) {
+    this->_player->set_buffering_depth_policy(policy);
+}
+
+void coordinator::set_export_window(std::optional<exporter_window> const &window) {
+    this->_exporter->set_window(window);
+}
+
+void coordinator::set_export_pinned_ranges(std::vector<proc::time::range> const &ranges) {
+    this->_exporter->set_pinned_ranges(ranges);
+}
+
+void coordinator::update_export_playhead() {
+    this->_exporter->set_playhead_frame(this->_player->current_frame());
+}
+
+void coordinator::set_export_storage_policy(exporter_storage_policy const &policy) {
+    this->_storage_policy = policy;
+    this->_exporter->set_storage_policy(
+        exporter_storage::resolved(this->_storage_policy, this->_renderer->format().pcm_format));
+}
+
+void coordinator::set_export_channel_policy(exporter_channel_policy const &policy) {
+    this->_channel_policy = policy;
+    this->_update_export_channel_policy(this->_player->channel_mapping());
+}
+
+void coordinator::set_export_profiling_enabled(bool const is_enabled) {
+    this->_exporter->set_profiling_enabled(is_enabled);
+}
+
+void coordinator::set_export_track_cache_capacity(std::size_t const capacity) {
+    this->_exporter->set_track_cache_capacity(capacity);
+}
+
+void coordinator::set_export_history_capacity(std::size_t const capacity) {
+    this->_exporter->set_history_capacity(capacity);
+}
 
-    player->overwrite(std::nullopt, {.index = begin_frag_idx, .length = length});
+void coordinator::set_export_fragment_cache_capacity(std::size_t const capacity) {
+    this->_exporter->set_fragment_cache_capacity(capacity);
+}
+
+void coordinator::set_export_slice_policy(exporter_slice_policy const &policy) {
+    this->_exporter->set_slice_policy(policy);
+}
+
+void coordinator::set_export_module_key_handler(exporter_module_key_f const &handler) {
+    this->_exporter->set_module_key_handler(handler);
+}
+
+void coordinator::begin_edit() {
+    this->_exporter->begin_edit();
+}
+
+void coordinator::commit_edit() {
+    this->_exporter->commit_edit();
 }
 
 std::string const &coordinator::identifier() const {
@@ -125,6 +243,10 @@ renderer_format const &coordinator::format() const {
     return this->_renderer->format();
 }
 
+exporter_profile_report coordinator::export_profile_report() const {
+    return this->_exporter->profile_report();
+}
+
 observing::syncable coordinator::observe_format(std::function<void(renderer_format const &)> &&handler) {
     return this->_renderer->observe_format(std::move(handler));
 }
@@ -134,21 +256,77 @@ observing::syncable coordinator::observe_is_playing(std::function<void(bool cons
 }
 
 void coordinator::_update_exporter() {
-    this->_exporter->set_timeline_container(
-        timeline_container::make_shared(this->_identifier, this->_renderer->format().sample_rate, this->_timeline));
+    auto const &format = this->_renderer->format();
+
+    this->_exporter->set_storage_policy(exporter_storage::resolved(this->_storage_policy, format.pcm_format));
+    this->_update_export_channel_policy(this->_player->channel_mapping());
+    this->_exporter->set_timeline_container(timeline_container::make_shared(
+        this->_identifier, format.sample_rate, this->_timeline, this->_fingerprint, this->_fragment_length));
+}
+
+sample_rate_t coordinator::_resolved_fragment_length() const {
+    return this->_fragment_length > 0 ? this->_fragment_length : this->format().sample_rate;
+}
+
+fragment_range coordinator::_fragment_range(proc::time::range const &range) const {
+    auto const frag_length = this->_resolved_fragment_length();
+
+    proc::time::range const frags_range = timeline_utils::fragments_range(range, frag_length);
+
+    auto const begin_frag_idx = frags_range.frame / frag_length;
+    auto const next_frag_idx = frags_range.next_frame() / frag_length;
+    auto const length = static_cast<length_t>(next_frag_idx - begin_frag_idx);
+
+    return {.index = begin_frag_idx, .length = length};
+}
+
+void coordinator::_update_export_channel_policy(playing::channel_mapping const &ch_mapping) {
+    auto const &ch_count = this->_renderer->format().channel_count;
+    auto policy = this->_channel_policy;
+
+    // 出力のチャンネル数が決まっていなければ全て割り当てられているものとして扱う
+    if (ch_count > 0) {
+        std::set<channel_index_t> mapped_channels;
+
+        auto each = make_fast_each(static_cast<channel_index_t>(ch_count));
+        while (yas_each_next(each)) {
+            if (auto const file_ch_idx = ch_mapping.file_index(yas_each_index(each), ch_count)) {
+                mapped_channels.insert(file_ch_idx.value());
+            }
+        }
+
+        policy.mapped_channels = std::move(mapped_channels);
+    } else {
+        policy.mapped_channels = std::nullopt;
+    }
+
+    this->_exporter->set_channel_policy(policy);
 }
 
 coordinator_ptr coordinator::make_shared(std::string const &root_path, std::shared_ptr<renderer> const &renderer) {
-    auto const worker = worker::make_shared();
+    return make_shared(root_path, renderer, 4);
+}
 
-    auto const player = player::make_shared(
-        root_path, renderer, worker, {},
-        player_resource::make_shared(reading_resource::make_shared(),
-                                     buffering_resource::make_shared(3, root_path, playing::make_buffering_channel)));
+coordinator_ptr coordinator::make_shared(std::string const &root_path, std::shared_ptr<renderer> const &renderer,
+                                         std::size_t const loader_thread_count) {
+    auto const worker = worker::make_shared();
 
     auto const exporter =
         exporter::make_shared(root_path, exporter_task_queue::make_shared(2), {.timeline = 0, .fragment = 1});
 
+    // 書き出したばかりのフラグメントはファイルを読まずに使う
+    auto make_channel = [fragment_cache = exporter->fragment_cache()](
+                            std::size_t const element_count, audio::format const &format,
+                            sample_rate_t const frag_length) {
+        return playing::make_buffering_channel(element_count, format, frag_length, fragment_cache);
+    };
+
+    auto const loader = buffering_loader::make_shared(loader_thread_count);
+
+    auto const player = player::make_shared(
+        root_path, renderer, worker, {},
+        player_resource::make_shared(buffering_resource::make_shared(3, root_path, std::move(make_channel), loader)));
+
     return make_shared(worker, renderer, player, exporter);
 }
 
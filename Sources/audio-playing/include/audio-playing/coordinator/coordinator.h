@@ -17,14 +17,46 @@
 namespace yas::playing {
 struct coordinator final {
     void set_timeline(proc::timeline_ptr const &, std::string const &identifier);
+    // fingerprintが前回と同じなら再起動後も書き出し済みのフラグメントを使い回す
+    void set_timeline(proc::timeline_ptr const &, std::string const &identifier,
+                      std::optional<std::string> const &fingerprint);
     void reset_timeline();
     void set_timeline_format(sample_rate_t const, audio::pcm_format const);
+    // 1フラグメントのフレーム数。短くするとシークや編集で読み込み直す量が減る。0なら1秒
+    void set_fragment_length(sample_rate_t const);
     void set_channel_mapping(channel_mapping const &);
     void set_rendering(bool const);
     void set_playing(bool const);
     void seek(frame_index_t const);
     void overwrite(proc::time::range const &);
 
+    // 再生時に先読みしておくフラグメントの数。変更すると読み込み直す
+    void set_buffering_element_count(std::size_t const);
+    // 指定すると読み込みにかかる時間に合わせて先読みするフラグメントの数を増減させる
+    void set_buffering_depth_policy(std::optional<buffering_depth_policy> const &);
+
+    // windowを指定すると再生位置の周辺とpinnedの範囲だけを書き出す
+    void set_export_window(std::optional<exporter_window> const &);
+    void set_export_pinned_ranges(std::vector<proc::time::range> const &);
+    // 書き出す範囲は再生位置に自動で追従する。すぐに反映させたい時だけ呼ぶ
+    void update_export_playhead();
+    // renderingを指定すると再生時のpcm_formatに合わせて書き出す
+    void set_export_storage_policy(exporter_storage_policy const &);
+    // mapped_channelsはchannel_mappingから埋めるので指定しなくて良い
+    void set_export_channel_policy(exporter_channel_policy const &);
+    void set_export_profiling_enabled(bool const);
+    void set_export_track_cache_capacity(std::size_t const);
+    // 元に戻すときにモジュールを作り直すなら、set_export_module_key_handlerで同じキーを返すと残したものを使う
+    void set_export_history_capacity(std::size_t const);
+    void set_export_fragment_cache_capacity(std::size_t const);
+    void set_export_slice_policy(exporter_slice_policy const &);
+    // 書き出す内容が同じモジュールに同じキーを返すと、タイムラインを作り直しても変わったところだけを書き出す
+    void set_export_module_key_handler(exporter_module_key_f const &);
+
+    // まとめて編集するときに囲むと、書き出しがcommit_editで1回にまとまる
+    void begin_edit();
+    void commit_edit();
+
     [[nodiscard]] std::string const &identifier() const;
     [[nodiscard]] std::optional<proc::timeline_ptr> const &timeline() const;
     [[nodiscard]] channel_mapping channel_mapping() const;
@@ -33,11 +65,15 @@ struct coordinator final {
     [[nodiscard]] frame_index_t current_frame() const;
 
     [[nodiscard]] renderer_format const &format() const;
+    [[nodiscard]] exporter_profile_report export_profile_report() const;
 
     [[nodiscard]] observing::syncable observe_format(std::function<void(renderer_format const &)> &&);
     [[nodiscard]] observing::syncable observe_is_playing(std::function<void(bool const &)> &&);
 
     [[nodiscard]] static coordinator_ptr make_shared(std::string const &root_path, std::shared_ptr<renderer> const &);
+    // loader_thread_count: 再生のためにフラグメントを読み込むスレッドの数。1ならworkerのスレッドだけで読む
+    [[nodiscard]] static coordinator_ptr make_shared(std::string const &root_path, std::shared_ptr<renderer> const &,
+                                                     std::size_t const loader_thread_count);
     [[nodiscard]] static coordinator_ptr make_shared(workable_ptr const &,
                                                      std::shared_ptr<renderer_for_coordinator> const &,
                                                      std::shared_ptr<player_for_coordinator> const &,
@@ -50,12 +86,19 @@ struct coordinator final {
     std::shared_ptr<exporter_for_coordinator> const _exporter;
     std::string _identifier = "";
     std::optional<proc::timeline_ptr> _timeline = std::nullopt;
+    std::optional<std::string> _fingerprint = std::nullopt;
+    sample_rate_t _fragment_length = 0;
+    exporter_storage_policy _storage_policy;
+    exporter_channel_policy _channel_policy;
 
     observing::canceller_pool _pool;
 
     coordinator(workable_ptr const &, std::shared_ptr<renderer_for_coordinator> const &,
                 std::shared_ptr<player_for_coordinator> const &, std::shared_ptr<exporter_for_coordinator> const &);
 
+    [[nodiscard]] sample_rate_t _resolved_fragment_length() const;
+    [[nodiscard]] fragment_range _fragment_range(proc::time::range const &) const;
     void _update_exporter();
+    void _update_export_channel_policy(playing::channel_mapping const &);
 };
 }  // namespace yas::playing
@@ -5,7 +5,9 @@
 #pragma once
 
 #include <audio-playing/common/channel_mapping.h>
+#include <audio-playing/exporter/exporter_profiler.h>
 #include <audio-playing/exporter/exporter_types.h>
+#include <audio-playing/player/buffering_resource_types.h>
 #include <audio-playing/renderer/renderer_types.h>
 
 #include <observing/umbrella.hpp>
@@ -33,11 +35,16 @@ struct player_for_coordinator {
     virtual void set_playing(bool const) = 0;
     virtual void seek(frame_index_t const) = 0;
     virtual void overwrite(std::optional<channel_index_t> const, fragment_range const) = 0;
+    virtual void overwrite_keeping_reading(std::optional<channel_index_t> const, fragment_range const) = 0;
+    virtual void set_buffering_element_count(std::size_t const) = 0;
+    virtual void set_buffering_depth_policy(std::optional<buffering_depth_policy> const &) = 0;
+    virtual void set_fragment_length(sample_rate_t const) = 0;
 
     [[nodiscard]] virtual std::string const &identifier() const = 0;
     [[nodiscard]] virtual playing::channel_mapping channel_mapping() const = 0;
     [[nodiscard]] virtual bool is_playing() const = 0;
     [[nodiscard]] virtual bool is_seeking() const = 0;
+    // workerのスレッドからも呼ばれる
     [[nodiscard]] virtual frame_index_t current_frame() const = 0;
 
     [[nodiscard]] virtual observing::syncable observe_is_playing(std::function<void(bool const &)> &&) = 0;
@@ -47,6 +54,21 @@ struct exporter_for_coordinator {
     virtual ~exporter_for_coordinator() = default;
 
     virtual void set_timeline_container(timeline_container_ptr const &) = 0;
+    virtual void set_window(std::optional<exporter_window> const &) = 0;
+    virtual void set_playhead_frame(frame_index_t const) = 0;
+    virtual void set_pinned_ranges(std::vector<proc::time::range> const &) = 0;
+    virtual void set_storage_policy(exporter_storage_policy const &) = 0;
+    virtual void set_channel_policy(exporter_channel_policy const &) = 0;
+    virtual void set_profiling_enabled(bool const) = 0;
+    virtual void set_track_cache_capacity(std::size_t const) = 0;
+    virtual void set_history_capacity(std::size_t const) = 0;
+    virtual void set_fragment_cache_capacity(std::size_t const) = 0;
+    virtual void set_slice_policy(exporter_slice_policy const &) = 0;
+    virtual void set_module_key_handler(exporter_module_key_f const &) = 0;
+    virtual void begin_edit() = 0;
+    virtual void commit_edit() = 0;
+
+    [[nodiscard]] virtual exporter_profile_report profile_report() const = 0;
 
     using event_observing_handler_f = std::function<void(exporter_event const &)>;
     [[nodiscard]] virtual observing::endable observe_event(event_observing_handler_f &&) = 0;
@@ -21,6 +21,8 @@
 
 #include <audio-processing/umbrella.hpp>
 
+#include <algorithm>
+
 using namespace yas;
 using namespace yas::playing;
 
@@ -39,6 +41,10 @@ exporter::exporter(std::string const &root_path, std::shared_ptr<task_queue_t> c
                     canceller = nullptr;
                 }
 
+                if (!container->is_available()) {
+                    this->_signature = std::nullopt;
+                }
+
                 if (container->is_available()) {
                     container->timeline()
                         ->get()
@@ -54,9 +60,147 @@ exporter::exporter(std::string const &root_path, std::shared_ptr<task_queue_t> c
 void exporter::set_timeline_container(timeline_container_ptr const &container) {
     assert(thread::is_main());
 
+    // 出力のチャンネル数やpcm_formatだけが変わった場合は書き出し直さない
+    if (*this->_container->value() == *container) {
+        return;
+    }
+
     this->_container->set_value(container);
 }
 
+void exporter::set_window(std::optional<exporter_window> const &window) {
+    assert(thread::is_main());
+
+    this->_window = window;
+    this->_update_window();
+}
+
+void exporter::set_playhead_frame(frame_index_t const frame) {
+    assert(thread::is_main());
+
+    this->_playhead_frame = frame;
+    this->_resource->set_playhead_frame(frame);
+    this->_update_window();
+}
+
+void exporter::set_pinned_ranges(std::vector<proc::time::range> const &ranges) {
+    assert(thread::is_main());
+
+    this->_pinned_ranges = ranges;
+    this->_update_window();
+}
+
+void exporter::set_storage_policy(exporter_storage_policy const &policy) {
+    assert(thread::is_main());
+
+    if (this->_storage_policy == policy) {
+        return;
+    }
+
+    this->_storage_policy = policy;
+
+    if (!this->_container->value()->is_available()) {
+        return;
+    }
+
+    auto task = exporter_task::make_shared(
+        [resource = this->_resource, policy](auto const &task) {
+            resource->update_storage_policy_on_task(policy, task);
+        },
+        {.priority = this->_priority.timeline});
+
+    this->_queue->push_back(std::move(task));
+}
+
+void exporter::set_channel_policy(exporter_channel_policy const &policy) {
+    assert(thread::is_main());
+
+    if (this->_channel_policy == policy) {
+        return;
+    }
+
+    this->_channel_policy = policy;
+
+    // タイムラインがなくてもresourceに持たせておく
+    auto task = exporter_task::make_shared(
+        [resource = this->_resource, policy](auto const &task) {
+            resource->update_channel_policy_on_task(policy, task);
+        },
+        {.priority = this->_priority.timeline});
+
+    this->_queue->push_back(std::move(task));
+}
+
+void exporter::set_profiling_enabled(bool const is_enabled) {
+    this->_resource->profiler->set_enabled(is_enabled);
+}
+
+void exporter::set_track_cache_capacity(std::size_t const capacity) {
+    this->_resource->track_cache->set_capacity(capacity);
+}
+
+void exporter::set_history_capacity(std::size_t const capacity) {
+    assert(thread::is_main());
+
+    this->_history_capacity = capacity;
+    this->_resource->history->set_capacity(capacity);
+}
+
+void exporter::set_fragment_cache_capacity(std::size_t const capacity) {
+    this->_resource->fragment_cache->set_capacity(capacity);
+}
+
+void exporter::set_slice_policy(exporter_slice_policy const &policy) {
+    this->_resource->set_slice_policy(policy);
+}
+
+void exporter::set_module_key_handler(exporter_module_key_f const &handler) {
+    assert(thread::is_main());
+
+    this->_module_key_handler = handler;
+
+    // 次の差分は新しいキーで取った今のタイムラインと比べる。編集中は編集前のものを残しておく
+    if (this->_signature.has_value() && !this->is_editing()) {
+        this->_reset_signature();
+    }
+}
+
+void exporter::begin_edit() {
+    assert(thread::is_main());
+
+    ++this->_edit_depth;
+}
+
+void exporter::commit_edit() {
+    assert(thread::is_main());
+
+    if (this->_edit_depth == 0) {
+        return;
+    }
+
+    --this->_edit_depth;
+
+    if (this->_edit_depth == 0) {
+        this->_push_edited_export_tasks();
+    }
+}
+
+bool exporter::is_editing() const {
+    return this->_edit_depth > 0;
+}
+
+exporter_profile_report exporter::profile_report() const {
+    return this->_resource->profiler->report();
+}
+
+fragment_cache_ptr const &exporter::fragment_cache() const {
+    return this->_resource->fragment_cache;
+}
+
+void exporter::reset_profile_report() {
+    this->_resource->profiler->reset();
+}
+
 observing::endable exporter::observe_event(event_observing_handler_f &&handler) {
     return this->_resource->event_notifier->observe(std::move(handler));
 }
@@ -64,7 +208,13 @@ observing::endable exporter::observe_event(event_observing_handler_f &&handler)
 void exporter::_receive_timeline_event(proc::timeline_event const &event) {
     switch (event.type) {
         case proc::timeline_event_type::any: {
-            this->_update_timeline(proc::copy_tracks(event.tracks));
+            auto signature = this->_make_signature(event.tracks);
+            auto const changed_ranges =
+                this->_signature.has_value()
+                    ? exporter_timeline_diff::changed_ranges(this->_signature.value(), signature)
+                    : std::nullopt;
+            this->_signature = std::move(signature);
+            this->_update_timeline(proc::copy_tracks(event.tracks), changed_ranges);
         } break;
         case proc::timeline_event_type::inserted: {
             this->_insert_track(event);
@@ -109,23 +259,90 @@ void exporter::_receive_relayed_track_event(proc::track_event const &event, trac
     }
 }
 
-void exporter::_update_timeline(proc::timeline::track_map_t &&tracks) {
+void exporter::_update_timeline(proc::timeline::track_map_t &&tracks,
+                                std::optional<std::vector<proc::time::range>> const &changed_ranges) {
     assert(thread::is_main());
 
-    this->_queue->cancel_all();
+    // 差分だけを書き出すときは、それまでの変更のタスクを残しておく
+    if (!changed_ranges.has_value()) {
+        this->_queue->cancel_all();
+        // 全体を書き出し直すので保留していたものは要らない
+        this->_edited_ranges.clear();
+    }
 
     auto const &container = this->_container->value();
 
+    this->_window_frag_ranges = this->_make_window_fragment_ranges();
+
     auto task = exporter_task::make_shared(
         [resource = this->_resource, tracks = std::move(tracks), identifier = container->identifier(),
-         sample_rate = container->sample_rate()](auto const &task) mutable {
-            resource->replace_timeline_on_task(std::move(tracks), identifier, sample_rate, task);
+         sample_rate = container->sample_rate(), frag_length = container->fragment_length(),
+         fingerprint = container->fingerprint(), storage_policy = this->_storage_policy,
+         window = this->_window_frag_ranges, changed_ranges](auto const &task) mutable {
+            resource->replace_timeline_on_task(std::move(tracks), identifier, sample_rate, frag_length, fingerprint,
+                                               storage_policy, window, changed_ranges, task);
         },
         {.priority = this->_priority.timeline});
 
     this->_queue->push_back(std::move(task));
 }
 
+void exporter::_reset_signature() {
+    auto const &container = this->_container->value();
+    if (!container->is_available()) {
+        return;
+    }
+
+    this->_signature = this->_make_signature(container->timeline().value()->tracks());
+}
+
+exporter_timeline_signature exporter::_make_signature(proc::timeline::track_map_t const &tracks) {
+    auto const &container = this->_container->value();
+    return exporter_timeline_diff::make_signature(container->identifier(), container->sample_rate(), tracks,
+                                                  this->_module_key_function());
+}
+
+void exporter::_update_signature(std::optional<proc::time::range> const &range,
+                                 std::function<void(exporter_timeline_signature &)> const &update) {
+    auto const &container = this->_container->value();
+
+    // 編集中は履歴のrevisionを編集前と比べるために更新せず、commit_editで作り直す
+    if (this->is_editing() || !this->_signature.has_value() || !container->is_available()) {
+        return;
+    }
+
+    auto &signature = this->_signature.value();
+
+    if (this->_history_capacity == 0 || !range.has_value()) {
+        update(signature);
+        return;
+    }
+
+    auto const frag_length = container->fragment_length();
+    auto const frag_range =
+        timeline_utils::to_fragment_range(timeline_utils::fragments_range(range.value(), frag_length), frag_length);
+
+    auto previous = exporter_timeline_diff::fragment_revisions(signature, frag_range, frag_length);
+    update(signature);
+    auto current = exporter_timeline_diff::fragment_revisions(signature, frag_range, frag_length);
+
+    this->_push_revisions_task(std::move(previous), std::move(current));
+}
+
+void exporter::_update_track_signature(track_index_t const trk_idx, std::optional<proc::time::range> const &range) {
+    this->_update_signature(range, [this, trk_idx](exporter_timeline_signature &signature) {
+        auto const &tracks = this->_container->value()->timeline().value()->tracks();
+        exporter_timeline_diff::update_track(signature, trk_idx, tracks, this->_module_key_function());
+    });
+}
+
+void exporter::_update_module_set_signature(track_index_t const trk_idx, proc::time::range const &range) {
+    this->_update_signature(range, [this, trk_idx, range](exporter_timeline_signature &signature) {
+        auto const &tracks = this->_container->value()->timeline().value()->tracks();
+        exporter_timeline_diff::update_module_set(signature, trk_idx, range, tracks, this->_module_key_function());
+    });
+}
+
 void exporter::_insert_track(proc::timeline_event const &event) {
     assert(thread::is_main());
 
@@ -139,6 +356,8 @@ void exporter::_insert_track(proc::timeline_event const &event) {
         {.priority = this->_priority.timeline});
     this->_queue->push_back(insert_task);
 
+    this->_update_track_signature(*event.index, total_range);
+
     if (total_range) {
         this->_push_export_task(*total_range);
     }
@@ -154,6 +373,8 @@ void exporter::_erase_track(proc::timeline_event const &event) {
         {.priority = this->_priority.timeline});
     this->_queue->push_back(std::move(erase_task));
 
+    this->_update_track_signature(*event.index, total_range);
+
     if (total_range) {
         this->_push_export_task(*total_range);
     }
@@ -172,6 +393,7 @@ void exporter::_insert_module_set(track_index_t const trk_idx, proc::track_event
         {.priority = this->_priority.timeline});
     this->_queue->push_back(std::move(task));
 
+    this->_update_module_set_signature(trk_idx, range);
     this->_push_export_task(range);
 }
 
@@ -186,6 +408,7 @@ void exporter::_erase_module_set(track_index_t const trk_idx, proc::track_event
                                            {.priority = this->_priority.timeline});
     this->_queue->push_back(std::move(task));
 
+    this->_update_module_set_signature(trk_idx, range);
     this->_push_export_task(range);
 }
 
@@ -200,6 +423,7 @@ void exporter::_insert_module(track_index_t const trk_idx, proc::time::range con
 
     this->_queue->push_back(std::move(task));
 
+    this->_update_module_set_signature(trk_idx, range);
     this->_push_export_task(range);
 }
 
@@ -213,10 +437,16 @@ void exporter::_erase_module(track_index_t const trk_idx, proc::time::range cons
 
     this->_queue->push_back(std::move(task));
 
+    this->_update_module_set_signature(trk_idx, range);
     this->_push_export_task(range);
 }
 
 void exporter::_push_export_task(proc::time::range const &range) {
+    if (this->is_editing()) {
+        this->_edited_ranges.emplace_back(range);
+        return;
+    }
+
     this->_queue->cancel([range](timeline_cancel_matcher_ptr const &matcher) { return matcher->is_cancel(range); });
 
     auto export_task = exporter_task::make_shared(
@@ -226,6 +456,148 @@ void exporter::_push_export_task(proc::time::range const &range) {
     this->_queue->push_back(std::move(export_task));
 }
 
+void exporter::_push_edited_export_tasks() {
+    auto const edited_ranges = std::move(this->_edited_ranges);
+    this->_edited_ranges.clear();
+
+    auto const &container = this->_container->value();
+    if (!container->is_available()) {
+        return;
+    }
+
+    auto const frag_length = container->fragment_length();
+
+    std::vector<fragment_range> frag_ranges;
+    frag_ranges.reserve(edited_ranges.size());
+
+    for (auto const &range : edited_ranges) {
+        frag_ranges.emplace_back(
+            timeline_utils::to_fragment_range(timeline_utils::fragments_range(range, frag_length), frag_length));
+    }
+
+    auto const merged_frag_ranges = timeline_utils::merged_fragment_ranges(std::move(frag_ranges));
+
+    // 編集中は更新していないので、ここで1度だけ作り直して編集前のものと比べる
+    if (this->_signature.has_value()) {
+        auto current = this->_make_signature(container->timeline().value()->tracks());
+
+        if (this->_history_capacity > 0) {
+            for (auto const &frag_range : merged_frag_ranges) {
+                this->_push_revisions_task(
+                    exporter_timeline_diff::fragment_revisions(this->_signature.value(), frag_range, frag_length),
+                    exporter_timeline_diff::fragment_revisions(current, frag_range, frag_length));
+            }
+        }
+
+        this->_signature = std::move(current);
+    }
+
+    // 重なったり隣り合ったりしている範囲はひとつにまとめて書き出す
+    for (auto const &frag_range : merged_frag_ranges) {
+        this->_push_export_task(timeline_utils::to_time_range(frag_range, frag_length));
+    }
+}
+
+void exporter::_push_revisions_task(std::map<fragment_index_t, std::string> &&previous,
+                                    std::map<fragment_index_t, std::string> &&current) {
+    std::map<fragment_index_t, exporter_revision_change> changes;
+
+    for (auto &pair : previous) {
+        changes.emplace(pair.first, exporter_revision_change{.previous = std::move(pair.second),
+                                                             .current = std::move(current.at(pair.first))});
+    }
+
+    auto task = exporter_task::make_shared(
+        [resource = this->_resource, changes = std::move(changes)](auto const &) {
+            resource->update_fragment_revisions_on_task(changes);
+        },
+        {.priority = this->_priority.timeline});
+
+    this->_queue->push_back(std::move(task));
+}
+
+exporter_timeline_diff::module_key_f exporter::_module_key_function() {
+    this->_prune_module_ids();
+
+    return [this](proc::module_ptr const &module) { return this->_module_key(module); };
+}
+
+std::string exporter::_module_key(proc::module_ptr const &module) {
+    // 呼び出し側のキーとインスタンスの通し番号が重ならないように先頭で分ける
+    if (this->_module_key_handler) {
+        if (auto const key = this->_module_key_handler(module); key.has_value()) {
+            return "k" + key.value();
+        }
+    }
+
+    return "i" + std::to_string(this->_module_id(module));
+}
+
+void exporter::_prune_module_ids() {
+    // 毎回辿るとタイムライン全体の長さになるので、前回から倍に増えたときだけ破棄されたモジュールを外す
+    if (this->_module_ids.size() < this->_module_ids_prune_size) {
+        return;
+    }
+
+    std::erase_if(this->_module_ids, [](auto const &pair) { return pair.second.first.expired(); });
+    this->_module_ids_prune_size = std::max(this->_module_ids.size() * 2, std::size_t(64));
+}
+
+uint64_t exporter::_module_id(proc::module_ptr const &module) {
+    auto const iterator = this->_module_ids.find(module.get());
+    if (iterator != this->_module_ids.end() && !iterator->second.first.expired()) {
+        return iterator->second.second;
+    }
+
+    auto const module_id = ++this->_last_module_id;
+    this->_module_ids.insert_or_assign(module.get(), std::make_pair(std::weak_ptr<proc::module>{module}, module_id));
+    return module_id;
+}
+
+void exporter::_update_window() {
+    auto const &container = this->_container->value();
+    if (!container->is_available()) {
+        return;
+    }
+
+    auto window_frag_ranges = this->_make_window_fragment_ranges();
+    if (window_frag_ranges == this->_window_frag_ranges) {
+        return;
+    }
+
+    this->_window_frag_ranges = window_frag_ranges;
+
+    auto task = exporter_task::make_shared(
+        [resource = this->_resource, window = std::move(window_frag_ranges)](auto const &task) {
+            resource->update_window_on_task(window, task);
+        },
+        {.priority = this->_priority.timeline});
+
+    this->_queue->push_back(std::move(task));
+}
+
+std::optional<std::vector<fragment_range>> exporter::_make_window_fragment_ranges() const {
+    auto const &container = this->_container->value();
+
+    if (!this->_window.has_value() || !container->is_available()) {
+        return std::nullopt;
+    }
+
+    auto const &window = this->_window.value();
+    auto const frag_length = container->fragment_length();
+    auto const playhead_frag_idx = math::floor_int(this->_playhead_frame, frag_length) / frag_length;
+
+    std::vector<fragment_range> ranges{
+        {.index = playhead_frag_idx - static_cast<fragment_index_t>(window.preceding_count),
+         .length = window.preceding_count + 1 + window.following_count}};
+
+    for (auto const &pinned_range : this->_pinned_ranges) {
+        ranges.emplace_back(timeline_utils::to_fragment_range(pinned_range, frag_length));
+    }
+
+    return timeline_utils::merged_fragment_ranges(std::move(ranges));
+}
+
 exporter_ptr exporter::make_shared(std::string const &root_path, std::shared_ptr<task_queue_t> const &task_queue,
                                    task_priority_t const &task_priority) {
     return exporter_ptr(new exporter{root_path, task_queue, task_priority});
@@ -237,6 +609,8 @@ std::string yas::to_string(exporter::method_t const &method) {
             return "reset";
         case exporter::method_t::export_began:
             return "export_began";
+        case exporter::method_t::export_progressed:
+            return "export_progressed";
         case exporter::method_t::export_ended:
             return "export_ended";
     }
@@ -254,6 +628,12 @@ std::string yas::to_string(exporter::error_t const &error) {
             return "write_numbers_failed";
         case exporter::error_t::get_content_paths_failed:
             return "get_content_paths_failed";
+        case exporter::error_t::write_manifest_failed:
+            return "write_manifest_failed";
+        case exporter::error_t::stash_fragment_failed:
+            return "stash_fragment_failed";
+        case exporter::error_t::restore_fragment_failed:
+            return "restore_fragment_failed";
     }
 }
 
@@ -6,6 +6,7 @@
 
 #include <audio-playing/coordinator/coordinator_dependency.h>
 #include <audio-playing/exporter/exporter_resource.h>
+#include <audio-playing/exporter/exporter_timeline_diff.h>
 #include <audio-playing/timeline/timeline_container.h>
 
 #include <ostream>
@@ -20,6 +21,40 @@ struct exporter final : exporter_for_coordinator {
     using task_queue_t = exporter_task_queue;
 
     void set_timeline_container(timeline_container_ptr const &) override;
+    void set_window(std::optional<exporter_window> const &) override;
+    void set_playhead_frame(frame_index_t const) override;
+    void set_pinned_ranges(std::vector<proc::time::range> const &) override;
+    // renderingはここに渡す前にexporter_storage::resolvedで置き換えておく
+    void set_storage_policy(exporter_storage_policy const &) override;
+    // 書き出すチャンネルと順番を決める
+    void set_channel_policy(exporter_channel_policy const &) override;
+    // 有効にすると書き出し時のトラックとモジュールの処理時間を集計する
+    void set_profiling_enabled(bool const) override;
+    // トラックの途中結果を保持し、変わっていないトラックは処理し直さない
+    // 0なら使わない
+    void set_track_cache_capacity(std::size_t const) override;
+    // 書き出し直す前のフラグメントを残し、編集を元に戻したときに使う
+    // モジュールはset_module_key_handlerのキーで比べるので、元に戻すときにモジュールを作り直すならキーを返す
+    // 0なら使わない
+    void set_history_capacity(std::size_t const) override;
+    // 書き出したフラグメントをメモリに置いて再生側に渡す。0なら使わない
+    void set_fragment_cache_capacity(std::size_t const) override;
+    // 書き出し時に1度に処理する長さを再生位置からの距離で選ぶ
+    // 再生位置に近いフラグメントは短く分けて、処理したところから再生側に渡す
+    void set_slice_policy(exporter_slice_policy const &) override;
+    // 差分や履歴でモジュールを比べるキーを返す。指定しなければインスタンスで比べるので、
+    // タイムラインを作り直したり、元に戻すときにモジュールを作り直すと全て変わったものとして書き出す
+    void set_module_key_handler(exporter_module_key_f const &) override;
+    // begin_editからcommit_editまでの編集はタイムラインに反映するだけにして、
+    // commit_editでまとめて書き出す。入れ子にできる
+    void begin_edit() override;
+    void commit_edit() override;
+    [[nodiscard]] bool is_editing() const;
+
+    [[nodiscard]] exporter_profile_report profile_report() const override;
+    // 再生側のbuffering_elementに渡して共有する
+    [[nodiscard]] fragment_cache_ptr const &fragment_cache() const;
+    void reset_profile_report();
 
     [[nodiscard]] observing::endable observe_event(event_observing_handler_f &&) override;
 
@@ -32,6 +67,26 @@ struct exporter final : exporter_for_coordinator {
     observing::value::holder_ptr<timeline_container_ptr> const _container;
     exporter_resource_ptr const _resource;
 
+    std::optional<exporter_window> _window = std::nullopt;
+    frame_index_t _playhead_frame = 0;
+    std::vector<proc::time::range> _pinned_ranges;
+    std::optional<std::vector<fragment_range>> _window_frag_ranges = std::nullopt;
+    exporter_storage_policy _storage_policy;
+    exporter_channel_policy _channel_policy;
+    // anyを受け取ったときに変わったところだけを書き出すために持っておく
+    // 編集のたびに全体を作り直さず、編集されたトラックやモジュールセットだけを更新する
+    std::optional<exporter_timeline_signature> _signature = std::nullopt;
+    std::size_t _history_capacity = 0;
+    exporter_module_key_f _module_key_handler = nullptr;
+    // キーのないモジュールをインスタンスで区別するための通し番号
+    // 破棄されたモジュールとアドレスが重なっても区別する
+    std::map<proc::module const *, std::pair<std::weak_ptr<proc::module>, uint64_t>> _module_ids;
+    uint64_t _last_module_id = 0;
+    std::size_t _module_ids_prune_size = 0;
+    std::size_t _edit_depth = 0;
+    // 編集中に書き出しを保留している範囲
+    std::vector<proc::time::range> _edited_ranges;
+
     observing::canceller_pool _pool;
 
     exporter(std::string const &root_path, std::shared_ptr<task_queue_t> const &, task_priority_t const &);
@@ -39,7 +94,14 @@ struct exporter final : exporter_for_coordinator {
     void _receive_timeline_event(proc::timeline_event const &event);
     void _receive_relayed_timeline_event(proc::timeline_event const &event);
     void _receive_relayed_track_event(proc::track_event const &event, track_index_t const trk_idx);
-    void _update_timeline(proc::timeline_track_map_t &&tracks);
+    void _update_timeline(proc::timeline_track_map_t &&tracks,
+                          std::optional<std::vector<proc::time::range>> const &changed_ranges);
+    void _reset_signature();
+    [[nodiscard]] exporter_timeline_signature _make_signature(proc::timeline::track_map_t const &);
+    void _update_signature(std::optional<proc::time::range> const &,
+                           std::function<void(exporter_timeline_signature &)> const &);
+    void _update_track_signature(track_index_t const, std::optional<proc::time::range> const &);
+    void _update_module_set_signature(track_index_t const, proc::time::range const &);
     void _insert_track(proc::timeline_event const &event);
     void _erase_track(proc::timeline_event const &event);
     void _insert_module_set(track_index_t const trk_idx, proc::track_event const &event);
@@ -48,6 +110,15 @@ struct exporter final : exporter_for_coordinator {
                         proc::module_set_event const &event);
     void _erase_module(track_index_t const trk_idx, proc::time::range const range, proc::module_set_event const &event);
     void _push_export_task(proc::time::range const &range);
+    void _push_edited_export_tasks();
+    void _push_revisions_task(std::map<fragment_index_t, std::string> &&previous,
+                              std::map<fragment_index_t, std::string> &&current);
+    [[nodiscard]] exporter_timeline_diff::module_key_f _module_key_function();
+    [[nodiscard]] std::string _module_key(proc::module_ptr const &);
+    void _prune_module_ids();
+    [[nodiscard]] uint64_t _module_id(proc::module_ptr const &);
+    void _update_window();
+    [[nodiscard]] std::optional<std::vector<fragment_range>> _make_window_fragment_ranges() const;
 };
 }  // namespace yas::playing
 
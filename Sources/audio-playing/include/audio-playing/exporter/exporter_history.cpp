@@ -0,0 +1,94 @@
+//
+//  exporter_history.cpp
+//
+
+#include "exporter_history.h"
+
+#include <algorithm>
+
+using namespace yas;
+using namespace yas::playing;
+
+exporter_history::exporter_history() {
+}
+
+void exporter_history::set_capacity(std::size_t const capacity) {
+    std::lock_guard<std::mutex> lock(this->_mutex);
+
+    this->_capacity = capacity;
+}
+
+std::size_t exporter_history::capacity() const {
+    std::lock_guard<std::mutex> lock(this->_mutex);
+
+    return this->_capacity;
+}
+
+bool exporter_history::is_enabled() const {
+    return this->capacity() > 0;
+}
+
+exporter_history::push_result exporter_history::push(fragment_index_t const frag_idx, std::string const &revision) {
+    std::lock_guard<std::mutex> lock(this->_mutex);
+
+    push_result result{.serial = ++this->_last_serial};
+
+    auto const iterator =
+        std::find_if(this->_versions.begin(), this->_versions.end(), [&frag_idx, &revision](version const &version) {
+            return version.fragment_index == frag_idx && version.revision == revision;
+        });
+
+    if (iterator != this->_versions.end()) {
+        result.evicted_serials.emplace_back(iterator->serial);
+        this->_versions.erase(iterator);
+    }
+
+    this->_versions.emplace_back(version{.fragment_index = frag_idx, .revision = revision, .serial = result.serial});
+
+    // 古いものから外す
+    while (this->_versions.size() > this->_capacity) {
+        result.evicted_serials.emplace_back(this->_versions.front().serial);
+        this->_versions.pop_front();
+    }
+
+    return result;
+}
+
+std::optional<uint64_t> exporter_history::take(fragment_index_t const frag_idx, std::string const &revision) {
+    std::lock_guard<std::mutex> lock(this->_mutex);
+
+    auto const iterator =
+        std::find_if(this->_versions.begin(), this->_versions.end(), [&frag_idx, &revision](version const &version) {
+            return version.fragment_index == frag_idx && version.revision == revision;
+        });
+
+    if (iterator == this->_versions.end()) {
+        return std::nullopt;
+    }
+
+    auto const serial = iterator->serial;
+    this->_versions.erase(iterator);
+    return serial;
+}
+
+void exporter_history::erase(uint64_t const serial) {
+    std::lock_guard<std::mutex> lock(this->_mutex);
+
+    std::erase_if(this->_versions, [&serial](version const &version) { return version.serial == serial; });
+}
+
+void exporter_history::clear() {
+    std::lock_guard<std::mutex> lock(this->_mutex);
+
+    this->_versions.clear();
+}
+
+std::size_t exporter_history::size() const {
+    std::lock_guard<std::mutex> lock(this->_mutex);
+
+    return this->_versions.size();
+}
+
+exporter_history_ptr exporter_history::make_shared() {
+    return exporter_history_ptr(new exporter_history{});
+}
@@ -0,0 +1,62 @@
+//
+//  exporter_history.h
+//
+
+#pragma once
+
+#include <audio-playing/common/ptr.h>
+#include <audio-playing/common/types.h>
+
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace yas::playing {
+// 編集の前後のフラグメントのrevision
+struct exporter_revision_change final {
+    std::string previous;
+    std::string current;
+};
+
+// 書き出し直す前のフラグメントをrevisionごとに残しておくための索引
+// ファイルの移動はexporter_resourceが行う
+struct exporter_history final {
+    struct push_result final {
+        uint64_t serial;
+        // capacityを超えたり同じrevisionで上書きされて外れたもの
+        std::vector<uint64_t> evicted_serials;
+    };
+
+    // 残しておくフラグメントの数。0なら使わない
+    void set_capacity(std::size_t const);
+    [[nodiscard]] std::size_t capacity() const;
+    [[nodiscard]] bool is_enabled() const;
+
+    [[nodiscard]] push_result push(fragment_index_t const, std::string const &revision);
+    // 見つかれば外してserialを返す
+    [[nodiscard]] std::optional<uint64_t> take(fragment_index_t const, std::string const &revision);
+    // 残しきれなかったものを外す
+    void erase(uint64_t const serial);
+    void clear();
+
+    [[nodiscard]] std::size_t size() const;
+
+    [[nodiscard]] static exporter_history_ptr make_shared();
+
+   private:
+    struct version final {
+        fragment_index_t fragment_index;
+        std::string revision;
+        uint64_t serial;
+    };
+
+    std::size_t _capacity = 0;
+    std::deque<version> _versions;
+    uint64_t _last_serial = 0;
+    mutable std::mutex _mutex;
+
+    exporter_history();
+};
+}  // namespace yas::playing
@@ -0,0 +1,234 @@
+//
+//  exporter_pipeline.cpp
+//
+
+#include "exporter_pipeline.h"
+
+#include <audio-playing/timeline/timeline_utils.h>
+
+#include <audio-processing/umbrella.hpp>
+
+#include <algorithm>
+#include <cstring>
+
+using namespace yas;
+using namespace yas::playing;
+
+static proc::signal_event_ptr joined_signal_event(exporter_channel_events::signal_events_t::const_iterator const begin,
+                                                  exporter_channel_events::signal_events_t::const_iterator const end) {
+    auto const &first_event = begin->second;
+
+    std::size_t length = 0;
+    for (auto it = begin; it != end; ++it) {
+        length += it->second->size();
+    }
+
+    auto joined = timeline_utils::make_signal_event(first_event->sample_type(), length);
+    if (!joined) {
+        return nullptr;
+    }
+
+    char *dst = const_cast<char *>(timeline_utils::char_data(*joined));
+
+    for (auto it = begin; it != end; ++it) {
+        auto const &event = *it->second;
+        std::memcpy(dst, timeline_utils::char_data(event), event.byte_size());
+        dst += event.byte_size();
+    }
+
+    return joined;
+}
+
+exporter_channel_events::signal_events_t exporter_channel_events::coalesced(signal_events_t const &events) {
+    if (events.size() < 2) {
+        return events;
+    }
+
+    signal_events_t sorted = events;
+    std::sort(sorted.begin(), sorted.end(),
+              [](auto const &lhs, auto const &rhs) { return lhs.first.frame < rhs.first.frame; });
+
+    // 重なっていると読み込み時の上書きの順番が変わってしまうのでそのままにする
+    for (std::size_t idx = 1; idx < sorted.size(); ++idx) {
+        if (sorted.at(idx).first.frame < sorted.at(idx - 1).first.next_frame()) {
+            return events;
+        }
+    }
+
+    signal_events_t result;
+    result.reserve(sorted.size());
+
+    auto run_begin = sorted.cbegin();
+
+    while (run_begin != sorted.cend()) {
+        auto run_end = std::next(run_begin);
+        auto const &type = run_begin->second->sample_type();
+
+        while (run_end != sorted.cend() && run_end->second->sample_type() == type &&
+               std::prev(run_end)->first.next_frame() == run_end->first.frame) {
+            ++run_end;
+        }
+
+        if (std::distance(run_begin, run_end) == 1) {
+            result.emplace_back(*run_begin);
+        } else if (auto joined = joined_signal_event(run_begin, run_end)) {
+            proc::time::range const range{run_begin->first.frame,
+                                          static_cast<length_t>(std::prev(run_end)->first.next_frame() -
+                                                                run_begin->first.frame)};
+            result.emplace_back(range, std::move(joined));
+        } else {
+            std::copy(run_begin, run_end, std::back_inserter(result));
+        }
+
+        run_begin = run_end;
+    }
+
+    return result;
+}
+
+void exporter_fragment::append(proc::stream const &stream) {
+    for (auto const &ch_pair : stream.channels()) {
+        auto const &channel = ch_pair.second;
+        auto &events = this->channels[ch_pair.first];
+
+        for (auto const &event_pair : channel.filtered_events<proc::signal_event>()) {
+            events.signal_events.emplace_back(event_pair.first, event_pair.second);
+        }
+
+        for (auto const &event_pair : channel.filtered_events<proc::number_event>()) {
+            events.number_events.emplace(event_pair.first, event_pair.second);
+        }
+    }
+}
+
+void exporter_fragment::coalesce() {
+    // 細かく分かれていても読み込みが1ファイルで済むようにまとめる
+    for (auto &ch_pair : this->channels) {
+        auto &events = ch_pair.second;
+        events.signal_events = exporter_channel_events::coalesced(events.signal_events);
+    }
+}
+
+exporter_fragment exporter_fragment::extract_channels(
+    std::function<bool(channel_index_t const)> const &is_extracted) {
+    exporter_fragment extracted{.range = this->range};
+
+    for (auto iterator = this->channels.begin(); iterator != this->channels.end();) {
+        if (is_extracted(iterator->first)) {
+            extracted.channels.emplace(iterator->first, std::move(iterator->second));
+            iterator = this->channels.erase(iterator);
+        } else {
+            ++iterator;
+        }
+    }
+
+    return extracted;
+}
+
+exporter_fragment exporter_fragment::make(proc::time::range const &range, proc::stream const &stream) {
+    exporter_fragment fragment{.range = range};
+    fragment.append(stream);
+    fragment.coalesce();
+    return fragment;
+}
+
+exporter_fragment_queue::exporter_fragment_queue(std::size_t const capacity)
+    : _capacity(std::max(capacity, std::size_t(1))) {
+}
+
+void exporter_fragment_queue::push(exporter_fragment &&fragment) {
+    {
+        std::unique_lock<std::mutex> lock(this->_mutex);
+        this->_condition.wait(lock, [this] { return this->_is_closed || this->_fragments.size() < this->_capacity; });
+
+        if (this->_is_closed) {
+            return;
+        }
+
+        this->_fragments.emplace_back(std::move(fragment));
+    }
+
+    this->_condition.notify_all();
+}
+
+bool exporter_fragment_queue::push_if_available(exporter_fragment &&fragment) {
+    {
+        std::lock_guard<std::mutex> lock(this->_mutex);
+
+        if (this->_is_closed || this->_fragments.size() >= this->_capacity) {
+            return false;
+        }
+
+        this->_fragments.emplace_back(std::move(fragment));
+    }
+
+    this->_condition.notify_all();
+
+    return true;
+}
+
+std::optional<exporter_fragment> exporter_fragment_queue::pop() {
+    std::optional<exporter_fragment> fragment = std::nullopt;
+
+    {
+        std::unique_lock<std::mutex> lock(this->_mutex);
+        this->_condition.wait(lock, [this] { return this->_is_closed || !this->_fragments.empty(); });
+
+        if (this->_fragments.empty()) {
+            return std::nullopt;
+        }
+
+        fragment = std::move(this->_fragments.front());
+        this->_fragments.pop_front();
+    }
+
+    this->_condition.notify_all();
+
+    return fragment;
+}
+
+std::optional<exporter_fragment> exporter_fragment_queue::pop_if_available() {
+    std::optional<exporter_fragment> fragment = std::nullopt;
+
+    {
+        std::lock_guard<std::mutex> lock(this->_mutex);
+
+        if (this->_fragments.empty()) {
+            return std::nullopt;
+        }
+
+        fragment = std::move(this->_fragments.front());
+        this->_fragments.pop_front();
+    }
+
+    this->_condition.notify_all();
+
+    return fragment;
+}
+
+void exporter_fragment_queue::close() {
+    {
+        std::lock_guard<std::mutex> lock(this->_mutex);
+        this->_is_closed = true;
+    }
+
+    this->_condition.notify_all();
+}
+
+exporter_writing_thread::exporter_writing_thread(exporter_fragment_queue &queue,
+                                                 std::function<void(exporter_fragment_queue &)> &&handler)
+    : _queue(queue), _thread([&queue, handler = std::move(handler)] { handler(queue); }) {
+}
+
+exporter_writing_thread::~exporter_writing_thread() {
+    this->join();
+}
+
+void exporter_writing_thread::join() {
+    if (!this->_thread.joinable()) {
+        return;
+    }
+
+    this->_queue.close();
+    this->_thread.join();
+}
@@ -0,0 +1,88 @@
+//
+//  exporter_pipeline.h
+//
+
+#pragma once
+
+#include <audio-playing/common/types.h>
+#include <audio-processing/event/number_event.h>
+#include <audio-processing/event/signal_event.h>
+#include <audio-processing/stream/stream.h>
+#include <audio-processing/time/time.h>
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+namespace yas::playing {
+struct exporter_channel_events final {
+    using signal_events_t = std::vector<std::pair<proc::time::range, proc::signal_event_ptr>>;
+
+    signal_events_t signal_events;
+    std::multimap<frame_index_t, proc::number_event_ptr> number_events;
+
+    // 隙間なく続いている同じ型のイベントをひとつにまとめる
+    // 重なりがあればまとめずに返す
+    [[nodiscard]] static signal_events_t coalesced(signal_events_t const &);
+};
+
+// 処理の終わったフラグメントを書き込みに渡すためのもの
+struct exporter_fragment final {
+    proc::time::range range;
+    std::map<channel_index_t, exporter_channel_events> channels;
+    // 処理の途中までのもの。rangeは処理した分だけで、再生側に渡すだけでファイルには書き込まない
+    bool is_partial = false;
+
+    // フラグメントより短く分けて処理したときは、分けたストリームを順に足していく
+    void append(proc::stream const &);
+    void coalesce();
+    // 条件に合うチャンネルを取り出して別のフラグメントにする
+    [[nodiscard]] exporter_fragment extract_channels(std::function<bool(channel_index_t const)> const &);
+
+    [[nodiscard]] static exporter_fragment make(proc::time::range const &, proc::stream const &);
+};
+
+// 処理と書き込みのスレッドの間に置く。capacityを超えてpushしようとすると空くまで待つ
+struct exporter_fragment_queue final {
+    explicit exporter_fragment_queue(std::size_t const capacity);
+
+    void push(exporter_fragment &&);
+    // 待たずに入れる。空きがなければ入れずにfalseを返す
+    bool push_if_available(exporter_fragment &&);
+    // closeされて空になったらnulloptを返す
+    [[nodiscard]] std::optional<exporter_fragment> pop();
+    // 待たずに取り出す。溜まっていなければnulloptを返す
+    [[nodiscard]] std::optional<exporter_fragment> pop_if_available();
+    void close();
+
+   private:
+    std::size_t const _capacity;
+    std::deque<exporter_fragment> _fragments;
+    bool _is_closed = false;
+    std::mutex _mutex;
+    std::condition_variable _condition;
+};
+
+// キューから取り出して書き込むスレッド。処理中に例外が出ても、破棄するときにキューを閉じて終わるのを待つ
+struct exporter_writing_thread final {
+    exporter_writing_thread(exporter_fragment_queue &, std::function<void(exporter_fragment_queue &)> &&);
+    ~exporter_writing_thread();
+
+    exporter_writing_thread(exporter_writing_thread const &) = delete;
+    exporter_writing_thread(exporter_writing_thread &&) = delete;
+    exporter_writing_thread &operator=(exporter_writing_thread const &) = delete;
+    exporter_writing_thread &operator=(exporter_writing_thread &&) = delete;
+
+    // キューを閉じて、溜まっているものを書き終わるまで待つ
+    void join();
+
+   private:
+    exporter_fragment_queue &_queue;
+    std::thread _thread;
+};
+}  // namespace yas::playing
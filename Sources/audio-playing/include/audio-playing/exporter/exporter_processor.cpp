@@ -0,0 +1,108 @@
+//
+//  exporter_processor.cpp
+//
+
+#include "exporter_processor.h"
+
+#include <audio-playing/common/math.h>
+#include <cpp-utils/fast_each.h>
+
+#include <audio-processing/umbrella.hpp>
+
+#include <algorithm>
+#include <chrono>
+
+#include "exporter_profiler.h"
+
+using namespace yas;
+using namespace yas::playing;
+
+void exporter_processor::process(proc::timeline::track_map_t const &tracks, proc::time::range const &range,
+                                 sample_rate_t const sample_rate, sample_rate_t const frag_length,
+                                 slice_length_f const &slice_length_handler, exporter_instruments const &instruments,
+                                 handler_f const &handler) {
+    auto const &profiler = instruments.profiler;
+    auto const &track_cache = instruments.track_cache;
+    auto const &revisions = instruments.revisions;
+    auto const next_frame = range.next_frame();
+    bool const is_profiling = profiler && profiler->is_enabled();
+    bool const is_caching = track_cache && track_cache->is_enabled() && revisions.size() == tracks.size();
+
+    for (frame_index_t frame = range.frame; frame < next_frame;) {
+        auto const frag_idx = math::floor_int(frame, frag_length) / static_cast<frame_index_t>(frag_length);
+        frame_index_t const frag_next_frame = (frag_idx + 1) * static_cast<frame_index_t>(frag_length);
+
+        length_t slice_length = slice_length_handler(frame);
+        if (slice_length == 0 || slice_length > frag_length) {
+            slice_length = frag_length;
+        }
+
+        frame_index_t const slice_next_frame =
+            std::min({frame + static_cast<frame_index_t>(slice_length), frag_next_frame, next_frame});
+        proc::time::range const slice_range{frame, static_cast<length_t>(slice_next_frame - frame)};
+        proc::sync_source const sync_source{sample_rate, slice_length};
+
+        // キャッシュがあれば変わっていないトラックまでを飛ばす
+        std::optional<exporter_track_cache::hit> cached = std::nullopt;
+        if (is_caching) {
+            cached = track_cache->find(slice_range, revisions);
+        }
+
+        std::unique_ptr<proc::stream> stream =
+            cached.has_value() ? std::move(cached->stream) : std::make_unique<proc::stream>(sync_source);
+        std::size_t track_count = 0;
+
+        for (auto const &track_pair : tracks) {
+            auto const &trk_idx = track_pair.first;
+
+            ++track_count;
+
+            if (cached.has_value() && trk_idx <= cached->track_index) {
+                continue;
+            }
+
+            auto const track_began = std::chrono::steady_clock::now();
+
+            for (auto const &module_set_pair : track_pair.second->module_sets()) {
+                auto const intersected = module_set_pair.first.intersected(slice_range);
+                if (!intersected.has_value()) {
+                    continue;
+                }
+
+                auto const &modules = module_set_pair.second->modules();
+
+                auto each = make_fast_each(modules.size());
+                while (yas_each_next(each)) {
+                    auto const &module_idx = yas_each_index(each);
+                    auto const module_began = std::chrono::steady_clock::now();
+
+                    modules.at(module_idx)->process(*intersected, *stream);
+
+                    if (is_profiling) {
+                        profiler->record_module(
+                            {.track_index = trk_idx, .range = module_set_pair.first, .module_index = module_idx},
+                            intersected->length, std::chrono::steady_clock::now() - module_began);
+                    }
+                }
+            }
+
+            if (is_profiling) {
+                profiler->record_track(frag_idx, trk_idx, slice_range.length,
+                                       std::chrono::steady_clock::now() - track_began);
+            }
+
+            if (is_caching) {
+                track_cache->store(slice_range,
+                                   exporter_track_cache::revisions_t{revisions.begin(),
+                                                                     revisions.begin() + track_count},
+                                   *stream);
+            }
+        }
+
+        if (handler(slice_range, *stream) == proc::continuation::abort) {
+            break;
+        }
+
+        frame = slice_next_frame;
+    }
+}
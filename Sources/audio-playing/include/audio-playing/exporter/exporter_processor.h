@@ -0,0 +1,39 @@
+//
+//  exporter_processor.h
+//
+
+#pragma once
+
+#include <audio-playing/common/ptr.h>
+#include <audio-playing/common/types.h>
+#include <audio-processing/stream/stream.h>
+#include <audio-processing/sync_source/sync_source.h>
+#include <audio-processing/time/time.h>
+#include <audio-processing/timeline/timeline.h>
+
+#include <functional>
+
+#include "exporter_track_cache.h"
+
+namespace yas::playing {
+// 書き出しの処理に差し込むもの。どれも無ければ計測もキャッシュもせずに処理する
+struct exporter_instruments final {
+    exporter_profiler_ptr profiler = nullptr;
+    exporter_track_cache_ptr track_cache = nullptr;
+    // track_cacheと照合する処理順のトラックのリビジョン
+    exporter_track_cache::revisions_t revisions;
+};
+}  // namespace yas::playing
+
+namespace yas::playing::exporter_processor {
+using handler_f = std::function<proc::continuation(proc::time::range const &, proc::stream const &)>;
+// スライスの先頭のフレームから、そのスライスの長さを返す。0ならフラグメントの終わりまで
+using slice_length_f = std::function<length_t(frame_index_t const)>;
+
+// 書き出しは計測やキャッシュの有無に関わらず常にこれで処理する
+// proc::timeline::processと同じく、スライスごとにトラックの順、モジュールセットの順、モジュールの順で処理する
+// スライスはフラグメントの境目をまたがない
+void process(proc::timeline::track_map_t const &, proc::time::range const &, sample_rate_t const sample_rate,
+             sample_rate_t const frag_length, slice_length_f const &, exporter_instruments const &,
+             handler_f const &);
+}  // namespace yas::playing::exporter_processor
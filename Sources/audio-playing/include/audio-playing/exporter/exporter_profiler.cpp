@@ -0,0 +1,130 @@
+//
+//  exporter_profiler.cpp
+//
+
+#include "exporter_profiler.h"
+
+#include <sstream>
+#include <tuple>
+
+using namespace yas;
+using namespace yas::playing;
+
+namespace yas::playing::exporter_profiler_utils {
+static void write_entry(std::ostringstream &stream, exporter_profile_entry const &entry) {
+    stream << "\"process_count\":" << entry.process_count << ",\"frame_count\":" << entry.frame_count
+           << ",\"duration_ns\":" << entry.duration.count() << ",\"frames_per_second\":" << entry.frames_per_second();
+}
+}  // namespace yas::playing::exporter_profiler_utils
+
+#pragma mark - exporter_profile_entry
+
+double exporter_profile_entry::frames_per_second() const {
+    if (this->duration.count() == 0) {
+        return 0.0;
+    }
+    return static_cast<double>(this->frame_count) / std::chrono::duration<double>(this->duration).count();
+}
+
+void exporter_profile_entry::add(length_t const frame_length, std::chrono::nanoseconds const duration) {
+    ++this->process_count;
+    this->frame_count += frame_length;
+    this->duration += duration;
+}
+
+#pragma mark - exporter_profile_module_key
+
+bool exporter_profile_module_key::operator<(exporter_profile_module_key const &rhs) const {
+    return std::tie(this->track_index, this->range, this->module_index) <
+           std::tie(rhs.track_index, rhs.range, rhs.module_index);
+}
+
+#pragma mark - exporter_profile_report
+
+std::string exporter_profile_report::to_json() const {
+    using namespace exporter_profiler_utils;
+
+    std::ostringstream stream;
+
+    stream << "{\"tracks\":[";
+
+    for (auto iterator = this->tracks.begin(); iterator != this->tracks.end(); ++iterator) {
+        stream << (iterator == this->tracks.begin() ? "" : ",") << "{\"track\":" << iterator->first << ",";
+        write_entry(stream, iterator->second);
+        stream << "}";
+    }
+
+    stream << "],\"modules\":[";
+
+    for (auto iterator = this->modules.begin(); iterator != this->modules.end(); ++iterator) {
+        auto const &key = iterator->first;
+        stream << (iterator == this->modules.begin() ? "" : ",") << "{\"track\":" << key.track_index
+               << ",\"frame\":" << key.range.frame << ",\"length\":" << key.range.length
+               << ",\"module\":" << key.module_index << ",";
+        write_entry(stream, iterator->second);
+        stream << "}";
+    }
+
+    stream << "],\"fragments\":[";
+
+    for (auto frag_it = this->fragments.begin(); frag_it != this->fragments.end(); ++frag_it) {
+        stream << (frag_it == this->fragments.begin() ? "" : ",") << "{\"fragment\":" << frag_it->first
+               << ",\"tracks\":[";
+
+        for (auto trk_it = frag_it->second.begin(); trk_it != frag_it->second.end(); ++trk_it) {
+            stream << (trk_it == frag_it->second.begin() ? "" : ",") << "{\"track\":" << trk_it->first << ",";
+            write_entry(stream, trk_it->second);
+            stream << "}";
+        }
+
+        stream << "]}";
+    }
+
+    stream << "]}";
+
+    return stream.str();
+}
+
+#pragma mark - exporter_profiler
+
+exporter_profiler::exporter_profiler() {
+}
+
+void exporter_profiler::set_enabled(bool const is_enabled) {
+    this->_is_enabled = is_enabled;
+}
+
+bool exporter_profiler::is_enabled() const {
+    return this->_is_enabled;
+}
+
+void exporter_profiler::record_track(fragment_index_t const frag_idx, track_index_t const trk_idx,
+                                     length_t const frame_length, std::chrono::nanoseconds const duration) {
+    std::lock_guard<std::mutex> lock(this->_mutex);
+
+    this->_report.tracks[trk_idx].add(frame_length, duration);
+    this->_report.fragments[frag_idx][trk_idx].add(frame_length, duration);
+}
+
+void exporter_profiler::record_module(exporter_profile_module_key const &key, length_t const frame_length,
+                                      std::chrono::nanoseconds const duration) {
+    std::lock_guard<std::mutex> lock(this->_mutex);
+
+    this->_report.modules[key].add(frame_length, duration);
+}
+
+exporter_profile_report exporter_profiler::report() const {
+    std::lock_guard<std::mutex> lock(this->_mutex);
+
+    return this->_report;
+}
+
+void exporter_profiler::reset() {
+    std::lock_guard<std::mutex> lock(this->_mutex);
+
+    this->_report = exporter_profile_report{};
+}
+
+exporter_profiler_ptr exporter_profiler::make_shared() {
+    return exporter_profiler_ptr(new exporter_profiler{});
+}
@@ -0,0 +1,69 @@
+//
+//  exporter_profiler.h
+//
+
+#pragma once
+
+#include <audio-playing/common/ptr.h>
+#include <audio-playing/common/types.h>
+#include <audio-processing/time/time.h>
+
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <string>
+
+namespace yas::playing {
+struct exporter_profile_entry final {
+    std::size_t process_count = 0;
+    uint64_t frame_count = 0;
+    std::chrono::nanoseconds duration{0};
+
+    // 1秒あたりに処理したフレーム数
+    [[nodiscard]] double frames_per_second() const;
+
+    void add(length_t const frame_length, std::chrono::nanoseconds const duration);
+};
+
+struct exporter_profile_module_key final {
+    track_index_t track_index;
+    proc::time::range range;
+    std::size_t module_index;
+
+    bool operator<(exporter_profile_module_key const &rhs) const;
+};
+
+struct exporter_profile_report final {
+    std::map<track_index_t, exporter_profile_entry> tracks;
+    std::map<exporter_profile_module_key, exporter_profile_entry> modules;
+    // フラグメントごとのトラックの処理時間
+    std::map<fragment_index_t, std::map<track_index_t, exporter_profile_entry>> fragments;
+
+    [[nodiscard]] std::string to_json() const;
+};
+
+// 書き出し時のトラックとモジュールの処理時間を集計する
+// 記録は書き出しのスレッドから、取得はどのスレッドからでも良い
+struct exporter_profiler final {
+    void set_enabled(bool const);
+    [[nodiscard]] bool is_enabled() const;
+
+    void record_track(fragment_index_t const, track_index_t const, length_t const frame_length,
+                      std::chrono::nanoseconds const);
+    void record_module(exporter_profile_module_key const &, length_t const frame_length,
+                       std::chrono::nanoseconds const);
+
+    [[nodiscard]] exporter_profile_report report() const;
+    void reset();
+
+    [[nodiscard]] static exporter_profiler_ptr make_shared();
+
+   private:
+    std::atomic<bool> _is_enabled = false;
+    exporter_profile_report _report;
+    mutable std::mutex _mutex;
+
+    exporter_profiler();
+};
+}  // namespace yas::playing
@@ -4,7 +4,11 @@
 
 #include "exporter_resource.h"
 
+#include <audio-playing/common/math.h>
 #include <audio-playing/common/path.h>
+#include <audio-playing/exporter/exporter_processor.h>
+#include <audio-playing/exporter/exporter_storage.h>
+#include <audio-playing/manifest_file/manifest_file.h>
 #include <audio-playing/numbers_file/numbers_file.h>
 #include <audio-playing/signal_file/signal_file.h>
 #include <audio-playing/timeline/timeline_utils.h>
@@ -15,24 +19,57 @@
 
 #include <audio-processing/umbrella.hpp>
 
+#include <algorithm>
+#include <deque>
+#include <thread>
+
 using namespace yas;
 using namespace yas::playing;
 
-exporter_resource::exporter_resource(std::string const &root_path) : _root_path(root_path) {
+exporter_resource::exporter_resource(std::string const &root_path)
+    : trash(exporter_trash::make_shared(exporter_trash::sibling_path(root_path))), _root_path(root_path) {
+    // 前回消しきれなかったものがあれば消す
+    this->trash->collect();
 }
 
 void exporter_resource::replace_timeline_on_task(proc::timeline::track_map_t &&tracks, std::string const &identifier,
-                                                 sample_rate_t const &sample_rate, task_t const &task) {
+                                                 sample_rate_t const &sample_rate,
+                                                 sample_rate_t const frag_length,
+                                                 std::optional<std::string> const &fingerprint,
+                                                 exporter_storage_policy const &storage_policy,
+                                                 std::optional<std::vector<fragment_range>> const &window,
+                                                 std::optional<std::vector<proc::time::range>> const &changed_ranges,
+                                                 task_t const &task) {
+    if (changed_ranges.has_value() &&
+        this->_can_replace_partially_on_task(identifier, sample_rate, frag_length, storage_policy)) {
+        this->_replace_timeline_partially_on_task(std::move(tracks), fingerprint, window, changed_ranges.value(), task);
+        return;
+    }
+
     this->_identifier = identifier;
     this->_timeline = proc::timeline::make_shared(std::move(tracks));
-    this->_sync_source.emplace(sample_rate, sample_rate);
+    this->_sync_source.emplace(sample_rate, frag_length);
+    this->_frag_length = frag_length;
+    this->_fingerprint = fingerprint;
+    this->_storage_policy = storage_policy;
+    this->_window = window;
+    this->_exported_frag_indices.clear();
+    this->_reset_track_revisions_on_task();
+    this->_clear_history_on_task();
+    this->fragment_cache->clear();
 
     if (task.is_canceled()) {
         return;
     }
 
-    if (auto const result = file_manager::remove_content(this->_root_path); !result) {
-        std::runtime_error("remove timeline root directory failed.");
+    if (!this->_restore_manifest_on_task(task)) {
+        // 消し終わるのを待たずに書き出しを始められるように、trashに移して後で消す
+        if (this->trash->move(this->_root_path)) {
+            this->trash->collect();
+        } else if (auto const result = file_manager::remove_content(this->_root_path); !result) {
+            this->_send_error_on_task(exporter_error::remove_fragment_failed, std::nullopt);
+            return;
+        }
     }
 
     this->_send_method_on_task(exporter_method::reset, std::nullopt);
@@ -41,6 +78,10 @@ void exporter_resource::replace_timeline_on_task(proc::timeline::track_map_t &&t
         return;
     }
 
+    if (auto const error = this->_write_manifest_on_task()) {
+        this->_send_error_on_task(*error, std::nullopt);
+    }
+
     proc::timeline_ptr const &timeline = this->_timeline;
 
     auto total_range = timeline->total_range();
@@ -48,20 +89,83 @@ void exporter_resource::replace_timeline_on_task(proc::timeline::track_map_t &&t
         return;
     }
 
-    auto const &sync_source = this->_sync_source.value();
-    auto const frags_range = timeline_utils::fragments_range(*total_range, sync_source.sample_rate);
+    auto const frags_range = timeline_utils::fragments_range(*total_range, this->_frag_length);
+
+    this->_export_unexported_fragments_on_task(frags_range, task);
+}
+
+void exporter_resource::update_window_on_task(std::optional<std::vector<fragment_range>> const &window,
+                                              task_t const &task) {
+    this->_window = window;
+
+    if (!this->_timeline || !this->_sync_source.has_value()) {
+        return;
+    }
+
+    if (auto const error = this->_evict_fragments_on_task(task)) {
+        this->_send_error_on_task(*error, std::nullopt);
+        return;
+    }
+
+    auto const total_range = this->_timeline->total_range();
+    if (!total_range.has_value()) {
+        return;
+    }
+
+    auto const frags_range = timeline_utils::fragments_range(*total_range, this->_frag_length);
+
+    this->_export_unexported_fragments_on_task(frags_range, task);
+}
+
+void exporter_resource::update_storage_policy_on_task(exporter_storage_policy const &policy, task_t const &task) {
+    this->_storage_policy = policy;
+
+    // 書き出し済みのものは全て型が変わるので書き出し直す
+    this->_export_all_again_on_task(task);
+}
+
+void exporter_resource::update_channel_policy_on_task(exporter_channel_policy const &policy, task_t const &task) {
+    bool const is_exported_changed = this->_channel_policy.skips_negative_channels != policy.skips_negative_channels;
+
+    this->_channel_policy = policy;
+
+    // 書き出す順番が変わるだけなら書き出し直さない
+    if (is_exported_changed) {
+        this->_export_all_again_on_task(task);
+    }
+}
+
+void exporter_resource::_export_all_again_on_task(task_t const &task) {
+    if (!this->_timeline || !this->_sync_source.has_value()) {
+        return;
+    }
+
+    auto const total_range = this->_timeline->total_range();
+    if (!total_range.has_value()) {
+        return;
+    }
+
+    auto const frags_range = timeline_utils::fragments_range(*total_range, this->_frag_length);
 
     this->_send_method_on_task(exporter_method::export_began, frags_range);
+    this->_clear_history_on_task();
 
-    this->_export_fragments_on_task(frags_range, task);
+    if (auto const error = this->_remove_fragments_on_task(frags_range, task)) {
+        this->_send_error_on_task(*error, frags_range);
+        return;
+    }
+
+    this->_export_unexported_fragments_on_task(frags_range, task);
 }
 
 void exporter_resource::insert_track_on_task(track_index_t const trk_idx, proc::track_ptr &&track) {
     this->_timeline->insert_track(trk_idx, std::move(track));
+    this->_update_track_revision_on_task(trk_idx);
 }
 
 void exporter_resource::erase_track_on_task(track_index_t const trk_idx) {
     this->_timeline->erase_track(trk_idx);
+    this->_track_revisions.erase(trk_idx);
 }
 
 void exporter_resource::insert_module_set_on_task(track_index_t const trk_idx, proc::time::range const &range,
@@ -72,12 +176,15 @@ void exporter_resource::insert_module_set_on_task(track_index_t const trk_idx, p
     for (auto const &module : module_set->modules()) {
         track->push_back_module(module, range);
     }
+
+    this->_update_track_revision_on_task(trk_idx);
 }
 
 void exporter_resource::erase_module_set_on_task(track_index_t const trk_idx, proc::time::range const &range) {
     auto const &track = this->_timeline->track(trk_idx);
     assert(track->module_sets().count(range) > 0);
     track->erase_modules_for_range(range);
+    this->_update_track_revision_on_task(trk_idx);
 }
 
 void exporter_resource::insert_module(proc::module_ptr const &module, module_index_t const module_idx,
@@ -85,6 +192,7 @@ void exporter_resource::insert_module(proc::module_ptr const &module, module_ind
     auto const &track = this->_timeline->track(trk_idx);
     assert(track->module_sets().count(range) > 0);
     track->insert_module(std::move(module), module_idx, range);
+    this->_update_track_revision_on_task(trk_idx);
 }
 
 void exporter_resource::erase_module(module_index_t const module_idx, track_index_t const trk_idx,
@@ -92,21 +200,278 @@ void exporter_resource::erase_module(module_index_t const module_idx, track_inde
     auto const &track = this->_timeline->track(trk_idx);
     assert(track->module_sets().count(range) > 0);
     track->erase_module_at(module_idx, range);
+    this->_update_track_revision_on_task(trk_idx);
+}
+
+void exporter_resource::update_fragment_revisions_on_task(
+    std::map<fragment_index_t, exporter_revision_change> const &changes) {
+    for (auto const &pair : changes) {
+        auto const &frag_idx = pair.first;
+
+        // 書き出してから最初の編集であれば、書き出してあるのは編集前の内容
+        if (!this->_edited_revisions.contains(frag_idx)) {
+            this->_exported_revisions.insert_or_assign(frag_idx, pair.second.previous);
+        }
+
+        this->_edited_revisions.insert_or_assign(frag_idx, pair.second.current);
+    }
 }
 
 void exporter_resource::export_on_task(proc::time::range const &range, task_t const &task) {
-    auto const &sync_source = this->_sync_source.value();
-    auto frags_range = timeline_utils::fragments_range(range, sync_source.sample_rate);
+    auto frags_range = timeline_utils::fragments_range(range, this->_frag_length);
+    bool const is_history_enabled = this->history->is_enabled();
 
     this->_send_method_on_task(exporter_method::export_began, frags_range);
 
+    if (is_history_enabled) {
+        if (auto const error = this->_stash_fragments_on_task(frags_range)) {
+            this->_send_error_on_task(*error, range);
+        }
+    }
+
     if (auto const error = this->_remove_fragments_on_task(frags_range, task)) {
         this->_send_error_on_task(*error, range);
+        return;
+    }
+
+    if (is_history_enabled) {
+        if (auto const error = this->_restore_fragments_on_task(frags_range)) {
+            this->_send_error_on_task(*error, range);
+        }
+    }
+
+    this->_update_exported_revisions_on_task(frags_range);
+
+    if (this->_window.has_value() || is_history_enabled) {
+        for (auto const &export_range : this->_unexported_ranges_on_task(frags_range)) {
+            this->_export_fragments_on_task(export_range, task);
+        }
     } else {
         this->_export_fragments_on_task(frags_range, task);
     }
 }
 
+void exporter_resource::set_slice_policy(exporter_slice_policy const &policy) {
+    std::lock_guard<std::mutex> lock(this->_slice_policy_mutex);
+    this->_slice_policy = policy;
+}
+
+void exporter_resource::set_playhead_frame(frame_index_t const frame) {
+    this->_playhead_frame = frame;
+}
+
+bool exporter_resource::_can_replace_partially_on_task(std::string const &identifier,
+                                                       sample_rate_t const &sample_rate,
+                                                       sample_rate_t const frag_length,
+                                                       exporter_storage_policy const &storage_policy) const {
+    return this->_timeline && this->_sync_source.has_value() && this->_identifier == identifier &&
+           this->_sync_source.value().sample_rate == sample_rate && this->_frag_length == frag_length &&
+           this->_storage_policy == storage_policy;
+}
+
+path::timeline exporter_resource::_timeline_path_on_task() const {
+    return path::timeline{.root_path = this->_root_path,
+                          .identifier = this->_identifier,
+                          .sample_rate = this->_sync_source.value().sample_rate,
+                          .fragment_length = this->_frag_length};
+}
+
+void exporter_resource::_replace_timeline_partially_on_task(proc::timeline::track_map_t &&tracks,
+                                                            std::optional<std::string> const &fingerprint,
+                                                            std::optional<std::vector<fragment_range>> const &window,
+                                                            std::vector<proc::time::range> const &changed_ranges,
+                                                            task_t const &task) {
+    assert(!thread::is_main());
+
+    this->_timeline = proc::timeline::make_shared(std::move(tracks));
+    this->_fingerprint = fingerprint;
+    this->_window = window;
+    this->_reset_track_revisions_on_task();
+
+    if (task.is_canceled()) {
+        return;
+    }
+
+    if (auto const error = this->_evict_fragments_on_task(task)) {
+        this->_send_error_on_task(*error, std::nullopt);
+        return;
+    }
+
+    auto const &frag_length = this->_frag_length;
+
+    auto frag_ranges = to_vector<fragment_range>(changed_ranges, [&frag_length](proc::time::range const &range) {
+        return timeline_utils::to_fragment_range(timeline_utils::fragments_range(range, frag_length), frag_length);
+    });
+
+    // 変わったモジュールセットの範囲だけを消して書き出し直す
+    for (auto const &frag_range : timeline_utils::merged_fragment_ranges(std::move(frag_ranges))) {
+        if (task.is_canceled()) {
+            return;
+        }
+
+        // 編集後のrevisionはわからなくなる
+        auto each = make_fast_each(frag_range.index, frag_range.end_index());
+        while (yas_each_next(each)) {
+            this->_edited_revisions.erase(yas_each_index(each));
+        }
+
+        this->export_on_task(timeline_utils::to_time_range(frag_range, frag_length), task);
+    }
+
+    if (auto const error = this->_write_manifest_on_task()) {
+        this->_send_error_on_task(*error, std::nullopt);
+    }
+
+    // windowが変わって新たに入ったところを書き出す
+    if (auto const total_range = this->_timeline->total_range()) {
+        this->_export_unexported_fragments_on_task(timeline_utils::fragments_range(*total_range, frag_length), task);
+    }
+}
+
+bool exporter_resource::_restore_manifest_on_task(task_t const &task) {
+    assert(!thread::is_main());
+
+    if (!this->_fingerprint.has_value()) {
+        return false;
+    }
+
+    auto const &sample_rate = this->_sync_source.value().sample_rate;
+    auto const tl_path = this->_timeline_path_on_task();
+
+    auto const read_result = manifest_file::read(path::manifest{tl_path}.value());
+    if (!read_result) {
+        return false;
+    }
+
+    auto const &manifest = read_result.value();
+    if (manifest.identifier != this->_identifier || manifest.sample_rate != sample_rate ||
+        manifest.fingerprint != this->_fingerprint.value() ||
+        manifest.storage != this->_manifest_storage_on_task()) {
+        return false;
+    }
+
+    if (auto const total_range = this->_timeline->total_range()) {
+        auto const frag_range =
+            timeline_utils::to_fragment_range(timeline_utils::fragments_range(*total_range, this->_frag_length),
+                                              this->_frag_length);
+
+        for (auto const &frag_idx : manifest.fragment_indices) {
+            if (frag_range.contains(frag_idx)) {
+                this->_exported_frag_indices.insert(frag_idx);
+            }
+        }
+    }
+
+    if (this->_remove_unlisted_contents_on_task(task).has_value()) {
+        this->_exported_frag_indices.clear();
+        return false;
+    }
+
+    return true;
+}
+
+std::optional<exporter_error> exporter_resource::_remove_unlisted_contents_on_task(task_t const &task) {
+    assert(!thread::is_main());
+
+    auto const tl_path = this->_timeline_path_on_task();
+    auto const tl_name = tl_path.value().filename();
+    auto const manifest_name = path::manifest{tl_path}.value().filename();
+
+    auto root_paths_result = file_manager::content_paths_in_directory(this->_root_path);
+    if (!root_paths_result) {
+        if (root_paths_result.error() == file_manager::content_paths_error::directory_not_found) {
+            return std::nullopt;
+        } else {
+            return exporter_error::get_content_paths_failed;
+        }
+    }
+
+    // 別のタイムラインのものは使わない
+    for (auto const &content_path : root_paths_result.value()) {
+        if (content_path.filename() == tl_name || content_path.filename() == manifest_name) {
+            continue;
+        }
+
+        if (!this->trash->move(content_path)) {
+            return exporter_error::remove_fragment_failed;
+        }
+    }
+
+    auto ch_paths_result = file_manager::content_paths_in_directory(tl_path.value());
+    if (!ch_paths_result) {
+        if (ch_paths_result.error() == file_manager::content_paths_error::directory_not_found) {
+            return std::nullopt;
+        } else {
+            return exporter_error::get_content_paths_failed;
+        }
+    }
+
+    // 書き出しの途中で止まったフラグメントが残っているかもしれないので消す
+    for (auto const &ch_path : ch_paths_result.value()) {
+        if (task.is_canceled()) {
+            return std::nullopt;
+        }
+
+        auto frag_paths_result = file_manager::content_paths_in_directory(ch_path);
+        if (!frag_paths_result) {
+            return exporter_error::get_content_paths_failed;
+        }
+
+        for (auto const &frag_path : frag_paths_result.value()) {
+            auto const frag_idx = yas::to_integer<fragment_index_t>(frag_path.filename());
+            if (this->_exported_frag_indices.contains(frag_idx)) {
+                continue;
+            }
+
+            if (!this->trash->move(frag_path)) {
+                return exporter_error::remove_fragment_failed;
+            }
+        }
+    }
+
+    this->trash->collect();
+
+    return std::nullopt;
+}
+
+std::string exporter_resource::_manifest_storage_on_task() const {
+    auto storage = exporter_storage::to_manifest_string(this->_storage_policy);
+
+    // 負のチャンネルを書き出すかどうかでもファイルが変わる
+    if (!this->_channel_policy.skips_negative_channels) {
+        storage += " negative_channels";
+    }
+
+    return storage;
+}
+
+std::optional<exporter_error> exporter_resource::_write_manifest_on_task() {
+    assert(!thread::is_main());
+
+    if (!this->_fingerprint.has_value()) {
+        return std::nullopt;
+    }
+
+    auto const &sample_rate = this->_sync_source.value().sample_rate;
+    auto const tl_path = this->_timeline_path_on_task();
+
+    if (!file_manager::create_directory_if_not_exists(this->_root_path)) {
+        return exporter_error::write_manifest_failed;
+    }
+
+    manifest_file::manifest const manifest{.identifier = this->_identifier,
+                                           .sample_rate = sample_rate,
+                                           .fingerprint = this->_fingerprint.value(),
+                                           .storage = this->_manifest_storage_on_task(),
+                                           .fragment_indices = this->_exported_frag_indices};
+
+    if (!manifest_file::write(path::manifest{tl_path}.value(), manifest)) {
+        return exporter_error::write_manifest_failed;
+    }
+
+    return std::nullopt;
+}
+
 void exporter_resource::_export_fragments_on_task(proc::time::range const &frags_range, task_t const &task) {
     assert(!thread::is_main());
 
@@ -114,37 +479,360 @@ void exporter_resource::_export_fragments_on_task(proc::time::range const &frags
         return;
     }
 
-    this->_timeline->process(frags_range, this->_sync_source.value(),
-                             [&task, this](proc::time::range const &range, proc::stream const &stream) {
-                                 if (task.is_canceled()) {
-                                     return proc::continuation::abort;
-                                 }
+    exporter_fragment_queue queue{exporter_resource::_pipeline_capacity};
+
+    // 書き込みを別スレッドで行い、次のフラグメントの処理と重ねる
+    exporter_writing_thread writing_thread{queue, [&task, this](exporter_fragment_queue &queue) {
+        auto const &frag_length = this->_frag_length;
+        auto const &policy = this->_channel_policy;
+        // 出力に割り当てられていないチャンネルは後回しにする
+        std::deque<exporter_fragment> deferred_fragments;
+        // 途中まで再生側に渡して、まだ最後まで揃っていないもの
+        std::optional<exporter_fragment> published_partial = std::nullopt;
+
+        auto const write_deferred = [&deferred_fragments, &task, &frag_length, this] {
+            auto const fragment = std::move(deferred_fragments.front());
+            deferred_fragments.pop_front();
+
+            if (task.is_canceled()) {
+                return;
+            }
+
+            if (auto error = this->_write_fragment_on_task(this->_converted_fragment_on_task(fragment))) {
+                this->_send_error_on_task(*error, fragment.range);
+            } else {
+                this->_exported_frag_indices.insert(fragment.range.frame / frag_length);
+            }
+        };
+
+        while (true) {
+            auto fragment = deferred_fragments.empty() ? queue.pop() : queue.pop_if_available();
+
+            if (!fragment.has_value()) {
+                if (deferred_fragments.empty()) {
+                    break;
+                }
+
+                // 処理が追いつかず手が空いているので後回しにしたものを書き込む
+                write_deferred();
+                continue;
+            }
+
+            if (task.is_canceled()) {
+                continue;
+            }
+
+            if (fragment->is_partial) {
+                // 再生に使うチャンネルだけを、ファイルに書き込まずに渡す
+                std::erase_if(fragment->channels,
+                              [&policy](auto const &ch_pair) { return policy.is_deferred(ch_pair.first); });
+
+                if (this->_publish_fragment_on_task(this->_converted_fragment_on_task(*fragment))) {
+                    this->_send_method_on_task(exporter_method::export_progressed, fragment->range);
+                    published_partial = std::move(fragment);
+                }
+                continue;
+            }
+
+            published_partial = std::nullopt;
+
+            auto const &range = fragment->range;
+            auto deferred = fragment->extract_channels(
+                [&policy](channel_index_t const ch_idx) { return policy.is_deferred(ch_idx); });
+
+            auto const converted = this->_converted_fragment_on_task(*fragment);
+
+            // メモリに置けたら、ファイルに書き終わるのを待たずに再生側へ知らせる
+            bool const is_published = this->_publish_fragment_on_task(converted);
+            if (is_published) {
+                this->_send_method_on_task(exporter_method::export_ended, range);
+            }
+
+            auto const error = this->_write_fragment_on_task(converted);
+
+            if (is_published) {
+                this->_persist_fragment_on_task(converted, !error.has_value());
+            }
+
+            if (error.has_value()) {
+                this->_send_error_on_task(*error, range);
+                continue;
+            }
 
-                                 if (auto error = this->_export_fragment_on_task(range, stream)) {
-                                     this->_send_error_on_task(*error, range);
-                                 } else {
-                                     this->_send_method_on_task(exporter_method::export_ended, range);
-                                 }
+            if (deferred.channels.empty()) {
+                this->_exported_frag_indices.insert(range.frame / frag_length);
+            } else {
+                deferred_fragments.emplace_back(std::move(deferred));
+            }
 
-                                 return proc::continuation::keep;
-                             });
+            if (!is_published) {
+                this->_send_method_on_task(exporter_method::export_ended, range);
+            }
+
+            if (deferred_fragments.size() > exporter_resource::_deferred_capacity) {
+                write_deferred();
+            }
+        }
+
+        // 最後まで揃わずに止まったものは再生側から外して、ファイルから読み直させる
+        if (published_partial.has_value()) {
+            this->_persist_fragment_on_task(*published_partial, false);
+            this->_send_method_on_task(exporter_method::export_progressed, published_partial->range);
+        }
+    }};
+
+    auto const frag_length = this->_frag_length;
+    auto const slice_policy = this->_slice_policy_on_task();
+    bool const is_publishing = this->fragment_cache->is_enabled();
+    std::optional<exporter_fragment> fragment = std::nullopt;
+
+    // スライスごとに受け取り、フラグメントの終わりまで揃ったら書き込みに回す
+    auto handler = [&task, &queue, &fragment, &frags_range, &slice_policy, frag_length, is_publishing, this](
+                       proc::time::range const &range, proc::stream const &stream) {
+        if (task.is_canceled()) {
+            return proc::continuation::abort;
+        }
+
+        if (!fragment.has_value()) {
+            proc::time::range const frag_range{math::floor_int(range.frame, frag_length),
+                                               static_cast<length_t>(frag_length)};
+            fragment = exporter_fragment{.range = frag_range.intersected(frags_range).value_or(range)};
+        }
+
+        fragment->append(stream);
+
+        if (range.next_frame() >= fragment->range.next_frame()) {
+            queue.push(std::move(fragment.value()));
+            fragment = std::nullopt;
+        } else if (is_publishing && this->_is_near_playhead_on_task(range.frame, slice_policy)) {
+            // 再生位置の近くは処理したところまでを先に渡す。書き込みが詰まっていたら次のスライスで渡す
+            exporter_fragment partial = fragment.value();
+            partial.range = proc::time::range{fragment->range.frame,
+                                              static_cast<length_t>(range.next_frame() - fragment->range.frame)};
+            partial.is_partial = true;
+            queue.push_if_available(std::move(partial));
+        }
+
+        return proc::continuation::keep;
+    };
+
+    // 計測やキャッシュを使う時も同じ処理を通す
+    exporter_processor::process(this->_timeline->tracks(), frags_range, this->_sync_source.value().sample_rate,
+                                frag_length,
+                                [&slice_policy, this](frame_index_t const frame) {
+                                    return this->_slice_length_on_task(frame, slice_policy);
+                                },
+                                {.profiler = this->profiler,
+                                 .track_cache = this->track_cache,
+                                 .revisions = this->track_cache->is_enabled() ? this->_track_revisions_on_task()
+                                                                              : exporter_track_cache::revisions_t{}},
+                                handler);
+
+    // 途中で止まったフラグメントは書き出さない
+    writing_thread.join();
+
+    if (auto const error = this->_write_manifest_on_task()) {
+        this->_send_error_on_task(*error, frags_range);
+    }
+}
+
+exporter_slice_policy exporter_resource::_slice_policy_on_task() {
+    std::lock_guard<std::mutex> lock(this->_slice_policy_mutex);
+    return this->_slice_policy;
+}
+
+length_t exporter_resource::_slice_length_on_task(frame_index_t const frame,
+                                                  exporter_slice_policy const &policy) const {
+    auto const &frag_length = this->_frag_length;
+    auto slice_length = this->_is_near_playhead_on_task(frame, policy) ? policy.near_length : policy.far_length;
+
+    if (slice_length == 0 || slice_length >= frag_length) {
+        return frag_length;
+    }
+
+    // フラグメントの中でスライスの長さが揃うようにする
+    while (frag_length % slice_length != 0) {
+        --slice_length;
+    }
+
+    return slice_length;
+}
+
+bool exporter_resource::_is_near_playhead_on_task(frame_index_t const frame,
+                                                  exporter_slice_policy const &policy) const {
+    auto const frag_length = static_cast<frame_index_t>(this->_frag_length);
+    auto const frag_idx = math::floor_int(frame, this->_frag_length) / frag_length;
+    auto const playhead_frag_idx = math::floor_int(this->_playhead_frame.load(), this->_frag_length) / frag_length;
+
+    return std::abs(frag_idx - playhead_frag_idx) <= static_cast<fragment_index_t>(policy.near_fragment_count);
+}
+
+void exporter_resource::_update_track_revision_on_task(track_index_t const trk_idx) {
+    this->_track_revisions.insert_or_assign(trk_idx, ++this->_last_track_revision);
+}
+
+void exporter_resource::_reset_track_revisions_on_task() {
+    this->_track_revisions.clear();
+    this->track_cache->clear();
+
+    for (auto const &track_pair : this->_timeline->tracks()) {
+        this->_update_track_revision_on_task(track_pair.first);
+    }
+}
+
+exporter_track_cache::revisions_t exporter_resource::_track_revisions_on_task() const {
+    exporter_track_cache::revisions_t revisions;
+
+    for (auto const &track_pair : this->_timeline->tracks()) {
+        auto const &trk_idx = track_pair.first;
+        auto const iterator = this->_track_revisions.find(trk_idx);
+        revisions.emplace_back(trk_idx, iterator != this->_track_revisions.end() ? iterator->second : 0);
+    }
+
+    return revisions;
+}
+
+void exporter_resource::_export_unexported_fragments_on_task(proc::time::range const &frags_range,
+                                                             task_t const &task) {
+    for (auto const &export_range : this->_unexported_ranges_on_task(frags_range)) {
+        if (task.is_canceled()) {
+            return;
+        }
+
+        this->_send_method_on_task(exporter_method::export_began, export_range);
+        this->_export_fragments_on_task(export_range, task);
+    }
+}
+
+std::vector<proc::time::range> exporter_resource::_unexported_ranges_on_task(
+    proc::time::range const &frags_range) const {
+    auto const &frag_length = this->_frag_length;
+    auto const frag_range = timeline_utils::to_fragment_range(frags_range, frag_length);
+
+    std::vector<fragment_range> const target_ranges =
+        this->_window.has_value() ? timeline_utils::intersected_fragment_ranges(frag_range, this->_window.value())
+                                  : std::vector<fragment_range>{frag_range};
+
+    std::set<fragment_index_t> unexported_indices;
+
+    for (auto const &target_range : target_ranges) {
+        auto each = make_fast_each(target_range.index, target_range.end_index());
+        while (yas_each_next(each)) {
+            auto const &frag_idx = yas_each_index(each);
+            if (!this->_exported_frag_indices.contains(frag_idx)) {
+                unexported_indices.insert(frag_idx);
+            }
+        }
+    }
+
+    return to_vector<proc::time::range>(timeline_utils::to_fragment_ranges(unexported_indices),
+                                        [&frag_length](fragment_range const &range) {
+                                            return timeline_utils::to_time_range(range, frag_length);
+                                        });
 }
 
-[[nodiscard]] std::optional<exporter_error> exporter_resource::_export_fragment_on_task(
-    proc::time::range const &frag_range, proc::stream const &stream) {
+std::optional<exporter_error> exporter_resource::_evict_fragments_on_task(task_t const &task) {
+    if (!this->_window.has_value()) {
+        return std::nullopt;
+    }
+
+    auto const &window = this->_window.value();
+
+    std::set<fragment_index_t> evicting_indices;
+    for (auto const &frag_idx : this->_exported_frag_indices) {
+        auto const contains = std::any_of(window.begin(), window.end(), [&frag_idx](fragment_range const &range) {
+            return range.contains(frag_idx);
+        });
+        if (!contains) {
+            evicting_indices.insert(frag_idx);
+        }
+    }
+
+    for (auto const &evicting_range : timeline_utils::to_fragment_ranges(evicting_indices)) {
+        if (auto const error = this->_remove_fragments_on_task(
+                timeline_utils::to_time_range(evicting_range, this->_frag_length), task)) {
+            return error;
+        }
+    }
+
+    return std::nullopt;
+}
+
+exporter_fragment exporter_resource::_converted_fragment_on_task(exporter_fragment const &fragment) const {
     assert(!thread::is_main());
 
-    auto const &sync_source = this->_sync_source.value();
-    path::timeline const tl_path{this->_root_path, this->_identifier, sync_source.sample_rate};
+    auto const frag_idx = fragment.range.frame / this->_frag_length;
 
-    auto const frag_idx = frag_range.frame / stream.sync_source().sample_rate;
+    exporter_fragment converted{.range = fragment.range};
 
-    for (auto const &ch_pair : stream.channels()) {
+    for (auto const &ch_pair : fragment.channels) {
         auto const &ch_idx = ch_pair.first;
-        auto const &channel = ch_pair.second;
 
-        path::channel const ch_path{tl_path, ch_idx};
-        auto const frag_path = path::fragment{ch_path, frag_idx};
+        if (!this->_channel_policy.is_exported(ch_idx)) {
+            continue;
+        }
+
+        auto const storage_format = this->_storage_policy.format_for_channel(ch_idx);
+        auto const seed = static_cast<uint32_t>(frag_idx * 31 + ch_idx);
+        auto &events = converted.channels[ch_idx];
+
+        events.number_events = ch_pair.second.number_events;
+
+        for (auto const &event_pair : ch_pair.second.signal_events) {
+            events.signal_events.emplace_back(event_pair.first,
+                                              exporter_storage::convert(event_pair.second, storage_format, seed));
+        }
+    }
+
+    // 変換して型が揃ったものもまとめられるように、変換の後でまとめる
+    converted.coalesce();
+
+    return converted;
+}
+
+bool exporter_resource::_publish_fragment_on_task(exporter_fragment const &fragment) {
+    assert(!thread::is_main());
+
+    if (!this->fragment_cache->is_enabled()) {
+        return false;
+    }
+
+    for (auto const &ch_pair : fragment.channels) {
+        this->fragment_cache->store(this->_fragment_path_on_task(ch_pair.first, fragment.range).value(),
+                                    ch_pair.second.signal_events);
+    }
+
+    return true;
+}
+
+void exporter_resource::_persist_fragment_on_task(exporter_fragment const &fragment, bool const is_succeeded) {
+    assert(!thread::is_main());
+
+    for (auto const &ch_pair : fragment.channels) {
+        auto const frag_path_value = this->_fragment_path_on_task(ch_pair.first, fragment.range).value();
+
+        // 書き込めなかったものは再生側に残さない
+        if (is_succeeded) {
+            this->fragment_cache->persist(frag_path_value);
+        } else {
+            this->fragment_cache->erase(frag_path_value);
+        }
+    }
+}
+
+path::fragment exporter_resource::_fragment_path_on_task(channel_index_t const ch_idx,
+                                                         proc::time::range const &frag_range) const {
+    return path::fragment{path::channel{this->_timeline_path_on_task(), ch_idx}, frag_range.frame / this->_frag_length};
+}
+
+// 型の変換はしないので_converted_fragment_on_taskを通したものを渡す
+std::optional<exporter_error> exporter_resource::_write_fragment_on_task(exporter_fragment const &fragment) {
+    assert(!thread::is_main());
+
+    for (auto const &ch_pair : fragment.channels) {
+        auto const &events = ch_pair.second;
+
+        auto const frag_path = this->_fragment_path_on_task(ch_pair.first, fragment.range);
         auto const frag_path_value = frag_path.value();
 
         auto remove_result = file_manager::remove_content(frag_path_value);
@@ -152,8 +840,8 @@ void exporter_resource::_export_fragments_on_task(proc::time::range const &frags
             return exporter_error::remove_fragment_failed;
         }
 
-        if (channel.events().size() == 0) {
-            return std::nullopt;
+        if (events.signal_events.empty() && events.number_events.empty()) {
+            continue;
         }
 
         auto const create_result = file_manager::create_directory_if_not_exists(frag_path_value);
@@ -161,9 +849,9 @@ void exporter_resource::_export_fragments_on_task(proc::time::range const &frags
             return exporter_error::create_directory_failed;
         }
 
-        for (auto const &event_pair : channel.filtered_events<proc::signal_event>()) {
+        for (auto const &event_pair : events.signal_events) {
             proc::time::range const &range = event_pair.first;
-            proc::signal_event_ptr const &event = event_pair.second;
+            auto const &event = event_pair.second;
 
             auto const signal_path_value = path::signal_event{frag_path, range, event->sample_type()}.value();
 
@@ -172,10 +860,10 @@ void exporter_resource::_export_fragments_on_task(proc::time::range const &frags
             }
         }
 
-        if (auto const number_events = channel.filtered_events<proc::number_event>(); number_events.size() > 0) {
+        if (events.number_events.size() > 0) {
             auto const number_path_value = path::number_events{frag_path}.value();
 
-            if (auto const result = numbers_file::write(number_path_value, number_events); !result) {
+            if (auto const result = numbers_file::write(number_path_value, events.number_events); !result) {
                 return exporter_error::write_numbers_failed;
             }
         }
@@ -188,9 +876,22 @@ std::optional<exporter_error> exporter_resource::_remove_fragments_on_task(proc:
                                                                            task_t const &task) {
     assert(!thread::is_main());
 
-    auto const &sync_source = this->_sync_source.value();
-    auto const &sample_rate = sync_source.sample_rate;
-    path::timeline const tl_path{this->_root_path, this->_identifier, sample_rate};
+    auto const &frag_length = this->_frag_length;
+    auto const tl_path = this->_timeline_path_on_task();
+
+    auto const begin_frag_idx = frags_range.frame / frag_length;
+    auto const end_frag_idx = frags_range.next_frame() / frag_length;
+
+    if (auto each = make_fast_each(begin_frag_idx, end_frag_idx); true) {
+        while (yas_each_next(each)) {
+            this->_exported_frag_indices.erase(yas_each_index(each));
+        }
+    }
+
+    // ファイルを消す前にmanifestから外しておく
+    if (auto const error = this->_write_manifest_on_task()) {
+        return error;
+    }
 
     auto ch_paths_result = file_manager::content_paths_in_directory(tl_path.value());
     if (!ch_paths_result) {
@@ -204,11 +905,9 @@ std::optional<exporter_error> exporter_resource::_remove_fragments_on_task(proc:
     auto const ch_names = to_vector<std::string>(ch_paths_result.value(),
                                                  [](std::filesystem::path const &path) { return path.filename(); });
 
-    auto const begin_frag_idx = frags_range.frame / sample_rate;
-    auto const end_frag_idx = frags_range.next_frame() / sample_rate;
-
     for (auto const &ch_name : ch_names) {
         if (task.is_canceled()) {
+            this->trash->collect();
             return std::nullopt;
         }
 
@@ -219,16 +918,236 @@ std::optional<exporter_error> exporter_resource::_remove_fragments_on_task(proc:
         while (yas_each_next(each)) {
             auto const &frag_idx = yas_each_index(each);
             auto const frag_path_value = path::fragment{ch_path, frag_idx}.value();
-            auto const remove_result = file_manager::remove_content(frag_path_value);
-            if (!remove_result) {
+            this->fragment_cache->erase(frag_path_value);
+            if (!this->trash->move(frag_path_value)) {
                 return exporter_error::remove_fragment_failed;
             }
         }
     }
 
+    this->trash->collect();
+
     return std::nullopt;
 }
 
+std::optional<exporter_error> exporter_resource::_stash_fragments_on_task(proc::time::range const &frags_range) {
+    assert(!thread::is_main());
+
+    auto const &frag_length = this->_frag_length;
+    auto const tl_path = this->_timeline_path_on_task();
+    path::history const history_path{tl_path};
+
+    auto ch_paths_result = file_manager::content_paths_in_directory(tl_path.value());
+    if (!ch_paths_result) {
+        if (ch_paths_result.error() == file_manager::content_paths_error::directory_not_found) {
+            return std::nullopt;
+        } else {
+            return exporter_error::get_content_paths_failed;
+        }
+    }
+
+    auto const ch_names = to_vector<std::string>(ch_paths_result.value(),
+                                                 [](std::filesystem::path const &path) { return path.filename(); });
+
+    std::optional<exporter_error> error = std::nullopt;
+
+    auto each = make_fast_each(frags_range.frame / frag_length, frags_range.next_frame() / frag_length);
+    while (yas_each_next(each)) {
+        auto const &frag_idx = yas_each_index(each);
+
+        auto const revision_it = this->_exported_revisions.find(frag_idx);
+        if (!this->_exported_frag_indices.contains(frag_idx) || revision_it == this->_exported_revisions.end()) {
+            continue;
+        }
+
+        auto const pushed = this->history->push(frag_idx, revision_it->second);
+
+        for (auto const &serial : pushed.evicted_serials) {
+            this->_discard_content_on_task(path::history_version{history_path, serial}.value());
+        }
+
+        auto const version_path_value = path::history_version{history_path, pushed.serial}.value();
+
+        // 途中までしか移せなかったものは残さない。フラグメントはこの後で消して書き出し直す
+        if (!this->_stash_fragment_on_task(frag_idx, version_path_value, ch_names)) {
+            this->history->erase(pushed.serial);
+            this->_discard_content_on_task(version_path_value);
+            error = exporter_error::stash_fragment_failed;
+        }
+    }
+
+    this->trash->collect();
+
+    return error;
+}
+
+bool exporter_resource::_stash_fragment_on_task(fragment_index_t const frag_idx, std::string const &version_path,
+                                                std::vector<std::string> const &ch_names) {
+    if (!file_manager::create_directory_if_not_exists(version_path)) {
+        return false;
+    }
+
+    auto const tl_path = this->_timeline_path_on_task();
+
+    // 消さずに移して、元に戻す編集のときに使う
+    for (auto const &ch_name : ch_names) {
+        path::channel const ch_path{tl_path, yas::to_integer<channel_index_t>(ch_name)};
+        auto const frag_path_value = path::fragment{ch_path, frag_idx}.value();
+
+        if (!file_manager::content_exists(frag_path_value)) {
+            continue;
+        }
+
+        std::error_code error_code;
+        std::filesystem::rename(frag_path_value, std::filesystem::path{version_path}.append(ch_name), error_code);
+        if (error_code) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+std::optional<exporter_error> exporter_resource::_restore_fragments_on_task(proc::time::range const &frags_range) {
+    assert(!thread::is_main());
+
+    auto const &frag_length = this->_frag_length;
+    auto const tl_path = this->_timeline_path_on_task();
+    path::history const history_path{tl_path};
+
+    std::vector<fragment_index_t> restored_indices;
+    std::optional<exporter_error> error = std::nullopt;
+
+    auto each = make_fast_each(frags_range.frame / frag_length, frags_range.next_frame() / frag_length);
+    while (yas_each_next(each)) {
+        auto const &frag_idx = yas_each_index(each);
+
+        if (this->_window.has_value()) {
+            auto const &window = this->_window.value();
+            auto const contains = std::any_of(window.begin(), window.end(), [&frag_idx](fragment_range const &range) {
+                return range.contains(frag_idx);
+            });
+            if (!contains) {
+                continue;
+            }
+        }
+
+        auto const revision_it = this->_edited_revisions.find(frag_idx);
+        if (revision_it == this->_edited_revisions.end()) {
+            continue;
+        }
+
+        auto const serial = this->history->take(frag_idx, revision_it->second);
+        if (!serial.has_value()) {
+            continue;
+        }
+
+        auto const version_path_value = path::history_version{history_path, serial.value()}.value();
+
+        if (this->_restore_fragment_on_task(frag_idx, version_path_value)) {
+            this->_exported_frag_indices.insert(frag_idx);
+            restored_indices.emplace_back(frag_idx);
+        } else {
+            error = exporter_error::restore_fragment_failed;
+        }
+
+        // 戻しきれなかったチャンネルが残っていてもまとめて捨てる
+        this->_discard_content_on_task(version_path_value);
+    }
+
+    this->trash->collect();
+
+    // 戻せたものだけmanifestに書いて再生側に知らせる。戻せなかったものは書き出されていないので後で書き出す
+    if (!restored_indices.empty()) {
+        if (auto const manifest_error = this->_write_manifest_on_task()) {
+            error = manifest_error;
+        }
+
+        for (auto const &frag_idx : restored_indices) {
+            this->_send_method_on_task(exporter_method::export_ended,
+                                       timeline_utils::to_time_range({.index = frag_idx, .length = 1}, frag_length));
+        }
+    }
+
+    return error;
+}
+
+bool exporter_resource::_restore_fragment_on_task(fragment_index_t const frag_idx, std::string const &version_path) {
+    auto ch_paths_result = file_manager::content_paths_in_directory(version_path);
+    if (!ch_paths_result) {
+        return false;
+    }
+
+    auto const tl_path = this->_timeline_path_on_task();
+    std::vector<std::string> restored_paths;
+
+    // 途中のチャンネルで失敗したら、戻したものも捨てて編集前と後が混ざらないようにする
+    auto const discard_restored = [this, &restored_paths] {
+        for (auto const &restored_path : restored_paths) {
+            this->_discard_content_on_task(restored_path);
+        }
+        return false;
+    };
+
+    for (auto const &version_ch_path : ch_paths_result.value()) {
+        path::channel const ch_path{tl_path, yas::to_integer<channel_index_t>(version_ch_path.filename())};
+
+        if (!file_manager::create_directory_if_not_exists(ch_path.value())) {
+            return discard_restored();
+        }
+
+        auto frag_path_value = path::fragment{ch_path, frag_idx}.value();
+
+        std::error_code error_code;
+        std::filesystem::rename(version_ch_path, frag_path_value, error_code);
+        if (error_code) {
+            return discard_restored();
+        }
+
+        restored_paths.emplace_back(std::move(frag_path_value));
+    }
+
+    return true;
+}
+
+void exporter_resource::_discard_content_on_task(std::string const &path) {
+    // trashに移せなければその場で消す
+    if (!this->trash->move(path)) {
+        file_manager::remove_content(path);
+    }
+}
+
+void exporter_resource::_update_exported_revisions_on_task(proc::time::range const &frags_range) {
+    auto const &frag_length = this->_frag_length;
+
+    auto each = make_fast_each(frags_range.frame / frag_length, frags_range.next_frame() / frag_length);
+    while (yas_each_next(each)) {
+        auto const &frag_idx = yas_each_index(each);
+
+        // 編集されずに書き出し直すものはrevisionがわからない
+        if (auto const iterator = this->_edited_revisions.find(frag_idx); iterator != this->_edited_revisions.end()) {
+            this->_exported_revisions.insert_or_assign(frag_idx, iterator->second);
+            this->_edited_revisions.erase(iterator);
+        } else {
+            this->_exported_revisions.erase(frag_idx);
+        }
+    }
+}
+
+void exporter_resource::_clear_history_on_task() {
+    this->history->clear();
+    this->_exported_revisions.clear();
+    this->_edited_revisions.clear();
+
+    if (!this->_sync_source.has_value()) {
+        return;
+    }
+
+    if (!file_manager::remove_content(path::history{this->_timeline_path_on_task()}.value())) {
+        this->_send_error_on_task(exporter_error::remove_fragment_failed, std::nullopt);
+    }
+}
+
 void exporter_resource::_send_method_on_task(exporter_method const type,
                                              std::optional<proc::time::range> const &range) {
     assert(!thread::is_main());
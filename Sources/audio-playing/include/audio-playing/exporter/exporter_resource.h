@@ -4,11 +4,22 @@
 
 #pragma once
 
+#include <audio-playing/common/fragment_cache.h>
+#include <audio-playing/common/path.h>
 #include <audio-playing/common/ptr.h>
 #include <audio-playing/common/types.h>
 #include <audio-processing/sync_source/sync_source.h>
 #include <audio-processing/timeline/timeline.h>
 
+#include <atomic>
+#include <mutex>
+#include <set>
+
+#include "exporter_history.h"
+#include "exporter_pipeline.h"
+#include "exporter_profiler.h"
+#include "exporter_track_cache.h"
+#include "exporter_trash.h"
 #include "exporter_types.h"
 
 namespace yas::playing {
@@ -16,25 +27,71 @@ struct exporter_resource final {
     using task_t = exporter_task;
 
     observing::notifier_ptr<exporter_event> const event_notifier = observing::notifier<exporter_event>::make_shared();
+    exporter_profiler_ptr const profiler = exporter_profiler::make_shared();
+    exporter_track_cache_ptr const track_cache = exporter_track_cache::make_shared();
+    exporter_history_ptr const history = exporter_history::make_shared();
+    // 消すファイルはroot_pathと並べて作るtrashに移して、別スレッドで消す
+    exporter_trash_ptr const trash;
+    // 書き出したものを再生側にファイルを通さずに渡す
+    fragment_cache_ptr const fragment_cache = playing::fragment_cache::make_shared();
 
     void replace_timeline_on_task(proc::timeline::track_map_t &&, std::string const &identifier, sample_rate_t const &,
+                                  sample_rate_t const frag_length, std::optional<std::string> const &fingerprint,
+                                  exporter_storage_policy const &,
+                                  std::optional<std::vector<fragment_range>> const &window,
+                                  std::optional<std::vector<proc::time::range>> const &changed_ranges,
                                   task_t const &);
+    void update_window_on_task(std::optional<std::vector<fragment_range>> const &window, task_t const &);
+    void update_storage_policy_on_task(exporter_storage_policy const &, task_t const &);
+    void update_channel_policy_on_task(exporter_channel_policy const &, task_t const &);
     void insert_track_on_task(track_index_t const, proc::track_ptr &&);
     void erase_track_on_task(track_index_t const);
     void insert_module_set_on_task(track_index_t const, proc::time::range const &, proc::module_set_ptr &&);
     void erase_module_set_on_task(track_index_t const, proc::time::range const &);
     void insert_module(proc::module_ptr const &, module_index_t const, track_index_t const, proc::time::range const);
     void erase_module(module_index_t const, track_index_t const, proc::time::range const);
+    void update_fragment_revisions_on_task(std::map<fragment_index_t, exporter_revision_change> const &);
 
     void export_on_task(proc::time::range const &, task_t const &);
 
+    // 書き出し時に1度に処理する長さを再生位置からの距離で選ぶ
+    // フラグメントの中で長さが揃うように、フラグメントの長さを割り切れる長さに切り下げる
+    void set_slice_policy(exporter_slice_policy const &);
+    // 処理中のスライスの長さと、途中までを再生側に渡すかどうかを決めるのに使う
+    void set_playhead_frame(frame_index_t const);
+
     [[nodiscard]] static exporter_resource_ptr make_shared(std::string const &root_path);
 
    private:
+    // 書き込み待ちで溜めておくフラグメントの数
+    static std::size_t constexpr _pipeline_capacity = 2;
+    // 後回しにしたチャンネルを溜めておくフラグメントの数。超えたら先に書き込む
+    static std::size_t constexpr _deferred_capacity = 8;
+
     std::string const _root_path;
     std::string _identifier;
     proc::timeline_ptr _timeline;
     std::optional<proc::sync_source> _sync_source;
+    // 1フラグメントのフレーム数
+    sample_rate_t _frag_length = 0;
+    // メインスレッドから書き換えられるので、書き出しを始めるときに取り出して使う
+    exporter_slice_policy _slice_policy;
+    std::mutex _slice_policy_mutex;
+    std::atomic<frame_index_t> _playhead_frame = 0;
+    // 値があればmanifestに書き出し済みのフラグメントを記録する
+    std::optional<std::string> _fingerprint = std::nullopt;
+    exporter_storage_policy _storage_policy;
+    exporter_channel_policy _channel_policy;
+    // nulloptなら全体を書き出す
+    std::optional<std::vector<fragment_range>> _window = std::nullopt;
+    std::set<fragment_index_t> _exported_frag_indices;
+    // トラックの中身が変わるたびに更新する。track_cacheの照合に使う
+    std::map<track_index_t, uint64_t> _track_revisions;
+    uint64_t _last_track_revision = 0;
+    // 書き出してあるファイルの内容のrevision
+    std::map<fragment_index_t, std::string> _exported_revisions;
+    // 書き出した後に編集されたもののrevision
+    std::map<fragment_index_t, std::string> _edited_revisions;
 
     exporter_resource(std::string const &root_path);
 
@@ -42,10 +99,44 @@ struct exporter_resource final {
     void _send_error_on_task(exporter_error const type, std::optional<proc::time::range> const &range);
     void _send_event_on_task(exporter_event event);
 
+    [[nodiscard]] bool _can_replace_partially_on_task(std::string const &identifier, sample_rate_t const &,
+                                                      sample_rate_t const frag_length,
+                                                      exporter_storage_policy const &) const;
+    [[nodiscard]] path::timeline _timeline_path_on_task() const;
+    void _replace_timeline_partially_on_task(proc::timeline::track_map_t &&,
+                                             std::optional<std::string> const &fingerprint,
+                                             std::optional<std::vector<fragment_range>> const &window,
+                                             std::vector<proc::time::range> const &changed_ranges, task_t const &);
+    [[nodiscard]] bool _restore_manifest_on_task(task_t const &);
+    [[nodiscard]] std::optional<exporter_error> _remove_unlisted_contents_on_task(task_t const &);
+    [[nodiscard]] std::string _manifest_storage_on_task() const;
+    [[nodiscard]] std::optional<exporter_error> _write_manifest_on_task();
+    void _export_all_again_on_task(task_t const &);
+
     void _export_fragments_on_task(proc::time::range const &, task_t const &);
-    [[nodiscard]] std::optional<exporter_error> _export_fragment_on_task(proc::time::range const &frag_range,
-                                                                         proc::stream const &stream);
+    [[nodiscard]] exporter_slice_policy _slice_policy_on_task();
+    [[nodiscard]] length_t _slice_length_on_task(frame_index_t const, exporter_slice_policy const &) const;
+    [[nodiscard]] bool _is_near_playhead_on_task(frame_index_t const, exporter_slice_policy const &) const;
+    void _update_track_revision_on_task(track_index_t const);
+    void _reset_track_revisions_on_task();
+    [[nodiscard]] exporter_track_cache::revisions_t _track_revisions_on_task() const;
+    void _export_unexported_fragments_on_task(proc::time::range const &frags_range, task_t const &);
+    [[nodiscard]] std::vector<proc::time::range> _unexported_ranges_on_task(proc::time::range const &frags_range) const;
+    [[nodiscard]] std::optional<exporter_error> _evict_fragments_on_task(task_t const &);
+    [[nodiscard]] exporter_fragment _converted_fragment_on_task(exporter_fragment const &) const;
+    [[nodiscard]] bool _publish_fragment_on_task(exporter_fragment const &);
+    void _persist_fragment_on_task(exporter_fragment const &, bool const is_succeeded);
+    [[nodiscard]] path::fragment _fragment_path_on_task(channel_index_t const, proc::time::range const &) const;
+    [[nodiscard]] std::optional<exporter_error> _write_fragment_on_task(exporter_fragment const &);
     [[nodiscard]] std::optional<exporter_error> _remove_fragments_on_task(proc::time::range const &frags_range,
                                                                           task_t const &task);
+    [[nodiscard]] std::optional<exporter_error> _stash_fragments_on_task(proc::time::range const &frags_range);
+    [[nodiscard]] bool _stash_fragment_on_task(fragment_index_t const, std::string const &version_path,
+                                               std::vector<std::string> const &ch_names);
+    [[nodiscard]] std::optional<exporter_error> _restore_fragments_on_task(proc::time::range const &frags_range);
+    [[nodiscard]] bool _restore_fragment_on_task(fragment_index_t const, std::string const &version_path);
+    void _discard_content_on_task(std::string const &path);
+    void _update_exported_revisions_on_task(proc::time::range const &frags_range);
+    void _clear_history_on_task();
 };
 }  // namespace yas::playing
@@ -0,0 +1,213 @@
+//
+//  exporter_storage.cpp
+//
+
+#include "exporter_storage.h"
+
+#include <Accelerate/Accelerate.h>
+
+#include <audio-processing/umbrella.hpp>
+
+#include <algorithm>
+#include <vector>
+
+using namespace yas;
+using namespace yas::playing;
+
+namespace yas::playing::exporter_storage {
+// 整数のシグナルは16bitの振幅として扱う。往復で値が変わらないようにfloatとはどちらの向きもこの値で変換する
+static float constexpr int16_scale = 32768.0f;
+
+template <typename T>
+static proc::signal_event_ptr int64_to_float(proc::signal_event_ptr const &event) {
+    auto converted = proc::signal_event::make_shared<T>(event->size());
+    T const scale = T(1) / static_cast<T>(int16_scale);
+    std::transform(event->data<int64_t>(), event->data<int64_t>() + event->size(), converted->template data<T>(),
+                   [&scale](int64_t const value) { return static_cast<T>(value) * scale; });
+    return converted;
+}
+
+static exporter_storage_format to_storage_format(audio::pcm_format const pcm_format) {
+    switch (pcm_format) {
+        case audio::pcm_format::float32:
+            return exporter_storage_format::float32;
+        case audio::pcm_format::float64:
+            return exporter_storage_format::float64;
+        case audio::pcm_format::int16:
+            return exporter_storage_format::int16;
+        case audio::pcm_format::fixed824:
+        case audio::pcm_format::other:
+            return exporter_storage_format::as_is;
+    }
+}
+
+static exporter_storage_format resolved_format(exporter_storage_format const format,
+                                               audio::pcm_format const pcm_format) {
+    if (format == exporter_storage_format::rendering) {
+        return to_storage_format(pcm_format);
+    }
+    return format;
+}
+
+// 1LSBの幅で三角分布になるノイズ
+static void make_tpdf_noise(float *data, std::size_t const length, uint32_t const seed) {
+    uint32_t state = seed * 2654435761u + 1u;
+
+    auto next = [&state] {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        return static_cast<float>(state) / 4294967296.0f;
+    };
+
+    for (std::size_t idx = 0; idx < length; ++idx) {
+        data[idx] = next() + next() - 1.0f;
+    }
+}
+
+static proc::signal_event_ptr to_float32(proc::signal_event_ptr const &event) {
+    auto const &type = event->sample_type();
+    vDSP_Length const length = event->size();
+
+    if (type == typeid(double)) {
+        auto converted = proc::signal_event::make_shared<float>(length);
+        vDSP_vdpsp(event->data<double>(), 1, converted->data<float>(), 1, length);
+        return converted;
+    } else if (type == typeid(int16_t)) {
+        auto converted = proc::signal_event::make_shared<float>(length);
+        float const scale = 1.0f / int16_scale;
+        vDSP_vflt16(event->data<int16_t>(), 1, converted->data<float>(), 1, length);
+        vDSP_vsmul(converted->data<float>(), 1, &scale, converted->data<float>(), 1, length);
+        return converted;
+    } else if (type == typeid(int64_t)) {
+        return int64_to_float<float>(event);
+    }
+
+    return event;
+}
+
+static proc::signal_event_ptr to_float64(proc::signal_event_ptr const &event) {
+    auto const &type = event->sample_type();
+    vDSP_Length const length = event->size();
+
+    if (type == typeid(float)) {
+        auto converted = proc::signal_event::make_shared<double>(length);
+        vDSP_vspdp(event->data<float>(), 1, converted->data<double>(), 1, length);
+        return converted;
+    } else if (type == typeid(int16_t)) {
+        auto converted = proc::signal_event::make_shared<double>(length);
+        double const scale = 1.0 / static_cast<double>(int16_scale);
+        vDSP_vflt16D(event->data<int16_t>(), 1, converted->data<double>(), 1, length);
+        vDSP_vsmulD(converted->data<double>(), 1, &scale, converted->data<double>(), 1, length);
+        return converted;
+    } else if (type == typeid(int64_t)) {
+        return int64_to_float<double>(event);
+    }
+
+    return event;
+}
+
+static proc::signal_event_ptr to_int16(proc::signal_event_ptr const &event, bool const is_dithered,
+                                       uint32_t const seed) {
+    auto const &type = event->sample_type();
+    vDSP_Length const length = event->size();
+
+    if (type == typeid(int64_t)) {
+        // 同じ16bitの振幅なので範囲に収めるだけ
+        auto converted = proc::signal_event::make_shared<int16_t>(length);
+        std::transform(event->data<int64_t>(), event->data<int64_t>() + length, converted->data<int16_t>(),
+                       [](int64_t const value) {
+                           return static_cast<int16_t>(std::clamp<int64_t>(value, INT16_MIN, INT16_MAX));
+                       });
+        return converted;
+    }
+
+    if (type != typeid(float) && type != typeid(double)) {
+        return event;
+    }
+
+    std::vector<float> scaled(length);
+
+    if (type == typeid(double)) {
+        vDSP_vdpsp(event->data<double>(), 1, scaled.data(), 1, length);
+    } else {
+        std::copy_n(event->data<float>(), length, scaled.data());
+    }
+
+    vDSP_vsmul(scaled.data(), 1, &int16_scale, scaled.data(), 1, length);
+
+    if (is_dithered) {
+        std::vector<float> noise(length);
+        make_tpdf_noise(noise.data(), length, seed);
+        vDSP_vadd(scaled.data(), 1, noise.data(), 1, scaled.data(), 1, length);
+    }
+
+    float const min = -32768.0f;
+    float const max = 32767.0f;
+    vDSP_vclip(scaled.data(), 1, &min, &max, scaled.data(), 1, length);
+
+    auto converted = proc::signal_event::make_shared<int16_t>(length);
+    vDSP_vfixr16(scaled.data(), 1, converted->data<int16_t>(), 1, length);
+    return converted;
+}
+}  // namespace yas::playing::exporter_storage
+
+exporter_storage_policy exporter_storage::resolved(exporter_storage_policy const &policy,
+                                                   audio::pcm_format const pcm_format) {
+    exporter_storage_policy resolved{.format = resolved_format(policy.format, pcm_format)};
+
+    for (auto const &pair : policy.channel_formats) {
+        resolved.channel_formats.emplace(pair.first, resolved_format(pair.second, pcm_format));
+    }
+
+    return resolved;
+}
+
+proc::signal_event_ptr exporter_storage::convert(proc::signal_event_ptr const &event,
+                                                 exporter_storage_format const format, uint32_t const seed) {
+    switch (format) {
+        case exporter_storage_format::as_is:
+        case exporter_storage_format::rendering:
+            return event;
+        case exporter_storage_format::float32:
+            return to_float32(event);
+        case exporter_storage_format::float64:
+            return to_float64(event);
+        case exporter_storage_format::int16:
+            return to_int16(event, false, seed);
+        case exporter_storage_format::int16_dithered:
+            return to_int16(event, true, seed);
+    }
+}
+
+std::string exporter_storage::to_manifest_string(exporter_storage_policy const &policy) {
+    std::string string = to_string(policy.format);
+
+    for (auto const &pair : policy.channel_formats) {
+        string += " " + std::to_string(pair.first) + ":" + to_string(pair.second);
+    }
+
+    return string;
+}
+
+std::string yas::to_string(exporter_storage_format const &format) {
+    switch (format) {
+        case exporter_storage_format::as_is:
+            return "as_is";
+        case exporter_storage_format::rendering:
+            return "rendering";
+        case exporter_storage_format::float32:
+            return "float32";
+        case exporter_storage_format::float64:
+            return "float64";
+        case exporter_storage_format::int16:
+            return "int16";
+        case exporter_storage_format::int16_dithered:
+            return "int16_dithered";
+    }
+}
+
+std::ostream &operator<<(std::ostream &os, yas::playing::exporter_storage_format const &value) {
+    os << to_string(value);
+    return os;
+}
@@ -0,0 +1,31 @@
+//
+//  exporter_storage.h
+//
+
+#pragma once
+
+#include <audio-engine/format/format.h>
+#include <audio-playing/exporter/exporter_types.h>
+#include <audio-processing/event/signal_event.h>
+
+#include <ostream>
+#include <string>
+
+namespace yas::playing::exporter_storage {
+// renderingをpcm_formatに合わせたフォーマットに置き換える
+[[nodiscard]] exporter_storage_policy resolved(exporter_storage_policy const &, audio::pcm_format const);
+
+// 変換できない型のときはそのまま返す。seedはディザのノイズに使う
+// int16とint64は16bitの振幅として扱い、floatとは1/32768で変換する
+[[nodiscard]] proc::signal_event_ptr convert(proc::signal_event_ptr const &, exporter_storage_format const,
+                                             uint32_t const seed);
+
+// manifestに記録して、変わっていれば書き出し直す
+[[nodiscard]] std::string to_manifest_string(exporter_storage_policy const &);
+}  // namespace yas::playing::exporter_storage
+
+namespace yas {
+std::string to_string(playing::exporter_storage_format const &);
+}  // namespace yas
+
+std::ostream &operator<<(std::ostream &, yas::playing::exporter_storage_format const &);
@@ -0,0 +1,194 @@
+//
+//  exporter_timeline_diff.cpp
+//
+
+#include "exporter_timeline_diff.h"
+
+#include <audio-playing/timeline/timeline_utils.h>
+#include <audio-processing/umbrella.hpp>
+#include <cpp-utils/fast_each.h>
+
+#include <sstream>
+
+using namespace yas;
+using namespace yas::playing;
+
+namespace yas::playing::exporter_timeline_diff {
+using module_sets_t = std::map<proc::time::range, std::vector<std::string>>;
+
+static void append_ranges(std::vector<proc::time::range> &ranges, module_sets_t const &module_sets) {
+    for (auto const &pair : module_sets) {
+        ranges.emplace_back(pair.first);
+    }
+}
+
+static void append_changed_ranges(std::vector<proc::time::range> &ranges, module_sets_t const &from,
+                                  module_sets_t const &to) {
+    for (auto const &pair : from) {
+        auto const iterator = to.find(pair.first);
+        if (iterator == to.end() || iterator->second != pair.second) {
+            ranges.emplace_back(pair.first);
+        }
+    }
+
+    for (auto const &pair : to) {
+        if (!from.contains(pair.first)) {
+            ranges.emplace_back(pair.first);
+        }
+    }
+}
+
+static std::vector<std::string> make_keys(proc::module_set_ptr const &module_set, module_key_f const &module_key) {
+    std::vector<std::string> keys;
+
+    for (auto const &module : module_set->modules()) {
+        keys.emplace_back(module_key(module));
+    }
+
+    return keys;
+}
+
+static module_sets_t make_module_sets(proc::track_ptr const &track, module_key_f const &module_key) {
+    module_sets_t module_sets;
+
+    for (auto const &module_set_pair : track->module_sets()) {
+        module_sets.emplace(module_set_pair.first, make_keys(module_set_pair.second, module_key));
+    }
+
+    return module_sets;
+}
+
+static void append_revision(std::ostream &stream, track_index_t const trk_idx, proc::time::range const &range,
+                            std::vector<std::string> const &keys) {
+    stream << trk_idx << ":" << range.frame << ":" << range.length << ":";
+
+    // キーに区切りの文字が含まれていても混ざらないように長さを前に付ける
+    for (auto const &key : keys) {
+        stream << key.size() << "=" << key << ",";
+    }
+
+    stream << ";";
+}
+}  // namespace yas::playing::exporter_timeline_diff
+
+exporter_timeline_signature exporter_timeline_diff::make_signature(std::string const &identifier,
+                                                                   sample_rate_t const sample_rate,
+                                                                   proc::timeline::track_map_t const &tracks,
+                                                                   module_key_f const &module_key) {
+    exporter_timeline_signature signature{.identifier = identifier, .sample_rate = sample_rate};
+
+    for (auto const &track_pair : tracks) {
+        signature.tracks.emplace(track_pair.first, make_module_sets(track_pair.second, module_key));
+    }
+
+    return signature;
+}
+
+void exporter_timeline_diff::update_track(exporter_timeline_signature &signature, track_index_t const trk_idx,
+                                          proc::timeline::track_map_t const &tracks, module_key_f const &module_key) {
+    if (auto const iterator = tracks.find(trk_idx); iterator != tracks.end()) {
+        signature.tracks.insert_or_assign(trk_idx, make_module_sets(iterator->second, module_key));
+    } else {
+        signature.tracks.erase(trk_idx);
+    }
+}
+
+void exporter_timeline_diff::update_module_set(exporter_timeline_signature &signature, track_index_t const trk_idx,
+                                               proc::time::range const &range,
+                                               proc::timeline::track_map_t const &tracks,
+                                               module_key_f const &module_key) {
+    auto const track_iterator = tracks.find(trk_idx);
+    if (track_iterator == tracks.end()) {
+        signature.tracks.erase(trk_idx);
+        return;
+    }
+
+    auto &module_sets = signature.tracks[trk_idx];
+    auto const &track_module_sets = track_iterator->second->module_sets();
+
+    if (auto const iterator = track_module_sets.find(range); iterator != track_module_sets.end()) {
+        module_sets.insert_or_assign(range, make_keys(iterator->second, module_key));
+    } else {
+        module_sets.erase(range);
+    }
+}
+
+std::optional<std::vector<proc::time::range>> exporter_timeline_diff::changed_ranges(
+    exporter_timeline_signature const &from, exporter_timeline_signature const &to) {
+    if (from.identifier != to.identifier || from.sample_rate != to.sample_rate) {
+        return std::nullopt;
+    }
+
+    std::vector<proc::time::range> ranges;
+
+    for (auto const &track_pair : from.tracks) {
+        auto const iterator = to.tracks.find(track_pair.first);
+        if (iterator == to.tracks.end()) {
+            append_ranges(ranges, track_pair.second);
+        } else {
+            append_changed_ranges(ranges, track_pair.second, iterator->second);
+        }
+    }
+
+    for (auto const &track_pair : to.tracks) {
+        if (!from.tracks.contains(track_pair.first)) {
+            append_ranges(ranges, track_pair.second);
+        }
+    }
+
+    return ranges;
+}
+
+std::string exporter_timeline_diff::fragment_revision(exporter_timeline_signature const &signature,
+                                                     proc::time::range const &range) {
+    std::ostringstream stream;
+
+    for (auto const &track_pair : signature.tracks) {
+        for (auto const &module_set_pair : track_pair.second) {
+            if (module_set_pair.first.intersected(range).has_value()) {
+                append_revision(stream, track_pair.first, module_set_pair.first, module_set_pair.second);
+            }
+        }
+    }
+
+    return stream.str();
+}
+
+std::map<fragment_index_t, std::string> exporter_timeline_diff::fragment_revisions(
+    exporter_timeline_signature const &signature, fragment_range const &frag_range, sample_rate_t const frag_length) {
+    auto const total_range = timeline_utils::to_time_range(frag_range, frag_length);
+
+    std::map<fragment_index_t, std::ostringstream> streams;
+
+    auto each = make_fast_each(frag_range.index, frag_range.end_index());
+    while (yas_each_next(each)) {
+        streams[yas_each_index(each)];
+    }
+
+    // モジュールセットごとに重なるフラグメントへ書き足すので、signatureは1度だけ辿る
+    for (auto const &track_pair : signature.tracks) {
+        for (auto const &module_set_pair : track_pair.second) {
+            auto const intersected = module_set_pair.first.intersected(total_range);
+            if (!intersected.has_value()) {
+                continue;
+            }
+
+            auto const covered_range = timeline_utils::to_fragment_range(
+                timeline_utils::fragments_range(intersected.value(), frag_length), frag_length);
+
+            auto covered_each = make_fast_each(covered_range.index, covered_range.end_index());
+            while (yas_each_next(covered_each)) {
+                append_revision(streams.at(yas_each_index(covered_each)), track_pair.first, module_set_pair.first,
+                                module_set_pair.second);
+            }
+        }
+    }
+
+    std::map<fragment_index_t, std::string> revisions;
+
+    for (auto const &pair : streams) {
+        revisions.emplace(pair.first, pair.second.str());
+    }
+
+    return revisions;
+}
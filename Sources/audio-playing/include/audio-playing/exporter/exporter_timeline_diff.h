@@ -0,0 +1,51 @@
+//
+//  exporter_timeline_diff.h
+//
+
+#pragma once
+
+#include <audio-playing/common/types.h>
+#include <audio-processing/time/time.h>
+#include <audio-processing/timeline/timeline.h>
+
+#include <functional>
+#include <map>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace yas::playing {
+// タイムラインの差分を取るために、トラックとモジュールの並びを保持しておくもの
+// モジュールはmodule_keyで返したキーで比較し、モジュール自体は保持しない
+struct exporter_timeline_signature final {
+    std::string identifier;
+    sample_rate_t sample_rate;
+    std::map<track_index_t, std::map<proc::time::range, std::vector<std::string>>> tracks;
+};
+}  // namespace yas::playing
+
+namespace yas::playing::exporter_timeline_diff {
+using module_key_f = std::function<std::string(proc::module_ptr const &)>;
+
+[[nodiscard]] exporter_timeline_signature make_signature(std::string const &identifier, sample_rate_t const,
+                                                         proc::timeline::track_map_t const &, module_key_f const &);
+
+// 編集されたトラックやモジュールセットだけを今のタイムラインから作り直す
+void update_track(exporter_timeline_signature &, track_index_t const, proc::timeline::track_map_t const &,
+                  module_key_f const &);
+void update_module_set(exporter_timeline_signature &, track_index_t const, proc::time::range const &,
+                       proc::timeline::track_map_t const &, module_key_f const &);
+
+// 変わったモジュールセットの範囲を返す
+// identifierかsample_rateが違えば全体が変わったとしてnulloptを返す
+[[nodiscard]] std::optional<std::vector<proc::time::range>> changed_ranges(exporter_timeline_signature const &from,
+                                                                           exporter_timeline_signature const &to);
+
+// rangeに重なるモジュールセットの並びを表す文字列を返す
+// 同じであれば書き出される内容も同じになる
+[[nodiscard]] std::string fragment_revision(exporter_timeline_signature const &, proc::time::range const &);
+// frag_rangeのフラグメントごとのfragment_revisionをまとめて返す
+[[nodiscard]] std::map<fragment_index_t, std::string> fragment_revisions(exporter_timeline_signature const &,
+                                                                         fragment_range const &,
+                                                                         sample_rate_t const frag_length);
+}  // namespace yas::playing::exporter_timeline_diff
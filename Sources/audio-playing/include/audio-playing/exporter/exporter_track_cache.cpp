@@ -0,0 +1,131 @@
+//
+//  exporter_track_cache.cpp
+//
+
+#include "exporter_track_cache.h"
+
+#include <audio-playing/timeline/timeline_utils.h>
+
+#include <audio-processing/umbrella.hpp>
+
+#include <algorithm>
+
+using namespace yas;
+using namespace yas::playing;
+
+namespace yas::playing::exporter_track_cache_utils {
+// 後のトラックでsignal_eventの中身が書き換えられるので、中身ごと複製する
+static std::unique_ptr<proc::stream> copied_stream(proc::stream const &src_stream) {
+    auto stream = std::make_unique<proc::stream>(src_stream.sync_source());
+
+    for (auto const &ch_pair : src_stream.channels()) {
+        auto &channel = stream->add_channel(ch_pair.first);
+
+        for (auto const &event_pair : ch_pair.second.filtered_events<proc::signal_event>()) {
+            if (auto copied = timeline_utils::copied_signal_event(*event_pair.second)) {
+                channel.insert_event(event_pair.first, std::move(copied));
+            }
+        }
+
+        for (auto const &event_pair : ch_pair.second.filtered_events<proc::number_event>()) {
+            channel.insert_event(proc::time::frame{event_pair.first}, event_pair.second);
+        }
+    }
+
+    return stream;
+}
+}  // namespace yas::playing::exporter_track_cache_utils
+
+exporter_track_cache::exporter_track_cache() {
+}
+
+void exporter_track_cache::set_capacity(std::size_t const capacity) {
+    std::lock_guard<std::mutex> lock(this->_mutex);
+
+    this->_capacity = capacity;
+    this->_evict_if_needed();
+}
+
+std::size_t exporter_track_cache::capacity() const {
+    std::lock_guard<std::mutex> lock(this->_mutex);
+
+    return this->_capacity;
+}
+
+bool exporter_track_cache::is_enabled() const {
+    return this->capacity() > 0;
+}
+
+std::optional<exporter_track_cache::hit> exporter_track_cache::find(proc::time::range const &range,
+                                                                     revisions_t const &revisions) {
+    std::lock_guard<std::mutex> lock(this->_mutex);
+
+    for (auto idx = revisions.size(); idx > 0; --idx) {
+        auto const &trk_idx = revisions.at(idx - 1).first;
+
+        auto iterator = this->_entries.find({range, trk_idx});
+        if (iterator == this->_entries.end()) {
+            continue;
+        }
+
+        auto &entry = iterator->second;
+        if (entry.revisions.size() != idx ||
+            !std::equal(entry.revisions.begin(), entry.revisions.end(), revisions.begin())) {
+            continue;
+        }
+
+        entry.used_count = ++this->_used_count;
+
+        return hit{.track_index = trk_idx, .stream = exporter_track_cache_utils::copied_stream(*entry.stream)};
+    }
+
+    return std::nullopt;
+}
+
+void exporter_track_cache::store(proc::time::range const &range, revisions_t const &revisions,
+                                 proc::stream const &stream) {
+    if (revisions.empty()) {
+        return;
+    }
+
+    auto copied = exporter_track_cache_utils::copied_stream(stream);
+
+    std::lock_guard<std::mutex> lock(this->_mutex);
+
+    if (this->_capacity == 0) {
+        return;
+    }
+
+    this->_entries.insert_or_assign(
+        {range, revisions.back().first},
+        entry{.revisions = revisions, .stream = std::move(copied), .used_count = ++this->_used_count});
+
+    this->_evict_if_needed();
+}
+
+void exporter_track_cache::clear() {
+    std::lock_guard<std::mutex> lock(this->_mutex);
+
+    this->_entries.clear();
+}
+
+std::size_t exporter_track_cache::size() const {
+    std::lock_guard<std::mutex> lock(this->_mutex);
+
+    return this->_entries.size();
+}
+
+void exporter_track_cache::_evict_if_needed() {
+    // 使われてから一番時間の経ったものから消す
+    while (this->_entries.size() > this->_capacity) {
+        auto const oldest = std::min_element(this->_entries.begin(), this->_entries.end(),
+                                             [](auto const &lhs, auto const &rhs) {
+                                                 return lhs.second.used_count < rhs.second.used_count;
+                                             });
+        this->_entries.erase(oldest);
+    }
+}
+
+exporter_track_cache_ptr exporter_track_cache::make_shared() {
+    return exporter_track_cache_ptr(new exporter_track_cache{});
+}
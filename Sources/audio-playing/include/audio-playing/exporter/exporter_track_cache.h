@@ -0,0 +1,62 @@
+//
+//  exporter_track_cache.h
+//
+
+#pragma once
+
+#include <audio-playing/common/ptr.h>
+#include <audio-playing/common/types.h>
+#include <audio-processing/stream/stream.h>
+#include <audio-processing/time/time.h>
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+namespace yas::playing {
+// トラックを処理し終えた時点のストリームを処理した範囲ごとに保持しておく
+// 上流のトラックが変わっていなければ、その続きのトラックから処理を再開できる
+struct exporter_track_cache final {
+    // 処理順に並べたトラックのインデックスとリビジョン
+    using revisions_t = std::vector<std::pair<track_index_t, uint64_t>>;
+
+    struct hit final {
+        // このトラックまでの処理を終えたストリーム
+        track_index_t track_index;
+        std::unique_ptr<proc::stream> stream;
+    };
+
+    // 保持するストリームの数。0なら使わない
+    void set_capacity(std::size_t const);
+    [[nodiscard]] std::size_t capacity() const;
+    [[nodiscard]] bool is_enabled() const;
+
+    // revisionsの先頭から一致するもののうち、一番後ろのトラックのものを複製して返す
+    [[nodiscard]] std::optional<hit> find(proc::time::range const &, revisions_t const &);
+    // revisionsは処理を終えたトラックまでのもの
+    void store(proc::time::range const &, revisions_t const &, proc::stream const &);
+    void clear();
+
+    [[nodiscard]] std::size_t size() const;
+
+    [[nodiscard]] static exporter_track_cache_ptr make_shared();
+
+   private:
+    struct entry final {
+        revisions_t revisions;
+        std::unique_ptr<proc::stream> stream;
+        uint64_t used_count;
+    };
+
+    std::size_t _capacity = 0;
+    std::map<std::pair<proc::time::range, track_index_t>, entry> _entries;
+    uint64_t _used_count = 0;
+    mutable std::mutex _mutex;
+
+    exporter_track_cache();
+
+    void _evict_if_needed();
+};
+}  // namespace yas::playing
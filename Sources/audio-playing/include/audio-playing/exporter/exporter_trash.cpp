@@ -0,0 +1,142 @@
+//
+//  exporter_trash.cpp
+//
+
+#include "exporter_trash.h"
+
+#include <filesystem>
+#include <vector>
+
+using namespace yas;
+using namespace yas::playing;
+
+exporter_trash::exporter_trash(std::string const &trash_path)
+    : _trash_path(trash_path), _thread([this] { this->_run(); }) {
+}
+
+exporter_trash::~exporter_trash() {
+    {
+        std::lock_guard<std::mutex> lock(this->_mutex);
+        this->_is_stopped = true;
+    }
+
+    this->_condition.notify_all();
+    this->_thread.join();
+}
+
+bool exporter_trash::move(std::string const &path) {
+    std::error_code error_code;
+
+    if (!std::filesystem::exists(path, error_code)) {
+        return !error_code;
+    }
+
+    // 消す側で空のtrashを消すのと重ならないようにする
+    std::lock_guard<std::mutex> lock(this->_mutex);
+
+    std::filesystem::create_directories(this->_trash_path, error_code);
+    if (error_code) {
+        return false;
+    }
+
+    // 前に消しきれなかったものと名前が重ならないようにする
+    std::filesystem::path dst_path;
+    do {
+        dst_path = std::filesystem::path{this->_trash_path}.append(std::to_string(++this->_last_serial));
+    } while (std::filesystem::exists(dst_path, error_code));
+
+    std::filesystem::rename(path, dst_path, error_code);
+
+    return !error_code;
+}
+
+void exporter_trash::collect() {
+    {
+        std::lock_guard<std::mutex> lock(this->_mutex);
+        this->_is_requested = true;
+    }
+
+    this->_condition.notify_all();
+}
+
+void exporter_trash::wait_until_collected() {
+    std::unique_lock<std::mutex> lock(this->_mutex);
+    this->_condition.wait(
+        lock, [this] { return this->_is_stopped || (!this->_is_requested && !this->_is_collecting); });
+}
+
+std::string const &exporter_trash::path() const {
+    return this->_trash_path;
+}
+
+void exporter_trash::_run() {
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(this->_mutex);
+            this->_condition.wait(lock, [this] { return this->_is_stopped || this->_is_requested; });
+
+            if (this->_is_stopped) {
+                return;
+            }
+
+            this->_is_requested = false;
+            this->_is_collecting = true;
+        }
+
+        this->_remove_contents();
+
+        {
+            std::lock_guard<std::mutex> lock(this->_mutex);
+            this->_is_collecting = false;
+        }
+
+        this->_condition.notify_all();
+    }
+}
+
+void exporter_trash::_remove_contents() {
+    std::error_code error_code;
+    std::vector<std::filesystem::path> paths;
+
+    for (auto iterator = std::filesystem::recursive_directory_iterator(this->_trash_path, error_code);
+         !error_code && iterator != std::filesystem::recursive_directory_iterator(); iterator.increment(error_code)) {
+        paths.emplace_back(iterator->path());
+    }
+
+    // 中身から先に消す
+    std::size_t removed_count = 0;
+
+    for (auto iterator = paths.rbegin(); iterator != paths.rend(); ++iterator) {
+        std::filesystem::remove(*iterator, error_code);
+
+        if (++removed_count % _batch_count == 0) {
+            {
+                std::lock_guard<std::mutex> lock(this->_mutex);
+                if (this->_is_stopped) {
+                    return;
+                }
+            }
+
+            std::this_thread::sleep_for(_batch_interval);
+        }
+    }
+
+    // 空になっていればtrash自体も消す
+    std::lock_guard<std::mutex> lock(this->_mutex);
+    std::filesystem::remove(this->_trash_path, error_code);
+}
+
+exporter_trash_ptr exporter_trash::make_shared(std::string const &trash_path) {
+    return exporter_trash_ptr(new exporter_trash{trash_path});
+}
+
+std::string exporter_trash::sibling_path(std::string const &root_path) {
+    auto path = std::filesystem::path{root_path}.lexically_normal();
+
+    // 末尾が区切り文字だとファイル名が空になるので、取り除いてから名前を付ける
+    if (!path.has_filename()) {
+        path = path.parent_path();
+    }
+
+    return path.concat("_trash").string();
+}
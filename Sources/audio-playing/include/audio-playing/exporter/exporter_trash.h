@@ -0,0 +1,54 @@
+//
+//  exporter_trash.h
+//
+
+#pragma once
+
+#include <audio-playing/common/ptr.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace yas::playing {
+// 要らなくなったファイルをtrashに移しておき、別スレッドで少しずつ消す
+// 書き出しのタスクが消し終わるのを待たずに次の処理を始められるようにする
+struct exporter_trash final {
+    ~exporter_trash();
+
+    // 名前を変えるだけなので中身が多くてもすぐに終わる
+    // pathがなければ何もしない。移せなければfalse
+    [[nodiscard]] bool move(std::string const &path);
+    // trashの中身を消し始める
+    void collect();
+    // 消し終わるまで待つ
+    void wait_until_collected();
+
+    [[nodiscard]] std::string const &path() const;
+
+    [[nodiscard]] static exporter_trash_ptr make_shared(std::string const &trash_path);
+    // root_pathと並べて置くtrashのパス。末尾に区切り文字があってもroot_pathの中には作らない
+    [[nodiscard]] static std::string sibling_path(std::string const &root_path);
+
+   private:
+    // 再生の読み込みとぶつからないように、これだけ消すごとに少し休む
+    static std::size_t constexpr _batch_count = 64;
+    static std::chrono::milliseconds constexpr _batch_interval{1};
+
+    std::string const _trash_path;
+    uint64_t _last_serial = 0;
+    std::mutex _mutex;
+    std::condition_variable _condition;
+    bool _is_requested = false;
+    bool _is_collecting = false;
+    bool _is_stopped = false;
+    std::thread _thread;
+
+    exporter_trash(std::string const &trash_path);
+
+    void _run();
+    void _remove_contents();
+};
+}  // namespace yas::playing
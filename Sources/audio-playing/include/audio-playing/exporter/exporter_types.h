@@ -5,14 +5,23 @@
 #pragma once
 
 #include <audio-playing/common/ptr.h>
+#include <audio-playing/common/types.h>
 #include <audio-processing/timeline/timeline.h>
 #include <cpp-utils/result.h>
 #include <cpp-utils/task_queue.h>
 
+#include <functional>
+#include <map>
+#include <optional>
+#include <set>
+#include <string>
+
 namespace yas::playing {
 enum class exporter_method {
     reset,
     export_began,
+    /// 処理の途中までを再生側に渡した。ファイルにはまだ書き込んでいない
+    export_progressed,
     export_ended,
 };
 
@@ -22,6 +31,9 @@ enum class exporter_error {
     write_signal_failed,
     write_numbers_failed,
     get_content_paths_failed,
+    write_manifest_failed,
+    stash_fragment_failed,
+    restore_fragment_failed,
 };
 
 using exporter_result_t = result<exporter_method, exporter_error>;
@@ -31,6 +43,104 @@ struct exporter_event final {
     std::optional<proc::time::range> const range;
 };
 
+struct exporter_window final {
+    /// 再生位置のフラグメントより前に書き出すフラグメントの数
+    length_t preceding_count = 0;
+    /// 再生位置のフラグメントより後に書き出すフラグメントの数
+    length_t following_count = 0;
+
+    bool operator==(exporter_window const &rhs) const {
+        return this->preceding_count == rhs.preceding_count && this->following_count == rhs.following_count;
+    }
+
+    bool operator!=(exporter_window const &rhs) const {
+        return !(*this == rhs);
+    }
+};
+
+struct exporter_slice_policy final {
+    /// 再生位置に近いフラグメントで1度に処理する長さ。短いほど処理したところから早く鳴らせる。0ならフラグメントの長さ
+    length_t near_length = 0;
+    /// それ以外のフラグメントで1度に処理する長さ。0ならフラグメントの長さ
+    length_t far_length = 0;
+    /// 再生位置のフラグメントから前後いくつまでを近いとみなすか
+    length_t near_fragment_count = 0;
+
+    bool operator==(exporter_slice_policy const &rhs) const {
+        return this->near_length == rhs.near_length && this->far_length == rhs.far_length &&
+               this->near_fragment_count == rhs.near_fragment_count;
+    }
+
+    bool operator!=(exporter_slice_policy const &rhs) const {
+        return !(*this == rhs);
+    }
+};
+
+enum class exporter_storage_format {
+    /// モジュールの出力した型のまま書き出す
+    as_is,
+    /// 再生時のpcm_formatに合わせる。coordinatorで具体的なフォーマットに置き換える
+    rendering,
+    float32,
+    float64,
+    int16,
+    int16_dithered,
+};
+
+struct exporter_storage_policy final {
+    exporter_storage_format format = exporter_storage_format::as_is;
+    /// チャンネルごとにformatを上書きする
+    std::map<channel_index_t, exporter_storage_format> channel_formats;
+
+    [[nodiscard]] exporter_storage_format format_for_channel(channel_index_t const ch_idx) const {
+        if (auto const iterator = this->channel_formats.find(ch_idx); iterator != this->channel_formats.end()) {
+            return iterator->second;
+        }
+        return this->format;
+    }
+
+    bool operator==(exporter_storage_policy const &rhs) const {
+        return this->format == rhs.format && this->channel_formats == rhs.channel_formats;
+    }
+
+    bool operator!=(exporter_storage_policy const &rhs) const {
+        return !(*this == rhs);
+    }
+};
+
+struct exporter_channel_policy final {
+    /// 負のチャンネルは内部のバスとみなして書き出さない
+    bool skips_negative_channels = true;
+    /// 出力に割り当てられていないチャンネルは手が空いたときに書き出す
+    bool defers_unmapped_channels = true;
+    /// 出力に割り当てられているチャンネル。coordinatorでchannel_mappingから埋める
+    /// nulloptなら全て割り当てられているものとして扱う
+    std::optional<std::set<channel_index_t>> mapped_channels = std::nullopt;
+
+    [[nodiscard]] bool is_exported(channel_index_t const ch_idx) const {
+        return !this->skips_negative_channels || ch_idx >= 0;
+    }
+
+    [[nodiscard]] bool is_deferred(channel_index_t const ch_idx) const {
+        return this->defers_unmapped_channels && this->mapped_channels.has_value() &&
+               !this->mapped_channels->contains(ch_idx);
+    }
+
+    bool operator==(exporter_channel_policy const &rhs) const {
+        return this->skips_negative_channels == rhs.skips_negative_channels &&
+               this->defers_unmapped_channels == rhs.defers_unmapped_channels &&
+               this->mapped_channels == rhs.mapped_channels;
+    }
+
+    bool operator!=(exporter_channel_policy const &rhs) const {
+        return !(*this == rhs);
+    }
+};
+
+/// モジュールを書き出す内容で区別するためのキーを返す。タイムラインを作り直しても同じ内容のモジュールには同じキーを返す
+/// nulloptを返したモジュールはインスタンスで区別する
+using exporter_module_key_f = std::function<std::optional<std::string>(proc::module_ptr const &)>;
+
 struct exporter_task_priority final {
     task_priority_t const timeline;
     task_priority_t const fragment;
@@ -0,0 +1,164 @@
+//
+//  manifest_file.cpp
+//
+
+#include "manifest_file.h"
+
+#include <audio-playing/timeline/timeline_utils.h>
+
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+using namespace yas;
+using namespace yas::playing;
+
+namespace yas::playing::manifest_file {
+static std::string const header = "playing_manifest";
+static uint32_t const version = 2;
+
+static std::optional<std::string> read_value(std::istream &stream, std::string const &key) {
+    std::string line;
+    if (!std::getline(stream, line)) {
+        return std::nullopt;
+    }
+
+    std::string const prefix = key + " ";
+    if (!line.starts_with(prefix)) {
+        return std::nullopt;
+    }
+
+    return line.substr(prefix.size());
+}
+}  // namespace yas::playing::manifest_file
+
+bool manifest_file::manifest::operator==(manifest const &rhs) const {
+    return this->identifier == rhs.identifier && this->sample_rate == rhs.sample_rate &&
+           this->fingerprint == rhs.fingerprint && this->storage == rhs.storage &&
+           this->fragment_indices == rhs.fragment_indices;
+}
+
+bool manifest_file::manifest::operator!=(manifest const &rhs) const {
+    return !(*this == rhs);
+}
+
+manifest_file::write_result_t manifest_file::write(std::string const &path, manifest const &manifest) {
+    std::string const tmp_path = path + ".tmp";
+
+    std::ofstream stream{tmp_path, std::ios_base::out | std::ios_base::trunc};
+    if (stream.fail()) {
+        return write_result_t{write_error::open_stream_failed};
+    }
+
+    auto const frag_ranges = timeline_utils::to_fragment_ranges(manifest.fragment_indices);
+
+    stream << header << " " << version << "\n";
+    stream << "identifier " << manifest.identifier << "\n";
+    stream << "sample_rate " << manifest.sample_rate << "\n";
+    stream << "fingerprint " << manifest.fingerprint << "\n";
+    stream << "storage " << manifest.storage << "\n";
+    stream << "fragments " << frag_ranges.size() << "\n";
+
+    for (auto const &frag_range : frag_ranges) {
+        stream << frag_range.index << " " << frag_range.length << "\n";
+    }
+
+    if (stream.fail()) {
+        return write_result_t{write_error::write_to_stream_failed};
+    }
+
+    stream.close();
+    if (stream.fail()) {
+        return write_result_t{write_error::close_stream_failed};
+    }
+
+    std::error_code error_code;
+    std::filesystem::rename(tmp_path, path, error_code);
+    if (error_code) {
+        return write_result_t{write_error::rename_failed};
+    }
+
+    return write_result_t{nullptr};
+}
+
+manifest_file::read_result_t manifest_file::read(std::string const &path) {
+    std::ifstream stream{path, std::ios_base::in};
+    if (stream.fail()) {
+        return read_result_t{read_error::open_stream_failed};
+    }
+
+    auto const version_value = read_value(stream, header);
+    if (!version_value.has_value() || *version_value != std::to_string(version)) {
+        return read_result_t{read_error::invalid_version};
+    }
+
+    auto const identifier = read_value(stream, "identifier");
+    auto const sample_rate = read_value(stream, "sample_rate");
+    auto const fingerprint = read_value(stream, "fingerprint");
+    auto const storage = read_value(stream, "storage");
+    auto const range_count = read_value(stream, "fragments");
+
+    if (!identifier.has_value() || !sample_rate.has_value() || !fingerprint.has_value() || !storage.has_value() ||
+        !range_count.has_value()) {
+        return read_result_t{read_error::invalid_format};
+    }
+
+    manifest manifest{.identifier = *identifier, .fingerprint = *fingerprint, .storage = *storage};
+
+    try {
+        manifest.sample_rate = std::stoul(*sample_rate);
+
+        std::size_t const count = std::stoul(*range_count);
+
+        for (std::size_t idx = 0; idx < count; ++idx) {
+            fragment_index_t frag_idx;
+            length_t length;
+
+            if (!(stream >> frag_idx >> length)) {
+                return read_result_t{read_error::invalid_format};
+            }
+
+            for (length_t offset = 0; offset < length; ++offset) {
+                manifest.fragment_indices.insert(frag_idx + static_cast<fragment_index_t>(offset));
+            }
+        }
+    } catch (std::exception const &) {
+        return read_result_t{read_error::invalid_format};
+    }
+
+    return read_result_t{std::move(manifest)};
+}
+
+std::string yas::to_string(manifest_file::write_error const &error) {
+    switch (error) {
+        case manifest_file::write_error::open_stream_failed:
+            return "open_stream_failed";
+        case manifest_file::write_error::write_to_stream_failed:
+            return "write_to_stream_failed";
+        case manifest_file::write_error::close_stream_failed:
+            return "close_stream_failed";
+        case manifest_file::write_error::rename_failed:
+            return "rename_failed";
+    }
+}
+
+std::string yas::to_string(manifest_file::read_error const &error) {
+    switch (error) {
+        case manifest_file::read_error::open_stream_failed:
+            return "open_stream_failed";
+        case manifest_file::read_error::invalid_version:
+            return "invalid_version";
+        case manifest_file::read_error::invalid_format:
+            return "invalid_format";
+    }
+}
+
+std::ostream &operator<<(std::ostream &os, yas::playing::manifest_file::write_error const &value) {
+    os << to_string(value);
+    return os;
+}
+
+std::ostream &operator<<(std::ostream &os, yas::playing::manifest_file::read_error const &value) {
+    os << to_string(value);
+    return os;
+}
@@ -0,0 +1,56 @@
+//
+//  manifest_file.h
+//
+
+#pragma once
+
+#include <audio-playing/common/types.h>
+#include <cpp-utils/result.h>
+
+#include <ostream>
+#include <set>
+#include <string>
+
+namespace yas::playing::manifest_file {
+enum class write_error {
+    open_stream_failed,
+    write_to_stream_failed,
+    close_stream_failed,
+    rename_failed,
+};
+
+enum class read_error {
+    open_stream_failed,
+    invalid_version,
+    invalid_format,
+};
+
+// 書き出しの済んだフラグメントを再起動後も使い回すための記録
+struct manifest final {
+    std::string identifier;
+    sample_rate_t sample_rate;
+    // タイムラインの内容が変わったら呼び出し側で変える。改行は含めない
+    std::string fingerprint;
+    // 書き出す時の型の変換。変わったら書き出し直す
+    std::string storage;
+    std::set<fragment_index_t> fragment_indices;
+
+    bool operator==(manifest const &rhs) const;
+    bool operator!=(manifest const &rhs) const;
+};
+
+using write_result_t = result<std::nullptr_t, write_error>;
+using read_result_t = result<manifest, read_error>;
+
+// 一時ファイルに書いてから置き換える
+write_result_t write(std::string const &path, manifest const &);
+read_result_t read(std::string const &path);
+}  // namespace yas::playing::manifest_file
+
+namespace yas {
+std::string to_string(playing::manifest_file::write_error const &);
+std::string to_string(playing::manifest_file::read_error const &);
+}  // namespace yas
+
+std::ostream &operator<<(std::ostream &, yas::playing::manifest_file::write_error const &);
+std::ostream &operator<<(std::ostream &, yas::playing::manifest_file::read_error const &);
@@ -4,7 +4,9 @@
 
 #include "buffering_channel.h"
 
+#include <audio-playing/common/math.h>
 #include <audio-playing/player/buffering_element.h>
+#include <audio-playing/player/player_utils.h>
 #include <cpp-utils/fast_each.h>
 
 #include <thread>
@@ -12,22 +14,53 @@
 using namespace yas;
 using namespace yas::playing;
 
-buffering_channel::buffering_channel(std::vector<std::shared_ptr<buffering_element_for_buffering_channel>> &&elements)
-    : _elements(std::move(elements)) {
+buffering_channel::buffering_channel(std::vector<std::shared_ptr<buffering_element_for_buffering_channel>> &&elements,
+                                     sample_rate_t const frag_length)
+    : _elements(std::move(elements)), _frag_length(frag_length) {
 }
 
-void buffering_channel::write_all_elements_on_task(path::channel const &ch_path, fragment_index_t const top_frag_idx) {
+void buffering_channel::write_top_element_on_task(path::channel const &ch_path, fragment_index_t const top_frag_idx,
+                                                  std::optional<fragment_range> const &loop_range) {
     this->_ch_path = ch_path;
+    this->_loop_range = loop_range;
 
-    fragment_index_t element_frag_idx = top_frag_idx;
-    for (auto &element : this->_elements) {
-        element->force_write_on_task(ch_path, element_frag_idx);
-        ++element_frag_idx;
+    if (this->_elements.empty()) {
+        return;
+    }
 
-        std::this_thread::yield();
+    for (auto const &element : this->_elements) {
+        element->set_loop_range_on_task(loop_range);
+    }
+
+    // フラグメントのインデックスをエレメントの数で割った余りの位置のエレメントに割り当てる
+    auto each = make_fast_each(static_cast<fragment_index_t>(this->_elements.size()));
+    while (yas_each_next(each)) {
+        auto const element_frag_idx = top_frag_idx + yas_each_index(each);
+        auto const &element = this->_element_at(element_frag_idx);
+
+        if (element_frag_idx == top_frag_idx) {
+            element->force_write_on_task(ch_path, element_frag_idx);
+        } else {
+            element->set_writable_on_task(element_frag_idx);
+        }
     }
 }
 
+bool buffering_channel::write_element_if_needed_on_task(fragment_index_t const frag_idx) {
+    if (this->_elements.empty()) {
+        return false;
+    }
+
+    auto const &element = this->_element_at(frag_idx);
+
+    if (element->state() == audio_buffering_element_state::writable &&
+        element->fragment_index_on_render() == frag_idx) {
+        return element->write_if_needed_on_task(this->_ch_path.value());
+    }
+
+    return false;
+}
+
 bool buffering_channel::write_elements_if_needed_on_task() {
     bool is_written = false;
 
@@ -41,16 +74,27 @@ bool buffering_channel::write_elements_if_needed_on_task() {
 }
 
 void buffering_channel::advance_on_render(fragment_index_t const frag_idx) {
-    for (auto const &element : this->_elements) {
-        if (element->fragment_index_on_render() == frag_idx) {
-            element->advance_on_render(frag_idx + this->_elements.size());
-        }
+    if (this->_elements.empty()) {
+        return;
+    }
+
+    // 進めた後も同じ位置のエレメントに留まる
+    if (auto const &element = this->_element_at(frag_idx); element->fragment_index_on_render() == frag_idx) {
+        element->advance_on_render(frag_idx + this->_elements.size());
     }
 }
 
-void buffering_channel::overwrite_element_on_render(fragment_range const range) {
+void buffering_channel::overwrite_element_on_render(fragment_range const range,
+                                                    std::optional<fragment_range> const &keeping_range) {
+    // 上書きはタイムライン上のフラグメントで指定されるので、ループで折り返した位置と比べる
     for (auto const &element : this->_elements) {
-        auto const frag_idx = element->fragment_index_on_render();
+        auto const element_frag_idx = element->fragment_index_on_render();
+        if (keeping_range.has_value() && keeping_range->contains(element_frag_idx)) {
+            // 読み込み中のエレメントを書き込み可能にすると音が途切れる
+            continue;
+        }
+
+        auto const frag_idx = player_utils::looped_fragment_index(element_frag_idx, this->_loop_range);
         if (range.contains(frag_idx)) {
             element->overwrite_on_render();
         }
@@ -58,35 +102,75 @@ void buffering_channel::overwrite_element_on_render(fragment_range const range)
 }
 
 bool buffering_channel::read_into_buffer_on_render(audio::pcm_buffer *out_buffer, frame_index_t const frame) {
-    for (auto const &element : this->_elements) {
-        if (element->contains_frame_on_render(frame)) {
-            return element->read_into_buffer_on_render(out_buffer, frame);
-        }
+    if (auto const *element = this->_element_containing_frame_on_render(frame)) {
+        return element->read_into_buffer_on_render(out_buffer, frame);
+    }
+
+    return false;
+}
+
+bool buffering_channel::read_into_channel_on_render(audio::pcm_buffer *out_buffer, uint32_t const out_ch_idx,
+                                                    uint32_t const to_frame, frame_index_t const frame,
+                                                    uint32_t const length) {
+    if (auto const *element = this->_element_containing_frame_on_render(frame)) {
+        return element->read_into_channel_on_render(out_buffer, out_ch_idx, to_frame, frame, length);
     }
 
     return false;
 }
 
+std::vector<std::shared_ptr<buffering_element_for_buffering_channel>> const &buffering_channel::elements() const {
+    return this->_elements;
+}
+
 std::vector<std::shared_ptr<buffering_element_for_buffering_channel>> const &buffering_channel::elements_for_test()
     const {
-    return this->_elements;
+    return this->elements();
+}
+
+std::shared_ptr<buffering_element_for_buffering_channel> const &buffering_channel::_element_at(
+    fragment_index_t const frag_idx) const {
+    return this->_elements[math::mod_int(frag_idx, this->_elements.size())];
+}
+
+buffering_element_for_buffering_channel *buffering_channel::_element_containing_frame_on_render(
+    frame_index_t const frame) const {
+    if (this->_elements.empty() || this->_frag_length == 0) {
+        return nullptr;
+    }
+
+    auto const frag_idx = math::floor_int(frame, this->_frag_length) / static_cast<int64_t>(this->_frag_length);
+    auto const &element = this->_element_at(frag_idx);
+
+    if (element->contains_frame_on_render(frame)) {
+        return element.get();
+    }
+
+    return nullptr;
 }
 
 buffering_channel_ptr buffering_channel::make_shared(
-    std::vector<std::shared_ptr<buffering_element_for_buffering_channel>> &&elements) {
-    return buffering_channel_ptr{new buffering_channel{std::move(elements)}};
+    std::vector<std::shared_ptr<buffering_element_for_buffering_channel>> &&elements,
+    sample_rate_t const frag_length) {
+    return buffering_channel_ptr{new buffering_channel{std::move(elements), frag_length}};
 }
 
 buffering_channel_ptr playing::make_buffering_channel(std::size_t const element_count, audio::format const &format,
                                                       sample_rate_t const frag_length) {
+    return make_buffering_channel(element_count, format, frag_length, nullptr);
+}
+
+buffering_channel_ptr playing::make_buffering_channel(std::size_t const element_count, audio::format const &format,
+                                                      sample_rate_t const frag_length,
+                                                      fragment_cache_ptr const &fragment_cache) {
     std::vector<std::shared_ptr<buffering_element_for_buffering_channel>> elements;
     elements.reserve(element_count);
 
     auto element_each = make_fast_each(element_count);
     while (yas_each_next(element_each)) {
-        elements.emplace_back(buffering_element::make_shared(format, frag_length));
+        elements.emplace_back(buffering_element::make_shared(format, frag_length, fragment_cache));
         std::this_thread::yield();
     }
 
-    return buffering_channel::make_shared(std::move(elements));
+    return buffering_channel::make_shared(std::move(elements), frag_length);
 }
@@ -10,26 +10,46 @@
 
 namespace yas::playing {
 struct buffering_channel final : buffering_channel_for_buffering_resource {
-    void write_all_elements_on_task(path::channel const &, fragment_index_t const top_frag_idx) override;
+    // 先頭のフラグメントだけ読み込み、残りのエレメントは書き込み待ちにする
+    // loop_rangeがあれば、エレメントはループの範囲の後ろを範囲の先頭へ折り返したファイルを読む
+    void write_top_element_on_task(path::channel const &, fragment_index_t const top_frag_idx,
+                                   std::optional<fragment_range> const &loop_range) override;
+    [[nodiscard]] bool write_element_if_needed_on_task(fragment_index_t const) override;
     [[nodiscard]] bool write_elements_if_needed_on_task() override;
 
     void advance_on_render(fragment_index_t const prev_frag_idx) override;
-    void overwrite_element_on_render(fragment_range const) override;
+    void overwrite_element_on_render(fragment_range const, std::optional<fragment_range> const &keeping_range) override;
     [[nodiscard]] bool read_into_buffer_on_render(audio::pcm_buffer *, frame_index_t const) override;
+    [[nodiscard]] bool read_into_channel_on_render(audio::pcm_buffer *, uint32_t const out_ch_idx,
+                                                   uint32_t const to_frame, frame_index_t const,
+                                                   uint32_t const length) override;
 
+    [[nodiscard]] std::vector<std::shared_ptr<buffering_element_for_buffering_channel>> const &elements() const;
     [[nodiscard]] std::vector<std::shared_ptr<buffering_element_for_buffering_channel>> const &elements_for_test()
         const;
 
+    // フラグメントはインデックスをエレメントの数で割った余りの位置のエレメントで扱う
     [[nodiscard]] static buffering_channel_ptr make_shared(
-        std::vector<std::shared_ptr<buffering_element_for_buffering_channel>> &&);
+        std::vector<std::shared_ptr<buffering_element_for_buffering_channel>> &&, sample_rate_t const frag_length);
 
    private:
     std::vector<std::shared_ptr<buffering_element_for_buffering_channel>> const _elements;
+    sample_rate_t const _frag_length;
     std::optional<path::channel> _ch_path = std::nullopt;
+    std::optional<fragment_range> _loop_range = std::nullopt;
 
-    explicit buffering_channel(std::vector<std::shared_ptr<buffering_element_for_buffering_channel>> &&);
+    buffering_channel(std::vector<std::shared_ptr<buffering_element_for_buffering_channel>> &&,
+                      sample_rate_t const frag_length);
+
+    [[nodiscard]] std::shared_ptr<buffering_element_for_buffering_channel> const &_element_at(
+        fragment_index_t const) const;
+    [[nodiscard]] buffering_element_for_buffering_channel *_element_containing_frame_on_render(
+        frame_index_t const) const;
 };
 
 [[nodiscard]] buffering_channel_ptr make_buffering_channel(std::size_t const element_count, audio::format const &format,
                                                            sample_rate_t const frag_length);
+[[nodiscard]] buffering_channel_ptr make_buffering_channel(std::size_t const element_count, audio::format const &format,
+                                                           sample_rate_t const frag_length,
+                                                           fragment_cache_ptr const &);
 }  // namespace yas::playing
@@ -19,9 +19,14 @@ struct buffering_element_for_buffering_channel {
 
     [[nodiscard]] virtual bool write_if_needed_on_task(path::channel const &) = 0;
     virtual void force_write_on_task(path::channel const &, fragment_index_t const) = 0;
+    virtual void set_writable_on_task(fragment_index_t const) = 0;
+    virtual void set_loop_range_on_task(std::optional<fragment_range> const &) = 0;
 
     [[nodiscard]] virtual bool contains_frame_on_render(frame_index_t const) = 0;
     [[nodiscard]] virtual bool read_into_buffer_on_render(audio::pcm_buffer *, frame_index_t const) = 0;
+    [[nodiscard]] virtual bool read_into_channel_on_render(audio::pcm_buffer *, uint32_t const out_ch_idx,
+                                                           uint32_t const to_frame, frame_index_t const,
+                                                           uint32_t const length) = 0;
     virtual void advance_on_render(fragment_index_t const) = 0;
     virtual void overwrite_on_render() = 0;
 };
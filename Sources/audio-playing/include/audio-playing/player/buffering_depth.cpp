@@ -0,0 +1,64 @@
+//
+//  buffering_depth.cpp
+//
+
+#include "buffering_depth.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace yas;
+using namespace yas::playing;
+
+buffering_depth::buffering_depth(buffering_depth_policy const &policy) : _policy(policy) {
+}
+
+buffering_depth_policy const &buffering_depth::policy() const {
+    return this->_policy;
+}
+
+void buffering_depth::add_load_duration(double const seconds) {
+    if (this->_peak_load_duration.has_value()) {
+        this->_peak_load_duration = std::max(seconds, this->_peak_load_duration.value() * _peak_decay);
+    } else {
+        this->_peak_load_duration = seconds;
+    }
+}
+
+std::optional<double> buffering_depth::peak_load_duration() const {
+    return this->_peak_load_duration;
+}
+
+std::size_t buffering_depth::element_count(std::size_t const current_count, double const frag_duration,
+                                           std::size_t const ch_count, std::size_t const element_byte_count) const {
+    if (!this->_peak_load_duration.has_value() || frag_duration <= 0.0) {
+        return this->_clamped(current_count, ch_count, element_byte_count);
+    }
+
+    // 再生中のエレメントの他に、読み込んでいる間に進む分だけ先読みしておく
+    double const ahead = this->_peak_load_duration.value() * this->_policy.safety_factor / frag_duration;
+    auto const count = static_cast<std::size_t>(std::ceil(ahead)) + 1;
+
+    return this->_clamped(count, ch_count, element_byte_count);
+}
+
+bool buffering_depth::is_underrunning(std::size_t const current_count, double const frag_duration) const {
+    if (!this->_peak_load_duration.has_value() || current_count == 0) {
+        return false;
+    }
+
+    return this->_peak_load_duration.value() > frag_duration * static_cast<double>(current_count - 1);
+}
+
+std::size_t buffering_depth::_clamped(std::size_t const count, std::size_t const ch_count,
+                                      std::size_t const element_byte_count) const {
+    auto const &policy = this->_policy;
+
+    std::size_t clamped = std::min(count, policy.max_element_count);
+
+    if (std::size_t const byte_count = ch_count * element_byte_count; byte_count > 0) {
+        clamped = std::min(clamped, policy.memory_budget / byte_count);
+    }
+
+    return std::max(clamped, policy.min_element_count);
+}
@@ -0,0 +1,40 @@
+//
+//  buffering_depth.h
+//
+
+#pragma once
+
+#include <audio-playing/player/buffering_resource_types.h>
+
+#include <optional>
+
+namespace yas::playing {
+// エレメントの読み込みにかかった時間から、途切れずに再生できるエレメントの数を決める
+struct buffering_depth final {
+    explicit buffering_depth(buffering_depth_policy const &);
+
+    [[nodiscard]] buffering_depth_policy const &policy() const;
+
+    // 1フラグメント分を全チャンネル読み込むのにかかった秒数
+    void add_load_duration(double const seconds);
+    [[nodiscard]] std::optional<double> peak_load_duration() const;
+
+    // frag_duration: 1フラグメントの秒数
+    // element_byte_count: 1チャンネル1エレメントのバッファのバイト数
+    // まだ計っていなければcurrent_countをpolicyの範囲に収めて返す
+    [[nodiscard]] std::size_t element_count(std::size_t const current_count, double const frag_duration,
+                                            std::size_t const ch_count, std::size_t const element_byte_count) const;
+    // 余裕を見なくても読み込みが再生に追いつかない
+    [[nodiscard]] bool is_underrunning(std::size_t const current_count, double const frag_duration) const;
+
+   private:
+    // 一時的に遅くなってもすぐには減らさないように、最大値を少しずつ下げていく
+    static double constexpr _peak_decay = 0.95;
+
+    buffering_depth_policy const _policy;
+    std::optional<double> _peak_load_duration = std::nullopt;
+
+    [[nodiscard]] std::size_t _clamped(std::size_t const count, std::size_t const ch_count,
+                                       std::size_t const element_byte_count) const;
+};
+}  // namespace yas::playing
@@ -4,15 +4,22 @@
 
 #include "buffering_element.h"
 
+#include <audio-playing/player/player_utils.h>
 #include <audio-playing/signal_file/signal_file.h>
 #include <audio-playing/signal_file/signal_file_info.h>
+#include <audio-playing/timeline/timeline_utils.h>
 #include <cpp-utils/file_manager.h>
 
+#include <audio-processing/umbrella.hpp>
+
+#include <cstring>
+
 using namespace yas;
 using namespace yas::playing;
 
-buffering_element::buffering_element(audio::format const &format, sample_rate_t const frag_length)
-    : _frag_length(frag_length), _buffer(format, frag_length) {
+buffering_element::buffering_element(audio::format const &format, sample_rate_t const frag_length,
+                                     fragment_cache_ptr const &fragment_cache)
+    : _frag_length(frag_length), _buffer(format, frag_length), _fragment_cache(fragment_cache) {
 }
 
 [[nodiscard]] buffering_element::state_t buffering_element::state() const {
@@ -20,16 +27,10 @@ buffering_element::buffering_element(audio::format const &format, sample_rate_t
 }
 
 [[nodiscard]] frame_index_t buffering_element::begin_frame_on_render() const {
-    if (this->_current_state.load() != state_t::readable) {
-        throw std::runtime_error("state is not reading.");
-    }
     return this->_frag_idx * this->_frag_length;
 }
 
 [[nodiscard]] fragment_index_t buffering_element::fragment_index_on_render() const {
-    if (this->_current_state.load() == state_t::initial) {
-        throw std::runtime_error("state is initial.");
-    }
     return this->_frag_idx;
 }
 
@@ -53,6 +54,11 @@ void buffering_element::force_write_on_task(path::channel const &ch_path, fragme
     }
 }
 
+void buffering_element::set_writable_on_task(fragment_index_t const frag_idx) {
+    this->_frag_idx = frag_idx;
+    this->_current_state.store(state_t::writable);
+}
+
 bool buffering_element::contains_frame_on_render(frame_index_t const frame) {
     if (this->_current_state.load() != state_t::readable) {
         return false;
@@ -65,7 +71,7 @@ bool buffering_element::contains_frame_on_render(frame_index_t const frame) {
 
 bool buffering_element::read_into_buffer_on_render(audio::pcm_buffer *out_buffer, frame_index_t const frame) {
     if (this->_current_state.load() != state_t::readable) {
-        throw std::runtime_error("state is not reading.");
+        return false;
     }
 
     frame_index_t const begin_frame = this->begin_frame_on_render();
@@ -87,6 +93,39 @@ bool buffering_element::read_into_buffer_on_render(audio::pcm_buffer *out_buffer
     }
 }
 
+bool buffering_element::read_into_channel_on_render(audio::pcm_buffer *out_buffer, uint32_t const out_ch_idx,
+                                                    uint32_t const to_frame, frame_index_t const frame,
+                                                    uint32_t const length) {
+    if (this->_current_state.load() != state_t::readable) {
+        return false;
+    }
+
+    frame_index_t const begin_frame = this->begin_frame_on_render();
+    frame_index_t const from_frame = frame - begin_frame;
+
+    if (from_frame < 0 || this->_buffer.frame_length() <= from_frame) {
+        return false;
+    }
+
+    if (begin_frame + this->_buffer.frame_length() < frame + length) {
+        return false;
+    }
+
+    if (out_buffer->frame_length() < to_frame + length) {
+        return false;
+    }
+
+    if (auto const result =
+            out_buffer->copy_channel_from(this->_buffer, {.to_channel = out_ch_idx,
+                                                          .from_begin_frame = static_cast<uint32_t>(from_frame),
+                                                          .to_begin_frame = to_frame,
+                                                          .length = length})) {
+        return true;
+    } else {
+        return false;
+    }
+}
+
 void buffering_element::advance_on_render(fragment_index_t const frag_idx) {
     if (this->_current_state.load() != state_t::readable) {
         return;
@@ -104,6 +143,14 @@ void buffering_element::overwrite_on_render() {
     this->_current_state.store(state_t::writable);
 }
 
+void buffering_element::set_loop_range_on_task(std::optional<fragment_range> const &loop_range) {
+    this->_loop_range = loop_range;
+}
+
+audio::pcm_buffer const &buffering_element::buffer_on_render() const {
+    return this->_buffer;
+}
+
 audio::pcm_buffer const &buffering_element::buffer_for_test() const {
     return this->_buffer;
 }
@@ -111,9 +158,17 @@ audio::pcm_buffer const &buffering_element::buffer_for_test() const {
 bool buffering_element::_write_on_task(path::channel const &ch_path) {
     this->_buffer.clear();
 
-    auto const frag_idx = this->_frag_idx;
+    // エレメントは再生する順のフラグメントで並び、ループの範囲の後ろでは範囲の先頭のファイルを読む
+    auto const frag_idx = player_utils::looped_fragment_index(this->_frag_idx, this->_loop_range);
 
     auto const frag_path = path::fragment{ch_path, frag_idx};
+
+    if (this->_fragment_cache) {
+        if (auto const events = this->_fragment_cache->find(frag_path.value())) {
+            return this->_write_from_cache_on_task(*events, frag_idx * this->_frag_length);
+        }
+    }
+
     auto const paths_result = file_manager::content_paths_in_directory(frag_path.value());
     if (!paths_result) {
         if (paths_result.error() == file_manager::content_paths_error::directory_not_found) {
@@ -146,8 +201,7 @@ bool buffering_element::_write_on_task(path::channel const &ch_path) {
         return true;
     }
 
-    sample_rate_t const sample_rate = std::round(format.sample_rate());
-    frame_index_t const buf_top_frame = frag_idx * sample_rate;
+    frame_index_t const buf_top_frame = frag_idx * this->_frag_length;
 
     for (signal_file_info const &info : infos) {
         if (auto const result = signal_file::read(info, this->_buffer, buf_top_frame); !result) {
@@ -158,6 +212,43 @@ bool buffering_element::_write_on_task(path::channel const &ch_path) {
     return true;
 }
 
+bool buffering_element::_write_from_cache_on_task(fragment_cache::signal_events_t const &events,
+                                                  frame_index_t const buf_top_frame) {
+    auto const &format = this->_buffer.format();
+    std::type_info const &sample_type = yas::to_sample_type(format.pcm_format());
+    if (sample_type == typeid(std::nullptr_t)) {
+        return false;
+    }
+
+    frame_index_t const buf_next_frame = buf_top_frame + this->_buffer.frame_length();
+    std::size_t const sample_byte_count = format.sample_byte_count();
+    char *data_ptr = timeline_utils::char_data(this->_buffer);
+
+    // ファイルから読むときと同じく、型の合わないものは読まない
+    for (auto const &event_pair : events) {
+        auto const &range = event_pair.first;
+        auto const &event = event_pair.second;
+
+        if (event->sample_type() != sample_type) {
+            continue;
+        }
+
+        if (range.frame < buf_top_frame || buf_next_frame < range.next_frame()) {
+            return false;
+        }
+
+        std::memcpy(&data_ptr[(range.frame - buf_top_frame) * sample_byte_count], timeline_utils::char_data(*event),
+                    range.length * sample_byte_count);
+    }
+
+    return true;
+}
+
 buffering_element_ptr buffering_element::make_shared(audio::format const &format, sample_rate_t const frag_length) {
-    return buffering_element_ptr{new buffering_element{format, frag_length}};
+    return make_shared(format, frag_length, nullptr);
+}
+
+buffering_element_ptr buffering_element::make_shared(audio::format const &format, sample_rate_t const frag_length,
+                                                     fragment_cache_ptr const &fragment_cache) {
+    return buffering_element_ptr{new buffering_element{format, frag_length, fragment_cache}};
 }
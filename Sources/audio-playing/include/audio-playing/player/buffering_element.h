@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include <audio-playing/common/fragment_cache.h>
 #include <audio-playing/common/ptr.h>
 #include <audio-playing/player/buffering_channel_dependency.h>
 #include <audio-playing/player/buffering_element_types.h>
@@ -11,30 +12,48 @@
 namespace yas::playing {
 struct buffering_element final : buffering_element_for_buffering_channel {
     [[nodiscard]] state_t state() const override;
+    // readableの時だけ意味がある
     [[nodiscard]] frame_index_t begin_frame_on_render() const;
     [[nodiscard]] fragment_index_t fragment_index_on_render() const override;
 
     [[nodiscard]] bool write_if_needed_on_task(path::channel const &) override;
     void force_write_on_task(path::channel const &, fragment_index_t const) override;
+    // 読み込まずにフラグメントの位置だけ決めて、write_if_needed_on_taskで読まれるようにする
+    void set_writable_on_task(fragment_index_t const) override;
+    // ループの範囲を折り返したフラグメントのファイルを読み込むようにする。次の書き込みから反映される
+    void set_loop_range_on_task(std::optional<fragment_range> const &) override;
 
     [[nodiscard]] bool contains_frame_on_render(frame_index_t const) override;
     [[nodiscard]] bool read_into_buffer_on_render(audio::pcm_buffer *, frame_index_t const) override;
+    // 途中のバッファを使わずに、out_bufferのチャンネルのto_frameの位置へ直接コピーする
+    [[nodiscard]] bool read_into_channel_on_render(audio::pcm_buffer *, uint32_t const out_ch_idx,
+                                                   uint32_t const to_frame, frame_index_t const,
+                                                   uint32_t const length) override;
     void advance_on_render(fragment_index_t const) override;
     void overwrite_on_render() override;
 
+    // readableの間だけレンダリングで参照する
+    [[nodiscard]] audio::pcm_buffer const &buffer_on_render() const;
+
     [[nodiscard]] audio::pcm_buffer const &buffer_for_test() const;
 
     [[nodiscard]] static buffering_element_ptr make_shared(audio::format const &, sample_rate_t const frag_length);
+    // fragment_cacheにあればファイルより先にそちらから読む
+    [[nodiscard]] static buffering_element_ptr make_shared(audio::format const &, sample_rate_t const frag_length,
+                                                           fragment_cache_ptr const &);
 
    private:
     sample_rate_t const _frag_length;
     audio::pcm_buffer _buffer;
+    fragment_cache_ptr const _fragment_cache;
 
     std::atomic<state_t> _current_state{state_t::initial};
     fragment_index_t _frag_idx = 0;
+    std::optional<fragment_range> _loop_range = std::nullopt;
 
-    buffering_element(audio::format const &, sample_rate_t const frag_length);
+    buffering_element(audio::format const &, sample_rate_t const frag_length, fragment_cache_ptr const &);
 
     bool _write_on_task(path::channel const &ch_path);
+    bool _write_from_cache_on_task(fragment_cache::signal_events_t const &, frame_index_t const buf_top_frame);
 };
 }  // namespace yas::playing
@@ -0,0 +1,141 @@
+//
+//  buffering_loader.cpp
+//
+
+#include "buffering_loader.h"
+
+using namespace yas;
+using namespace yas::playing;
+
+buffering_loader::buffering_loader(std::size_t const thread_count) {
+    if (thread_count > 1) {
+        this->_threads.reserve(thread_count - 1);
+
+        for (std::size_t idx = 1; idx < thread_count; ++idx) {
+            this->_threads.emplace_back([this] { this->_run(); });
+        }
+    }
+}
+
+buffering_loader::~buffering_loader() {
+    {
+        std::lock_guard<std::mutex> lock(this->_mutex);
+        this->_is_stopped = true;
+    }
+
+    this->_condition.notify_all();
+
+    for (auto &thread : this->_threads) {
+        thread.join();
+    }
+}
+
+std::size_t buffering_loader::thread_count() const {
+    return this->_threads.size() + 1;
+}
+
+void buffering_loader::perform(std::size_t const count, std::function<void(std::size_t const)> const &handler) {
+    if (count == 0) {
+        return;
+    }
+
+    if (this->_threads.empty() || count == 1) {
+        for (std::size_t idx = 0; idx < count; ++idx) {
+            handler(idx);
+        }
+        return;
+    }
+
+    std::lock_guard<std::mutex> perform_lock(this->_perform_mutex);
+
+    {
+        std::lock_guard<std::mutex> lock(this->_mutex);
+        this->_handler = &handler;
+        this->_count = count;
+        this->_next_idx = 0;
+        this->_finished_count = 0;
+        this->_exception = nullptr;
+    }
+
+    this->_condition.notify_all();
+
+    this->_perform_jobs();
+
+    std::exception_ptr exception = nullptr;
+
+    {
+        std::unique_lock<std::mutex> lock(this->_mutex);
+        this->_condition.wait(lock, [this] { return this->_finished_count == this->_count; });
+
+        this->_handler = nullptr;
+        exception = this->_exception;
+        this->_exception = nullptr;
+    }
+
+    if (exception) {
+        std::rethrow_exception(exception);
+    }
+}
+
+void buffering_loader::_run() {
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(this->_mutex);
+            this->_condition.wait(lock, [this] {
+                return this->_is_stopped || (this->_handler != nullptr && this->_next_idx < this->_count);
+            });
+
+            if (this->_is_stopped) {
+                return;
+            }
+        }
+
+        this->_perform_jobs();
+    }
+}
+
+void buffering_loader::_perform_jobs() {
+    while (true) {
+        std::function<void(std::size_t const)> const *handler = nullptr;
+        std::size_t idx = 0;
+
+        {
+            std::lock_guard<std::mutex> lock(this->_mutex);
+
+            if (this->_handler == nullptr || this->_count <= this->_next_idx) {
+                return;
+            }
+
+            handler = this->_handler;
+            idx = this->_next_idx++;
+        }
+
+        std::exception_ptr exception = nullptr;
+
+        try {
+            (*handler)(idx);
+        } catch (...) {
+            exception = std::current_exception();
+        }
+
+        bool is_finished = false;
+
+        {
+            std::lock_guard<std::mutex> lock(this->_mutex);
+
+            if (exception && !this->_exception) {
+                this->_exception = exception;
+            }
+
+            is_finished = (++this->_finished_count == this->_count);
+        }
+
+        if (is_finished) {
+            this->_condition.notify_all();
+        }
+    }
+}
+
+buffering_loader_ptr buffering_loader::make_shared(std::size_t const thread_count) {
+    return buffering_loader_ptr(new buffering_loader{thread_count});
+}
@@ -0,0 +1,50 @@
+//
+//  buffering_loader.h
+//
+
+#pragma once
+
+#include <audio-playing/common/ptr.h>
+
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace yas::playing {
+// チャンネルごとのエレメントの読み込みを複数のスレッドに分けて行う
+// 呼び出したスレッドも読み込みに加わり、全て終わるまで待ってから戻る
+struct buffering_loader final {
+    ~buffering_loader();
+
+    // 呼び出したスレッドを含めた読み込みのスレッドの数
+    [[nodiscard]] std::size_t thread_count() const;
+
+    // handlerにはcount未満のインデックスが1回ずつ渡される
+    // handlerで投げられた例外は全て終わってから投げ直す
+    void perform(std::size_t const count, std::function<void(std::size_t const)> const &handler);
+
+    // thread_countが1以下なら呼び出したスレッドだけで順に読み込む
+    [[nodiscard]] static buffering_loader_ptr make_shared(std::size_t const thread_count);
+
+   private:
+    std::vector<std::thread> _threads;
+
+    std::mutex _perform_mutex;
+    std::mutex _mutex;
+    std::condition_variable _condition;
+    std::function<void(std::size_t const)> const *_handler = nullptr;
+    std::size_t _count = 0;
+    std::size_t _next_idx = 0;
+    std::size_t _finished_count = 0;
+    std::exception_ptr _exception = nullptr;
+    bool _is_stopped = false;
+
+    explicit buffering_loader(std::size_t const thread_count);
+
+    void _run();
+    void _perform_jobs();
+};
+}  // namespace yas::playing
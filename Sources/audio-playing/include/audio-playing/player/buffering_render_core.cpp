@@ -0,0 +1,134 @@
+//
+//  buffering_render_core.cpp
+//
+
+#include "buffering_render_core.h"
+
+#include <audio-playing/common/math.h>
+#include <audio-playing/player/buffering_channel.h>
+#include <audio-playing/player/buffering_element.h>
+
+#include <algorithm>
+
+using namespace yas;
+using namespace yas::playing;
+
+buffering_render_core::buffering_render_core(std::vector<buffering_channel_ptr> &&channels,
+                                             std::vector<buffering_element *> &&elements,
+                                             std::size_t const element_count, sample_rate_t const frag_length,
+                                             read_f const read_handler)
+    : _elements(std::move(elements)),
+      _channels(std::move(channels)),
+      _element_count(element_count),
+      _ch_count(this->_channels.size()),
+      _frag_length(frag_length),
+      _read_handler(read_handler) {
+}
+
+std::size_t buffering_render_core::channel_count() const {
+    return this->_ch_count;
+}
+
+bool buffering_render_core::read_into_buffer_on_render(audio::pcm_buffer *out_buffer, uint32_t const to_frame,
+                                                       frame_index_t const frame, uint32_t const length) const {
+    return this->_read_handler(*this, out_buffer, to_frame, frame, length);
+}
+
+template <typename T, std::size_t ChCount>
+bool buffering_render_core::_read(buffering_render_core const &core, audio::pcm_buffer *out_buffer,
+                                  uint32_t const to_frame, frame_index_t const frame, uint32_t const length) {
+    std::size_t const ch_count = (ChCount > 0) ? ChCount : core._ch_count;
+
+    if (out_buffer->format().channel_count() < ch_count || out_buffer->frame_length() < to_frame + length) {
+        return false;
+    }
+
+    auto const frag_idx = math::floor_int(frame, core._frag_length) / static_cast<int64_t>(core._frag_length);
+    auto const element_idx = static_cast<std::size_t>(math::mod_int(frag_idx, core._element_count));
+
+    for (std::size_t ch_idx = 0; ch_idx < ch_count; ++ch_idx) {
+        buffering_element *const element = core._elements[ch_idx * core._element_count + element_idx];
+
+        if (!element->contains_frame_on_render(frame)) {
+            return false;
+        }
+
+        auto const from_frame = static_cast<uint32_t>(frame - element->begin_frame_on_render());
+
+        if (core._frag_length < from_frame + length) {
+            return false;
+        }
+
+        T const *const from_data = element->buffer_on_render().data_ptr_at_index<T>(0) + from_frame;
+        T *const to_data = out_buffer->data_ptr_at_index<T>(static_cast<uint32_t>(ch_idx)) + to_frame;
+
+        std::copy_n(from_data, length, to_data);
+    }
+
+    return true;
+}
+
+template <typename T>
+buffering_render_core::read_f buffering_render_core::_read_handler_for(std::size_t const ch_count) {
+    switch (ch_count) {
+        case 1:
+            return &buffering_render_core::_read<T, 1>;
+        case 2:
+            return &buffering_render_core::_read<T, 2>;
+        default:
+            return &buffering_render_core::_read<T, 0>;
+    }
+}
+
+buffering_render_core_ptr buffering_render_core::make_shared(
+    std::vector<std::shared_ptr<buffering_channel_for_buffering_resource>> const &channels,
+    std::size_t const element_count, sample_rate_t const frag_length, audio::pcm_format const pcm_format) {
+    if (channels.empty() || element_count == 0 || frag_length == 0) {
+        return nullptr;
+    }
+
+    read_f read_handler = nullptr;
+
+    switch (pcm_format) {
+        case audio::pcm_format::float32:
+            read_handler = _read_handler_for<float>(channels.size());
+            break;
+        case audio::pcm_format::float64:
+            read_handler = _read_handler_for<double>(channels.size());
+            break;
+        case audio::pcm_format::int16:
+            read_handler = _read_handler_for<int16_t>(channels.size());
+            break;
+        case audio::pcm_format::fixed824:
+            read_handler = _read_handler_for<int32_t>(channels.size());
+            break;
+        case audio::pcm_format::other:
+            return nullptr;
+    }
+
+    std::vector<buffering_channel_ptr> concrete_channels;
+    concrete_channels.reserve(channels.size());
+
+    std::vector<buffering_element *> elements;
+    elements.reserve(channels.size() * element_count);
+
+    for (auto const &channel : channels) {
+        auto concrete_channel = std::dynamic_pointer_cast<buffering_channel>(channel);
+        if (!concrete_channel || concrete_channel->elements().size() != element_count) {
+            return nullptr;
+        }
+
+        for (auto const &element : concrete_channel->elements()) {
+            auto *const concrete_element = dynamic_cast<buffering_element *>(element.get());
+            if (!concrete_element) {
+                return nullptr;
+            }
+            elements.emplace_back(concrete_element);
+        }
+
+        concrete_channels.emplace_back(std::move(concrete_channel));
+    }
+
+    return buffering_render_core_ptr{new buffering_render_core{std::move(concrete_channels), std::move(elements),
+                                                               element_count, frag_length, read_handler}};
+}
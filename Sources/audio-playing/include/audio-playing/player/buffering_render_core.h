@@ -0,0 +1,48 @@
+//
+//  buffering_render_core.h
+//
+
+#pragma once
+
+#include <audio-engine/pcm_buffer/pcm_buffer.h>
+#include <audio-playing/common/ptr.h>
+#include <audio-playing/common/types.h>
+
+#include <vector>
+
+namespace yas::playing {
+// 具体的なエレメントを直接参照し、pcm_formatとチャンネル数ごとに選んだ処理で出力のバッファへコピーする
+struct buffering_render_core final {
+    [[nodiscard]] std::size_t channel_count() const;
+
+    // out_bufferの全てのチャンネルのto_frameの位置に、frameからlengthの長さをコピーする
+    [[nodiscard]] bool read_into_buffer_on_render(audio::pcm_buffer *, uint32_t const to_frame, frame_index_t const,
+                                                  uint32_t const length) const;
+
+    // channelsやエレメントがbuffering_channelとbuffering_elementでない場合や、pcm_formatが扱えない場合はnullptrを返す
+    [[nodiscard]] static buffering_render_core_ptr make_shared(
+        std::vector<std::shared_ptr<buffering_channel_for_buffering_resource>> const &channels,
+        std::size_t const element_count, sample_rate_t const frag_length, audio::pcm_format const);
+
+   private:
+    using read_f = bool (*)(buffering_render_core const &, audio::pcm_buffer *, uint32_t const, frame_index_t const,
+                            uint32_t const);
+
+    // チャンネルごとにエレメントを並べたもの
+    std::vector<buffering_element *> const _elements;
+    std::vector<buffering_channel_ptr> const _channels;
+    std::size_t const _element_count;
+    std::size_t const _ch_count;
+    sample_rate_t const _frag_length;
+    read_f const _read_handler;
+
+    buffering_render_core(std::vector<buffering_channel_ptr> &&, std::vector<buffering_element *> &&,
+                          std::size_t const element_count, sample_rate_t const frag_length, read_f const);
+
+    template <typename T, std::size_t ChCount>
+    static bool _read(buffering_render_core const &, audio::pcm_buffer *, uint32_t const to_frame,
+                      frame_index_t const, uint32_t const length);
+    template <typename T>
+    [[nodiscard]] static read_f _read_handler_for(std::size_t const ch_count);
+};
+}  // namespace yas::playing
@@ -15,6 +15,8 @@
 #include <cpp-utils/file_manager.h>
 #include <cpp-utils/result.h>
 
+#include <algorithm>
+#include <chrono>
 #include <mutex>
 #include <thread>
 
@@ -22,12 +24,17 @@ using namespace yas;
 using namespace yas::playing;
 
 buffering_resource::buffering_resource(std::size_t const element_count, std::string const &root_path,
-                                       make_channel_f &&make_channel_handler)
-    : _element_count(element_count), _root_path(root_path), _make_channel_handler(make_channel_handler), _ch_mapping() {
+                                       make_channel_f &&make_channel_handler, buffering_loader_ptr const &loader)
+    : _element_count(element_count),
+      _root_path(root_path),
+      _make_channel_handler(make_channel_handler),
+      _loader(loader),
+      _ch_mapping(),
+      _element_count_request(element_count) {
 }
 
 std::size_t buffering_resource::element_count() const {
-    return this->_element_count;
+    return this->_element_count.load();
 }
 
 buffering_resource::setup_state_t buffering_resource::setup_state() const {
@@ -48,12 +55,13 @@ sample_rate_t buffering_resource::fragment_length_on_render() const {
 
 void buffering_resource::set_creating_on_render(sample_rate_t const sample_rate, audio::pcm_format const &pcm_format,
                                                 uint32_t const ch_count) {
-    if (auto const state = this->_setup_state.load(); state == setup_state_t::creating) {
-        throw std::runtime_error("state (" + to_string(state) + ") is already creating.");
+    if (this->_setup_state.load() == setup_state_t::creating) {
+        this->_render_errors.add_on_render(render_error::invalid_setup_state);
+        return;
     }
 
     this->_sample_rate = sample_rate;
-    this->_frag_length = round(sample_rate);
+    this->_frag_length = this->_resolved_frag_length(sample_rate);
     this->_pcm_format = pcm_format;
     this->_ch_count = ch_count;
     this->_setup_state.store(setup_state_t::creating);
@@ -61,8 +69,9 @@ void buffering_resource::set_creating_on_render(sample_rate_t const sample_rate,
 
 bool buffering_resource::needs_create_on_render(sample_rate_t const sample_rate, audio::pcm_format const &pcm_format,
                                                 uint32_t const ch_count) {
-    if (auto const state = this->_setup_state.load(); state != setup_state_t::rendering) {
-        throw std::runtime_error("state (" + to_string(state) + ") is not rendering.");
+    if (this->_setup_state.load() != setup_state_t::rendering) {
+        this->_render_errors.add_on_render(render_error::invalid_setup_state);
+        return false;
     }
 
     if (this->_sample_rate != sample_rate) {
@@ -77,6 +86,11 @@ bool buffering_resource::needs_create_on_render(sample_rate_t const sample_rate,
         return true;
     }
 
+    // エレメントのバッファの長さが変わるので作り直す
+    if (this->_frag_length != this->_resolved_frag_length(sample_rate)) {
+        return true;
+    }
+
     return false;
 }
 
@@ -87,7 +101,9 @@ void buffering_resource::create_buffer_on_task() {
 
     this->_format = std::nullopt;
     this->_tl_path = std::nullopt;
+    this->_render_core = nullptr;
     this->_channels.clear();
+    this->_pending_frag_range = std::nullopt;
 
     std::this_thread::yield();
 
@@ -112,12 +128,9 @@ void buffering_resource::create_buffer_on_task() {
 
     std::this_thread::yield();
 
-    auto ch_each = make_fast_each(this->_ch_count);
-    while (yas_each_next(ch_each)) {
-        this->_channels.emplace_back(this->_make_channel_handler(this->_element_count, format, this->_sample_rate));
-
-        std::this_thread::yield();
-    }
+    this->_update_depth_policy_on_task();
+    this->_create_channels_on_task(this->_target_element_count_on_task());
+    this->_update_depth_on_task();
 
     this->_rendering_state.store(rendering_state_t::waiting);
 
@@ -129,8 +142,9 @@ void buffering_resource::create_buffer_on_task() {
 }
 
 void buffering_resource::set_all_writing_on_render(frame_index_t const frame) {
-    if (auto const state = this->_rendering_state.load(); state == rendering_state_t::all_writing) {
-        throw std::runtime_error("state (" + to_string(state) + ") is already all_writing.");
+    if (this->_rendering_state.load() == rendering_state_t::all_writing) {
+        this->_render_errors.add_on_render(render_error::invalid_rendering_state);
+        return;
     }
 
     this->_all_writing_frame = frame;
@@ -155,9 +169,34 @@ void buffering_resource::write_all_elements_on_task() {
 
     std::this_thread::yield();
 
+    if (auto loop_range = this->_pull_loop_range_request_on_task(); loop_range.has_value()) {
+        this->_loop_range = loop_range.value();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(this->_loop_mutex);
+        this->_loop_range_on_main = this->_loop_range;
+        this->_loop_frag_length_on_main = this->_frag_length;
+    }
+
+    std::this_thread::yield();
+
+    // renderからは読まれていないので、エレメントの数が変わっていればここで作り直す
+    this->_update_depth_policy_on_task();
+    if (auto const element_count = this->_target_element_count_on_task();
+        element_count != this->_element_count.load()) {
+        this->_render_core = nullptr;
+        this->_channels.clear();
+        this->_create_channels_on_task(element_count);
+        this->_update_depth_on_task();
+    }
+
+    std::this_thread::yield();
+
     this->_tl_path = path::timeline{.root_path = this->_root_path,
                                     .identifier = this->_identifier,
-                                    .sample_rate = static_cast<sample_rate_t>(this->_sample_rate)};
+                                    .sample_rate = static_cast<sample_rate_t>(this->_sample_rate),
+                                    .fragment_length = this->_frag_length};
 
     std::this_thread::yield();
 
@@ -166,15 +205,24 @@ void buffering_resource::write_all_elements_on_task() {
         throw std::runtime_error("sample_rate is empty.");
     }
 
-    channel_index_t ch_idx = 0;
+    auto const begin_time = std::chrono::steady_clock::now();
+
+    // 再生位置のフラグメントだけを全チャンネル分読み込んだらすぐに再生を始め、残りはadvancingの間に読む
     auto const ch_count = this->_channels.size();
-    for (auto const &channel : this->_channels) {
+    this->_perform_on_channels_on_task([this, ch_count, top_frag_idx = top_frag_idx.value()](std::size_t const idx) {
+        auto const ch_idx = static_cast<channel_index_t>(idx);
         path::channel const ch_path{*this->_tl_path, this->_ch_mapping.file_index(ch_idx, ch_count).value()};
-        channel->write_all_elements_on_task(ch_path, top_frag_idx.value());
+        this->_channels.at(idx)->write_top_element_on_task(ch_path, top_frag_idx, this->_loop_range);
+    });
 
-        ++ch_idx;
+    std::chrono::duration<double> const duration = std::chrono::steady_clock::now() - begin_time;
+    this->_add_load_duration_on_task(duration.count());
 
-        std::this_thread::yield();
+    if (auto const element_count = this->_element_count.load(); element_count > 1) {
+        this->_pending_frag_range =
+            fragment_range{.index = top_frag_idx.value() + 1, .length = static_cast<length_t>(element_count - 1)};
+    } else {
+        this->_pending_frag_range = std::nullopt;
     }
 
     std::this_thread::yield();
@@ -185,8 +233,9 @@ void buffering_resource::write_all_elements_on_task() {
 }
 
 void buffering_resource::advance_on_render(fragment_index_t const frag_idx) {
-    if (auto const state = this->_rendering_state.load(); state != rendering_state_t::advancing) {
-        throw std::runtime_error("state (" + to_string(state) + ") is not advancing.");
+    if (this->_rendering_state.load() != rendering_state_t::advancing) {
+        this->_render_errors.add_on_render(render_error::invalid_rendering_state);
+        return;
     }
 
     for (auto const &channel : this->_channels) {
@@ -200,46 +249,67 @@ bool buffering_resource::write_elements_if_needed_on_task() {
         return false;
     }
 
-    bool is_loaded = false;
+    this->_update_depth_policy_on_task();
 
-    for (auto const &channel : this->_channels) {
-        if (channel->write_elements_if_needed_on_task()) {
-            is_loaded = true;
+    if (this->_write_pending_elements_on_task()) {
+        return true;
+    }
+
+    std::atomic<bool> is_loaded{false};
+
+    auto const begin_time = std::chrono::steady_clock::now();
+
+    this->_perform_on_channels_on_task([this, &is_loaded](std::size_t const idx) {
+        if (this->_channels.at(idx)->write_elements_if_needed_on_task()) {
+            is_loaded.store(true);
         }
+    });
 
-        std::this_thread::yield();
+    // 複数のフラグメントをまとめて読んだ場合も1つ分として扱うので、多めに見積もられる
+    if (is_loaded.load()) {
+        std::chrono::duration<double> const duration = std::chrono::steady_clock::now() - begin_time;
+        this->_add_load_duration_on_task(duration.count());
     }
 
-    return is_loaded;
+    return is_loaded.load();
 }
 
-void buffering_resource::overwrite_element_on_render(element_address const &address) {
-    if (auto const state = this->_rendering_state.load(); state != rendering_state_t::advancing) {
-        throw std::runtime_error("state (" + to_string(state) + ") is not advancing.");
+void buffering_resource::overwrite_element_on_render(element_address const &address,
+                                                     fragment_range const &reading_range) {
+    if (this->_rendering_state.load() != rendering_state_t::advancing) {
+        this->_render_errors.add_on_render(render_error::invalid_rendering_state);
+        return;
     }
 
+    auto const keeping_range = address.keeps_reading ? std::optional<fragment_range>{reading_range} : std::nullopt;
+
     if (address.file_channel_index.has_value()) {
         if (auto const out_ch_idx =
                 this->_ch_mapping.out_index(address.file_channel_index.value(), this->_channels.size());
-            out_ch_idx.has_value()) {
-            this->_channels.at(out_ch_idx.value())->overwrite_element_on_render(address.fragment_range);
+            out_ch_idx.has_value() && out_ch_idx.value() < this->_channels.size()) {
+            this->_channels[out_ch_idx.value()]->overwrite_element_on_render(address.fragment_range, keeping_range);
         }
     } else {
         for (auto const &channel : this->_channels) {
-            channel->overwrite_element_on_render(address.fragment_range);
+            channel->overwrite_element_on_render(address.fragment_range, keeping_range);
         }
     }
 }
 
 bool buffering_resource::needs_all_writing_on_render() const {
-    if (auto const state = this->_rendering_state.load(); true) {
-        if (state != rendering_state_t::waiting && state != rendering_state_t::advancing) {
-            throw std::runtime_error("state (" + to_string(state) + ") is not waiting or advanding.");
-        }
+    if (auto const state = this->_rendering_state.load();
+        state != rendering_state_t::waiting && state != rendering_state_t::advancing) {
+        this->_render_errors.add_on_render(render_error::invalid_rendering_state);
+        return false;
+    }
+
+    if (this->_needs_resize_on_render()) {
+        return true;
     }
 
     if (auto lock = std::unique_lock<std::mutex>(this->_request_mutex, std::try_to_lock); lock.owns_lock()) {
-        return this->_ch_mapping_request.has_value() || this->_identifier_request.has_value();
+        return this->_ch_mapping_request.has_value() || this->_identifier_request.has_value() ||
+               this->_loop_range_request.has_value();
     }
     return false;
 }
@@ -254,17 +324,102 @@ void buffering_resource::set_identifier_request_on_main(std::string const &ident
     this->_identifier_request = identifier;
 }
 
+void buffering_resource::set_element_count_request_on_main(std::size_t const element_count) {
+    if (element_count == 0) {
+        throw std::invalid_argument("element_count is zero.");
+    }
+
+    this->_element_count_request.store(element_count);
+}
+
+void buffering_resource::set_fragment_length_request_on_main(sample_rate_t const frag_length) {
+    this->_frag_length_request.store(frag_length);
+}
+
+void buffering_resource::set_depth_policy_request_on_main(std::optional<buffering_depth_policy> const &policy) {
+    if (policy.has_value() && policy->min_element_count == 0) {
+        throw std::invalid_argument("min_element_count is zero.");
+    }
+
+    std::lock_guard<std::mutex> lock(this->_request_mutex);
+    this->_depth_policy_request = policy;
+}
+
+void buffering_resource::set_loop_range_request_on_main(std::optional<fragment_range> const &loop_range) {
+    if (loop_range.has_value() && loop_range->length == 0) {
+        throw std::invalid_argument("loop_range length is zero.");
+    }
+
+    std::lock_guard<std::mutex> lock(this->_request_mutex);
+    this->_loop_range_request = loop_range;
+}
+
+frame_index_t buffering_resource::looped_frame_on_render(frame_index_t const frame) const {
+    return player_utils::looped_frame(frame, this->_loop_range, this->_frag_length);
+}
+
+frame_index_t buffering_resource::looped_frame_on_main(frame_index_t const frame) const {
+    std::lock_guard<std::mutex> lock(this->_loop_mutex);
+    return player_utils::looped_frame(frame, this->_loop_range_on_main, this->_loop_frag_length_on_main);
+}
+
 bool buffering_resource::read_into_buffer_on_render(audio::pcm_buffer *out_buffer, channel_index_t const ch_idx,
                                                     frame_index_t const frame) {
-    if (auto const state = this->_rendering_state.load(); state != rendering_state_t::advancing) {
-        throw std::runtime_error("state (" + to_string(state) + ") is not advancing.");
+    if (this->_rendering_state.load() != rendering_state_t::advancing) {
+        this->_render_errors.add_on_render(render_error::invalid_rendering_state);
+        return false;
     }
 
     if (this->_channels.size() <= ch_idx) {
         return false;
     }
 
-    return this->_channels.at(ch_idx)->read_into_buffer_on_render(out_buffer, frame);
+    return this->_channels[ch_idx]->read_into_buffer_on_render(out_buffer, frame);
+}
+
+bool buffering_resource::read_into_channel_on_render(audio::pcm_buffer *out_buffer, channel_index_t const ch_idx,
+                                                     uint32_t const to_frame, frame_index_t const frame,
+                                                     uint32_t const length) {
+    if (this->_rendering_state.load() != rendering_state_t::advancing) {
+        this->_render_errors.add_on_render(render_error::invalid_rendering_state);
+        return false;
+    }
+
+    if (this->_channels.size() <= ch_idx) {
+        return false;
+    }
+
+    return this->_channels[ch_idx]->read_into_channel_on_render(out_buffer, static_cast<uint32_t>(ch_idx), to_frame,
+                                                                 frame, length);
+}
+
+bool buffering_resource::read_into_channels_on_render(audio::pcm_buffer *out_buffer, uint32_t const to_frame,
+                                                      frame_index_t const frame, uint32_t const length) {
+    if (this->_rendering_state.load() != rendering_state_t::advancing) {
+        this->_render_errors.add_on_render(render_error::invalid_rendering_state);
+        return false;
+    }
+
+    if (this->_render_core) {
+        return this->_render_core->read_into_buffer_on_render(out_buffer, to_frame, frame, length);
+    }
+
+    auto const ch_count = std::min(this->_channels.size(), std::size_t(out_buffer->format().channel_count()));
+
+    auto each = make_fast_each(ch_count);
+    while (yas_each_next(each)) {
+        auto const &idx = yas_each_index(each);
+        if (!this->_channels[idx]->read_into_channel_on_render(out_buffer, static_cast<uint32_t>(idx), to_frame,
+                                                               frame, length)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+render_error_counts buffering_resource::pull_render_errors() {
+    return this->_render_errors.pull();
 }
 
 std::optional<channel_mapping> buffering_resource::_pull_ch_mapping_request_on_task() {
@@ -285,10 +440,161 @@ std::optional<std::string> buffering_resource::_pull_identifier_request_on_task(
     return std::nullopt;
 }
 
-buffering_resource_ptr buffering_resource::make_shared(std::size_t const element_count, std::string const &root_path,
+std::optional<std::optional<fragment_range>> buffering_resource::_pull_loop_range_request_on_task() {
+    if (auto lock = std::unique_lock<std::mutex>(this->_request_mutex, std::try_to_lock); lock.owns_lock()) {
+        auto loop_range = std::move(this->_loop_range_request);
+        this->_loop_range_request = std::nullopt;
+        return loop_range;
+    }
+    return std::nullopt;
+}
+
+std::optional<std::optional<buffering_depth_policy>> buffering_resource::_pull_depth_policy_request_on_task() {
+    if (auto lock = std::unique_lock<std::mutex>(this->_request_mutex, std::try_to_lock); lock.owns_lock()) {
+        auto policy = std::move(this->_depth_policy_request);
+        this->_depth_policy_request = std::nullopt;
+        return policy;
+    }
+    return std::nullopt;
+}
+
+bool buffering_resource::_write_pending_elements_on_task() {
+    // 再生位置に近いフラグメントから全チャンネル分ずつ読む
+    while (this->_pending_frag_range.has_value()) {
+        auto const frag_range = this->_pending_frag_range.value();
+
+        if (frag_range.length > 1) {
+            this->_pending_frag_range = fragment_range{.index = frag_range.index + 1, .length = frag_range.length - 1};
+        } else {
+            this->_pending_frag_range = std::nullopt;
+        }
+
+        std::atomic<bool> is_loaded{false};
+
+        auto const begin_time = std::chrono::steady_clock::now();
+
+        this->_perform_on_channels_on_task([this, &is_loaded, frag_idx = frag_range.index](std::size_t const idx) {
+            if (this->_channels.at(idx)->write_element_if_needed_on_task(frag_idx)) {
+                is_loaded.store(true);
+            }
+        });
+
+        if (is_loaded.load()) {
+            std::chrono::duration<double> const duration = std::chrono::steady_clock::now() - begin_time;
+            this->_add_load_duration_on_task(duration.count());
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void buffering_resource::_perform_on_channels_on_task(std::function<void(std::size_t const)> const &handler) {
+    auto const ch_count = this->_channels.size();
+
+    // チャンネルごとにエレメントを持っているので、別々のスレッドで読み込んでも重ならない
+    if (this->_loader) {
+        this->_loader->perform(ch_count, handler);
+    } else {
+        for (std::size_t idx = 0; idx < ch_count; ++idx) {
+            handler(idx);
+
+            std::this_thread::yield();
+        }
+    }
+}
+
+sample_rate_t buffering_resource::_resolved_frag_length(sample_rate_t const sample_rate) const {
+    if (auto const frag_length = this->_frag_length_request.load(); frag_length > 0) {
+        return frag_length;
+    }
+
+    return sample_rate;
+}
+
+bool buffering_resource::_needs_resize_on_render() const {
+    auto const element_count = this->_element_count.load();
+
+    if (auto const adaptive_count = this->_adaptive_element_count.load(); adaptive_count > 0) {
+        // 読み込みが追いつかないときだけすぐに広げ、それ以外は次に全体を書き込むときに合わせる
+        return element_count < adaptive_count && this->_is_underrunning.load();
+    }
 
+    return this->_element_count_request.load() != element_count;
+}
+
+std::size_t buffering_resource::_target_element_count_on_task() const {
+    if (auto const adaptive_count = this->_adaptive_element_count.load(); adaptive_count > 0) {
+        return adaptive_count;
+    }
+
+    return this->_element_count_request.load();
+}
+
+void buffering_resource::_create_channels_on_task(std::size_t const element_count) {
+    auto ch_each = make_fast_each(this->_ch_count);
+    while (yas_each_next(ch_each)) {
+        this->_channels.emplace_back(this->_make_channel_handler(element_count, *this->_format, this->_frag_length));
+
+        std::this_thread::yield();
+    }
+
+    this->_render_core =
+        buffering_render_core::make_shared(this->_channels, element_count, this->_frag_length, this->_pcm_format);
+
+    this->_element_count.store(element_count);
+}
+
+void buffering_resource::_update_depth_policy_on_task() {
+    auto policy = this->_pull_depth_policy_request_on_task();
+    if (!policy.has_value()) {
+        return;
+    }
+
+    if (policy->has_value()) {
+        this->_depth.emplace(policy->value());
+    } else {
+        this->_depth.reset();
+    }
+
+    this->_update_depth_on_task();
+}
+
+void buffering_resource::_add_load_duration_on_task(double const seconds) {
+    if (!this->_depth.has_value()) {
+        return;
+    }
+
+    this->_depth->add_load_duration(seconds);
+    this->_update_depth_on_task();
+}
+
+void buffering_resource::_update_depth_on_task() {
+    if (!this->_depth.has_value() || !this->_format.has_value() || this->_sample_rate == 0) {
+        this->_adaptive_element_count.store(0);
+        this->_is_underrunning.store(false);
+        return;
+    }
+
+    auto const element_count = this->_element_count.load();
+    double const frag_duration = static_cast<double>(this->_frag_length) / static_cast<double>(this->_sample_rate);
+    std::size_t const element_byte_count = this->_frag_length * this->_format->sample_byte_count();
+
+    this->_adaptive_element_count.store(
+        this->_depth->element_count(element_count, frag_duration, this->_ch_count, element_byte_count));
+    this->_is_underrunning.store(this->_depth->is_underrunning(element_count, frag_duration));
+}
+
+buffering_resource_ptr buffering_resource::make_shared(std::size_t const element_count, std::string const &root_path,
                                                        make_channel_f &&make_channel_handler) {
-    return buffering_resource_ptr{new buffering_resource{element_count, root_path, std::move(make_channel_handler)}};
+    return make_shared(element_count, root_path, std::move(make_channel_handler), nullptr);
+}
+
+buffering_resource_ptr buffering_resource::make_shared(std::size_t const element_count, std::string const &root_path,
+                                                       make_channel_f &&make_channel_handler,
+                                                       buffering_loader_ptr const &loader) {
+    return buffering_resource_ptr{
+        new buffering_resource{element_count, root_path, std::move(make_channel_handler), loader}};
 }
 
 frame_index_t buffering_resource::all_writing_frame_for_test() const {
@@ -299,6 +605,14 @@ channel_mapping const &buffering_resource::ch_mapping_for_test() const {
     return this->_ch_mapping;
 }
 
+bool buffering_resource::has_render_core_for_test() const {
+    return this->_render_core != nullptr;
+}
+
 std::string const &buffering_resource::identifier_for_test() const {
     return this->_identifier;
 }
+
+std::optional<fragment_range> const &buffering_resource::loop_range_for_test() const {
+    return this->_loop_range;
+}
@@ -5,6 +5,9 @@
 #pragma once
 
 #include <audio-playing/common/path.h>
+#include <audio-playing/player/buffering_depth.h>
+#include <audio-playing/player/buffering_loader.h>
+#include <audio-playing/player/buffering_render_core.h>
 #include <audio-playing/player/buffering_resource_dependency.h>
 #include <audio-playing/player/buffering_resource_types.h>
 #include <audio-playing/player/player_resource_dependency.h>
@@ -27,29 +30,49 @@ struct buffering_resource final : buffering_resource_for_player_resource {
     void write_all_elements_on_task() override;
     void advance_on_render(fragment_index_t const) override;
     [[nodiscard]] bool write_elements_if_needed_on_task() override;
-    void overwrite_element_on_render(element_address const &) override;
+    void overwrite_element_on_render(element_address const &, fragment_range const &reading_range) override;
 
     bool needs_all_writing_on_render() const override;
     void set_channel_mapping_request_on_main(channel_mapping const &) override;
     void set_identifier_request_on_main(std::string const &) override;
+    void set_element_count_request_on_main(std::size_t const) override;
+    void set_fragment_length_request_on_main(sample_rate_t const) override;
+    void set_depth_policy_request_on_main(std::optional<buffering_depth_policy> const &) override;
+    // 全て書き込み直す時に反映される。ループの範囲の後ろに進むと範囲の先頭のフラグメントを先読みしておく
+    void set_loop_range_request_on_main(std::optional<fragment_range> const &) override;
+    // advancingかwaitingの間だけ呼ぶ
+    [[nodiscard]] frame_index_t looped_frame_on_render(frame_index_t const) const override;
+    [[nodiscard]] frame_index_t looped_frame_on_main(frame_index_t const) const override;
 
     [[nodiscard]] bool read_into_buffer_on_render(audio::pcm_buffer *, channel_index_t const,
                                                   frame_index_t const) override;
+    [[nodiscard]] bool read_into_channel_on_render(audio::pcm_buffer *, channel_index_t const, uint32_t const to_frame,
+                                                   frame_index_t const, uint32_t const length) override;
+    [[nodiscard]] bool read_into_channels_on_render(audio::pcm_buffer *, uint32_t const to_frame, frame_index_t const,
+                                                    uint32_t const length) override;
+
+    [[nodiscard]] render_error_counts pull_render_errors() override;
 
     using make_channel_f = std::function<std::shared_ptr<buffering_channel_for_buffering_resource>(
         std::size_t const, audio::format const &, sample_rate_t const)>;
 
     static buffering_resource_ptr make_shared(std::size_t const element_count, std::string const &root_path,
                                               make_channel_f &&);
+    // loaderがあればチャンネルごとの読み込みを並列に行う
+    static buffering_resource_ptr make_shared(std::size_t const element_count, std::string const &root_path,
+                                              make_channel_f &&, buffering_loader_ptr const &);
 
     frame_index_t all_writing_frame_for_test() const;
     channel_mapping const &ch_mapping_for_test() const;
+    bool has_render_core_for_test() const;
     std::string const &identifier_for_test() const;
+    std::optional<fragment_range> const &loop_range_for_test() const;
 
    private:
-    std::size_t const _element_count;
+    std::atomic<std::size_t> _element_count;
     std::string const _root_path;
     make_channel_f const _make_channel_handler;
+    buffering_loader_ptr const _loader;
 
     std::atomic<setup_state_t> _setup_state{setup_state_t::initial};
     sample_rate_t _sample_rate = 0;
@@ -63,16 +86,51 @@ struct buffering_resource final : buffering_resource_for_player_resource {
     frame_index_t _all_writing_frame = 0;
     channel_mapping _ch_mapping;
     std::string _identifier = "";
+    std::optional<fragment_range> _loop_range = std::nullopt;
 
     std::vector<std::shared_ptr<buffering_channel_for_buffering_resource>> _channels;
+    // channelsが具体的な型ならチャンネルを作った時に選ばれる
+    buffering_render_core_ptr _render_core = nullptr;
+    // シーク後にまだ読み込んでいないフラグメントの範囲
+    std::optional<fragment_range> _pending_frag_range = std::nullopt;
 
     mutable std::mutex _request_mutex;
     std::optional<channel_mapping> _ch_mapping_request = std::nullopt;
     std::optional<std::string> _identifier_request = std::nullopt;
+    std::optional<std::optional<buffering_depth_policy>> _depth_policy_request = std::nullopt;
+    std::optional<std::optional<fragment_range>> _loop_range_request = std::nullopt;
+
+    // mainから再生位置を求めるために、書き込み時のループの範囲を残しておく
+    mutable std::mutex _loop_mutex;
+    std::optional<fragment_range> _loop_range_on_main = std::nullopt;
+    sample_rate_t _loop_frag_length_on_main = 0;
+
+    std::atomic<std::size_t> _element_count_request;
+    // 0ならsample_rateと同じ1秒
+    std::atomic<sample_rate_t> _frag_length_request{0};
+    // depthを使っていなければ0
+    std::atomic<std::size_t> _adaptive_element_count{0};
+    std::atomic<bool> _is_underrunning{false};
+    std::optional<buffering_depth> _depth = std::nullopt;
+
+    mutable render_error_counter _render_errors;
 
-    buffering_resource(std::size_t const element_count, std::string const &root_path, make_channel_f &&);
+    buffering_resource(std::size_t const element_count, std::string const &root_path, make_channel_f &&,
+                       buffering_loader_ptr const &);
 
     std::optional<channel_mapping> _pull_ch_mapping_request_on_task();
     std::optional<std::string> _pull_identifier_request_on_task();
+    std::optional<std::optional<buffering_depth_policy>> _pull_depth_policy_request_on_task();
+    std::optional<std::optional<fragment_range>> _pull_loop_range_request_on_task();
+
+    [[nodiscard]] sample_rate_t _resolved_frag_length(sample_rate_t const sample_rate) const;
+    [[nodiscard]] bool _needs_resize_on_render() const;
+    [[nodiscard]] std::size_t _target_element_count_on_task() const;
+    void _create_channels_on_task(std::size_t const element_count);
+    void _update_depth_policy_on_task();
+    void _add_load_duration_on_task(double const seconds);
+    void _update_depth_on_task();
+    [[nodiscard]] bool _write_pending_elements_on_task();
+    void _perform_on_channels_on_task(std::function<void(std::size_t const)> const &);
 };
 }  // namespace yas::playing
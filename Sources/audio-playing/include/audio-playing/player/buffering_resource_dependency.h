@@ -11,11 +11,18 @@ namespace yas::playing {
 struct buffering_channel_for_buffering_resource {
     virtual ~buffering_channel_for_buffering_resource() = default;
 
-    virtual void write_all_elements_on_task(path::channel const &, fragment_index_t const top_frag_idx) = 0;
+    virtual void write_top_element_on_task(path::channel const &, fragment_index_t const top_frag_idx,
+                                           std::optional<fragment_range> const &loop_range) = 0;
+    [[nodiscard]] virtual bool write_element_if_needed_on_task(fragment_index_t const) = 0;
     [[nodiscard]] virtual bool write_elements_if_needed_on_task() = 0;
 
     virtual void advance_on_render(fragment_index_t const prev_frag_idx) = 0;
-    virtual void overwrite_element_on_render(fragment_range const) = 0;
+    // keeping_rangeはループで折り返す前のフラグメントの範囲で、そこにあるエレメントは上書きしない
+    virtual void overwrite_element_on_render(fragment_range const,
+                                             std::optional<fragment_range> const &keeping_range) = 0;
     [[nodiscard]] virtual bool read_into_buffer_on_render(audio::pcm_buffer *, frame_index_t const) = 0;
+    [[nodiscard]] virtual bool read_into_channel_on_render(audio::pcm_buffer *, uint32_t const out_ch_idx,
+                                                           uint32_t const to_frame, frame_index_t const,
+                                                           uint32_t const length) = 0;
 };
 }  // namespace yas::playing
@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include <cstddef>
 #include <ostream>
 #include <string>
 
@@ -45,6 +46,26 @@ enum class audio_buffering_rendering_state {
     /// 個別のバッファがwritableならファイルから読み込んで、終わったらreadableにする
     advancing,
 };
+
+// 読み込みにかかる時間を見てエレメントの数を増減させるときの設定
+struct buffering_depth_policy final {
+    std::size_t min_element_count = 2;
+    std::size_t max_element_count = 16;
+    // 全チャンネルのエレメントのバッファを合わせたバイト数の上限。min_element_countの方を優先する
+    std::size_t memory_budget = 64 * 1024 * 1024;
+    // 読み込みにかかった時間に対して、どれだけ先まで読んでおくか
+    double safety_factor = 2.0;
+
+    bool operator==(buffering_depth_policy const &rhs) const {
+        return this->min_element_count == rhs.min_element_count &&
+               this->max_element_count == rhs.max_element_count && this->memory_budget == rhs.memory_budget &&
+               this->safety_factor == rhs.safety_factor;
+    }
+
+    bool operator!=(buffering_depth_policy const &rhs) const {
+        return !(*this == rhs);
+    }
+};
 }  // namespace yas::playing
 
 namespace yas {
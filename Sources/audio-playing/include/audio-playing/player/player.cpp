@@ -12,8 +12,6 @@
 #include <audio-playing/player/buffering_resource.h>
 #include <audio-playing/player/player_resource.h>
 #include <audio-playing/player/player_utils.h>
-#include <audio-playing/player/reading_resource.h>
-#include <cpp-utils/fast_each.h>
 
 #include <thread>
 
@@ -24,7 +22,6 @@ player::player(std::string const &root_path, std::shared_ptr<renderer_for_player
                workable_ptr const &worker, player_task_priority const &priority,
                std::shared_ptr<player_resource_for_player> const &resource)
     : _renderer(renderer), _worker(worker), _priority(priority), _resource(resource), _ch_mapping(), _identifier("") {
-    using reading_state_t = reading_resource::state_t;
     using rendering_state_t = buffering_resource::rendering_state_t;
     using setup_state_t = buffering_resource::setup_state_t;
 
@@ -35,18 +32,10 @@ player::player(std::string const &root_path, std::shared_ptr<renderer_for_player
     // setup worker
 
     worker->add_task(priority.setup, [resource = this->_resource] {
-        auto const &reading = resource->reading();
         auto const &buffering = resource->buffering();
 
         auto result = worker::task_result::unprocessed;
 
-        if (reading->state() == reading_state_t::creating) {
-            reading->create_buffer_on_task();
-            std::this_thread::yield();
-            result = worker::task_result::processed;
-            std::this_thread::yield();
-        }
-
         if (buffering->setup_state() == setup_state_t::creating) {
             buffering->create_buffer_on_task();
             std::this_thread::yield();
@@ -77,16 +66,16 @@ player::player(std::string const &root_path, std::shared_ptr<renderer_for_player
     // setup renderer
 
     player_resource::overwrite_requests_f overwrite_requests_handler =
-        [buffering = this->_resource->buffering()](player_resource::overwrite_requests_t const &requests) {
+        [buffering = this->_resource->buffering()](player_resource::overwrite_requests_t const &requests,
+                                                   fragment_range const &reading_range) {
             for (auto const &request : requests) {
-                buffering->overwrite_element_on_render(request);
+                buffering->overwrite_element_on_render(request, reading_range);
             }
         };
 
     this->_renderer->set_rendering_handler([resource = this->_resource,
                                             overwrite_requests_handler = std::move(overwrite_requests_handler)](
                                                audio::pcm_buffer *const out_buffer) {
-        auto const &reading = resource->reading();
         auto const &buffering = resource->buffering();
 
         auto const &out_format = out_buffer->format();
@@ -95,29 +84,14 @@ player::player(std::string const &root_path, std::shared_ptr<renderer_for_player
         auto const out_length = out_buffer->frame_length();
         auto const out_ch_count = out_format.channel_count();
 
+        // renderスレッドでは例外を投げずに数えて、他のスレッドから取り出す
         if (out_format.is_interleaved()) {
-            throw std::invalid_argument("out_buffer is not non-interleaved.");
-        }
-
-        // reading_resourceのセットアップ
-
-        switch (reading->state()) {
-            case reading_state_t::initial:
-                // 初期状態なのでバッファ生成開始
-                reading->set_creating_on_render(sample_rate, pcm_format, out_length);
-                return;
-            case reading_state_t::creating:
-                // task側で生成中
-                return;
-            case reading_state_t::rendering:
-                // バッファ生成済み
-                break;
+            resource->add_render_error_on_render(render_error::interleaved_out_buffer);
+            return;
         }
 
-        // 生成済みのreadingバッファを作り直すかチェック
-        if (reading->needs_create_on_render(sample_rate, pcm_format, out_length)) {
-            // バッファを再生成
-            reading->set_creating_on_render(sample_rate, pcm_format, out_length);
+        if (out_length == 0) {
+            resource->add_render_error_on_render(render_error::zero_length);
             return;
         }
 
@@ -160,63 +134,57 @@ player::player(std::string const &root_path, std::shared_ptr<renderer_for_player
                 if (rendering_state == rendering_state_t::waiting || seek_frame.has_value() || needs_all_writing) {
                     // 全バッファ再書き込み開始
                     resource->reset_overwrite_requests_on_render();
-                    auto const frame = seek_frame.has_value() ? seek_frame.value() : resource->current_frame();
                     if (seek_frame.has_value()) {
+                        // ループしていれば範囲の中に収めてからシークする
+                        auto const frame = buffering->looped_frame_on_render(seek_frame.value());
                         resource->set_current_frame_on_render(frame);
+                        buffering->set_all_writing_on_render(frame);
+                    } else {
+                        // ループの範囲が変わっても同じ位置から続くように、タイムライン上の位置に戻してから書き込む
+                        auto const current_frame = resource->current_frame();
+                        auto const frame = buffering->looped_frame_on_render(current_frame);
+                        if (frame != current_frame) {
+                            resource->set_current_frame_on_render(frame);
+                        }
+                        buffering->set_all_writing_on_render(frame);
                     }
-                    buffering->set_all_writing_on_render(frame);
                     return;
                 }
             } break;
         }
 
-        // bufferingの要素の上書き
-        resource->perform_overwrite_requests_on_render(overwrite_requests_handler);
-
-        // 再生中でなければ終了
+        // 再生中でなければbufferingの要素の上書きだけして終了
         if (!resource->is_playing_on_render()) {
+            resource->perform_overwrite_requests_on_render({.index = 0, .length = 0}, overwrite_requests_handler);
             return;
         }
 
+        frame_index_t const begin_frame = resource->current_frame();
+        uint32_t const frag_length = buffering->fragment_length_on_render();
+
+        // bufferingの要素の上書き
+        // 書き出し途中のものは、この後に読み込むフラグメントのエレメントを残して上書きする
+        resource->perform_overwrite_requests_on_render(
+            player_utils::reading_fragment_range(begin_frame, out_length, frag_length), overwrite_requests_handler);
+
         // 以下レンダリング
 
-        audio::pcm_buffer *reading_buffer = reading->buffer_on_render();
-        if (!reading_buffer) {
+        // ループの範囲より前にいたら、範囲の先頭から書き込み直す
+        if (auto const looped_frame = buffering->looped_frame_on_render(begin_frame); looped_frame > begin_frame) {
+            resource->reset_overwrite_requests_on_render();
+            resource->set_current_frame_on_render(looped_frame);
+            buffering->set_all_writing_on_render(looped_frame);
             return;
         }
-
-        frame_index_t const begin_frame = resource->current_frame();
         frame_index_t current_frame = begin_frame;
         frame_index_t const next_frame = current_frame + out_length;
-        uint32_t const frag_length = buffering->fragment_length_on_render();
 
         while (current_frame < next_frame) {
             auto const proc_length = player_utils::process_length(current_frame, next_frame, frag_length);
             uint32_t const to_frame = uint32_t(current_frame - begin_frame);
 
-            bool read_failed = false;
-
-            auto each = make_fast_each(out_format.channel_count());
-            while (yas_each_next(each)) {
-                auto const &idx = yas_each_index(each);
-
-                if (buffering->channel_count_on_render() <= idx) {
-                    break;
-                }
-
-                reading_buffer->clear();
-                reading_buffer->set_frame_length(proc_length);
-
-                if (!buffering->read_into_buffer_on_render(reading_buffer, idx, current_frame)) {
-                    read_failed = true;
-                    break;
-                }
-
-                out_buffer->copy_channel_from(*reading_buffer,
-                                              {.to_channel = idx, .to_begin_frame = to_frame, .length = proc_length});
-            }
-
-            if (read_failed) {
+            // エレメントのバッファから出力のバッファへ全チャンネルまとめて直接コピーする
+            if (!buffering->read_into_channels_on_render(out_buffer, to_frame, current_frame, proc_length)) {
                 break;
             }
 
@@ -263,6 +231,29 @@ void player::overwrite(std::optional<channel_index_t> const file_ch_idx, fragmen
     this->_resource->add_overwrite_request_on_main({.file_channel_index = file_ch_idx, .fragment_range = frag_range});
 }
 
+void player::overwrite_keeping_reading(std::optional<channel_index_t> const file_ch_idx,
+                                       fragment_range const frag_range) {
+    this->_resource->add_overwrite_request_on_main(
+        {.file_channel_index = file_ch_idx, .fragment_range = frag_range, .keeps_reading = true});
+}
+
+void player::set_buffering_element_count(std::size_t const element_count) {
+    this->_resource->buffering()->set_element_count_request_on_main(element_count);
+}
+
+void player::set_buffering_depth_policy(std::optional<buffering_depth_policy> const &policy) {
+    this->_resource->buffering()->set_depth_policy_request_on_main(policy);
+}
+
+void player::set_fragment_length(sample_rate_t const frag_length) {
+    this->_resource->buffering()->set_fragment_length_request_on_main(frag_length);
+}
+
+void player::set_fragment_loop_range(std::optional<fragment_range> const &frag_loop_range) {
+    this->_resource->buffering()->set_loop_range_request_on_main(frag_loop_range);
+    this->_fragment_loop_range = frag_loop_range;
+}
+
 std::string const &player::identifier() const {
     return this->_identifier;
 }
@@ -280,13 +271,21 @@ bool player::is_seeking() const {
 }
 
 frame_index_t player::current_frame() const {
-    return this->_resource->current_frame();
+    return this->_resource->buffering()->looped_frame_on_main(this->_resource->current_frame());
+}
+
+std::optional<fragment_range> const &player::fragment_loop_range() const {
+    return this->_fragment_loop_range;
 }
 
 observing::syncable player::observe_is_playing(std::function<void(bool const &)> &&handler) {
     return this->_is_playing->observe(std::move(handler));
 }
 
+render_error_counts player::pull_render_errors() {
+    return this->_resource->pull_render_errors();
+}
+
 player_ptr player::make_shared(std::string const &root_path, std::shared_ptr<renderer_for_player> const &renderer,
                                workable_ptr const &worker, player_task_priority const &priority,
                                std::shared_ptr<player_resource_for_player> const &resource) {
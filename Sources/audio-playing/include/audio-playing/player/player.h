@@ -19,15 +19,32 @@ struct player final : player_for_coordinator {
     void set_playing(bool const) override;
     void seek(frame_index_t const) override;
     void overwrite(std::optional<channel_index_t> const file_ch_idx, fragment_range const) override;
+    // レンダリングで読み込み中のエレメントは残して上書きする。書き出し途中のものを反映する時に使い、音を途切れさせない
+    void overwrite_keeping_reading(std::optional<channel_index_t> const file_ch_idx, fragment_range const) override;
+    // 変更すると全てのエレメントを読み込み直す
+    void set_buffering_element_count(std::size_t const) override;
+    // 指定すると読み込みにかかる時間に合わせてエレメントの数を増減させる
+    void set_buffering_depth_policy(std::optional<buffering_depth_policy> const &) override;
+    // 書き出したタイムラインのフラグメントの長さに合わせる。0なら1秒
+    void set_fragment_length(sample_rate_t const) override;
+    // フラグメント単位の範囲を繰り返し再生する。範囲の終わりの前から先頭のフラグメントを読んでおくので途切れない
+    // 再生位置が範囲より前にあるときや範囲より前へシークしたときは、範囲の先頭から再生する
+    // 変更した時だけ全てのエレメントを読み込み直す
+    void set_fragment_loop_range(std::optional<fragment_range> const &);
 
     [[nodiscard]] std::string const &identifier() const override;
     [[nodiscard]] playing::channel_mapping channel_mapping() const override;
     [[nodiscard]] bool is_playing() const override;
     [[nodiscard]] bool is_seeking() const override;
+    // ループしていればタイムライン上の位置に折り返す
     [[nodiscard]] frame_index_t current_frame() const override;
+    [[nodiscard]] std::optional<fragment_range> const &fragment_loop_range() const;
 
     [[nodiscard]] observing::syncable observe_is_playing(std::function<void(bool const &)> &&) override;
 
+    // renderスレッドで数えたエラーを取り出して0に戻す。renderスレッド以外から呼ぶ
+    [[nodiscard]] render_error_counts pull_render_errors();
+
     static player_ptr make_shared(std::string const &root_path, std::shared_ptr<renderer_for_player> const &,
                                   workable_ptr const &, player_task_priority const &,
                                   std::shared_ptr<player_resource_for_player> const &);
@@ -41,6 +58,7 @@ struct player final : player_for_coordinator {
     observing::value::holder_ptr<bool> _is_playing = observing::value::holder<bool>::make_shared(false);
     playing::channel_mapping _ch_mapping;
     std::string _identifier;
+    std::optional<fragment_range> _fragment_loop_range = std::nullopt;
     observing::canceller_pool _pool;
 
     player(std::string const &root_path, std::shared_ptr<renderer_for_player> const &, workable_ptr const &,
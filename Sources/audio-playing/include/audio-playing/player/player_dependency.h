@@ -5,6 +5,7 @@
 #pragma once
 
 #include <audio-playing/common/ptr.h>
+#include <audio-playing/player/render_error.h>
 #include <audio-playing/renderer/renderer_types.h>
 
 namespace yas::playing {
@@ -16,11 +17,12 @@ struct renderer_for_player {
 
 struct player_resource_for_player {
     using overwrite_requests_t = std::vector<element_address>;
-    using overwrite_requests_f = std::function<void(overwrite_requests_t const &)>;
+    // reading_rangeはこのレンダリングで読み込むフラグメントの範囲。ループで折り返す前の位置
+    using overwrite_requests_f =
+        std::function<void(overwrite_requests_t const &, fragment_range const &reading_range)>;
 
     virtual ~player_resource_for_player() = default;
 
-    virtual std::shared_ptr<reading_resource_for_player_resource> const &reading() const = 0;
     virtual std::shared_ptr<buffering_resource_for_player_resource> const &buffering() const = 0;
 
     virtual void set_playing_on_main(bool const) = 0;
@@ -34,7 +36,12 @@ struct player_resource_for_player {
     [[nodiscard]] virtual frame_index_t current_frame() const = 0;
 
     virtual void add_overwrite_request_on_main(element_address &&) = 0;
-    virtual void perform_overwrite_requests_on_render(overwrite_requests_f const &) = 0;
+    virtual void perform_overwrite_requests_on_render(fragment_range const &reading_range,
+                                                      overwrite_requests_f const &) = 0;
     virtual void reset_overwrite_requests_on_render() = 0;
+
+    virtual void add_render_error_on_render(render_error const) = 0;
+    // bufferingで数えたものも合わせて取り出す
+    [[nodiscard]] virtual render_error_counts pull_render_errors() = 0;
 };
 }  // namespace yas::playing
@@ -5,19 +5,13 @@
 #include "player_resource.h"
 
 #include <audio-playing/player/buffering_resource.h>
-#include <audio-playing/player/reading_resource.h>
 #include <cpp-utils/fast_each.h>
 
 using namespace yas;
 using namespace yas::playing;
 
-player_resource::player_resource(std::shared_ptr<reading_resource_for_player_resource> const &reading,
-                                 std::shared_ptr<buffering_resource_for_player_resource> const &buffering)
-    : _reading(reading), _buffering(buffering) {
-}
-
-std::shared_ptr<reading_resource_for_player_resource> const &player_resource::reading() const {
-    return this->_reading;
+player_resource::player_resource(std::shared_ptr<buffering_resource_for_player_resource> const &buffering)
+    : _buffering(buffering) {
 }
 
 std::shared_ptr<buffering_resource_for_player_resource> const &player_resource::buffering() const {
@@ -76,10 +70,11 @@ void player_resource::add_overwrite_request_on_main(element_address &&request) {
     this->_overwrite_requests.emplace_back(std::move(request));
 }
 
-void player_resource::perform_overwrite_requests_on_render(overwrite_requests_f const &handler) {
+void player_resource::perform_overwrite_requests_on_render(fragment_range const &reading_range,
+                                                           overwrite_requests_f const &handler) {
     if (auto lock = std::unique_lock<std::mutex>(this->_overwrite_mutex, std::try_to_lock); lock.owns_lock()) {
         if (!this->_is_overwritten) {
-            handler(this->_overwrite_requests);
+            handler(this->_overwrite_requests, reading_range);
             this->_is_overwritten = true;
         }
     }
@@ -91,8 +86,17 @@ void player_resource::reset_overwrite_requests_on_render() {
     }
 }
 
+void player_resource::add_render_error_on_render(render_error const error) {
+    this->_render_errors.add_on_render(error);
+}
+
+render_error_counts player_resource::pull_render_errors() {
+    auto counts = this->_render_errors.pull();
+    counts += this->_buffering->pull_render_errors();
+    return counts;
+}
+
 player_resource_ptr player_resource::make_shared(
-    std::shared_ptr<reading_resource_for_player_resource> const &reading,
     std::shared_ptr<buffering_resource_for_player_resource> const &buffering) {
-    return player_resource_ptr{new player_resource{reading, buffering}};
+    return player_resource_ptr{new player_resource{buffering}};
 }
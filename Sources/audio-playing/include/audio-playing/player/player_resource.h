@@ -12,7 +12,6 @@
 
 namespace yas::playing {
 struct player_resource final : player_resource_for_player {
-    std::shared_ptr<reading_resource_for_player_resource> const &reading() const override;
     std::shared_ptr<buffering_resource_for_player_resource> const &buffering() const override;
 
     void set_playing_on_main(bool const) override;
@@ -26,14 +25,16 @@ struct player_resource final : player_resource_for_player {
     [[nodiscard]] frame_index_t current_frame() const override;
 
     void add_overwrite_request_on_main(element_address &&) override;
-    void perform_overwrite_requests_on_render(overwrite_requests_f const &) override;
+    void perform_overwrite_requests_on_render(fragment_range const &reading_range,
+                                              overwrite_requests_f const &) override;
     void reset_overwrite_requests_on_render() override;
 
-    static player_resource_ptr make_shared(std::shared_ptr<reading_resource_for_player_resource> const &,
-                                           std::shared_ptr<buffering_resource_for_player_resource> const &);
+    void add_render_error_on_render(render_error const) override;
+    [[nodiscard]] render_error_counts pull_render_errors() override;
+
+    static player_resource_ptr make_shared(std::shared_ptr<buffering_resource_for_player_resource> const &);
 
    private:
-    std::shared_ptr<reading_resource_for_player_resource> const _reading;
     std::shared_ptr<buffering_resource_for_player_resource> const _buffering;
 
     std::atomic<bool> _is_playing{false};
@@ -54,7 +55,8 @@ struct player_resource final : player_resource_for_player {
     overwrite_requests_t _overwrite_requests;
     bool _is_overwritten = false;
 
-    player_resource(std::shared_ptr<reading_resource_for_player_resource> const &,
-                    std::shared_ptr<buffering_resource_for_player_resource> const &);
+    render_error_counter _render_errors;
+
+    player_resource(std::shared_ptr<buffering_resource_for_player_resource> const &);
 };
 }  // namespace yas::playing
@@ -8,24 +8,9 @@
 #include <audio-engine/pcm_buffer/pcm_buffer.h>
 #include <audio-playing/common/channel_mapping.h>
 #include <audio-playing/player/buffering_resource_types.h>
-#include <audio-playing/player/reading_resource_types.h>
+#include <audio-playing/player/render_error.h>
 
 namespace yas::playing {
-struct reading_resource_for_player_resource {
-    using state_t = reading_resource_state;
-
-    virtual ~reading_resource_for_player_resource() = default;
-
-    [[nodiscard]] virtual state_t state() const = 0;
-    [[nodiscard]] virtual audio::pcm_buffer *buffer_on_render() = 0;
-
-    [[nodiscard]] virtual bool needs_create_on_render(sample_rate_t const sample_rate, audio::pcm_format const,
-                                                      uint32_t const length) const = 0;
-    virtual void set_creating_on_render(sample_rate_t const sample_rate, audio::pcm_format const,
-                                        uint32_t const length) = 0;
-    virtual void create_buffer_on_task() = 0;
-};
-
 struct buffering_resource_for_player_resource {
     using setup_state_t = audio_buffering_setup_state;
     using rendering_state_t = audio_buffering_rendering_state;
@@ -49,13 +34,30 @@ struct buffering_resource_for_player_resource {
     virtual void write_all_elements_on_task() = 0;
     virtual void advance_on_render(fragment_index_t const) = 0;
     [[nodiscard]] virtual bool write_elements_if_needed_on_task() = 0;
-    virtual void overwrite_element_on_render(element_address const &) = 0;
+    // keeps_readingならreading_rangeにあるエレメントは上書きしない
+    virtual void overwrite_element_on_render(element_address const &, fragment_range const &reading_range) = 0;
 
     virtual bool needs_all_writing_on_render() const = 0;
     virtual void set_channel_mapping_request_on_main(channel_mapping const &) = 0;
     virtual void set_identifier_request_on_main(std::string const &) = 0;
+    virtual void set_element_count_request_on_main(std::size_t const) = 0;
+    virtual void set_fragment_length_request_on_main(sample_rate_t const) = 0;
+    virtual void set_depth_policy_request_on_main(std::optional<buffering_depth_policy> const &) = 0;
+    virtual void set_loop_range_request_on_main(std::optional<fragment_range> const &) = 0;
+    // 再生位置のフレームをループの範囲で折り返したタイムライン上のフレームにする。範囲より前は範囲の先頭にする
+    [[nodiscard]] virtual frame_index_t looped_frame_on_render(frame_index_t const) const = 0;
+    [[nodiscard]] virtual frame_index_t looped_frame_on_main(frame_index_t const) const = 0;
 
     [[nodiscard]] virtual bool read_into_buffer_on_render(audio::pcm_buffer *, channel_index_t const,
                                                           frame_index_t const) = 0;
+    // out_bufferのch_idxのチャンネルのto_frameの位置に、frameからlengthの長さを直接コピーする
+    [[nodiscard]] virtual bool read_into_channel_on_render(audio::pcm_buffer *, channel_index_t const,
+                                                           uint32_t const to_frame, frame_index_t const,
+                                                           uint32_t const length) = 0;
+    // out_bufferのbufferingにある全てのチャンネルへ、read_into_channel_on_renderと同じようにコピーする
+    [[nodiscard]] virtual bool read_into_channels_on_render(audio::pcm_buffer *, uint32_t const to_frame,
+                                                            frame_index_t const, uint32_t const length) = 0;
+
+    [[nodiscard]] virtual render_error_counts pull_render_errors() = 0;
 };
 }  // namespace yas::playing
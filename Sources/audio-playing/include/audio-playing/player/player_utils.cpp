@@ -33,3 +33,52 @@ std::optional<fragment_index_t> player_utils::advancing_fragment_index(frame_ind
         return std::nullopt;
     }
 }
+
+fragment_range player_utils::reading_fragment_range(frame_index_t const frame, uint32_t const length,
+                                                   uint32_t const frag_length) {
+    if (length == 0 || frag_length == 0) {
+        return {.index = 0, .length = 0};
+    }
+
+    auto const begin_idx = math::floor_int(frame, frag_length) / frag_length;
+    auto const end_idx = math::floor_int(frame + length - 1, frag_length) / frag_length + 1;
+    return {.index = begin_idx, .length = static_cast<length_t>(end_idx - begin_idx)};
+}
+
+fragment_index_t player_utils::looped_fragment_index(fragment_index_t const frag_idx,
+                                                     std::optional<fragment_range> const &frag_loop_range) {
+    if (!frag_loop_range.has_value() || frag_loop_range->length == 0) {
+        return frag_idx;
+    }
+
+    if (frag_idx < frag_loop_range->index) {
+        return frag_loop_range->index;
+    }
+
+    auto const end_idx = frag_loop_range->end_index();
+    if (frag_idx < end_idx) {
+        return frag_idx;
+    }
+
+    return frag_loop_range->index + (frag_idx - end_idx) % static_cast<fragment_index_t>(frag_loop_range->length);
+}
+
+frame_index_t player_utils::looped_frame(frame_index_t const frame,
+                                         std::optional<fragment_range> const &frag_loop_range,
+                                         sample_rate_t const frag_length) {
+    if (!frag_loop_range.has_value() || frag_loop_range->length == 0 || frag_length == 0) {
+        return frame;
+    }
+
+    frame_index_t const begin_frame = frag_loop_range->index * frag_length;
+    if (frame < begin_frame) {
+        return begin_frame;
+    }
+
+    frame_index_t const end_frame = frag_loop_range->end_index() * frag_length;
+    if (frame < end_frame) {
+        return frame;
+    }
+
+    return begin_frame + (frame - end_frame) % (end_frame - begin_frame);
+}
@@ -13,4 +13,11 @@ std::optional<fragment_index_t> top_fragment_idx(sample_rate_t const frag_length
 uint32_t process_length(frame_index_t const frame, frame_index_t const next_frame, uint32_t const frag_length);
 std::optional<fragment_index_t> advancing_fragment_index(frame_index_t const frame, uint32_t const proc_length,
                                                          uint32_t const frag_length);
+// frameからlengthの長さを読み込むときにまたぐフラグメントの範囲
+fragment_range reading_fragment_range(frame_index_t const frame, uint32_t const length, uint32_t const frag_length);
+
+// ループの範囲はフラグメント単位。範囲の終わり以降は範囲の先頭へ折り返し、範囲より前は範囲の先頭にする
+fragment_index_t looped_fragment_index(fragment_index_t const, std::optional<fragment_range> const &frag_loop_range);
+frame_index_t looped_frame(frame_index_t const, std::optional<fragment_range> const &frag_loop_range,
+                           sample_rate_t const frag_length);
 }  // namespace yas::playing::player_utils
@@ -0,0 +1,67 @@
+//
+//  render_error.cpp
+//
+
+#include "render_error.h"
+
+using namespace yas;
+using namespace yas::playing;
+
+std::size_t render_error_counts::count(render_error const error) const {
+    return this->values.at(static_cast<std::size_t>(error));
+}
+
+std::size_t render_error_counts::total() const {
+    std::size_t total = 0;
+    for (auto const &value : this->values) {
+        total += value;
+    }
+    return total;
+}
+
+render_error_counts &render_error_counts::operator+=(render_error_counts const &rhs) {
+    for (std::size_t idx = 0; idx < size; ++idx) {
+        this->values[idx] += rhs.values[idx];
+    }
+    return *this;
+}
+
+bool render_error_counts::operator==(render_error_counts const &rhs) const {
+    return this->values == rhs.values;
+}
+
+bool render_error_counts::operator!=(render_error_counts const &rhs) const {
+    return !(*this == rhs);
+}
+
+void render_error_counter::add_on_render(render_error const error) {
+    this->_counts[static_cast<std::size_t>(error)].fetch_add(1, std::memory_order_relaxed);
+}
+
+render_error_counts render_error_counter::pull() {
+    render_error_counts counts;
+
+    for (std::size_t idx = 0; idx < render_error_counts::size; ++idx) {
+        counts.values[idx] = this->_counts[idx].exchange(0, std::memory_order_relaxed);
+    }
+
+    return counts;
+}
+
+std::string yas::to_string(playing::render_error const error) {
+    switch (error) {
+        case playing::render_error::invalid_setup_state:
+            return "invalid_setup_state";
+        case playing::render_error::invalid_rendering_state:
+            return "invalid_rendering_state";
+        case playing::render_error::interleaved_out_buffer:
+            return "interleaved_out_buffer";
+        case playing::render_error::zero_length:
+            return "zero_length";
+    }
+}
+
+std::ostream &operator<<(std::ostream &os, yas::playing::render_error const &value) {
+    os << to_string(value);
+    return os;
+}
@@ -0,0 +1,55 @@
+//
+//  render_error.h
+//
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <ostream>
+#include <string>
+
+namespace yas::playing {
+// renderスレッドでは例外を投げずに数えるだけにする
+enum class render_error : std::size_t {
+    // bufferingのsetup_stateが呼び出しに合っていない
+    invalid_setup_state,
+    // bufferingのrendering_stateが呼び出しに合っていない
+    invalid_rendering_state,
+    // 出力のバッファがインターリーブされている
+    interleaved_out_buffer,
+    // 出力のバッファの長さが0
+    zero_length,
+};
+
+struct render_error_counts final {
+    static std::size_t constexpr size = static_cast<std::size_t>(render_error::zero_length) + 1;
+
+    std::array<std::size_t, size> values{};
+
+    [[nodiscard]] std::size_t count(render_error const) const;
+    [[nodiscard]] std::size_t total() const;
+
+    render_error_counts &operator+=(render_error_counts const &);
+
+    bool operator==(render_error_counts const &) const;
+    bool operator!=(render_error_counts const &) const;
+};
+
+// ロックもメモリの確保もせずにrenderスレッドからエラーを数える
+struct render_error_counter final {
+    void add_on_render(render_error const);
+    // 数えたエラーを取り出して0に戻す。renderスレッド以外から呼ぶ
+    [[nodiscard]] render_error_counts pull();
+
+   private:
+    std::array<std::atomic<std::size_t>, render_error_counts::size> _counts{};
+};
+}  // namespace yas::playing
+
+namespace yas {
+std::string to_string(playing::render_error const);
+}  // namespace yas
+
+std::ostream &operator<<(std::ostream &, yas::playing::render_error const &);
@@ -8,8 +8,14 @@ using namespace yas;
 using namespace yas::playing;
 
 timeline_container::timeline_container(std::string const &identifier, sample_rate_t const sample_rate,
-                                       std::optional<proc::timeline_ptr> const &timeline)
-    : _identifier(identifier), _sample_rate(sample_rate), _timeline(timeline) {
+                                       std::optional<proc::timeline_ptr> const &timeline,
+                                       std::optional<std::string> const &fingerprint,
+                                       sample_rate_t const fragment_length)
+    : _identifier(identifier),
+      _sample_rate(sample_rate),
+      _timeline(timeline),
+      _fingerprint(fingerprint),
+      _fragment_length(fragment_length) {
 }
 
 std::string const &timeline_container::identifier() const {
@@ -20,19 +26,51 @@ sample_rate_t const &timeline_container::sample_rate() const {
     return this->_sample_rate;
 }
 
+sample_rate_t timeline_container::fragment_length() const {
+    return this->_fragment_length > 0 ? this->_fragment_length : this->_sample_rate;
+}
+
 std::optional<proc::timeline_ptr> const &timeline_container::timeline() const {
     return this->_timeline;
 }
 
+std::optional<std::string> const &timeline_container::fingerprint() const {
+    return this->_fingerprint;
+}
+
 bool timeline_container::is_available() const {
     return !this->_identifier.empty() && this->_sample_rate > 0 && this->_timeline.has_value();
 }
 
+bool timeline_container::operator==(timeline_container const &rhs) const {
+    return this->_identifier == rhs._identifier && this->_sample_rate == rhs._sample_rate &&
+           this->_timeline == rhs._timeline && this->_fingerprint == rhs._fingerprint &&
+           this->fragment_length() == rhs.fragment_length();
+}
+
+bool timeline_container::operator!=(timeline_container const &rhs) const {
+    return !(*this == rhs);
+}
+
 timeline_container_ptr timeline_container::make_shared(std::string const &identifier, sample_rate_t const sample_rate,
                                                        std::optional<proc::timeline_ptr> const &timeline) {
-    return timeline_container_ptr(new timeline_container{identifier, sample_rate, timeline});
+    return make_shared(identifier, sample_rate, timeline, std::nullopt);
+}
+
+timeline_container_ptr timeline_container::make_shared(std::string const &identifier, sample_rate_t const sample_rate,
+                                                       std::optional<proc::timeline_ptr> const &timeline,
+                                                       std::optional<std::string> const &fingerprint) {
+    return make_shared(identifier, sample_rate, timeline, fingerprint, 0);
+}
+
+timeline_container_ptr timeline_container::make_shared(std::string const &identifier, sample_rate_t const sample_rate,
+                                                       std::optional<proc::timeline_ptr> const &timeline,
+                                                       std::optional<std::string> const &fingerprint,
+                                                       sample_rate_t const fragment_length) {
+    return timeline_container_ptr(
+        new timeline_container{identifier, sample_rate, timeline, fingerprint, fragment_length});
 }
 
 timeline_container_ptr timeline_container::make_shared_empty() {
-    return timeline_container_ptr(new timeline_container{"", 0, std::nullopt});
+    return timeline_container_ptr(new timeline_container{"", 0, std::nullopt, std::nullopt, 0});
 }
@@ -12,20 +12,37 @@ namespace yas::playing {
 struct timeline_container final {
     std::string const &identifier() const;
     sample_rate_t const &sample_rate() const;
+    // 1フラグメントのフレーム数。指定がなければsample_rateと同じ1秒
+    sample_rate_t fragment_length() const;
     std::optional<proc::timeline_ptr> const &timeline() const;
+    // 同じfingerprintであれば以前に書き出したフラグメントを使い回す
+    std::optional<std::string> const &fingerprint() const;
 
     bool is_available() const;
 
+    bool operator==(timeline_container const &rhs) const;
+    bool operator!=(timeline_container const &rhs) const;
+
     static timeline_container_ptr make_shared(std::string const &identifier, sample_rate_t const sample_rate,
                                               std::optional<proc::timeline_ptr> const &timeline);
+    static timeline_container_ptr make_shared(std::string const &identifier, sample_rate_t const sample_rate,
+                                              std::optional<proc::timeline_ptr> const &timeline,
+                                              std::optional<std::string> const &fingerprint);
+    static timeline_container_ptr make_shared(std::string const &identifier, sample_rate_t const sample_rate,
+                                              std::optional<proc::timeline_ptr> const &timeline,
+                                              std::optional<std::string> const &fingerprint,
+                                              sample_rate_t const fragment_length);
     static timeline_container_ptr make_shared_empty();
 
    private:
     std::string const _identifier;
     sample_rate_t const _sample_rate;
     std::optional<proc::timeline_ptr> const _timeline;
+    std::optional<std::string> const _fingerprint;
+    sample_rate_t const _fragment_length;
 
     timeline_container(std::string const &identifier, sample_rate_t const sample_rate,
-                       std::optional<proc::timeline_ptr> const &timeline);
+                       std::optional<proc::timeline_ptr> const &timeline, std::optional<std::string> const &fingerprint,
+                       sample_rate_t const fragment_length);
 };
 }  // namespace yas::playing
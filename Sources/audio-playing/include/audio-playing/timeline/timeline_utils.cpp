@@ -8,6 +8,8 @@
 #include <audio-playing/common/math.h>
 #include <cpp-utils/boolean.h>
 
+#include <algorithm>
+#include <cstring>
 #include <fstream>
 
 using namespace yas;
@@ -19,6 +21,71 @@ proc::time::range timeline_utils::fragments_range(proc::time::range const &range
     return proc::time::range{frame, static_cast<length_t>(next_frame - frame)};
 }
 
+fragment_range timeline_utils::to_fragment_range(proc::time::range const &range, sample_rate_t const frag_length) {
+    auto const frags_range = fragments_range(range, frag_length);
+    auto const begin_frag_idx = frags_range.frame / static_cast<frame_index_t>(frag_length);
+    auto const next_frag_idx = frags_range.next_frame() / static_cast<frame_index_t>(frag_length);
+    return fragment_range{.index = begin_frag_idx, .length = static_cast<length_t>(next_frag_idx - begin_frag_idx)};
+}
+
+proc::time::range timeline_utils::to_time_range(fragment_range const &frag_range, sample_rate_t const frag_length) {
+    return proc::time::range{frag_range.index * static_cast<frame_index_t>(frag_length),
+                             frag_range.length * frag_length};
+}
+
+std::vector<fragment_range> timeline_utils::merged_fragment_ranges(std::vector<fragment_range> ranges) {
+    std::sort(ranges.begin(), ranges.end(),
+              [](fragment_range const &lhs, fragment_range const &rhs) { return lhs.index < rhs.index; });
+
+    std::vector<fragment_range> merged;
+
+    for (auto const &range : ranges) {
+        if (range.length == 0) {
+            continue;
+        }
+
+        if (merged.size() > 0 && range.index <= merged.back().end_index()) {
+            auto &last = merged.back();
+            auto const end_index = std::max(last.end_index(), range.end_index());
+            last.length = static_cast<length_t>(end_index - last.index);
+        } else {
+            merged.emplace_back(range);
+        }
+    }
+
+    return merged;
+}
+
+std::vector<fragment_range> timeline_utils::intersected_fragment_ranges(fragment_range const &range,
+                                                                        std::vector<fragment_range> const &ranges) {
+    std::vector<fragment_range> intersected;
+
+    for (auto const &other : merged_fragment_ranges(ranges)) {
+        auto const begin_index = std::max(range.index, other.index);
+        auto const end_index = std::min(range.end_index(), other.end_index());
+        if (begin_index < end_index) {
+            intersected.emplace_back(
+                fragment_range{.index = begin_index, .length = static_cast<length_t>(end_index - begin_index)});
+        }
+    }
+
+    return intersected;
+}
+
+std::vector<fragment_range> timeline_utils::to_fragment_ranges(std::set<fragment_index_t> const &indices) {
+    std::vector<fragment_range> ranges;
+
+    for (auto const &idx : indices) {
+        if (ranges.size() > 0 && ranges.back().end_index() == idx) {
+            ++ranges.back().length;
+        } else {
+            ranges.emplace_back(fragment_range{.index = idx, .length = 1});
+        }
+    }
+
+    return ranges;
+}
+
 char const *timeline_utils::char_data(proc::signal_event const &event) {
     auto const &type = event.sample_type();
 
@@ -88,20 +155,63 @@ char const *timeline_utils::char_data(proc::number_event const &event) {
 }
 
 char *timeline_utils::char_data(audio::pcm_buffer &buffer) {
+    return char_data(buffer, 0);
+}
+
+char *timeline_utils::char_data(audio::pcm_buffer &buffer, uint32_t const buf_idx) {
     switch (buffer.format().pcm_format()) {
         case audio::pcm_format::float32:
-            return reinterpret_cast<char *>(buffer.data_ptr_at_index<float>(0));
+            return reinterpret_cast<char *>(buffer.data_ptr_at_index<float>(buf_idx));
         case audio::pcm_format::float64:
-            return reinterpret_cast<char *>(buffer.data_ptr_at_index<double>(0));
+            return reinterpret_cast<char *>(buffer.data_ptr_at_index<double>(buf_idx));
         case audio::pcm_format::int16:
-            return reinterpret_cast<char *>(buffer.data_ptr_at_index<int16_t>(0));
+            return reinterpret_cast<char *>(buffer.data_ptr_at_index<int16_t>(buf_idx));
         case audio::pcm_format::fixed824:
-            return reinterpret_cast<char *>(buffer.data_ptr_at_index<int32_t>(0));
+            return reinterpret_cast<char *>(buffer.data_ptr_at_index<int32_t>(buf_idx));
         case audio::pcm_format::other:
             return nullptr;
     }
 }
 
+proc::signal_event_ptr timeline_utils::make_signal_event(std::type_info const &type, std::size_t const length) {
+    if (type == typeid(double)) {
+        return proc::signal_event::make_shared<double>(length);
+    } else if (type == typeid(float)) {
+        return proc::signal_event::make_shared<float>(length);
+    } else if (type == typeid(int64_t)) {
+        return proc::signal_event::make_shared<int64_t>(length);
+    } else if (type == typeid(uint64_t)) {
+        return proc::signal_event::make_shared<uint64_t>(length);
+    } else if (type == typeid(int32_t)) {
+        return proc::signal_event::make_shared<int32_t>(length);
+    } else if (type == typeid(uint32_t)) {
+        return proc::signal_event::make_shared<uint32_t>(length);
+    } else if (type == typeid(int16_t)) {
+        return proc::signal_event::make_shared<int16_t>(length);
+    } else if (type == typeid(uint16_t)) {
+        return proc::signal_event::make_shared<uint16_t>(length);
+    } else if (type == typeid(int8_t)) {
+        return proc::signal_event::make_shared<int8_t>(length);
+    } else if (type == typeid(uint8_t)) {
+        return proc::signal_event::make_shared<uint8_t>(length);
+    } else if (type == typeid(boolean)) {
+        return proc::signal_event::make_shared<boolean>(length);
+    } else {
+        return nullptr;
+    }
+}
+
+proc::signal_event_ptr timeline_utils::copied_signal_event(proc::signal_event const &event) {
+    auto copied = make_signal_event(event.sample_type(), event.size());
+    if (!copied) {
+        return nullptr;
+    }
+
+    std::memcpy(const_cast<char *>(char_data(*copied)), char_data(event), event.byte_size());
+
+    return copied;
+}
+
 sample_store_type timeline_utils::to_sample_store_type(std::type_info const &type) {
     if (type == typeid(double)) {
         return sample_store_type::float64;
@@ -12,14 +12,31 @@
 #include <audio-processing/time/time.h>
 #include <cpp-utils/result.h>
 
+#include <set>
+#include <vector>
+
 namespace yas::playing::timeline_utils {
 [[nodiscard]] proc::time::range fragments_range(proc::time::range const &, sample_rate_t const);
+[[nodiscard]] fragment_range to_fragment_range(proc::time::range const &, sample_rate_t const frag_length);
+[[nodiscard]] proc::time::range to_time_range(fragment_range const &, sample_rate_t const frag_length);
+
+// 重なりや隣接しているものをまとめてindex順に並べる
+[[nodiscard]] std::vector<fragment_range> merged_fragment_ranges(std::vector<fragment_range>);
+[[nodiscard]] std::vector<fragment_range> intersected_fragment_ranges(fragment_range const &,
+                                                                     std::vector<fragment_range> const &);
+[[nodiscard]] std::vector<fragment_range> to_fragment_ranges(std::set<fragment_index_t> const &);
 
 [[nodiscard]] char const *char_data(proc::signal_event const &);
 [[nodiscard]] char const *char_data(proc::time::frame::type const &);
 [[nodiscard]] char const *char_data(sample_store_type const &);
 [[nodiscard]] char const *char_data(proc::number_event const &);
 [[nodiscard]] char *char_data(audio::pcm_buffer &);
+[[nodiscard]] char *char_data(audio::pcm_buffer &, uint32_t const buf_idx);
+
+// 型を指定してlengthの長さのsignal_eventを作る。対応していない型ならnullptrを返す
+[[nodiscard]] proc::signal_event_ptr make_signal_event(std::type_info const &, std::size_t const length);
+// signal_eventを中身ごと複製する
+[[nodiscard]] proc::signal_event_ptr copied_signal_event(proc::signal_event const &);
 
 [[nodiscard]] sample_store_type to_sample_store_type(std::type_info const &);
 [[nodiscard]] std::type_info const &to_sample_type(sample_store_type const &);
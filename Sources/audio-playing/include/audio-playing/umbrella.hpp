@@ -4,21 +4,35 @@
 
 #pragma once
 
+#include <audio-playing/bouncer/bouncer.h>
 #include <audio-playing/common/channel_mapping.h>
+#include <audio-playing/common/fragment_cache.h>
 #include <audio-playing/common/math.h>
 #include <audio-playing/common/path.h>
 #include <audio-playing/common/types.h>
 #include <audio-playing/coordinator/coordinator.h>
 #include <audio-playing/exporter/exporter.h>
+#include <audio-playing/exporter/exporter_history.h>
+#include <audio-playing/exporter/exporter_processor.h>
+#include <audio-playing/exporter/exporter_profiler.h>
+#include <audio-playing/exporter/exporter_storage.h>
+#include <audio-playing/exporter/exporter_timeline_diff.h>
+#include <audio-playing/exporter/exporter_track_cache.h>
+#include <audio-playing/exporter/exporter_trash.h>
+#include <audio-playing/manifest_file/manifest_file.h>
 #include <audio-playing/numbers_file/numbers_file.h>
 #include <audio-playing/player/buffering_channel.h>
+#include <audio-playing/player/buffering_depth.h>
 #include <audio-playing/player/buffering_element.h>
+#include <audio-playing/player/buffering_loader.h>
+#include <audio-playing/player/buffering_render_core.h>
 #include <audio-playing/player/buffering_resource.h>
 #include <audio-playing/player/player.h>
 #include <audio-playing/player/player_resource.h>
-#include <audio-playing/player/reading_resource.h>
+#include <audio-playing/player/render_error.h>
 #include <audio-playing/renderer/renderer.h>
 #include <audio-playing/signal_file/signal_file.h>
 #include <audio-playing/timeline/timeline_canceller.h>
 #include <audio-playing/timeline/timeline_container.h>
 #include <audio-playing/timeline/timeline_utils.h>
+#include <audio-playing/wave_file/wave_file.h>
@@ -0,0 +1,191 @@
+//
+//  wave_file.cpp
+//
+
+#include "wave_file.h"
+
+#include <limits>
+#include <optional>
+
+using namespace yas;
+using namespace yas::playing;
+
+namespace yas::playing::wave_file_utils {
+// RF64のds64チャンクと同じ大きさのJUNKチャンクを置いておき、4GBを超えたら書き換える
+static std::size_t constexpr ds64_size = 28;
+static std::size_t constexpr fmt_size = 16;
+static std::size_t constexpr header_size = 12 + (8 + ds64_size) + (8 + fmt_size) + 8;
+
+static void append(std::string &bytes, char const *chunk_id) {
+    bytes.append(chunk_id, 4);
+}
+
+template <typename T>
+static void append(std::string &bytes, T const value) {
+    for (std::size_t idx = 0; idx < sizeof(T); ++idx) {
+        bytes.push_back(static_cast<char>((static_cast<uint64_t>(value) >> (idx * 8)) & 0xFF));
+    }
+}
+
+static std::optional<uint16_t> format_tag(audio::pcm_format const pcm_format) {
+    switch (pcm_format) {
+        case audio::pcm_format::float32:
+        case audio::pcm_format::float64:
+            return 3;
+        case audio::pcm_format::int16:
+            return 1;
+        case audio::pcm_format::fixed824:
+        case audio::pcm_format::other:
+            return std::nullopt;
+    }
+}
+
+static uint32_t sample_byte_count(audio::pcm_format const pcm_format) {
+    switch (pcm_format) {
+        case audio::pcm_format::float64:
+            return 8;
+        case audio::pcm_format::float32:
+        case audio::pcm_format::fixed824:
+            return 4;
+        case audio::pcm_format::int16:
+            return 2;
+        case audio::pcm_format::other:
+            return 0;
+    }
+}
+
+static std::string make_header(sample_rate_t const sample_rate, uint32_t const ch_count,
+                               audio::pcm_format const pcm_format, uint64_t const data_byte_count,
+                               uint64_t const frame_length) {
+    uint32_t const block_align = ch_count * sample_byte_count(pcm_format);
+    uint64_t const riff_size = header_size - 8 + data_byte_count;
+    bool const is_rf64 = riff_size > std::numeric_limits<uint32_t>::max();
+    uint32_t const size_max = std::numeric_limits<uint32_t>::max();
+
+    std::string bytes;
+    bytes.reserve(header_size);
+
+    append(bytes, is_rf64 ? "RF64" : "RIFF");
+    append(bytes, is_rf64 ? size_max : static_cast<uint32_t>(riff_size));
+    append(bytes, "WAVE");
+
+    append(bytes, is_rf64 ? "ds64" : "JUNK");
+    append(bytes, static_cast<uint32_t>(ds64_size));
+    if (is_rf64) {
+        append(bytes, riff_size);
+        append(bytes, data_byte_count);
+        append(bytes, frame_length);
+        append(bytes, uint32_t(0));
+    } else {
+        bytes.append(ds64_size, '\0');
+    }
+
+    append(bytes, "fmt ");
+    append(bytes, static_cast<uint32_t>(fmt_size));
+    append(bytes, format_tag(pcm_format).value());
+    append(bytes, static_cast<uint16_t>(ch_count));
+    append(bytes, static_cast<uint32_t>(sample_rate));
+    append(bytes, static_cast<uint32_t>(sample_rate * block_align));
+    append(bytes, static_cast<uint16_t>(block_align));
+    append(bytes, static_cast<uint16_t>(sample_byte_count(pcm_format) * 8));
+
+    append(bytes, "data");
+    append(bytes, is_rf64 ? size_max : static_cast<uint32_t>(data_byte_count));
+
+    return bytes;
+}
+}  // namespace yas::playing::wave_file_utils
+
+wave_file::wave_file(std::ofstream &&stream, sample_rate_t const sample_rate, uint32_t const ch_count,
+                     audio::pcm_format const pcm_format)
+    : _stream(std::move(stream)), _sample_rate(sample_rate), _ch_count(ch_count), _pcm_format(pcm_format) {
+}
+
+uint32_t wave_file::channel_count() const {
+    return this->_ch_count;
+}
+
+audio::pcm_format wave_file::pcm_format() const {
+    return this->_pcm_format;
+}
+
+uint64_t wave_file::frame_length() const {
+    return this->_data_byte_count / (this->_sample_byte_count() * this->_ch_count);
+}
+
+wave_file::write_result_t wave_file::write(char const *data, length_t const frame_length) {
+    std::size_t const byte_count = frame_length * this->_sample_byte_count() * this->_ch_count;
+
+    this->_stream.write(data, byte_count);
+
+    if (this->_stream.fail()) {
+        return write_result_t{wave_file_error::write_to_stream_failed};
+    }
+
+    this->_data_byte_count += byte_count;
+
+    return write_result_t{nullptr};
+}
+
+wave_file::write_result_t wave_file::close() {
+    auto const header = wave_file_utils::make_header(this->_sample_rate, this->_ch_count, this->_pcm_format,
+                                                     this->_data_byte_count, this->frame_length());
+
+    this->_stream.seekp(0);
+    this->_stream.write(header.data(), header.size());
+
+    if (this->_stream.fail()) {
+        return write_result_t{wave_file_error::write_to_stream_failed};
+    }
+
+    this->_stream.close();
+
+    if (this->_stream.fail()) {
+        return write_result_t{wave_file_error::close_stream_failed};
+    }
+
+    return write_result_t{nullptr};
+}
+
+uint32_t wave_file::_sample_byte_count() const {
+    return wave_file_utils::sample_byte_count(this->_pcm_format);
+}
+
+wave_file::make_result_t wave_file::make_created(std::filesystem::path const &path, sample_rate_t const sample_rate,
+                                                 uint32_t const ch_count, audio::pcm_format const pcm_format) {
+    if (ch_count == 0 || sample_rate == 0 || !wave_file_utils::format_tag(pcm_format).has_value()) {
+        return make_result_t{wave_file_error::invalid_format};
+    }
+
+    std::ofstream stream{path, std::ios_base::out | std::ios_base::binary | std::ios_base::trunc};
+    if (!stream) {
+        return make_result_t{wave_file_error::open_stream_failed};
+    }
+
+    auto const header = wave_file_utils::make_header(sample_rate, ch_count, pcm_format, 0, 0);
+    stream.write(header.data(), header.size());
+
+    if (stream.fail()) {
+        return make_result_t{wave_file_error::write_to_stream_failed};
+    }
+
+    return make_result_t{wave_file_ptr(new wave_file{std::move(stream), sample_rate, ch_count, pcm_format})};
+}
+
+std::string yas::to_string(wave_file_error const &error) {
+    switch (error) {
+        case wave_file_error::invalid_format:
+            return "invalid_format";
+        case wave_file_error::open_stream_failed:
+            return "open_stream_failed";
+        case wave_file_error::write_to_stream_failed:
+            return "write_to_stream_failed";
+        case wave_file_error::close_stream_failed:
+            return "close_stream_failed";
+    }
+}
+
+std::ostream &operator<<(std::ostream &os, yas::playing::wave_file_error const &value) {
+    os << to_string(value);
+    return os;
+}
@@ -0,0 +1,58 @@
+//
+//  wave_file.h
+//
+
+#pragma once
+
+#include <audio-engine/format/format.h>
+#include <audio-playing/common/ptr.h>
+#include <audio-playing/common/types.h>
+#include <cpp-utils/result.h>
+
+#include <filesystem>
+#include <fstream>
+#include <ostream>
+#include <string>
+
+namespace yas::playing {
+enum class wave_file_error {
+    invalid_format,
+    open_stream_failed,
+    write_to_stream_failed,
+    close_stream_failed,
+};
+
+// 書き出し専用のwaveファイル。4GBを超えたらcloseでRF64に書き換える
+struct wave_file final {
+    using make_result_t = result<wave_file_ptr, wave_file_error>;
+    using write_result_t = result<std::nullptr_t, wave_file_error>;
+
+    [[nodiscard]] uint32_t channel_count() const;
+    [[nodiscard]] audio::pcm_format pcm_format() const;
+    [[nodiscard]] uint64_t frame_length() const;
+
+    // interleavedのデータを書き込む
+    [[nodiscard]] write_result_t write(char const *data, length_t const frame_length);
+    [[nodiscard]] write_result_t close();
+
+    [[nodiscard]] static make_result_t make_created(std::filesystem::path const &, sample_rate_t const,
+                                                    uint32_t const ch_count, audio::pcm_format const);
+
+   private:
+    std::ofstream _stream;
+    sample_rate_t const _sample_rate;
+    uint32_t const _ch_count;
+    audio::pcm_format const _pcm_format;
+    uint64_t _data_byte_count = 0;
+
+    wave_file(std::ofstream &&, sample_rate_t const, uint32_t const ch_count, audio::pcm_format const);
+
+    [[nodiscard]] uint32_t _sample_byte_count() const;
+};
+}  // namespace yas::playing
+
+namespace yas {
+std::string to_string(playing::wave_file_error const &);
+}  // namespace yas
+
+std::ostream &operator<<(std::ostream &, yas::playing::wave_file_error const &);
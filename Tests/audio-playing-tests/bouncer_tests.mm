@@ -0,0 +1,207 @@
+//
+//  bouncer_tests.mm
+//
+
+#import <XCTest/XCTest.h>
+#import <audio-playing/umbrella.hpp>
+#import <audio-processing/umbrella.hpp>
+#import <cpp-utils/file_manager.h>
+#import <cpp-utils/file_path.h>
+#import <fstream>
+#import <iterator>
+#import "test_utils.h"
+
+using namespace yas;
+using namespace yas::playing;
+
+namespace yas::playing::bouncer_test {
+static sample_rate_t const sample_rate = 2;
+
+static proc::timeline_ptr make_timeline() {
+    auto module0 = proc::make_signal_module<float>(1.0f);
+    module0->connect_output(proc::to_connector_index(proc::constant::output::value), 0);
+    auto module1 = proc::make_signal_module<float>(2.0f);
+    module1->connect_output(proc::to_connector_index(proc::constant::output::value), 1);
+    auto module2 = proc::make_signal_module<int16_t>(3);
+    module2->connect_output(proc::to_connector_index(proc::constant::output::value), 1);
+
+    auto track0 = proc::track::make_shared();
+    track0->push_back_module(module0, {-1, 3});
+    auto track1 = proc::track::make_shared();
+    track1->push_back_module(module1, {1, 3});
+    auto track2 = proc::track::make_shared();
+    track2->push_back_module(module2, {0, 5});
+
+    return proc::timeline::make_shared({{0, track0}, {1, track1}, {2, track2}});
+}
+}  // namespace yas::playing::bouncer_test
+
+@interface bouncer_tests : XCTestCase
+
+@end
+
+@implementation bouncer_tests
+
+- (void)setUp {
+    file_manager::remove_content(test_utils::root_path());
+}
+
+- (void)tearDown {
+    file_manager::remove_content(test_utils::root_path());
+}
+
+- (void)test_bounce_to_buffer {
+    auto const timeline = bouncer_test::make_timeline();
+    auto const bouncer = bouncer::make_shared(timeline, bouncer_test::sample_rate, 3);
+
+    XCTAssertEqual(bouncer->thread_count(), 3);
+
+    audio::format const format{{.sample_rate = bouncer_test::sample_rate,
+                                .pcm_format = audio::pcm_format::float32,
+                                .channel_count = 2,
+                                .interleaved = false}};
+    audio::pcm_buffer buffer{format, 5};
+
+    auto const result = bouncer->bounce_to_buffer({-1, 5}, buffer, {});
+
+    XCTAssertTrue(result);
+
+    float const *data0 = buffer.data_ptr_at_index<float>(0);
+    XCTAssertEqual(data0[0], 1.0f);
+    XCTAssertEqual(data0[1], 1.0f);
+    XCTAssertEqual(data0[2], 1.0f);
+    XCTAssertEqual(data0[3], 0.0f);
+    XCTAssertEqual(data0[4], 0.0f);
+
+    float const *data1 = buffer.data_ptr_at_index<float>(1);
+    XCTAssertEqual(data1[0], 0.0f);
+    XCTAssertEqual(data1[1], 0.0f);
+    XCTAssertEqual(data1[2], 2.0f);
+    XCTAssertEqual(data1[3], 2.0f);
+    XCTAssertEqual(data1[4], 2.0f);
+}
+
+- (void)test_bounce_to_buffer_with_channel_mapping {
+    auto const timeline = bouncer_test::make_timeline();
+    auto const bouncer = bouncer::make_shared(timeline, bouncer_test::sample_rate, 2);
+
+    audio::format const format{{.sample_rate = bouncer_test::sample_rate,
+                                .pcm_format = audio::pcm_format::int16,
+                                .channel_count = 1,
+                                .interleaved = false}};
+    audio::pcm_buffer buffer{format, 4};
+
+    auto const result = bouncer->bounce_to_buffer({0, 4}, buffer, {.indices = {1}});
+
+    XCTAssertTrue(result);
+
+    int16_t const *data = buffer.data_ptr_at_index<int16_t>(0);
+    XCTAssertEqual(data[0], 3);
+    XCTAssertEqual(data[1], 3);
+    XCTAssertEqual(data[2], 3);
+    XCTAssertEqual(data[3], 3);
+}
+
+- (void)test_bounce_to_buffer_failed {
+    auto const timeline = bouncer_test::make_timeline();
+    auto const bouncer = bouncer::make_shared(timeline, bouncer_test::sample_rate, 1);
+
+    audio::format const interleaved_format{{.sample_rate = bouncer_test::sample_rate,
+                                            .pcm_format = audio::pcm_format::float32,
+                                            .channel_count = 2,
+                                            .interleaved = true}};
+    audio::pcm_buffer interleaved_buffer{interleaved_format, 4};
+
+    auto const interleaved_result = bouncer->bounce_to_buffer({0, 4}, interleaved_buffer, {});
+    XCTAssertFalse(interleaved_result);
+    XCTAssertEqual(interleaved_result.error(), bouncer_error::invalid_format);
+
+    audio::format const format{{.sample_rate = bouncer_test::sample_rate,
+                                .pcm_format = audio::pcm_format::float32,
+                                .channel_count = 1,
+                                .interleaved = false}};
+    audio::pcm_buffer short_buffer{format, 3};
+
+    auto const short_result = bouncer->bounce_to_buffer({0, 4}, short_buffer, {});
+    XCTAssertFalse(short_result);
+    XCTAssertEqual(short_result.error(), bouncer_error::invalid_format);
+}
+
+- (void)test_bounce_to_file {
+    XCTAssertTrue(file_manager::create_directory_if_not_exists(test_utils::root_path()));
+
+    auto const path = file_path{test_utils::root_path()}.appending("bounce.wav").string();
+    auto const timeline = bouncer_test::make_timeline();
+    auto const bouncer = bouncer::make_shared(timeline, bouncer_test::sample_rate, 2);
+
+    auto const result = bouncer->bounce_to_file({-1, 5}, path, audio::pcm_format::float32, 2, {});
+
+    XCTAssertTrue(result);
+
+    std::ifstream stream{path, std::ios_base::in | std::ios_base::binary};
+    std::vector<char> const bytes{std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>()};
+
+    std::size_t const header_size = 80;
+    std::size_t const data_size = 5 * 2 * sizeof(float);
+
+    XCTAssertEqual(bytes.size(), header_size + data_size);
+    XCTAssertEqual(std::string(&bytes[0], 4), "RIFF");
+    XCTAssertEqual(std::string(&bytes[8], 4), "WAVE");
+    XCTAssertEqual(std::string(&bytes[48], 4), "fmt ");
+    XCTAssertEqual(std::string(&bytes[72], 4), "data");
+
+    uint32_t data_chunk_size;
+    std::memcpy(&data_chunk_size, &bytes[76], sizeof(uint32_t));
+    XCTAssertEqual(data_chunk_size, data_size);
+
+    float samples[10];
+    std::memcpy(samples, &bytes[header_size], data_size);
+    XCTAssertEqual(samples[0], 1.0f);
+    XCTAssertEqual(samples[1], 0.0f);
+    XCTAssertEqual(samples[2], 1.0f);
+    XCTAssertEqual(samples[3], 0.0f);
+    XCTAssertEqual(samples[4], 1.0f);
+    XCTAssertEqual(samples[5], 2.0f);
+    XCTAssertEqual(samples[6], 0.0f);
+    XCTAssertEqual(samples[7], 2.0f);
+    XCTAssertEqual(samples[8], 0.0f);
+    XCTAssertEqual(samples[9], 2.0f);
+}
+
+- (void)test_bounce_to_file_with_invalid_format {
+    XCTAssertTrue(file_manager::create_directory_if_not_exists(test_utils::root_path()));
+
+    auto const path = file_path{test_utils::root_path()}.appending("bounce.wav").string();
+    auto const timeline = bouncer_test::make_timeline();
+    auto const bouncer = bouncer::make_shared(timeline, bouncer_test::sample_rate, 1);
+
+    auto const result = bouncer->bounce_to_file({0, 2}, path, audio::pcm_format::fixed824, 1, {});
+
+    XCTAssertFalse(result);
+    XCTAssertEqual(result.error(), bouncer_error::invalid_format);
+    XCTAssertFalse(file_manager::content_exists(path));
+}
+
+- (void)test_bounce_to_file_with_invalid_range {
+    XCTAssertTrue(file_manager::create_directory_if_not_exists(test_utils::root_path()));
+
+    auto const path = file_path{test_utils::root_path()}.appending("bounce.wav").string();
+    auto const timeline = bouncer_test::make_timeline();
+    auto const bouncer = bouncer::make_shared(timeline, bouncer_test::sample_rate, 1);
+
+    auto const result = bouncer->bounce_to_file({0, 0}, path, audio::pcm_format::float32, 1, {});
+
+    XCTAssertFalse(result);
+    XCTAssertEqual(result.error(), bouncer_error::invalid_range);
+    XCTAssertFalse(file_manager::content_exists(path), @"ファイルを作る前に弾く");
+}
+
+- (void)test_bouncer_error_to_string {
+    XCTAssertEqual(to_string(bouncer_error::invalid_range), "invalid_range");
+    XCTAssertEqual(to_string(bouncer_error::invalid_format), "invalid_format");
+    XCTAssertEqual(to_string(bouncer_error::create_file_failed), "create_file_failed");
+    XCTAssertEqual(to_string(bouncer_error::write_file_failed), "write_file_failed");
+    XCTAssertEqual(to_string(bouncer_error::close_file_failed), "close_file_failed");
+}
+
+@end
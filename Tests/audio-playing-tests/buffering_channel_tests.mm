@@ -31,11 +31,16 @@ struct element : buffering_element_for_buffering_channel {
     std::function<fragment_index_t(void)> fragment_index_handler;
     std::function<bool(path::channel const &)> write_if_needed_handler;
     std::function<void(path::channel const &, fragment_index_t const)> force_write_handler;
+    std::function<void(fragment_index_t const)> set_writable_handler;
     std::function<bool(frame_index_t const)> contains_frame_handler;
     std::function<bool(audio::pcm_buffer *, frame_index_t const)> read_into_buffer_handler;
+    std::function<bool(audio::pcm_buffer *, uint32_t const, uint32_t const, frame_index_t const, uint32_t const)>
+        read_into_channel_handler;
     std::function<void(fragment_index_t const)> advance_handler;
     std::function<void(void)> overwrite_handler;
 
+    std::optional<fragment_range> loop_range = std::nullopt;
+
     state_t state() const {
         return this->state_handler();
     }
@@ -52,6 +57,14 @@ struct element : buffering_element_for_buffering_channel {
         this->force_write_handler(ch_path, frag_idx);
     }
 
+    void set_writable_on_task(fragment_index_t const frag_idx) {
+        this->set_writable_handler(frag_idx);
+    }
+
+    void set_loop_range_on_task(std::optional<fragment_range> const &loop_range) {
+        this->loop_range = loop_range;
+    }
+
     bool contains_frame_on_render(frame_index_t const frame) {
         return this->contains_frame_handler(frame);
     }
@@ -60,6 +73,11 @@ struct element : buffering_element_for_buffering_channel {
         return this->read_into_buffer_handler(buffer, frame);
     }
 
+    bool read_into_channel_on_render(audio::pcm_buffer *buffer, uint32_t const out_ch_idx, uint32_t const to_frame,
+                                     frame_index_t const frame, uint32_t const length) {
+        return this->read_into_channel_handler(buffer, out_ch_idx, to_frame, frame, length);
+    }
+
     void advance_on_render(fragment_index_t const frag_idx) {
         this->advance_handler(frag_idx);
     }
@@ -93,7 +111,7 @@ static buffering_element_ptr cast_to_buffering_element(
 - (void)test_initial_elements {
     auto const element0 = buffering_channel_test::element::make_shared();
     auto const element1 = buffering_channel_test::element::make_shared();
-    auto const channel = buffering_channel::make_shared({element0, element1});
+    auto const channel = buffering_channel::make_shared({element0, element1}, buffering_channel_test::sample_rate);
 
     auto const &elements = channel->elements_for_test();
     XCTAssertEqual(elements.size(), 2);
@@ -104,30 +122,128 @@ static buffering_element_ptr cast_to_buffering_element(
     XCTAssertEqual(casted_element1, element1);
 }
 
-- (void)test_write_all_elements {
-    std::vector<std::pair<path::channel, fragment_index_t>> called0;
+- (void)test_write_top_element {
+    std::vector<std::pair<path::channel, fragment_index_t>> called_force0;
+    std::vector<fragment_index_t> called_writable0;
     auto const element0 = buffering_channel_test::element::make_shared();
-    element0->force_write_handler = [&called0](path::channel const &ch_path, fragment_index_t const frag_idx) {
-        called0.emplace_back(ch_path, frag_idx);
+    element0->force_write_handler = [&called_force0](path::channel const &ch_path, fragment_index_t const frag_idx) {
+        called_force0.emplace_back(ch_path, frag_idx);
+    };
+    element0->set_writable_handler = [&called_writable0](fragment_index_t const frag_idx) {
+        called_writable0.emplace_back(frag_idx);
     };
 
-    std::vector<std::pair<path::channel, fragment_index_t>> called1;
+    std::vector<std::pair<path::channel, fragment_index_t>> called_force1;
+    std::vector<fragment_index_t> called_writable1;
     auto const element1 = buffering_channel_test::element::make_shared();
-    element1->force_write_handler = [&called1](path::channel const &ch_path, fragment_index_t const frag_idx) {
-        called1.emplace_back(ch_path, frag_idx);
+    element1->force_write_handler = [&called_force1](path::channel const &ch_path, fragment_index_t const frag_idx) {
+        called_force1.emplace_back(ch_path, frag_idx);
+    };
+    element1->set_writable_handler = [&called_writable1](fragment_index_t const frag_idx) {
+        called_writable1.emplace_back(frag_idx);
     };
 
-    auto const channel = buffering_channel::make_shared({element0, element1});
+    auto const channel = buffering_channel::make_shared({element0, element1}, buffering_channel_test::sample_rate);
     auto const ch_path = buffering_channel_test::channel_path();
 
-    channel->write_all_elements_on_task(ch_path, 0);
+    channel->write_top_element_on_task(ch_path, 3, std::nullopt);
 
+    XCTAssertEqual(called_force1.size(), 1, @"エレメントの数で割った余りの位置に割り当てる");
+    XCTAssertEqual(called_force1.at(0).first, ch_path);
+    XCTAssertEqual(called_force1.at(0).second, 3);
+    XCTAssertEqual(called_writable1.size(), 0);
+
+    XCTAssertEqual(called_force0.size(), 0, @"先頭以外は読み込まない");
+    XCTAssertEqual(called_writable0.size(), 1);
+    XCTAssertEqual(called_writable0.at(0), 4);
+
+    channel->write_top_element_on_task(ch_path, -2, std::nullopt);
+
+    XCTAssertEqual(called_force0.size(), 1, @"負のインデックスも余りの位置に割り当てる");
+    XCTAssertEqual(called_force0.at(0).second, -2);
+    XCTAssertEqual(called_writable1.size(), 1);
+    XCTAssertEqual(called_writable1.at(0), -1);
+}
+
+- (void)test_write_top_element_with_loop_range {
+    std::vector<fragment_index_t> called_force;
+    std::vector<fragment_index_t> called_writable;
+
+    auto const element0 = buffering_channel_test::element::make_shared();
+    auto const element1 = buffering_channel_test::element::make_shared();
+
+    for (auto const &element : {element0, element1}) {
+        element->force_write_handler = [&called_force](path::channel const &, fragment_index_t const frag_idx) {
+            called_force.emplace_back(frag_idx);
+        };
+        element->set_writable_handler = [&called_writable](fragment_index_t const frag_idx) {
+            called_writable.emplace_back(frag_idx);
+        };
+    }
+
+    auto const channel = buffering_channel::make_shared({element0, element1}, buffering_channel_test::sample_rate);
+    auto const ch_path = buffering_channel_test::channel_path();
+
+    channel->write_top_element_on_task(ch_path, 3, fragment_range{.index = 1, .length = 3});
+
+    XCTAssertEqual(element0->loop_range, (fragment_range{.index = 1, .length = 3}), @"全てのエレメントに渡す");
+    XCTAssertEqual(element1->loop_range, (fragment_range{.index = 1, .length = 3}));
+
+    // エレメントは再生する順のフラグメントのまま割り当て、ファイルの折り返しはエレメントで行う
+    XCTAssertEqual(called_force, (std::vector<fragment_index_t>{3}));
+    XCTAssertEqual(called_writable, (std::vector<fragment_index_t>{4}));
+
+    channel->write_top_element_on_task(ch_path, 0, std::nullopt);
+
+    XCTAssertEqual(element0->loop_range, std::nullopt);
+    XCTAssertEqual(element1->loop_range, std::nullopt);
+}
+
+- (void)test_write_element_if_needed {
+    using state_t = audio_buffering_element_state;
+
+    std::vector<path::channel> called0;
+    state_t state0 = state_t::readable;
+    auto const element0 = buffering_channel_test::element::make_shared();
+    element0->force_write_handler = [](path::channel const &, fragment_index_t const) {};
+    element0->set_writable_handler = [](fragment_index_t const) {};
+    element0->state_handler = [&state0] { return state0; };
+    element0->fragment_index_handler = [] { return 0; };
+    element0->write_if_needed_handler = [&called0](path::channel const &ch_path) {
+        called0.emplace_back(ch_path);
+        return true;
+    };
+
+    std::vector<path::channel> called1;
+    auto const element1 = buffering_channel_test::element::make_shared();
+    element1->force_write_handler = [](path::channel const &, fragment_index_t const) {};
+    element1->set_writable_handler = [](fragment_index_t const) {};
+    element1->state_handler = [] { return state_t::writable; };
+    element1->fragment_index_handler = [] { return 1; };
+    element1->write_if_needed_handler = [&called1](path::channel const &ch_path) {
+        called1.emplace_back(ch_path);
+        return true;
+    };
+
+    auto const channel = buffering_channel::make_shared({element0, element1}, buffering_channel_test::sample_rate);
+    auto const ch_path = buffering_channel_test::channel_path();
+
+    channel->write_top_element_on_task(ch_path, 0, std::nullopt);
+
+    XCTAssertFalse(channel->write_element_if_needed_on_task(0), @"書き込み待ちでなければ読まない");
+    XCTAssertEqual(called0.size(), 0);
+
+    XCTAssertTrue(channel->write_element_if_needed_on_task(1));
+    XCTAssertEqual(called1.size(), 1);
+    XCTAssertEqual(called1.at(0), ch_path);
+
+    XCTAssertFalse(channel->write_element_if_needed_on_task(2), @"フラグメントが合うエレメントがなければ読まない");
+
+    state0 = state_t::writable;
+
+    XCTAssertTrue(channel->write_element_if_needed_on_task(0));
     XCTAssertEqual(called0.size(), 1);
-    XCTAssertEqual(called0.at(0).first, ch_path);
-    XCTAssertEqual(called0.at(0).second, 0);
     XCTAssertEqual(called1.size(), 1);
-    XCTAssertEqual(called1.at(0).first, ch_path);
-    XCTAssertEqual(called1.at(0).second, 1);
 }
 
 - (void)test_write_elements_if_needed {
@@ -135,6 +251,7 @@ static buffering_element_ptr cast_to_buffering_element(
     bool result0 = false;
     auto const element0 = buffering_channel_test::element::make_shared();
     element0->force_write_handler = [](path::channel const &, fragment_index_t const) {};
+    element0->set_writable_handler = [](fragment_index_t const) {};
     element0->write_if_needed_handler = [&called0, &result0](path::channel const &ch_path) {
         called0.emplace_back(ch_path);
         return result0;
@@ -144,15 +261,16 @@ static buffering_element_ptr cast_to_buffering_element(
     bool result1 = false;
     auto const element1 = buffering_channel_test::element::make_shared();
     element1->force_write_handler = [](path::channel const &, fragment_index_t const) {};
+    element1->set_writable_handler = [](fragment_index_t const) {};
     element1->write_if_needed_handler = [&called1, &result1](path::channel const &ch_path) {
         called1.emplace_back(ch_path);
         return result1;
     };
 
-    auto const channel = buffering_channel::make_shared({element0, element1});
+    auto const channel = buffering_channel::make_shared({element0, element1}, buffering_channel_test::sample_rate);
     auto const ch_path = buffering_channel_test::channel_path();
 
-    channel->write_all_elements_on_task(ch_path, 0);
+    channel->write_top_element_on_task(ch_path, 0, std::nullopt);
 
     XCTAssertFalse(channel->write_elements_if_needed_on_task());
 
@@ -203,7 +321,7 @@ static buffering_element_ptr cast_to_buffering_element(
     element1->fragment_index_handler = [] { return 1; };
     element1->advance_handler = [&called1](fragment_index_t const frag_idx) { called1.emplace_back(frag_idx); };
 
-    auto const channel = buffering_channel::make_shared({element0, element1});
+    auto const channel = buffering_channel::make_shared({element0, element1}, buffering_channel_test::sample_rate);
 
     channel->advance_on_render(0);
 
@@ -211,6 +329,11 @@ static buffering_element_ptr cast_to_buffering_element(
     XCTAssertEqual(called0.at(0), 2);
 
     XCTAssertEqual(called1.size(), 0);
+
+    channel->advance_on_render(2);
+
+    XCTAssertEqual(called0.size(), 1, @"余りの位置のエレメントのフラグメントが合わなければ進めない");
+    XCTAssertEqual(called1.size(), 0);
 }
 
 - (void)test_overwrite_element {
@@ -224,24 +347,87 @@ static buffering_element_ptr cast_to_buffering_element(
     element1->fragment_index_handler = [] { return 1; };
     element1->overwrite_handler = [&called1]() { ++called1; };
 
-    auto const channel = buffering_channel::make_shared({element0, element1});
+    auto const channel = buffering_channel::make_shared({element0, element1}, buffering_channel_test::sample_rate);
 
-    channel->overwrite_element_on_render({0, 1});
+    channel->overwrite_element_on_render({0, 1}, std::nullopt);
 
     XCTAssertEqual(called0, 1);
     XCTAssertEqual(called1, 0);
 
-    channel->overwrite_element_on_render({1, 1});
+    channel->overwrite_element_on_render({1, 1}, std::nullopt);
 
     XCTAssertEqual(called0, 1);
     XCTAssertEqual(called1, 1);
 
-    channel->overwrite_element_on_render({0, 2});
+    channel->overwrite_element_on_render({0, 2}, std::nullopt);
 
     XCTAssertEqual(called0, 2);
     XCTAssertEqual(called1, 2);
 }
 
+- (void)test_overwrite_element_keeping_reading {
+    std::size_t called0 = 0;
+    auto const element0 = buffering_channel_test::element::make_shared();
+    element0->fragment_index_handler = [] { return 0; };
+    element0->overwrite_handler = [&called0]() { ++called0; };
+
+    std::size_t called1 = 0;
+    auto const element1 = buffering_channel_test::element::make_shared();
+    element1->fragment_index_handler = [] { return 1; };
+    element1->overwrite_handler = [&called1]() { ++called1; };
+
+    std::size_t called2 = 0;
+    auto const element2 = buffering_channel_test::element::make_shared();
+    element2->fragment_index_handler = [] { return 2; };
+    element2->overwrite_handler = [&called2]() { ++called2; };
+
+    auto const channel =
+        buffering_channel::make_shared({element0, element1, element2}, buffering_channel_test::sample_rate);
+
+    channel->overwrite_element_on_render({0, 3}, fragment_range{.index = 0, .length = 2});
+
+    XCTAssertEqual(called0, 0, @"読み込み中のエレメントは上書きしない");
+    XCTAssertEqual(called1, 0, @"またいで読み込むエレメントも上書きしない");
+    XCTAssertEqual(called2, 1);
+}
+
+- (void)test_overwrite_element_with_loop_range {
+    std::size_t called0 = 0;
+    auto const element0 = buffering_channel_test::element::make_shared();
+    element0->force_write_handler = [](path::channel const &, fragment_index_t const) {};
+    element0->set_writable_handler = [](fragment_index_t const) {};
+    element0->fragment_index_handler = [] { return 4; };
+    element0->overwrite_handler = [&called0]() { ++called0; };
+
+    std::size_t called1 = 0;
+    auto const element1 = buffering_channel_test::element::make_shared();
+    element1->force_write_handler = [](path::channel const &, fragment_index_t const) {};
+    element1->set_writable_handler = [](fragment_index_t const) {};
+    element1->fragment_index_handler = [] { return 5; };
+    element1->overwrite_handler = [&called1]() { ++called1; };
+
+    auto const channel = buffering_channel::make_shared({element0, element1}, buffering_channel_test::sample_rate);
+
+    channel->write_top_element_on_task(buffering_channel_test::channel_path(), 4,
+                                       fragment_range{.index = 1, .length = 3});
+
+    // 4は1に、5は2に折り返したファイルを読んでいる
+    channel->overwrite_element_on_render({1, 1}, std::nullopt);
+
+    XCTAssertEqual(called0, 1);
+    XCTAssertEqual(called1, 0);
+
+    channel->overwrite_element_on_render({4, 2}, std::nullopt);
+
+    XCTAssertEqual(called0, 1, @"再生する順のフラグメントでは上書きしない");
+    XCTAssertEqual(called1, 0);
+
+    channel->overwrite_element_on_render({2, 1}, std::nullopt);
+
+    XCTAssertEqual(called0, 1);
+    XCTAssertEqual(called1, 1);
+}
+
 - (void)test_read_into_buffer {
     std::vector<frame_index_t> called_contains0;
     std::vector<frame_index_t> called_read0;
@@ -290,59 +476,102 @@ static buffering_element_ptr cast_to_buffering_element(
         return false;
     };
 
-    auto const channel = buffering_channel::make_shared({element0, element1, element2});
+    auto const channel =
+        buffering_channel::make_shared({element0, element1, element2}, buffering_channel_test::sample_rate);
 
     audio::pcm_buffer buffer{buffering_channel_test::format, buffering_channel_test::sample_rate};
     int16_t const *const data = buffer.data_ptr_at_index<int16_t>(0);
 
-    XCTAssertFalse(channel->read_into_buffer_on_render(&buffer, 100));
+    // フレーム2はフラグメント1なので、1番目のエレメントだけを見る
+    XCTAssertFalse(channel->read_into_buffer_on_render(&buffer, 2));
 
-    XCTAssertEqual(called_contains0.size(), 1);
-    XCTAssertEqual(called_contains0.at(0), 100);
-    XCTAssertEqual(called_read0.size(), 0);
+    XCTAssertEqual(called_contains0.size(), 0);
     XCTAssertEqual(called_contains1.size(), 1);
-    XCTAssertEqual(called_contains1.at(0), 100);
+    XCTAssertEqual(called_contains1.at(0), 2);
     XCTAssertEqual(called_read1.size(), 0);
-    XCTAssertEqual(called_contains2.size(), 1);
-    XCTAssertEqual(called_contains2.at(0), 100);
-    XCTAssertEqual(called_read2.size(), 0);
+    XCTAssertEqual(called_contains2.size(), 0);
 
     XCTAssertEqual(data[0], 0);
     XCTAssertEqual(data[1], 0);
 
     contains1 = true;
 
-    XCTAssertFalse(channel->read_into_buffer_on_render(&buffer, 200));
+    XCTAssertFalse(channel->read_into_buffer_on_render(&buffer, 3));
 
-    XCTAssertEqual(called_contains0.size(), 2);
-    XCTAssertEqual(called_contains0.at(1), 200);
-    XCTAssertEqual(called_read0.size(), 0);
     XCTAssertEqual(called_contains1.size(), 2);
-    XCTAssertEqual(called_contains1.at(1), 200);
+    XCTAssertEqual(called_contains1.at(1), 3);
     XCTAssertEqual(called_read1.size(), 1);
-    XCTAssertEqual(called_read1.at(0), 200);
-    XCTAssertEqual(called_contains2.size(), 1);
-    XCTAssertEqual(called_read2.size(), 0);
+    XCTAssertEqual(called_read1.at(0), 3);
 
     XCTAssertEqual(data[0], 0);
     XCTAssertEqual(data[1], 0);
 
     is_read1 = true;
 
-    XCTAssertTrue(channel->read_into_buffer_on_render(&buffer, 300));
+    // フレーム8はフラグメント4なので、余りの1番目のエレメントを見る
+    XCTAssertTrue(channel->read_into_buffer_on_render(&buffer, 8));
 
-    XCTAssertEqual(called_contains0.size(), 3);
-    XCTAssertEqual(called_contains0.at(2), 300);
-    XCTAssertEqual(called_read0.size(), 0);
     XCTAssertEqual(called_contains1.size(), 3);
-    XCTAssertEqual(called_contains1.at(2), 300);
+    XCTAssertEqual(called_contains1.at(2), 8);
     XCTAssertEqual(called_read1.size(), 2);
-    XCTAssertEqual(called_read1.at(1), 300);
-    XCTAssertEqual(called_contains2.size(), 1);
-    XCTAssertEqual(called_read2.size(), 0);
+    XCTAssertEqual(called_read1.at(1), 8);
 
     XCTAssertEqual(data[0], 123);
     XCTAssertEqual(data[1], 456);
+
+    // フレーム-4はフラグメント-2なので、余りの1番目のエレメントを見る
+    XCTAssertTrue(channel->read_into_buffer_on_render(&buffer, -4));
+
+    XCTAssertEqual(called_contains1.size(), 4);
+    XCTAssertEqual(called_contains1.at(3), -4);
+    XCTAssertEqual(called_read1.size(), 3);
+
+    XCTAssertEqual(called_contains0.size(), 0);
+    XCTAssertEqual(called_read0.size(), 0);
+    XCTAssertEqual(called_contains2.size(), 0);
+    XCTAssertEqual(called_read2.size(), 0);
+}
+
+- (void)test_read_into_channel {
+    using called_t = std::tuple<audio::pcm_buffer *, uint32_t, uint32_t, frame_index_t, uint32_t>;
+
+    std::vector<called_t> called_read0;
+    auto const element0 = buffering_channel_test::element::make_shared();
+    element0->contains_frame_handler = [](frame_index_t const frame) { return false; };
+    element0->read_into_channel_handler = [&called_read0](audio::pcm_buffer *buffer, uint32_t const out_ch_idx,
+                                                          uint32_t const to_frame, frame_index_t const frame,
+                                                          uint32_t const length) {
+        called_read0.emplace_back(buffer, out_ch_idx, to_frame, frame, length);
+        return false;
+    };
+
+    std::vector<called_t> called_read1;
+    bool contains1 = false;
+    auto const element1 = buffering_channel_test::element::make_shared();
+    element1->contains_frame_handler = [&contains1](frame_index_t const frame) { return contains1; };
+    element1->read_into_channel_handler = [&called_read1](audio::pcm_buffer *buffer, uint32_t const out_ch_idx,
+                                                          uint32_t const to_frame, frame_index_t const frame,
+                                                          uint32_t const length) {
+        called_read1.emplace_back(buffer, out_ch_idx, to_frame, frame, length);
+        return true;
+    };
+
+    auto const channel = buffering_channel::make_shared({element0, element1}, buffering_channel_test::sample_rate);
+
+    audio::pcm_buffer buffer{buffering_channel_test::format, buffering_channel_test::sample_rate};
+
+    XCTAssertFalse(channel->read_into_channel_on_render(&buffer, 0, 1, 2, 1));
+
+    XCTAssertEqual(called_read0.size(), 0);
+    XCTAssertEqual(called_read1.size(), 0);
+
+    contains1 = true;
+
+    XCTAssertTrue(channel->read_into_channel_on_render(&buffer, 0, 1, 3, 1));
+
+    XCTAssertEqual(called_read0.size(), 0);
+    XCTAssertEqual(called_read1.size(), 1);
+    XCTAssertEqual(called_read1.at(0), (called_t{&buffer, 0, 1, 3, 1}));
 }
 
 - (void)test_make_channel {
@@ -0,0 +1,86 @@
+//
+//  buffering_depth_tests.mm
+//
+
+#import <XCTest/XCTest.h>
+#import <audio-playing/umbrella.hpp>
+
+using namespace yas;
+using namespace yas::playing;
+
+@interface buffering_depth_tests : XCTestCase
+
+@end
+
+@implementation buffering_depth_tests
+
+- (void)test_element_count_without_measurement {
+    buffering_depth const depth{{.min_element_count = 2, .max_element_count = 8, .memory_budget = 1024}};
+
+    XCTAssertFalse(depth.peak_load_duration().has_value());
+
+    XCTAssertEqual(depth.element_count(3, 1.0, 1, 16), 3);
+    XCTAssertEqual(depth.element_count(1, 1.0, 1, 16), 2);
+    XCTAssertEqual(depth.element_count(10, 1.0, 1, 16), 8);
+}
+
+- (void)test_element_count {
+    buffering_depth depth{{.min_element_count = 2, .max_element_count = 16, .safety_factor = 2.0}};
+
+    // 0.125秒のフラグメントを0.25秒で読み込むなら、0.5秒分の4つに再生中の1つを足す
+    depth.add_load_duration(0.25);
+
+    XCTAssertEqual(depth.peak_load_duration(), 0.25);
+    XCTAssertEqual(depth.element_count(3, 0.125, 1, 16), 5);
+
+    // 速ければ最小の数にする
+    buffering_depth fast_depth{{.min_element_count = 2, .max_element_count = 16, .safety_factor = 2.0}};
+    fast_depth.add_load_duration(0.001);
+
+    XCTAssertEqual(fast_depth.element_count(3, 1.0, 1, 16), 2);
+}
+
+- (void)test_element_count_limited_by_budget {
+    buffering_depth depth{{.min_element_count = 2, .max_element_count = 16, .memory_budget = 2 * 4 * 100}};
+
+    depth.add_load_duration(10.0);
+
+    XCTAssertEqual(depth.element_count(3, 1.0, 2, 100), 4, @"2チャンネルで100バイトなら4つまで");
+    XCTAssertEqual(depth.element_count(3, 1.0, 8, 100), 2, @"収まらなくても最小の数は確保する");
+}
+
+- (void)test_peak_decay {
+    buffering_depth depth{{}};
+
+    depth.add_load_duration(1.0);
+    depth.add_load_duration(0.0);
+
+    XCTAssertEqual(depth.peak_load_duration(), 0.95, @"遅かった分は少しずつ減らす");
+
+    depth.add_load_duration(2.0);
+
+    XCTAssertEqual(depth.peak_load_duration(), 2.0);
+}
+
+- (void)test_is_underrunning {
+    buffering_depth depth{{}};
+
+    XCTAssertFalse(depth.is_underrunning(3, 1.0));
+
+    depth.add_load_duration(1.5);
+
+    XCTAssertFalse(depth.is_underrunning(3, 1.0));
+    XCTAssertTrue(depth.is_underrunning(2, 1.0));
+}
+
+- (void)test_policy_equal {
+    buffering_depth_policy const policy1{.min_element_count = 2};
+    buffering_depth_policy const policy2{.min_element_count = 2};
+    buffering_depth_policy const policy3{.min_element_count = 3};
+
+    XCTAssertTrue(policy1 == policy2);
+    XCTAssertFalse(policy1 == policy3);
+    XCTAssertTrue(policy1 != policy3);
+}
+
+@end
@@ -96,7 +96,7 @@ static bool write_signal_to_file(proc::signal_event_ptr const &write_event, frag
 
     XCTAssertEqual(element->state(), buffering_element::state_t::writable);
     XCTAssertEqual(element->fragment_index_on_render(), 13);
-    XCTAssertThrows(element->begin_frame_on_render());
+    XCTAssertNoThrow(element->begin_frame_on_render(), @"renderスレッドで呼ばれるので例外を投げない");
 
     auto const load_result = element->write_if_needed_on_task(ch_path);
     XCTAssertTrue(load_result);
@@ -211,6 +211,46 @@ static bool write_signal_to_file(proc::signal_event_ptr const &write_event, frag
     }
 }
 
+- (void)test_read_into_channel {
+    auto const ch_path = buffering_element_test::channel_path();
+    auto const element = buffering_element_test::make_element();
+
+    if (auto const signal = proc::signal_event::make_shared<float>(buffering_element_test::sample_rate)) {
+        float *data = signal->data<float>();
+        data[0] = 1.0f;
+        data[1] = 0.5f;
+
+        XCTAssertTrue(buffering_element_test::write_signal_to_file(signal, 1));
+    }
+
+    element->force_write_on_task(ch_path, 1);
+
+    XCTAssertEqual(element->state(), buffering_element::state_t::readable);
+
+    audio::format const out_format{{.sample_rate = buffering_element_test::sample_rate,
+                                     .pcm_format = buffering_element_test::pcm_format,
+                                     .channel_count = 2,
+                                     .interleaved = false}};
+    audio::pcm_buffer out_buffer{out_format, 4};
+
+    XCTAssertTrue(element->read_into_channel_on_render(&out_buffer, 1, 1, 2, 2));
+
+    float const *const data0 = out_buffer.data_ptr_at_index<float>(0);
+    float const *const data1 = out_buffer.data_ptr_at_index<float>(1);
+    XCTAssertEqual(data1[0], 0.0f);
+    XCTAssertEqual(data1[1], 1.0f, @"to_frameの位置に直接書き込まれる");
+    XCTAssertEqual(data1[2], 0.5f);
+    XCTAssertEqual(data1[3], 0.0f);
+    XCTAssertEqual(data0[1], 0.0f, @"他のチャンネルには書き込まない");
+
+    XCTAssertTrue(element->read_into_channel_on_render(&out_buffer, 0, 3, 3, 1));
+    XCTAssertEqual(data0[3], 0.5f);
+
+    XCTAssertFalse(element->read_into_channel_on_render(&out_buffer, 0, 0, 1, 1), @"エレメントの範囲より前");
+    XCTAssertFalse(element->read_into_channel_on_render(&out_buffer, 0, 0, 3, 2), @"エレメントの範囲を超える");
+    XCTAssertFalse(element->read_into_channel_on_render(&out_buffer, 0, 3, 2, 2), @"out_bufferの範囲を超える");
+}
+
 - (void)test_advance {
     auto const ch_path = buffering_element_test::channel_path();
     auto const element = buffering_element_test::make_element();
@@ -241,6 +281,75 @@ static bool write_signal_to_file(proc::signal_event_ptr const &write_event, frag
     XCTAssertEqual(element->state(), buffering_element::state_t::writable);
 }
 
+- (void)test_set_writable {
+    auto const ch_path = buffering_element_test::channel_path();
+    auto const element = buffering_element_test::make_element();
+
+    element->set_writable_on_task(5);
+
+    XCTAssertEqual(element->state(), buffering_element::state_t::writable, @"読み込まずに書き込み待ちにする");
+    XCTAssertEqual(element->fragment_index_on_render(), 5);
+    XCTAssertFalse(element->contains_frame_on_render(10));
+
+    XCTAssertTrue(element->write_if_needed_on_task(ch_path));
+
+    XCTAssertEqual(element->state(), buffering_element::state_t::readable);
+    XCTAssertEqual(element->begin_frame_on_render(), 10);
+}
+
+- (void)test_write_with_loop_range {
+    auto const ch_path = buffering_element_test::channel_path();
+    auto const element = buffering_element_test::make_element();
+
+    if (auto const signal = proc::signal_event::make_shared<float>(buffering_element_test::sample_rate)) {
+        float *data = signal->data<float>();
+        data[0] = 1.0f;
+        data[1] = 2.0f;
+        XCTAssertTrue(buffering_element_test::write_signal_to_file(signal, 1));
+    }
+
+    if (auto const signal = proc::signal_event::make_shared<float>(buffering_element_test::sample_rate)) {
+        float *data = signal->data<float>();
+        data[0] = 3.0f;
+        data[1] = 4.0f;
+        XCTAssertTrue(buffering_element_test::write_signal_to_file(signal, 2));
+    }
+
+    audio::pcm_buffer out_buffer{buffering_element_test::format, 2};
+    float const *const out_data = out_buffer.data_ptr_at_index<float>(0);
+
+    element->set_loop_range_on_task(fragment_range{.index = 1, .length = 2});
+
+    // ループの範囲内ならそのままのフラグメントを読む
+    element->force_write_on_task(ch_path, 2);
+
+    XCTAssertTrue(element->read_into_channel_on_render(&out_buffer, 0, 0, 4, 2));
+    XCTAssertEqual(out_data[0], 3.0f);
+    XCTAssertEqual(out_data[1], 4.0f);
+
+    // ループの範囲の後ろは範囲の先頭へ折り返したフラグメントを読むが、再生位置のフレームはそのまま
+    element->force_write_on_task(ch_path, 3);
+
+    XCTAssertEqual(element->fragment_index_on_render(), 3);
+    XCTAssertEqual(element->begin_frame_on_render(), 6);
+    XCTAssertTrue(element->read_into_channel_on_render(&out_buffer, 0, 0, 6, 2));
+    XCTAssertEqual(out_data[0], 1.0f);
+    XCTAssertEqual(out_data[1], 2.0f);
+
+    element->advance_on_render(6);
+
+    XCTAssertTrue(element->write_if_needed_on_task(ch_path));
+    XCTAssertTrue(element->read_into_channel_on_render(&out_buffer, 0, 0, 12, 2));
+    XCTAssertEqual(out_data[0], 3.0f);
+    XCTAssertEqual(out_data[1], 4.0f);
+
+    element->set_loop_range_on_task(std::nullopt);
+    element->force_write_on_task(ch_path, 3);
+
+    XCTAssertTrue(element->read_into_channel_on_render(&out_buffer, 0, 0, 6, 2));
+    XCTAssertEqual(out_data[0], 0.0f, @"ループしなければファイルのないフラグメントを読む");
+}
+
 - (void)test_write_if_needed {
     auto const ch_path = buffering_element_test::channel_path();
     auto const element = buffering_element_test::make_element();
@@ -385,6 +494,53 @@ static bool write_signal_to_file(proc::signal_event_ptr const &write_event, frag
     }}.join();
 }
 
+- (void)test_write_from_fragment_cache {
+    auto const ch_path = buffering_element_test::channel_path();
+    auto const cache = fragment_cache::make_shared();
+    cache->set_capacity(1);
+
+    auto const element =
+        buffering_element::make_shared(buffering_element_test::format, buffering_element_test::sample_rate, cache);
+
+    // ファイルには書かずにcacheにだけ入れる
+    auto const signal = proc::signal_event::make_shared<float>(buffering_element_test::sample_rate);
+    float *signal_data = signal->data<float>();
+    signal_data[0] = 8.0f;
+    signal_data[1] = 16.0f;
+
+    path::fragment const frag_path{.channel_path = ch_path, .fragment_index = 1};
+    cache->store(frag_path.value(), {{proc::time::range{2, 2}, signal}});
+
+    element->force_write_on_task(ch_path, 1);
+
+    XCTAssertEqual(element->state(), buffering_element::state_t::readable);
+
+    audio::pcm_buffer buffer{buffering_element_test::format, buffering_element_test::sample_rate};
+
+    std::thread{[&element, &buffer] {
+        XCTAssertTrue(element->read_into_buffer_on_render(&buffer, 1 * buffering_element_test::sample_rate));
+
+        float const *const data = buffer.data_ptr_at_index<float>(0);
+        XCTAssertEqual(data[0], 8.0f);
+        XCTAssertEqual(data[1], 16.0f);
+    }}.join();
+
+    // cacheから消えればファイルを読む
+    cache->erase(frag_path.value());
+
+    element->force_write_on_task(ch_path, 1);
+
+    std::thread{[&element, &buffer] {
+        buffer.clear();
+
+        XCTAssertTrue(element->read_into_buffer_on_render(&buffer, 1 * buffering_element_test::sample_rate));
+
+        float const *const data = buffer.data_ptr_at_index<float>(0);
+        XCTAssertEqual(data[0], 0.0f);
+        XCTAssertEqual(data[1], 0.0f);
+    }}.join();
+}
+
 - (void)test_state_to_string {
     XCTAssertEqual(to_string(audio_buffering_element_state::initial), "initial");
     XCTAssertEqual(to_string(audio_buffering_element_state::writable), "writable");
@@ -0,0 +1,104 @@
+//
+//  buffering_loader_tests.mm
+//
+
+#import <XCTest/XCTest.h>
+#import <audio-playing/umbrella.hpp>
+#import <mutex>
+#import <set>
+#import <thread>
+
+using namespace yas;
+using namespace yas::playing;
+
+@interface buffering_loader_tests : XCTestCase
+
+@end
+
+@implementation buffering_loader_tests
+
+- (void)test_thread_count {
+    XCTAssertEqual(buffering_loader::make_shared(0)->thread_count(), 1);
+    XCTAssertEqual(buffering_loader::make_shared(1)->thread_count(), 1);
+    XCTAssertEqual(buffering_loader::make_shared(4)->thread_count(), 4);
+}
+
+- (void)test_perform_serial {
+    auto const loader = buffering_loader::make_shared(1);
+
+    std::vector<std::size_t> called;
+    std::vector<std::thread::id> called_thread_ids;
+
+    loader->perform(3, [&called, &called_thread_ids](std::size_t const idx) {
+        called.emplace_back(idx);
+        called_thread_ids.emplace_back(std::this_thread::get_id());
+    });
+
+    XCTAssertEqual(called, (std::vector<std::size_t>{0, 1, 2}));
+
+    for (auto const &thread_id : called_thread_ids) {
+        XCTAssertEqual(thread_id, std::this_thread::get_id(), @"呼び出したスレッドで読み込む");
+    }
+}
+
+- (void)test_perform_parallel {
+    auto const loader = buffering_loader::make_shared(4);
+
+    std::mutex mutex;
+    std::multiset<std::size_t> called;
+    std::set<std::thread::id> called_thread_ids;
+
+    for (std::size_t count = 0; count < 3; ++count) {
+        called.clear();
+
+        loader->perform(100, [&mutex, &called, &called_thread_ids](std::size_t const idx) {
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+
+            std::lock_guard<std::mutex> lock(mutex);
+            called.insert(idx);
+            called_thread_ids.insert(std::this_thread::get_id());
+        });
+
+        // 戻ってきた時には全て終わっている
+        XCTAssertEqual(called.size(), 100);
+
+        for (std::size_t idx = 0; idx < 100; ++idx) {
+            XCTAssertEqual(called.count(idx), 1);
+        }
+    }
+
+    XCTAssertGreaterThan(called_thread_ids.size(), 1);
+}
+
+- (void)test_perform_empty {
+    auto const loader = buffering_loader::make_shared(2);
+
+    bool is_called = false;
+
+    loader->perform(0, [&is_called](std::size_t const) { is_called = true; });
+
+    XCTAssertFalse(is_called);
+}
+
+- (void)test_perform_rethrow {
+    auto const loader = buffering_loader::make_shared(2);
+
+    std::atomic<std::size_t> called_count{0};
+
+    XCTAssertThrows(loader->perform(10, [&called_count](std::size_t const idx) {
+        ++called_count;
+
+        if (idx == 3) {
+            throw std::runtime_error("load failed.");
+        }
+    }));
+
+    XCTAssertEqual(called_count.load(), 10, @"他の読み込みは最後まで行う");
+
+    // 例外の後も使える
+    called_count = 0;
+    loader->perform(4, [&called_count](std::size_t const) { ++called_count; });
+    XCTAssertEqual(called_count.load(), 4);
+}
+
+@end
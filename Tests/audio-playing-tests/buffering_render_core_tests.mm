@@ -0,0 +1,182 @@
+//
+//  buffering_render_core_tests.mm
+//
+
+#import <XCTest/XCTest.h>
+#import <cpp-utils/file_manager.h>
+#import <audio-playing/umbrella.hpp>
+#import <audio-processing/umbrella.hpp>
+#import "test_utils.h"
+
+using namespace yas;
+using namespace yas::playing;
+
+namespace yas::playing::buffering_render_core_test {
+static sample_rate_t const sample_rate = 2;
+static std::size_t const element_count = 2;
+
+static path::channel channel_path(channel_index_t const ch_idx) {
+    path::timeline const tl_path{.root_path = test_utils::root_path(),
+                                 .identifier = "0",
+                                 .sample_rate = buffering_render_core_test::sample_rate};
+    return path::channel{.timeline_path = tl_path, .channel_index = ch_idx};
+}
+
+template <typename T>
+static bool write_signal_to_file(channel_index_t const ch_idx, fragment_index_t const frag_idx,
+                                 std::vector<T> const &values) {
+    auto const signal = proc::signal_event::make_shared<T>(values.size());
+    std::copy(values.begin(), values.end(), signal->template data<T>());
+
+    auto const frame = frag_idx * buffering_render_core_test::sample_rate;
+    path::fragment const frag_path{.channel_path = channel_path(ch_idx), .fragment_index = frag_idx};
+    path::signal_event const signal_path{.fragment_path = frag_path,
+                                         .range = proc::time::range{frame, signal->size()},
+                                         .sample_type = signal->sample_type()};
+
+    if (!file_manager::create_directory_if_not_exists(frag_path.value())) {
+        return false;
+    }
+
+    return signal_file::write(signal_path.value(), *signal);
+}
+
+static std::vector<std::shared_ptr<buffering_channel_for_buffering_resource>> make_channels(
+    std::size_t const ch_count, audio::pcm_format const pcm_format) {
+    audio::format const format{{.sample_rate = buffering_render_core_test::sample_rate,
+                                .pcm_format = pcm_format,
+                                .channel_count = 1,
+                                .interleaved = false}};
+
+    std::vector<std::shared_ptr<buffering_channel_for_buffering_resource>> channels;
+
+    for (std::size_t ch_idx = 0; ch_idx < ch_count; ++ch_idx) {
+        auto const channel = playing::make_buffering_channel(buffering_render_core_test::element_count, format,
+                                                             buffering_render_core_test::sample_rate);
+        channel->write_top_element_on_task(channel_path(ch_idx), 0, std::nullopt);
+        (void)channel->write_element_if_needed_on_task(1);
+        channels.emplace_back(channel);
+    }
+
+    return channels;
+}
+
+static audio::pcm_buffer make_out_buffer(uint32_t const ch_count, audio::pcm_format const pcm_format) {
+    audio::format const format{{.sample_rate = buffering_render_core_test::sample_rate,
+                                .pcm_format = pcm_format,
+                                .channel_count = ch_count,
+                                .interleaved = false}};
+    return audio::pcm_buffer{format, 4};
+}
+}  // namespace yas::playing::buffering_render_core_test
+
+@interface buffering_render_core_tests : XCTestCase
+
+@end
+
+@implementation buffering_render_core_tests
+
+- (void)setUp {
+    file_manager::remove_content(test_utils::root_path());
+}
+
+- (void)tearDown {
+    file_manager::remove_content(test_utils::root_path());
+}
+
+- (void)test_make_failed {
+    auto const channels = buffering_render_core_test::make_channels(1, audio::pcm_format::float32);
+
+    XCTAssertFalse(buffering_render_core::make_shared({}, buffering_render_core_test::element_count,
+                                                      buffering_render_core_test::sample_rate,
+                                                      audio::pcm_format::float32));
+    XCTAssertFalse(buffering_render_core::make_shared(channels, 3, buffering_render_core_test::sample_rate,
+                                                      audio::pcm_format::float32),
+                   @"エレメントの数が合わない");
+    XCTAssertFalse(buffering_render_core::make_shared(channels, buffering_render_core_test::element_count,
+                                                      buffering_render_core_test::sample_rate,
+                                                      audio::pcm_format::other));
+}
+
+- (void)test_read_mono {
+    XCTAssertTrue(buffering_render_core_test::write_signal_to_file<float>(0, 0, {1.0f, 2.0f}));
+    XCTAssertTrue(buffering_render_core_test::write_signal_to_file<float>(0, 1, {3.0f, 4.0f}));
+
+    auto const channels = buffering_render_core_test::make_channels(1, audio::pcm_format::float32);
+    auto const core = buffering_render_core::make_shared(channels, buffering_render_core_test::element_count,
+                                                         buffering_render_core_test::sample_rate,
+                                                         audio::pcm_format::float32);
+
+    XCTAssertTrue(core);
+    XCTAssertEqual(core->channel_count(), 1);
+
+    auto out_buffer = buffering_render_core_test::make_out_buffer(1, audio::pcm_format::float32);
+    float const *const data = out_buffer.data_ptr_at_index<float>(0);
+
+    XCTAssertTrue(core->read_into_buffer_on_render(&out_buffer, 0, 0, 2));
+    XCTAssertTrue(core->read_into_buffer_on_render(&out_buffer, 2, 2, 2));
+
+    XCTAssertEqual(data[0], 1.0f);
+    XCTAssertEqual(data[1], 2.0f);
+    XCTAssertEqual(data[2], 3.0f);
+    XCTAssertEqual(data[3], 4.0f);
+
+    XCTAssertFalse(core->read_into_buffer_on_render(&out_buffer, 0, 1, 2), @"フラグメントをまたぐ");
+    XCTAssertFalse(core->read_into_buffer_on_render(&out_buffer, 0, 4, 1), @"読み込まれていないフラグメント");
+    XCTAssertFalse(core->read_into_buffer_on_render(&out_buffer, 3, 0, 2), @"out_bufferの範囲を超える");
+}
+
+- (void)test_read_stereo {
+    XCTAssertTrue(buffering_render_core_test::write_signal_to_file<int16_t>(0, 1, {10, 11}));
+    XCTAssertTrue(buffering_render_core_test::write_signal_to_file<int16_t>(1, 1, {20, 21}));
+
+    auto const channels = buffering_render_core_test::make_channels(2, audio::pcm_format::int16);
+    auto const core = buffering_render_core::make_shared(channels, buffering_render_core_test::element_count,
+                                                         buffering_render_core_test::sample_rate,
+                                                         audio::pcm_format::int16);
+
+    XCTAssertTrue(core);
+    XCTAssertEqual(core->channel_count(), 2);
+
+    auto out_buffer = buffering_render_core_test::make_out_buffer(2, audio::pcm_format::int16);
+
+    XCTAssertTrue(core->read_into_buffer_on_render(&out_buffer, 1, 2, 2));
+
+    int16_t const *const data0 = out_buffer.data_ptr_at_index<int16_t>(0);
+    int16_t const *const data1 = out_buffer.data_ptr_at_index<int16_t>(1);
+    XCTAssertEqual(data0[0], 0);
+    XCTAssertEqual(data0[1], 10);
+    XCTAssertEqual(data0[2], 11);
+    XCTAssertEqual(data0[3], 0);
+    XCTAssertEqual(data1[0], 0);
+    XCTAssertEqual(data1[1], 20);
+    XCTAssertEqual(data1[2], 21);
+    XCTAssertEqual(data1[3], 0);
+
+    auto mono_buffer = buffering_render_core_test::make_out_buffer(1, audio::pcm_format::int16);
+    XCTAssertFalse(core->read_into_buffer_on_render(&mono_buffer, 0, 2, 2), @"出力のチャンネルが足りない");
+}
+
+- (void)test_read_multi_channels {
+    XCTAssertTrue(buffering_render_core_test::write_signal_to_file<double>(0, 0, {0.1, 0.2}));
+    XCTAssertTrue(buffering_render_core_test::write_signal_to_file<double>(1, 0, {1.1, 1.2}));
+    XCTAssertTrue(buffering_render_core_test::write_signal_to_file<double>(2, 0, {2.1, 2.2}));
+
+    auto const channels = buffering_render_core_test::make_channels(3, audio::pcm_format::float64);
+    auto const core = buffering_render_core::make_shared(channels, buffering_render_core_test::element_count,
+                                                         buffering_render_core_test::sample_rate,
+                                                         audio::pcm_format::float64);
+
+    XCTAssertTrue(core);
+    XCTAssertEqual(core->channel_count(), 3);
+
+    auto out_buffer = buffering_render_core_test::make_out_buffer(3, audio::pcm_format::float64);
+
+    XCTAssertTrue(core->read_into_buffer_on_render(&out_buffer, 0, 1, 1));
+
+    XCTAssertEqual(out_buffer.data_ptr_at_index<double>(0)[0], 0.2);
+    XCTAssertEqual(out_buffer.data_ptr_at_index<double>(1)[0], 1.2);
+    XCTAssertEqual(out_buffer.data_ptr_at_index<double>(2)[0], 2.2);
+}
+
+@end
@@ -4,6 +4,8 @@
 
 #import <XCTest/XCTest.h>
 #import <audio-playing/umbrella.hpp>
+#import <map>
+#import <mutex>
 #import <thread>
 #import "test_utils.h"
 
@@ -39,30 +41,47 @@ struct channel : buffering_channel_for_buffering_resource {
     }
 
     std::function<bool()> write_elements_handler;
-    std::function<void(path::channel const &, fragment_index_t const)> write_all_elements_handler;
+    std::function<void(path::channel const &, fragment_index_t const)> write_top_element_handler;
+    std::function<bool(fragment_index_t const)> write_element_handler;
     std::function<void(fragment_index_t const)> advance_handler;
-    std::function<void(fragment_range const)> overwrite_element_handler;
+    std::function<void(fragment_range const, std::optional<fragment_range> const &)> overwrite_element_handler;
     std::function<bool(audio::pcm_buffer *, frame_index_t const)> read_into_buffer_handler;
+    std::function<bool(audio::pcm_buffer *, uint32_t const, uint32_t const, frame_index_t const, uint32_t const)>
+        read_into_channel_handler;
+
+    std::optional<fragment_range> loop_range = std::nullopt;
 
     bool write_elements_if_needed_on_task() {
         return this->write_elements_handler();
     }
 
-    void write_all_elements_on_task(path::channel const &ch_path, fragment_index_t const top_frag_idx) {
-        this->write_all_elements_handler(ch_path, top_frag_idx);
+    void write_top_element_on_task(path::channel const &ch_path, fragment_index_t const top_frag_idx,
+                                   std::optional<fragment_range> const &loop_range) {
+        this->loop_range = loop_range;
+        this->write_top_element_handler(ch_path, top_frag_idx);
+    }
+
+    bool write_element_if_needed_on_task(fragment_index_t const frag_idx) {
+        return this->write_element_handler(frag_idx);
     }
 
     void advance_on_render(fragment_index_t const frag_idx) {
         this->advance_handler(frag_idx);
     }
 
-    void overwrite_element_on_render(fragment_range const frag_range) {
-        this->overwrite_element_handler(frag_range);
+    void overwrite_element_on_render(fragment_range const frag_range,
+                                     std::optional<fragment_range> const &keeping_range) {
+        this->overwrite_element_handler(frag_range, keeping_range);
     }
 
     bool read_into_buffer_on_render(audio::pcm_buffer *out_buffer, frame_index_t const frame) {
         return this->read_into_buffer_handler(out_buffer, frame);
     }
+
+    bool read_into_channel_on_render(audio::pcm_buffer *out_buffer, uint32_t const out_ch_idx, uint32_t const to_frame,
+                                     frame_index_t const frame, uint32_t const length) {
+        return this->read_into_channel_handler(out_buffer, out_ch_idx, to_frame, frame, length);
+    }
 };
 
 struct cpp {
@@ -113,8 +132,9 @@ struct cpp {
 
         auto each = make_fast_each(buffering_test::ch_count);
         while (yas_each_next(each)) {
-            channels.at(yas_each_index(each))->write_all_elements_handler = [](path::channel const &,
-                                                                               fragment_index_t const) {};
+            auto const &channel = channels.at(yas_each_index(each));
+            channel->write_top_element_handler = [](path::channel const &, fragment_index_t const) {};
+            channel->write_element_handler = [](fragment_index_t const) { return false; };
         }
 
         std::thread{[&buffering] { buffering->set_all_writing_on_render(0); }}.join();
@@ -200,9 +220,9 @@ struct cpp {
 
     std::thread{[&buffering] { buffering->create_buffer_on_task(); }}.join();
 
-    channels.at(0)->write_all_elements_handler = [](path::channel const &ch_path, fragment_index_t const top_frag_idx) {
+    channels.at(0)->write_top_element_handler = [](path::channel const &ch_path, fragment_index_t const top_frag_idx) {
     };
-    channels.at(1)->write_all_elements_handler = [](path::channel const &ch_path, fragment_index_t const top_frag_idx) {
+    channels.at(1)->write_top_element_handler = [](path::channel const &ch_path, fragment_index_t const top_frag_idx) {
     };
 
     XCTAssertEqual(buffering->setup_state(), audio_buffering_setup_state::rendering);
@@ -348,6 +368,83 @@ struct cpp {
     XCTAssertEqual(called_count_1, 4);
 }
 
+- (void)test_write_pending_elements {
+    self->_cpp.setup_rendering();
+
+    auto const &buffering = self->_cpp.buffering;
+    auto &channels = self->_cpp.channels;
+
+    std::vector<std::pair<std::size_t, fragment_index_t>> called_top;
+    std::vector<std::pair<std::size_t, fragment_index_t>> called_element;
+    std::size_t called_elements_count = 0;
+    bool result = true;
+
+    auto each = make_fast_each(buffering_test::ch_count);
+    while (yas_each_next(each)) {
+        auto const &idx = yas_each_index(each);
+        auto const &channel = channels.at(idx);
+        channel->write_top_element_handler = [idx, &called_top](path::channel const &,
+                                                                fragment_index_t const top_frag_idx) {
+            called_top.emplace_back(idx, top_frag_idx);
+        };
+        channel->write_element_handler = [idx, &called_element, &result](fragment_index_t const frag_idx) {
+            called_element.emplace_back(idx, frag_idx);
+            return result;
+        };
+        channel->write_elements_handler = [&called_elements_count] {
+            ++called_elements_count;
+            return false;
+        };
+    }
+
+    buffering->set_all_writing_on_render(4);
+    buffering->write_all_elements_on_task();
+
+    XCTAssertEqual(buffering->rendering_state(), audio_buffering_rendering_state::advancing,
+                   @"先頭のフラグメントを読んだらすぐにadvancingになる");
+    XCTAssertEqual(called_top.size(), 2);
+    XCTAssertEqual(called_top.at(0), (std::pair<std::size_t, fragment_index_t>{0, 1}));
+    XCTAssertEqual(called_top.at(1), (std::pair<std::size_t, fragment_index_t>{1, 1}));
+    XCTAssertEqual(called_element.size(), 0);
+
+    // 残りのフラグメントは1つずつ全チャンネル分読む
+
+    XCTAssertTrue(buffering->write_elements_if_needed_on_task());
+
+    XCTAssertEqual(called_element.size(), 2);
+    XCTAssertEqual(called_element.at(0), (std::pair<std::size_t, fragment_index_t>{0, 2}));
+    XCTAssertEqual(called_element.at(1), (std::pair<std::size_t, fragment_index_t>{1, 2}));
+    XCTAssertEqual(called_elements_count, 0);
+
+    XCTAssertTrue(buffering->write_elements_if_needed_on_task());
+
+    XCTAssertEqual(called_element.size(), 4);
+    XCTAssertEqual(called_element.at(2), (std::pair<std::size_t, fragment_index_t>{0, 3}));
+    XCTAssertEqual(called_element.at(3), (std::pair<std::size_t, fragment_index_t>{1, 3}));
+    XCTAssertEqual(called_elements_count, 0);
+
+    XCTAssertFalse(buffering->write_elements_if_needed_on_task());
+
+    XCTAssertEqual(called_element.size(), 4);
+    XCTAssertEqual(called_elements_count, 2);
+
+    // 読むものがなければ次のフラグメントに進む
+
+    called_element.clear();
+    called_elements_count = 0;
+    result = false;
+
+    buffering->set_all_writing_on_render(0);
+    buffering->write_all_elements_on_task();
+
+    XCTAssertFalse(buffering->write_elements_if_needed_on_task());
+
+    XCTAssertEqual(called_element.size(), 4);
+    XCTAssertEqual(called_element.at(1), (std::pair<std::size_t, fragment_index_t>{1, 1}));
+    XCTAssertEqual(called_element.at(3), (std::pair<std::size_t, fragment_index_t>{1, 2}));
+    XCTAssertEqual(called_elements_count, 2);
+}
+
 - (void)test_write_all_elements {
     self->_cpp.setup_rendering();
 
@@ -357,12 +454,12 @@ struct cpp {
     std::vector<std::pair<path::channel, fragment_index_t>> called_channel_0;
     std::vector<std::pair<path::channel, fragment_index_t>> called_channel_1;
 
-    channels.at(0)->write_all_elements_handler = [&called_channel_0](path::channel const &ch_path,
-                                                                     fragment_index_t const top_frag_idx) {
+    channels.at(0)->write_top_element_handler = [&called_channel_0](path::channel const &ch_path,
+                                                                    fragment_index_t const top_frag_idx) {
         called_channel_0.emplace_back(ch_path, top_frag_idx);
     };
-    channels.at(1)->write_all_elements_handler = [&called_channel_1](path::channel const &ch_path,
-                                                                     fragment_index_t const top_frag_idx) {
+    channels.at(1)->write_top_element_handler = [&called_channel_1](path::channel const &ch_path,
+                                                                    fragment_index_t const top_frag_idx) {
         called_channel_1.emplace_back(ch_path, top_frag_idx);
     };
 
@@ -410,6 +507,63 @@ struct cpp {
     XCTAssertEqual(called_channel_1.at(2).second, 5);
 }
 
+- (void)test_write_elements_with_loader {
+    std::vector<std::shared_ptr<buffering_test::channel>> channels;
+
+    auto const buffering = buffering_resource::make_shared(
+        buffering_test::element_count, test_utils::root_path(),
+        [&channels](std::size_t const element_count, audio::format const &format, sample_rate_t const frag_length) {
+            auto channel = std::make_shared<buffering_test::channel>(element_count, format, frag_length);
+            channels.emplace_back(channel);
+            return channel;
+        },
+        buffering_loader::make_shared(2));
+
+    buffering->set_creating_on_render(buffering_test::sample_rate, buffering_test::pcm_format,
+                                      buffering_test::ch_count);
+    buffering->create_buffer_on_task();
+
+    std::mutex mutex;
+    std::map<std::size_t, path::channel> called_top;
+    std::atomic<std::size_t> called_element_count{0};
+    std::atomic<std::size_t> called_elements_count{0};
+
+    auto each = make_fast_each(buffering_test::ch_count);
+    while (yas_each_next(each)) {
+        auto const &idx = yas_each_index(each);
+        auto const &channel = channels.at(idx);
+        channel->write_top_element_handler = [idx, &mutex, &called_top](path::channel const &ch_path,
+                                                                        fragment_index_t const) {
+            std::lock_guard<std::mutex> lock(mutex);
+            called_top.emplace(idx, ch_path);
+        };
+        channel->write_element_handler = [&called_element_count](fragment_index_t const) {
+            ++called_element_count;
+            return true;
+        };
+        channel->write_elements_handler = [&called_elements_count, idx] {
+            ++called_elements_count;
+            return idx == 1;
+        };
+    }
+
+    buffering->set_all_writing_on_render(0);
+    buffering->write_all_elements_on_task();
+
+    XCTAssertEqual(buffering->rendering_state(), audio_buffering_rendering_state::advancing);
+    XCTAssertEqual(called_top.size(), 2);
+    XCTAssertEqual(called_top.at(0), buffering_test::channel_path("", 0));
+    XCTAssertEqual(called_top.at(1), buffering_test::channel_path("", 1));
+
+    XCTAssertTrue(buffering->write_elements_if_needed_on_task());
+    XCTAssertTrue(buffering->write_elements_if_needed_on_task());
+    XCTAssertEqual(called_element_count.load(), 4);
+    XCTAssertEqual(called_elements_count.load(), 0);
+
+    XCTAssertTrue(buffering->write_elements_if_needed_on_task(), @"どれかのチャンネルで読み込めばtrue");
+    XCTAssertEqual(called_elements_count.load(), 2);
+}
+
 - (void)test_overwrite_element {
     self->_cpp.setup_advancing();
 
@@ -419,29 +573,37 @@ struct cpp {
     std::vector<fragment_range> called0;
     std::vector<fragment_range> called1;
 
-    channels.at(0)->overwrite_element_handler = [&called0](fragment_range const frag_range) {
+    channels.at(0)->overwrite_element_handler = [&called0](fragment_range const frag_range,
+                                                           std::optional<fragment_range> const &keeping_range) {
+        XCTAssertFalse(keeping_range.has_value());
         called0.emplace_back(frag_range);
     };
-    channels.at(1)->overwrite_element_handler = [&called1](fragment_range const frag_range) {
+    channels.at(1)->overwrite_element_handler = [&called1](fragment_range const frag_range,
+                                                           std::optional<fragment_range> const &keeping_range) {
+        XCTAssertFalse(keeping_range.has_value());
         called1.emplace_back(frag_range);
     };
 
-    buffering->overwrite_element_on_render({.file_channel_index = 0, .fragment_range = {.index = 0, .length = 1}});
+    buffering->overwrite_element_on_render({.file_channel_index = 0, .fragment_range = {.index = 0, .length = 1}},
+                                           {.index = 0, .length = 1});
 
     XCTAssertEqual(called0.size(), 1);
     XCTAssertEqual(called0.at(0).index, 0);
     XCTAssertEqual(called0.at(0).length, 1);
     XCTAssertEqual(called1.size(), 0);
 
-    buffering->overwrite_element_on_render({.file_channel_index = 1, .fragment_range = {.index = 1, .length = 1}});
+    buffering->overwrite_element_on_render({.file_channel_index = 1, .fragment_range = {.index = 1, .length = 1}},
+                                           {.index = 0, .length = 1});
 
     XCTAssertEqual(called0.size(), 1);
     XCTAssertEqual(called1.size(), 1);
     XCTAssertEqual(called1.at(0).index, 1);
     XCTAssertEqual(called1.at(0).length, 1);
 
-    buffering->overwrite_element_on_render({.file_channel_index = 2, .fragment_range = {.index = 2, .length = 1}});
-    buffering->overwrite_element_on_render({.file_channel_index = -1, .fragment_range = {.index = -1, .length = 1}});
+    buffering->overwrite_element_on_render({.file_channel_index = 2, .fragment_range = {.index = 2, .length = 1}},
+                                           {.index = 0, .length = 1});
+    buffering->overwrite_element_on_render({.file_channel_index = -1, .fragment_range = {.index = -1, .length = 1}},
+                                           {.index = 0, .length = 1});
 
     XCTAssertEqual(called0.size(), 1);
     XCTAssertEqual(called1.size(), 1);
@@ -454,29 +616,33 @@ struct cpp {
     XCTAssertEqual(called0.size(), 1);
     XCTAssertEqual(called1.size(), 1);
 
-    buffering->overwrite_element_on_render({.file_channel_index = 3, .fragment_range = {.index = 3, .length = 1}});
+    buffering->overwrite_element_on_render({.file_channel_index = 3, .fragment_range = {.index = 3, .length = 1}},
+                                           {.index = 0, .length = 1});
 
     XCTAssertEqual(called0.size(), 1);
     XCTAssertEqual(called1.size(), 2);
     XCTAssertEqual(called1.at(1).index, 3);
     XCTAssertEqual(called1.at(1).length, 1);
 
-    buffering->overwrite_element_on_render({.file_channel_index = 2, .fragment_range = {.index = 4, .length = 1}});
+    buffering->overwrite_element_on_render({.file_channel_index = 2, .fragment_range = {.index = 4, .length = 1}},
+                                           {.index = 0, .length = 1});
 
     XCTAssertEqual(called0.size(), 2);
     XCTAssertEqual(called0.at(1).index, 4);
     XCTAssertEqual(called0.at(1).length, 1);
     XCTAssertEqual(called1.size(), 2);
 
-    buffering->overwrite_element_on_render({.file_channel_index = 0, .fragment_range = {.index = 5, .length = 1}});
-    buffering->overwrite_element_on_render({.file_channel_index = 1, .fragment_range = {.index = 6, .length = 1}});
+    buffering->overwrite_element_on_render({.file_channel_index = 0, .fragment_range = {.index = 5, .length = 1}},
+                                           {.index = 0, .length = 1});
+    buffering->overwrite_element_on_render({.file_channel_index = 1, .fragment_range = {.index = 6, .length = 1}},
+                                           {.index = 0, .length = 1});
 
     XCTAssertEqual(called0.size(), 2);
     XCTAssertEqual(called1.size(), 2);
 
     // file_channel_indexがnulloptなら全ch上書き
     buffering->overwrite_element_on_render(
-        {.file_channel_index = std::nullopt, .fragment_range = {.index = 7, .length = 1}});
+        {.file_channel_index = std::nullopt, .fragment_range = {.index = 7, .length = 1}}, {.index = 0, .length = 1});
 
     XCTAssertEqual(called0.size(), 3);
     XCTAssertEqual(called0.at(2).index, 7);
@@ -486,6 +652,34 @@ struct cpp {
     XCTAssertEqual(called1.at(2).length, 1);
 }
 
+- (void)test_overwrite_element_keeping_reading {
+    self->_cpp.setup_advancing();
+
+    auto const &buffering = self->_cpp.buffering;
+    auto &channels = self->_cpp.channels;
+
+    std::vector<std::optional<fragment_range>> called0;
+
+    channels.at(0)->overwrite_element_handler = [&called0](fragment_range const,
+                                                           std::optional<fragment_range> const &keeping_range) {
+        called0.emplace_back(keeping_range);
+    };
+    channels.at(1)->overwrite_element_handler = [](fragment_range const, std::optional<fragment_range> const &) {};
+
+    buffering->overwrite_element_on_render(
+        {.file_channel_index = 0, .fragment_range = {.index = 0, .length = 3}, .keeps_reading = true},
+        {.index = 1, .length = 2});
+
+    XCTAssertEqual(called0.size(), 1);
+    XCTAssertEqual(called0.at(0), (fragment_range{.index = 1, .length = 2}), @"読み込み中の範囲を渡す");
+
+    buffering->overwrite_element_on_render({.file_channel_index = 0, .fragment_range = {.index = 0, .length = 3}},
+                                           {.index = 1, .length = 2});
+
+    XCTAssertEqual(called0.size(), 2);
+    XCTAssertFalse(called0.at(1).has_value(), @"書き出し終わったものは読み込み中でも上書きする");
+}
+
 - (void)test_read_into_buffer {
     self->_cpp.setup_advancing();
 
@@ -541,6 +735,144 @@ struct cpp {
     XCTAssertFalse(buffering->read_into_buffer_on_render(&buffer, 1, 301));
 }
 
+- (void)test_read_into_channel {
+    self->_cpp.setup_advancing();
+
+    auto const &buffering = self->_cpp.buffering;
+    auto &channels = self->_cpp.channels;
+
+    using called_t = std::tuple<audio::pcm_buffer *, uint32_t, uint32_t, frame_index_t, uint32_t>;
+
+    std::vector<called_t> called0;
+    std::vector<called_t> called1;
+
+    channels.at(0)->read_into_channel_handler = [&called0](audio::pcm_buffer *buffer, uint32_t const out_ch_idx,
+                                                           uint32_t const to_frame, frame_index_t const frame,
+                                                           uint32_t const length) {
+        called0.emplace_back(buffer, out_ch_idx, to_frame, frame, length);
+        return true;
+    };
+
+    channels.at(1)->read_into_channel_handler = [&called1](audio::pcm_buffer *buffer, uint32_t const out_ch_idx,
+                                                           uint32_t const to_frame, frame_index_t const frame,
+                                                           uint32_t const length) {
+        called1.emplace_back(buffer, out_ch_idx, to_frame, frame, length);
+        return false;
+    };
+
+    audio::pcm_buffer buffer{buffering_test::format, buffering_test::sample_rate};
+
+    XCTAssertTrue(buffering->read_into_channel_on_render(&buffer, 0, 1, 100, 2));
+
+    XCTAssertEqual(called0.size(), 1);
+    XCTAssertEqual(called0.at(0), (called_t{&buffer, 0, 1, 100, 2}));
+    XCTAssertEqual(called1.size(), 0);
+
+    XCTAssertFalse(buffering->read_into_channel_on_render(&buffer, 1, 2, 101, 1), @"channelから返したフラグと一致");
+
+    XCTAssertEqual(called1.size(), 1);
+    XCTAssertEqual(called1.at(0), (called_t{&buffer, 1, 2, 101, 1}), @"出力のチャンネルはch_idxと同じ");
+
+    XCTAssertFalse(buffering->read_into_channel_on_render(&buffer, 2, 0, 102, 1));
+
+    // ch_idxが範囲外で呼ばれない
+    XCTAssertEqual(called0.size(), 1);
+    XCTAssertEqual(called1.size(), 1);
+}
+
+- (void)test_read_into_channels {
+    self->_cpp.setup_advancing();
+
+    auto const &buffering = self->_cpp.buffering;
+    auto &channels = self->_cpp.channels;
+
+    XCTAssertFalse(buffering->has_render_core_for_test(), @"テスト用のチャンネルならチャンネルごとに読み込む");
+
+    using called_t = std::tuple<audio::pcm_buffer *, uint32_t, uint32_t, frame_index_t, uint32_t>;
+
+    std::vector<called_t> called0;
+    std::vector<called_t> called1;
+    bool result0 = true;
+
+    channels.at(0)->read_into_channel_handler = [&called0, &result0](audio::pcm_buffer *buffer,
+                                                                     uint32_t const out_ch_idx, uint32_t const to_frame,
+                                                                     frame_index_t const frame, uint32_t const length) {
+        called0.emplace_back(buffer, out_ch_idx, to_frame, frame, length);
+        return result0;
+    };
+
+    channels.at(1)->read_into_channel_handler = [&called1](audio::pcm_buffer *buffer, uint32_t const out_ch_idx,
+                                                           uint32_t const to_frame, frame_index_t const frame,
+                                                           uint32_t const length) {
+        called1.emplace_back(buffer, out_ch_idx, to_frame, frame, length);
+        return true;
+    };
+
+    audio::format const out_format{{.sample_rate = buffering_test::sample_rate,
+                                     .pcm_format = buffering_test::pcm_format,
+                                     .channel_count = buffering_test::ch_count,
+                                     .interleaved = false}};
+    audio::pcm_buffer buffer{out_format, buffering_test::sample_rate};
+
+    XCTAssertTrue(buffering->read_into_channels_on_render(&buffer, 1, 100, 2));
+
+    XCTAssertEqual(called0.size(), 1);
+    XCTAssertEqual(called0.at(0), (called_t{&buffer, 0, 1, 100, 2}));
+    XCTAssertEqual(called1.size(), 1);
+    XCTAssertEqual(called1.at(0), (called_t{&buffer, 1, 1, 100, 2}));
+
+    result0 = false;
+
+    XCTAssertFalse(buffering->read_into_channels_on_render(&buffer, 0, 101, 1));
+
+    XCTAssertEqual(called0.size(), 2);
+    XCTAssertEqual(called1.size(), 1, @"読み込めなかったら残りのチャンネルは読まない");
+}
+
+- (void)test_render_core {
+    auto const buffering = buffering_resource::make_shared(
+        buffering_test::element_count, test_utils::root_path(),
+        [](std::size_t const element_count, audio::format const &format, sample_rate_t const frag_length) {
+            return playing::make_buffering_channel(element_count, format, frag_length);
+        });
+
+    XCTAssertFalse(buffering->has_render_core_for_test());
+
+    buffering->set_creating_on_render(buffering_test::sample_rate, buffering_test::pcm_format,
+                                      buffering_test::ch_count);
+    buffering->create_buffer_on_task();
+
+    XCTAssertTrue(buffering->has_render_core_for_test(), @"buffering_channelならチャンネルを作った時に選ばれる");
+}
+
+- (void)test_render_errors {
+    self->_cpp.setup_rendering();
+
+    auto const &buffering = self->_cpp.buffering;
+
+    XCTAssertEqual(buffering->rendering_state(), audio_buffering_rendering_state::waiting);
+
+    audio::pcm_buffer buffer{buffering_test::format, buffering_test::sample_rate};
+
+    // advancingでなければ例外を投げずに数えるだけ
+    XCTAssertNoThrow(buffering->advance_on_render(0));
+    XCTAssertNoThrow(buffering->overwrite_element_on_render(
+        {.file_channel_index = std::nullopt, .fragment_range = {.index = 0, .length = 1}}, {.index = 0, .length = 1}));
+    XCTAssertFalse(buffering->read_into_buffer_on_render(&buffer, 0, 0));
+    XCTAssertFalse(buffering->read_into_channel_on_render(&buffer, 0, 0, 0, 1));
+    XCTAssertFalse(buffering->read_into_channels_on_render(&buffer, 0, 0, 1));
+
+    XCTAssertNoThrow(buffering->set_all_writing_on_render(0));
+    XCTAssertNoThrow(buffering->set_all_writing_on_render(0));
+    XCTAssertFalse(buffering->needs_all_writing_on_render());
+
+    auto const counts = buffering->pull_render_errors();
+    XCTAssertEqual(counts.count(render_error::invalid_rendering_state), 7);
+    XCTAssertEqual(counts.total(), 7);
+
+    XCTAssertEqual(buffering->pull_render_errors().total(), 0, @"取り出したら0に戻る");
+}
+
 - (void)test_needs_all_writing_on_render {
     self->_cpp.setup_advancing();
 
@@ -565,6 +897,15 @@ struct cpp {
     buffering->write_all_elements_on_task();
 
     XCTAssertFalse(buffering->needs_all_writing_on_render(), @"書き込めばリセットされてfalse");
+
+    buffering->set_loop_range_request_on_main(fragment_range{.index = 0, .length = 1});
+
+    XCTAssertTrue(buffering->needs_all_writing_on_render(), @"loop_range_requestがあればtrue");
+
+    buffering->set_all_writing_on_render(0);
+    buffering->write_all_elements_on_task();
+
+    XCTAssertFalse(buffering->needs_all_writing_on_render(), @"書き込めばリセットされてfalse");
 }
 
 - (void)test_channel_mapping_request {
@@ -597,6 +938,53 @@ struct cpp {
     XCTAssertEqual(buffering->identifier_for_test(), "444");
 }
 
+- (void)test_loop_range_request {
+    self->_cpp.setup_advancing();
+
+    auto const &buffering = self->_cpp.buffering;
+    auto const &channels = self->_cpp.channels;
+
+    XCTAssertThrows(buffering->set_loop_range_request_on_main(fragment_range{.index = 0, .length = 0}));
+
+    buffering->set_loop_range_request_on_main(fragment_range{.index = 1, .length = 2});
+
+    XCTAssertEqual(buffering->loop_range_for_test(), std::nullopt, @"書き込むまでは反映しない");
+    XCTAssertEqual(buffering->looped_frame_on_render(12), 12);
+    XCTAssertEqual(buffering->looped_frame_on_main(12), 12);
+
+    buffering->set_all_writing_on_render(0);
+    buffering->write_all_elements_on_task();
+
+    XCTAssertEqual(buffering->loop_range_for_test(), (fragment_range{.index = 1, .length = 2}));
+    XCTAssertEqual(channels.at(0)->loop_range, (fragment_range{.index = 1, .length = 2}));
+    XCTAssertEqual(channels.at(1)->loop_range, (fragment_range{.index = 1, .length = 2}));
+
+    // フラグメントの長さは4なので、ループの範囲は4から12のフレーム
+    XCTAssertEqual(buffering->looped_frame_on_render(11), 11);
+    XCTAssertEqual(buffering->looped_frame_on_render(12), 4);
+    XCTAssertEqual(buffering->looped_frame_on_render(21), 5);
+    XCTAssertEqual(buffering->looped_frame_on_main(12), 4);
+    XCTAssertEqual(buffering->looped_frame_on_main(21), 5);
+    // 範囲より前は範囲の先頭にする
+    XCTAssertEqual(buffering->looped_frame_on_render(3), 4);
+    XCTAssertEqual(buffering->looped_frame_on_main(-1), 4);
+
+    buffering->set_identifier_request_on_main("555");
+    buffering->set_all_writing_on_render(0);
+    buffering->write_all_elements_on_task();
+
+    XCTAssertEqual(channels.at(0)->loop_range, (fragment_range{.index = 1, .length = 2}), @"リクエストがなければそのまま");
+
+    buffering->set_loop_range_request_on_main(std::nullopt);
+    buffering->set_all_writing_on_render(0);
+    buffering->write_all_elements_on_task();
+
+    XCTAssertEqual(buffering->loop_range_for_test(), std::nullopt);
+    XCTAssertEqual(channels.at(0)->loop_range, std::nullopt);
+    XCTAssertEqual(buffering->looped_frame_on_render(12), 12);
+    XCTAssertEqual(buffering->looped_frame_on_main(12), 12);
+}
+
 - (void)test_element_count {
     auto const buffering = buffering_resource::make_shared(
         buffering_test::element_count, test_utils::root_path(),
@@ -607,6 +995,118 @@ struct cpp {
     XCTAssertEqual(buffering->element_count(), buffering_test::element_count);
 }
 
+- (void)test_element_count_request {
+    auto const channels = std::make_shared<std::vector<std::shared_ptr<buffering_test::channel>>>();
+
+    auto const buffering = buffering_resource::make_shared(
+        buffering_test::element_count, test_utils::root_path(),
+        [channels](std::size_t const element_count, audio::format const &format, sample_rate_t const frag_length) {
+            auto channel = std::make_shared<buffering_test::channel>(element_count, format, frag_length);
+            channel->write_top_element_handler = [](path::channel const &, fragment_index_t const) {};
+            channels->emplace_back(channel);
+            return channel;
+        });
+
+    buffering->set_creating_on_render(buffering_test::sample_rate, buffering_test::pcm_format,
+                                      buffering_test::ch_count);
+    buffering->create_buffer_on_task();
+    buffering->set_all_writing_on_render(0);
+    buffering->write_all_elements_on_task();
+
+    XCTAssertEqual(channels->size(), buffering_test::ch_count);
+    XCTAssertFalse(buffering->needs_all_writing_on_render());
+
+    buffering->set_element_count_request_on_main(5);
+
+    XCTAssertTrue(buffering->needs_all_writing_on_render(), @"エレメントの数が変わればtrue");
+    XCTAssertEqual(buffering->element_count(), buffering_test::element_count, @"書き込むまでは変わらない");
+
+    channels->clear();
+
+    buffering->set_all_writing_on_render(0);
+    buffering->write_all_elements_on_task();
+
+    XCTAssertEqual(buffering->element_count(), 5);
+    XCTAssertEqual(channels->size(), buffering_test::ch_count, @"チャンネルを作り直す");
+    XCTAssertEqual(channels->at(0)->element_count, 5);
+    XCTAssertFalse(buffering->needs_all_writing_on_render());
+    XCTAssertEqual(buffering->rendering_state(), audio_buffering_rendering_state::advancing);
+}
+
+- (void)test_depth_policy_request {
+    auto const channels = std::make_shared<std::vector<std::shared_ptr<buffering_test::channel>>>();
+
+    auto const buffering = buffering_resource::make_shared(
+        buffering_test::element_count, test_utils::root_path(),
+        [channels](std::size_t const element_count, audio::format const &format, sample_rate_t const frag_length) {
+            auto channel = std::make_shared<buffering_test::channel>(element_count, format, frag_length);
+            channel->write_top_element_handler = [](path::channel const &, fragment_index_t const) {};
+            channels->emplace_back(channel);
+            return channel;
+        });
+
+    // 読み込みを計る前はエレメントの数を範囲に収めるだけ
+    buffering->set_depth_policy_request_on_main(buffering_depth_policy{.min_element_count = 4});
+
+    buffering->set_creating_on_render(buffering_test::sample_rate, buffering_test::pcm_format,
+                                      buffering_test::ch_count);
+    buffering->create_buffer_on_task();
+
+    XCTAssertEqual(buffering->element_count(), 4);
+    XCTAssertEqual(channels->at(0)->element_count, 4);
+
+    channels->clear();
+
+    buffering->set_depth_policy_request_on_main(std::nullopt);
+    buffering->set_all_writing_on_render(0);
+    buffering->write_all_elements_on_task();
+
+    XCTAssertEqual(buffering->element_count(), buffering_test::element_count, @"使わなくなれば元の数に戻す");
+    XCTAssertEqual(channels->size(), buffering_test::ch_count);
+}
+
+- (void)test_fragment_length_request {
+    auto const channels = std::make_shared<std::vector<std::shared_ptr<buffering_test::channel>>>();
+    auto const ch_paths = std::make_shared<std::vector<path::channel>>();
+
+    auto const buffering = buffering_resource::make_shared(
+        buffering_test::element_count, test_utils::root_path(),
+        [channels, ch_paths](std::size_t const element_count, audio::format const &format,
+                             sample_rate_t const frag_length) {
+            auto channel = std::make_shared<buffering_test::channel>(element_count, format, frag_length);
+            channel->write_top_element_handler = [ch_paths](path::channel const &ch_path, fragment_index_t const) {
+                ch_paths->emplace_back(ch_path);
+            };
+            channels->emplace_back(channel);
+            return channel;
+        });
+
+    buffering->set_fragment_length_request_on_main(2);
+
+    buffering->set_creating_on_render(buffering_test::sample_rate, buffering_test::pcm_format,
+                                      buffering_test::ch_count);
+    buffering->create_buffer_on_task();
+
+    XCTAssertEqual(buffering->fragment_length_on_render(), 2);
+    XCTAssertEqual(channels->at(0)->frag_length, 2);
+
+    buffering->set_identifier_request_on_main("0");
+    buffering->set_all_writing_on_render(0);
+    buffering->write_all_elements_on_task();
+
+    XCTAssertEqual(ch_paths->size(), buffering_test::ch_count);
+    XCTAssertEqual(ch_paths->at(0).timeline_path.fragment_length, 2);
+
+    XCTAssertFalse(buffering->needs_create_on_render(buffering_test::sample_rate, buffering_test::pcm_format,
+                                                     buffering_test::ch_count));
+
+    buffering->set_fragment_length_request_on_main(0);
+
+    XCTAssertTrue(buffering->needs_create_on_render(buffering_test::sample_rate, buffering_test::pcm_format,
+                                                    buffering_test::ch_count),
+                  @"フラグメントの長さが変われば作り直す");
+}
+
 - (void)test_setup_state_to_string {
     XCTAssertEqual(to_string(audio_buffering_setup_state::initial), "initial");
     XCTAssertEqual(to_string(audio_buffering_setup_state::creating), "creating");
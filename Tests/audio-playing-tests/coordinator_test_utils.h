@@ -62,6 +62,10 @@ struct player : player_for_coordinator {
     std::function<void(bool)> set_playing_handler;
     std::function<void(frame_index_t)> seek_handler;
     std::function<void(std::optional<channel_index_t>, fragment_range)> overwrite_handler;
+    std::function<void(std::optional<channel_index_t>, fragment_range)> overwrite_keeping_reading_handler;
+    std::function<void(std::size_t)> set_buffering_element_count_handler;
+    std::function<void(std::optional<buffering_depth_policy>)> set_buffering_depth_policy_handler;
+    std::function<void(sample_rate_t)> set_fragment_length_handler;
     std::function<std::string const &(void)> identifier_handler;
     std::function<playing::channel_mapping(void)> ch_mapping_handler;
     std::function<bool(void)> is_playing_handler;
@@ -89,6 +93,23 @@ struct player : player_for_coordinator {
         this->overwrite_handler(file_ch_idx, frag_range);
     }
 
+    void overwrite_keeping_reading(std::optional<channel_index_t> const file_ch_idx,
+                                   fragment_range const frag_range) override {
+        this->overwrite_keeping_reading_handler(file_ch_idx, frag_range);
+    }
+
+    void set_buffering_element_count(std::size_t const element_count) override {
+        this->set_buffering_element_count_handler(element_count);
+    }
+
+    void set_buffering_depth_policy(std::optional<buffering_depth_policy> const &policy) override {
+        this->set_buffering_depth_policy_handler(policy);
+    }
+
+    void set_fragment_length(sample_rate_t const frag_length) override {
+        this->set_fragment_length_handler(frag_length);
+    }
+
     std::string const &identifier() const override {
         return this->identifier_handler();
     }
@@ -116,12 +137,82 @@ struct player : player_for_coordinator {
 
 struct exporter : exporter_for_coordinator {
     std::function<void(timeline_container_ptr)> set_timeline_container_handler;
+    std::function<void(std::optional<exporter_window>)> set_window_handler;
+    std::function<void(frame_index_t)> set_playhead_frame_handler;
+    std::function<void(std::vector<proc::time::range>)> set_pinned_ranges_handler;
+    std::function<void(exporter_storage_policy)> set_storage_policy_handler;
+    std::function<void(exporter_channel_policy)> set_channel_policy_handler;
+    std::function<void(bool)> set_profiling_enabled_handler;
+    std::function<void(std::size_t)> set_track_cache_capacity_handler;
+    std::function<void(std::size_t)> set_history_capacity_handler;
+    std::function<void(std::size_t)> set_fragment_cache_capacity_handler;
+    std::function<void(exporter_slice_policy)> set_slice_policy_handler;
+    std::function<void(exporter_module_key_f)> set_module_key_handler_handler;
+    std::function<void(void)> begin_edit_handler;
+    std::function<void(void)> commit_edit_handler;
+    std::function<exporter_profile_report(void)> profile_report_handler;
     std::function<observing::endable(event_observing_handler_f &&)> observe_event_handler;
 
     void set_timeline_container(timeline_container_ptr const &container) override {
         this->set_timeline_container_handler(container);
     }
 
+    void set_window(std::optional<exporter_window> const &window) override {
+        this->set_window_handler(window);
+    }
+
+    void set_playhead_frame(frame_index_t const frame) override {
+        this->set_playhead_frame_handler(frame);
+    }
+
+    void set_pinned_ranges(std::vector<proc::time::range> const &ranges) override {
+        this->set_pinned_ranges_handler(ranges);
+    }
+
+    void set_storage_policy(exporter_storage_policy const &policy) override {
+        this->set_storage_policy_handler(policy);
+    }
+
+    void set_channel_policy(exporter_channel_policy const &policy) override {
+        this->set_channel_policy_handler(policy);
+    }
+
+    void set_profiling_enabled(bool const is_enabled) override {
+        this->set_profiling_enabled_handler(is_enabled);
+    }
+
+    void set_track_cache_capacity(std::size_t const capacity) override {
+        this->set_track_cache_capacity_handler(capacity);
+    }
+
+    void set_history_capacity(std::size_t const capacity) override {
+        this->set_history_capacity_handler(capacity);
+    }
+
+    void set_fragment_cache_capacity(std::size_t const capacity) override {
+        this->set_fragment_cache_capacity_handler(capacity);
+    }
+
+    void set_slice_policy(exporter_slice_policy const &policy) override {
+        this->set_slice_policy_handler(policy);
+    }
+
+    void set_module_key_handler(exporter_module_key_f const &handler) override {
+        this->set_module_key_handler_handler(handler);
+    }
+
+    void begin_edit() override {
+        this->begin_edit_handler();
+    }
+
+    void commit_edit() override {
+        this->commit_edit_handler();
+    }
+
+    exporter_profile_report profile_report() const override {
+        return this->profile_report_handler();
+    }
+
     observing::endable observe_event(exporter_for_coordinator::event_observing_handler_f &&handler) override {
         return this->observe_event_handler(std::move(handler));
     }
@@ -132,6 +223,7 @@ struct cpp {
     std::shared_ptr<coordinator_test::renderer> renderer = nullptr;
     std::shared_ptr<coordinator_test::player> player = nullptr;
     std::shared_ptr<coordinator_test::exporter> exporter = nullptr;
+    std::vector<std::pair<uint32_t, workable::task_f>> tasks;
 
     observing::notifier_ptr<exporter_event> exporter_event_notifier = nullptr;
     observing::value::holder_ptr<renderer_format> configulation_holder = nullptr;
@@ -157,6 +249,17 @@ struct cpp {
             };
 
         this->worker->start_handler = [] {};
+        this->worker->add_task_handler = [this](uint32_t priority, workable::task_f &&task) {
+            this->tasks.emplace_back(priority, std::move(task));
+        };
+        this->exporter->set_playhead_frame_handler = [](frame_index_t) {};
+        this->exporter->set_storage_policy_handler = [](exporter_storage_policy const &) {};
+        this->exporter->set_channel_policy_handler = [](exporter_channel_policy const &) {};
+        this->player->ch_mapping_handler = [] { return playing::channel_mapping{}; };
+        this->renderer->format_handler = []() -> renderer_format const & {
+            static renderer_format const format{};
+            return format;
+        };
 
         this->coordinator = coordinator::make_shared(this->worker, this->renderer, this->player, this->exporter);
 
@@ -169,6 +272,7 @@ struct cpp {
         this->player = nullptr;
         this->exporter = nullptr;
         this->coordinator = nullptr;
+        this->tasks.clear();
     }
 };
 }  // namespace yas::playing::coordinator_test
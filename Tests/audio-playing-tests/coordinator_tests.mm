@@ -31,6 +31,7 @@ using namespace yas::playing;
     bool exporter_event_called = false;
     bool fomat_called = false;
     bool start_called = false;
+    std::vector<uint32_t> called_add_task;
 
     auto const exporter_event_notifier = observing::notifier<exporter_event>::make_shared();
     exporter->observe_event_handler = [notifier = exporter_event_notifier, &exporter_event_called](
@@ -47,12 +48,17 @@ using namespace yas::playing;
     };
 
     worker->start_handler = [&start_called] { start_called = true; };
+    worker->add_task_handler = [&called_add_task](uint32_t priority, workable::task_f &&) {
+        called_add_task.emplace_back(priority);
+    };
 
     auto const coordinator = coordinator::make_shared(worker, renderer, player, exporter);
 
     XCTAssertTrue(exporter_event_called);
     XCTAssertTrue(fomat_called);
     XCTAssertTrue(start_called);
+    XCTAssertEqual(called_add_task.size(), 1);
+    XCTAssertEqual(called_add_task.at(0), 2);
 }
 
 - (void)test_set_and_reset_timeline {
@@ -99,6 +105,36 @@ using namespace yas::playing;
     XCTAssertEqual(called_set_identifier.at(1), "");
 }
 
+- (void)test_set_timeline_with_fingerprint {
+    auto const coordinator = self->_cpp.setup_coordinator();
+
+    std::vector<timeline_container_ptr> called;
+
+    self->_cpp.exporter->set_timeline_container_handler = [&called](auto const &container) {
+        called.emplace_back(container);
+    };
+    renderer_format format{.sample_rate = 44100};
+    self->_cpp.renderer->format_handler = [&format] { return format; };
+
+    auto const timeline = proc::timeline::make_shared();
+
+    coordinator->set_timeline(timeline, "1", "fp");
+
+    XCTAssertEqual(called.size(), 1);
+    XCTAssertEqual(called.at(0)->fingerprint(), "fp");
+
+    coordinator->set_timeline(timeline, "1");
+
+    XCTAssertEqual(called.size(), 2);
+    XCTAssertEqual(called.at(1)->fingerprint(), std::nullopt);
+
+    coordinator->set_timeline(timeline, "1", "fp");
+    coordinator->reset_timeline();
+
+    XCTAssertEqual(called.size(), 4);
+    XCTAssertEqual(called.at(3)->fingerprint(), std::nullopt);
+}
+
 - (void)test_set_channel_mapping {
     auto const coordinator = self->_cpp.setup_coordinator();
 
@@ -166,12 +202,304 @@ using namespace yas::playing;
 
     std::vector<frame_index_t> called;
 
+    std::vector<frame_index_t> called_playhead;
+
     self->_cpp.player->seek_handler = [&called](frame_index_t frame) { called.emplace_back(frame); };
+    self->_cpp.exporter->set_playhead_frame_handler = [&called_playhead](frame_index_t frame) {
+        called_playhead.emplace_back(frame);
+    };
 
     coordinator->seek(123);
 
     XCTAssertEqual(called.size(), 1);
     XCTAssertEqual(called.at(0), 123);
+    XCTAssertEqual(called_playhead.size(), 1);
+    XCTAssertEqual(called_playhead.at(0), 123);
+}
+
+- (void)test_export_window {
+    auto const coordinator = self->_cpp.setup_coordinator();
+
+    std::vector<std::optional<exporter_window>> called_window;
+    std::vector<std::vector<proc::time::range>> called_pinned;
+    std::vector<frame_index_t> called_playhead;
+
+    self->_cpp.exporter->set_window_handler = [&called_window](std::optional<exporter_window> window) {
+        called_window.emplace_back(window);
+    };
+    self->_cpp.exporter->set_pinned_ranges_handler = [&called_pinned](std::vector<proc::time::range> ranges) {
+        called_pinned.emplace_back(ranges);
+    };
+    self->_cpp.exporter->set_playhead_frame_handler = [&called_playhead](frame_index_t frame) {
+        called_playhead.emplace_back(frame);
+    };
+    self->_cpp.player->current_frame_handler = [] { return frame_index_t(456); };
+
+    coordinator->set_export_window(exporter_window{.preceding_count = 1, .following_count = 2});
+
+    XCTAssertEqual(called_window.size(), 1);
+    XCTAssertTrue(called_window.at(0) == (exporter_window{.preceding_count = 1, .following_count = 2}));
+
+    coordinator->set_export_pinned_ranges({proc::time::range{10, 20}});
+
+    XCTAssertEqual(called_pinned.size(), 1);
+    XCTAssertEqual(called_pinned.at(0).size(), 1);
+    XCTAssertEqual(called_pinned.at(0).at(0), (proc::time::range{10, 20}));
+
+    coordinator->update_export_playhead();
+
+    XCTAssertEqual(called_playhead.size(), 1);
+    XCTAssertEqual(called_playhead.at(0), 456);
+
+    coordinator->set_export_window(std::nullopt);
+
+    XCTAssertEqual(called_window.size(), 2);
+    XCTAssertFalse(called_window.at(1).has_value());
+}
+
+- (void)test_follow_export_playhead {
+    auto const coordinator = self->_cpp.setup_coordinator();
+
+    XCTAssertEqual(self->_cpp.tasks.size(), 1);
+    auto const &task = self->_cpp.tasks.at(0).second;
+
+    frame_index_t current_frame = 0;
+    std::vector<frame_index_t> called_playhead;
+    XCTestExpectation *expectation = nil;
+
+    self->_cpp.player->current_frame_handler = [&current_frame] { return current_frame; };
+    self->_cpp.exporter->set_playhead_frame_handler = [&called_playhead, &expectation](frame_index_t frame) {
+        called_playhead.emplace_back(frame);
+        [expectation fulfill];
+    };
+
+    expectation = [self expectationWithDescription:@"first"];
+
+    XCTAssertEqual(task(), worker::task_result::unprocessed);
+
+    [self waitForExpectations:@[expectation] timeout:10.0];
+
+    XCTAssertEqual(called_playhead.size(), 1);
+    XCTAssertEqual(called_playhead.at(0), 0);
+
+    // 再生位置が変わらなければ送らない
+
+    XCTAssertEqual(task(), worker::task_result::unprocessed);
+
+    current_frame = 100;
+    expectation = [self expectationWithDescription:@"advanced"];
+
+    XCTAssertEqual(task(), worker::task_result::unprocessed);
+    // 反映されるまでは次を送らない
+    current_frame = 200;
+    XCTAssertEqual(task(), worker::task_result::unprocessed);
+
+    [self waitForExpectations:@[expectation] timeout:10.0];
+
+    XCTAssertEqual(called_playhead.size(), 2);
+    XCTAssertEqual(called_playhead.at(1), 200, @"メインスレッドで反映する時の再生位置を使う");
+}
+
+- (void)test_export_storage_policy {
+    auto const coordinator = self->_cpp.setup_coordinator();
+
+    std::vector<exporter_storage_policy> called;
+
+    self->_cpp.exporter->set_storage_policy_handler = [&called](exporter_storage_policy const &policy) {
+        called.emplace_back(policy);
+    };
+    renderer_format format{.sample_rate = 44100, .pcm_format = audio::pcm_format::int16};
+    self->_cpp.renderer->format_handler = [&format]() -> renderer_format const & { return format; };
+
+    coordinator->set_export_storage_policy(
+        {.format = exporter_storage_format::rendering, .channel_formats = {{1, exporter_storage_format::float32}}});
+
+    XCTAssertEqual(called.size(), 1);
+    XCTAssertEqual(called.at(0).format, exporter_storage_format::int16);
+    XCTAssertEqual(called.at(0).format_for_channel(1), exporter_storage_format::float32);
+
+    self->_cpp.exporter->set_timeline_container_handler = [](auto const &) {};
+    format.pcm_format = audio::pcm_format::float64;
+    self->_cpp.configulation_holder->set_value(format);
+
+    XCTAssertEqual(called.size(), 2);
+    XCTAssertEqual(called.at(1).format, exporter_storage_format::float64);
+}
+
+- (void)test_export_channel_policy {
+    auto const coordinator = self->_cpp.setup_coordinator();
+
+    std::vector<exporter_channel_policy> called;
+
+    self->_cpp.exporter->set_channel_policy_handler = [&called](exporter_channel_policy const &policy) {
+        called.emplace_back(policy);
+    };
+    renderer_format const format{.sample_rate = 44100, .channel_count = 2};
+    self->_cpp.renderer->format_handler = [&format]() -> renderer_format const & { return format; };
+    self->_cpp.player->set_ch_mapping_handler = [](channel_mapping const &) {};
+
+    coordinator->set_export_channel_policy({.skips_negative_channels = false});
+
+    XCTAssertEqual(called.size(), 1);
+    XCTAssertFalse(called.at(0).skips_negative_channels);
+    XCTAssertTrue(called.at(0).defers_unmapped_channels);
+    XCTAssertEqual(called.at(0).mapped_channels.value(), (std::set<channel_index_t>{0, 1}));
+
+    coordinator->set_channel_mapping({.indices = {3, -1, 5}});
+
+    XCTAssertEqual(called.size(), 2);
+    XCTAssertFalse(called.at(1).skips_negative_channels);
+    XCTAssertEqual(called.at(1).mapped_channels.value(), (std::set<channel_index_t>{3, -1}));
+    XCTAssertFalse(called.at(1).is_deferred(-1));
+    XCTAssertTrue(called.at(1).is_deferred(5));
+}
+
+- (void)test_export_profiling {
+    auto const coordinator = self->_cpp.setup_coordinator();
+
+    std::vector<bool> called;
+
+    self->_cpp.exporter->set_profiling_enabled_handler = [&called](bool is_enabled) {
+        called.emplace_back(is_enabled);
+    };
+    self->_cpp.exporter->profile_report_handler = [] {
+        exporter_profile_report report;
+        report.tracks[1].add(10, std::chrono::nanoseconds{20});
+        return report;
+    };
+
+    coordinator->set_export_profiling_enabled(true);
+
+    XCTAssertEqual(called.size(), 1);
+    XCTAssertTrue(called.at(0));
+
+    auto const report = coordinator->export_profile_report();
+
+    XCTAssertEqual(report.tracks.size(), 1);
+    XCTAssertEqual(report.tracks.at(1).frame_count, 10);
+}
+
+- (void)test_export_track_cache_capacity {
+    auto const coordinator = self->_cpp.setup_coordinator();
+
+    std::vector<std::size_t> called;
+
+    self->_cpp.exporter->set_track_cache_capacity_handler = [&called](std::size_t capacity) {
+        called.emplace_back(capacity);
+    };
+
+    coordinator->set_export_track_cache_capacity(16);
+
+    XCTAssertEqual(called.size(), 1);
+    XCTAssertEqual(called.at(0), 16);
+}
+
+- (void)test_export_history_capacity {
+    auto const coordinator = self->_cpp.setup_coordinator();
+
+    std::vector<std::size_t> called;
+
+    self->_cpp.exporter->set_history_capacity_handler = [&called](std::size_t capacity) {
+        called.emplace_back(capacity);
+    };
+
+    coordinator->set_export_history_capacity(32);
+
+    XCTAssertEqual(called.size(), 1);
+    XCTAssertEqual(called.at(0), 32);
+}
+
+- (void)test_export_fragment_cache_capacity {
+    auto const coordinator = self->_cpp.setup_coordinator();
+
+    std::vector<std::size_t> called;
+
+    self->_cpp.exporter->set_fragment_cache_capacity_handler = [&called](std::size_t capacity) {
+        called.emplace_back(capacity);
+    };
+
+    coordinator->set_export_fragment_cache_capacity(16);
+
+    XCTAssertEqual(called.size(), 1);
+    XCTAssertEqual(called.at(0), 16);
+}
+
+- (void)test_export_slice_policy {
+    auto const coordinator = self->_cpp.setup_coordinator();
+
+    std::vector<exporter_slice_policy> called;
+
+    self->_cpp.exporter->set_slice_policy_handler = [&called](exporter_slice_policy policy) {
+        called.emplace_back(policy);
+    };
+
+    exporter_slice_policy const policy{.near_length = 128, .far_length = 0, .near_fragment_count = 1};
+
+    coordinator->set_export_slice_policy(policy);
+
+    XCTAssertEqual(called.size(), 1);
+    XCTAssertTrue(called.at(0) == policy);
+}
+
+- (void)test_export_module_key_handler {
+    auto const coordinator = self->_cpp.setup_coordinator();
+
+    std::vector<exporter_module_key_f> called;
+
+    self->_cpp.exporter->set_module_key_handler_handler = [&called](exporter_module_key_f handler) {
+        called.emplace_back(std::move(handler));
+    };
+
+    coordinator->set_export_module_key_handler([](proc::module_ptr const &) { return "a"; });
+
+    XCTAssertEqual(called.size(), 1);
+    XCTAssertEqual(called.at(0)(nullptr), "a");
+}
+
+- (void)test_edit {
+    auto const coordinator = self->_cpp.setup_coordinator();
+
+    std::vector<std::string> called;
+
+    self->_cpp.exporter->begin_edit_handler = [&called] { called.emplace_back("begin"); };
+    self->_cpp.exporter->commit_edit_handler = [&called] { called.emplace_back("commit"); };
+
+    coordinator->begin_edit();
+    coordinator->commit_edit();
+
+    XCTAssertEqual(called.size(), 2);
+    XCTAssertEqual(called.at(0), "begin");
+    XCTAssertEqual(called.at(1), "commit");
+}
+
+- (void)test_buffering_element_count {
+    auto const coordinator = self->_cpp.setup_coordinator();
+
+    std::vector<std::size_t> called;
+
+    self->_cpp.player->set_buffering_element_count_handler = [&called](std::size_t count) {
+        called.emplace_back(count);
+    };
+
+    coordinator->set_buffering_element_count(6);
+
+    XCTAssertEqual(called.size(), 1);
+    XCTAssertEqual(called.at(0), 6);
+}
+
+- (void)test_buffering_depth_policy {
+    auto const coordinator = self->_cpp.setup_coordinator();
+
+    std::vector<std::optional<buffering_depth_policy>> called;
+
+    self->_cpp.player->set_buffering_depth_policy_handler = [&called](std::optional<buffering_depth_policy> policy) {
+        called.emplace_back(policy);
+    };
+
+    coordinator->set_buffering_depth_policy(buffering_depth_policy{.min_element_count = 3});
+
+    XCTAssertEqual(called.size(), 1);
+    XCTAssertEqual(called.at(0), (buffering_depth_policy{.min_element_count = 3}));
 }
 
 - (void)test_overwrite {
@@ -213,6 +541,47 @@ using namespace yas::playing;
     XCTAssertEqual(called.at(0).second.length, 3);
 }
 
+- (void)test_fragment_length {
+    auto const coordinator = self->_cpp.setup_coordinator();
+
+    std::vector<sample_rate_t> called_exporter;
+    std::vector<sample_rate_t> called_player;
+    std::vector<fragment_range> called_overwrite;
+
+    renderer_format format{.sample_rate = 4};
+    self->_cpp.renderer->format_handler = [&format] { return format; };
+    self->_cpp.exporter->set_timeline_container_handler = [&called_exporter](timeline_container_ptr container) {
+        called_exporter.emplace_back(container->fragment_length());
+    };
+    self->_cpp.player->set_fragment_length_handler = [&called_player](sample_rate_t frag_length) {
+        called_player.emplace_back(frag_length);
+    };
+    self->_cpp.player->overwrite_handler = [&called_overwrite](std::optional<channel_index_t>,
+                                                               fragment_range frag_range) {
+        called_overwrite.emplace_back(frag_range);
+    };
+
+    coordinator->set_fragment_length(2);
+
+    XCTAssertEqual(called_exporter.size(), 1);
+    XCTAssertEqual(called_exporter.at(0), 2);
+    XCTAssertEqual(called_player.size(), 1);
+    XCTAssertEqual(called_player.at(0), 2);
+
+    coordinator->overwrite(proc::time::range{0, 5});
+
+    XCTAssertEqual(called_overwrite.size(), 1);
+    XCTAssertEqual(called_overwrite.at(0).index, 0);
+    XCTAssertEqual(called_overwrite.at(0).length, 3);
+
+    called_exporter.clear();
+
+    coordinator->set_fragment_length(0);
+
+    XCTAssertEqual(called_exporter.size(), 1);
+    XCTAssertEqual(called_exporter.at(0), 4, @"0ならサンプルレートと同じ長さ");
+}
+
 - (void)test_identifier {
     auto const coordinator = self->_cpp.setup_coordinator();
 
@@ -402,4 +771,31 @@ using namespace yas::playing;
     XCTAssertEqual(called.at(1).second.length, 3);
 }
 
+- (void)test_export_progressed {
+    auto const coordinator = self->_cpp.setup_coordinator();
+
+    renderer_format format{.sample_rate = 4};
+    self->_cpp.renderer->format_handler = [&format] { return format; };
+
+    std::vector<std::pair<std::optional<channel_index_t>, fragment_range>> called;
+    std::size_t called_overwrite = 0;
+
+    self->_cpp.player->overwrite_keeping_reading_handler = [&called](std::optional<channel_index_t> ch_idx,
+                                                                    fragment_range frag_range) {
+        called.emplace_back(std::make_pair(ch_idx, frag_range));
+    };
+    self->_cpp.player->overwrite_handler = [&called_overwrite](std::optional<channel_index_t>, fragment_range) {
+        ++called_overwrite;
+    };
+
+    self->_cpp.exporter_event_notifier->notify(exporter_event{
+        .result = exporter_result_t{exporter_method::export_progressed}, .range = proc::time::range{4, 1}});
+
+    XCTAssertEqual(called.size(), 1);
+    XCTAssertEqual(called.at(0).first, std::nullopt);
+    XCTAssertEqual(called.at(0).second.index, 1);
+    XCTAssertEqual(called.at(0).second.length, 1);
+    XCTAssertEqual(called_overwrite, 0, @"途中までのものは読み込み中のエレメントを残す");
+}
+
 @end
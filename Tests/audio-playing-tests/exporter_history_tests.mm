@@ -0,0 +1,80 @@
+//
+//  exporter_history_tests.mm
+//
+
+#import <XCTest/XCTest.h>
+#import <audio-playing/umbrella.hpp>
+
+using namespace yas;
+using namespace yas::playing;
+
+@interface exporter_history_tests : XCTestCase
+
+@end
+
+@implementation exporter_history_tests
+
+- (void)test_push_and_take {
+    auto const history = exporter_history::make_shared();
+    history->set_capacity(2);
+
+    XCTAssertTrue(history->is_enabled());
+
+    auto const pushed0 = history->push(0, "a");
+    auto const pushed1 = history->push(1, "a");
+
+    XCTAssertEqual(pushed0.evicted_serials.size(), 0);
+    XCTAssertEqual(pushed1.evicted_serials.size(), 0);
+    XCTAssertNotEqual(pushed0.serial, pushed1.serial);
+    XCTAssertEqual(history->size(), 2);
+
+    XCTAssertFalse(history->take(0, "b").has_value());
+    XCTAssertEqual(history->take(0, "a").value(), pushed0.serial);
+    XCTAssertFalse(history->take(0, "a").has_value());
+    XCTAssertEqual(history->size(), 1);
+}
+
+- (void)test_evict {
+    auto const history = exporter_history::make_shared();
+    history->set_capacity(2);
+
+    auto const pushed0 = history->push(0, "a");
+    auto const pushed1 = history->push(0, "b");
+    auto const pushed2 = history->push(0, "c");
+
+    XCTAssertEqual(pushed2.evicted_serials.size(), 1);
+    XCTAssertEqual(pushed2.evicted_serials.at(0), pushed0.serial);
+
+    // 同じrevisionは新しいもので置き換える
+    auto const pushed3 = history->push(0, "b");
+
+    XCTAssertEqual(pushed3.evicted_serials.size(), 1);
+    XCTAssertEqual(pushed3.evicted_serials.at(0), pushed1.serial);
+    XCTAssertEqual(history->take(0, "b").value(), pushed3.serial);
+
+    history->clear();
+
+    XCTAssertEqual(history->size(), 0);
+}
+
+- (void)test_erase {
+    auto const history = exporter_history::make_shared();
+    history->set_capacity(2);
+
+    auto const pushed0 = history->push(0, "a");
+    auto const pushed1 = history->push(1, "a");
+
+    history->erase(pushed0.serial);
+
+    XCTAssertEqual(history->size(), 1);
+    XCTAssertFalse(history->take(0, "a").has_value());
+    XCTAssertEqual(history->take(1, "a").value(), pushed1.serial);
+}
+
+- (void)test_disabled {
+    auto const history = exporter_history::make_shared();
+
+    XCTAssertFalse(history->is_enabled());
+}
+
+@end
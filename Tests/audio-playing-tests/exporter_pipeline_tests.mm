@@ -0,0 +1,270 @@
+//
+//  exporter_pipeline_tests.mm
+//
+
+#import <XCTest/XCTest.h>
+#import <audio-playing/exporter/exporter_pipeline.h>
+#import <audio-processing/umbrella.hpp>
+#import <atomic>
+#import <thread>
+
+using namespace yas;
+using namespace yas::playing;
+
+@interface exporter_pipeline_tests : XCTestCase
+
+@end
+
+@implementation exporter_pipeline_tests
+
+- (void)test_make_fragment {
+    proc::stream stream{proc::sync_source{2, 2}};
+
+    auto &channel0 = stream.add_channel(0);
+    channel0.insert_event(proc::time::range{0, 2}, proc::signal_event::make_shared<int16_t>(2));
+    channel0.insert_event(proc::time::frame{1}, proc::number_event::make_shared<int64_t>(10));
+    stream.add_channel(1);
+
+    auto const fragment = exporter_fragment::make({0, 2}, stream);
+
+    XCTAssertEqual(fragment.range, (proc::time::range{0, 2}));
+    XCTAssertEqual(fragment.channels.size(), 2);
+
+    auto const &events0 = fragment.channels.at(0);
+    XCTAssertEqual(events0.signal_events.size(), 1);
+    XCTAssertEqual(events0.signal_events.at(0).first, (proc::time::range{0, 2}));
+    XCTAssertEqual(events0.number_events.size(), 1);
+    XCTAssertEqual(events0.number_events.begin()->first, 1);
+
+    auto const &events1 = fragment.channels.at(1);
+    XCTAssertEqual(events1.signal_events.size(), 0);
+    XCTAssertEqual(events1.number_events.size(), 0);
+}
+
+- (void)test_make_fragment_coalesces_signal_events {
+    proc::stream stream{proc::sync_source{4, 4}};
+
+    auto &channel = stream.add_channel(0);
+
+    auto event0 = proc::signal_event::make_shared<int16_t>(2);
+    event0->data<int16_t>()[0] = 1;
+    event0->data<int16_t>()[1] = 2;
+    auto event1 = proc::signal_event::make_shared<int16_t>(2);
+    event1->data<int16_t>()[0] = 3;
+    event1->data<int16_t>()[1] = 4;
+
+    channel.insert_event(proc::time::range{0, 2}, event0);
+    channel.insert_event(proc::time::range{2, 2}, event1);
+
+    auto const fragment = exporter_fragment::make({0, 4}, stream);
+
+    auto const &events = fragment.channels.at(0).signal_events;
+    XCTAssertEqual(events.size(), 1);
+    XCTAssertEqual(events.at(0).first, (proc::time::range{0, 4}));
+
+    auto const &joined = events.at(0).second;
+    XCTAssertTrue(joined->sample_type() == typeid(int16_t));
+    XCTAssertEqual(joined->size(), 4);
+    XCTAssertEqual(joined->data<int16_t>()[0], 1);
+    XCTAssertEqual(joined->data<int16_t>()[1], 2);
+    XCTAssertEqual(joined->data<int16_t>()[2], 3);
+    XCTAssertEqual(joined->data<int16_t>()[3], 4);
+}
+
+- (void)test_append_slices {
+    proc::stream stream0{proc::sync_source{4, 2}};
+    auto event0 = proc::signal_event::make_shared<int16_t>(2);
+    event0->data<int16_t>()[0] = 1;
+    event0->data<int16_t>()[1] = 2;
+    stream0.add_channel(0).insert_event(proc::time::range{0, 2}, event0);
+
+    proc::stream stream1{proc::sync_source{4, 2}};
+    auto event1 = proc::signal_event::make_shared<int16_t>(2);
+    event1->data<int16_t>()[0] = 3;
+    event1->data<int16_t>()[1] = 4;
+    auto &channel1 = stream1.add_channel(0);
+    channel1.insert_event(proc::time::range{2, 2}, event1);
+    channel1.insert_event(proc::time::frame{3}, proc::number_event::make_shared<int64_t>(10));
+
+    exporter_fragment fragment{.range = {0, 4}};
+    fragment.append(stream0);
+    fragment.append(stream1);
+
+    XCTAssertEqual(fragment.channels.at(0).signal_events.size(), 2);
+
+    fragment.coalesce();
+
+    auto const &events = fragment.channels.at(0);
+    XCTAssertEqual(events.signal_events.size(), 1);
+    XCTAssertEqual(events.signal_events.at(0).first, (proc::time::range{0, 4}));
+    XCTAssertEqual(events.signal_events.at(0).second->data<int16_t>()[0], 1);
+    XCTAssertEqual(events.signal_events.at(0).second->data<int16_t>()[3], 4);
+    XCTAssertEqual(events.number_events.size(), 1);
+    XCTAssertEqual(events.number_events.begin()->first, 3);
+}
+
+- (void)test_coalesced_keeps_gaps_and_different_types {
+    exporter_channel_events::signal_events_t const events{
+        {proc::time::range{0, 2}, proc::signal_event::make_shared<float>(2)},
+        {proc::time::range{2, 2}, proc::signal_event::make_shared<float>(2)},
+        {proc::time::range{4, 2}, proc::signal_event::make_shared<double>(2)},
+        {proc::time::range{7, 1}, proc::signal_event::make_shared<double>(1)}};
+
+    auto const coalesced = exporter_channel_events::coalesced(events);
+
+    XCTAssertEqual(coalesced.size(), 3);
+    XCTAssertEqual(coalesced.at(0).first, (proc::time::range{0, 4}));
+    XCTAssertTrue(coalesced.at(0).second->sample_type() == typeid(float));
+    XCTAssertEqual(coalesced.at(1).first, (proc::time::range{4, 2}));
+    XCTAssertEqual(coalesced.at(2).first, (proc::time::range{7, 1}));
+}
+
+- (void)test_coalesced_keeps_overlapped_events {
+    exporter_channel_events::signal_events_t const events{
+        {proc::time::range{0, 2}, proc::signal_event::make_shared<float>(2)},
+        {proc::time::range{1, 2}, proc::signal_event::make_shared<float>(2)},
+        {proc::time::range{3, 1}, proc::signal_event::make_shared<float>(1)}};
+
+    auto const coalesced = exporter_channel_events::coalesced(events);
+
+    XCTAssertEqual(coalesced.size(), 3);
+    XCTAssertEqual(coalesced.at(0).first, (proc::time::range{0, 2}));
+    XCTAssertEqual(coalesced.at(1).first, (proc::time::range{1, 2}));
+    XCTAssertEqual(coalesced.at(2).first, (proc::time::range{3, 1}));
+}
+
+- (void)test_queue_push_and_pop {
+    exporter_fragment_queue queue{2};
+
+    queue.push(exporter_fragment{.range = {0, 1}});
+    queue.push(exporter_fragment{.range = {1, 1}});
+    queue.close();
+
+    auto const fragment0 = queue.pop();
+    XCTAssertTrue(fragment0.has_value());
+    XCTAssertEqual(fragment0->range, (proc::time::range{0, 1}));
+
+    auto const fragment1 = queue.pop();
+    XCTAssertTrue(fragment1.has_value());
+    XCTAssertEqual(fragment1->range, (proc::time::range{1, 1}));
+
+    XCTAssertFalse(queue.pop().has_value());
+}
+
+- (void)test_queue_pop_if_available {
+    exporter_fragment_queue queue{2};
+
+    XCTAssertFalse(queue.pop_if_available().has_value());
+
+    queue.push(exporter_fragment{.range = {0, 1}});
+
+    auto const fragment = queue.pop_if_available();
+    XCTAssertTrue(fragment.has_value());
+    XCTAssertEqual(fragment->range, (proc::time::range{0, 1}));
+
+    XCTAssertFalse(queue.pop_if_available().has_value());
+}
+
+- (void)test_queue_push_if_available {
+    exporter_fragment_queue queue{1};
+
+    XCTAssertTrue(queue.push_if_available(exporter_fragment{.range = {0, 1}}));
+    XCTAssertFalse(queue.push_if_available(exporter_fragment{.range = {1, 1}}), @"空きがなければ待たずに諦める");
+
+    auto const fragment = queue.pop_if_available();
+    XCTAssertTrue(fragment.has_value());
+    XCTAssertEqual(fragment->range, (proc::time::range{0, 1}));
+
+    queue.close();
+
+    XCTAssertFalse(queue.push_if_available(exporter_fragment{.range = {2, 1}}));
+}
+
+- (void)test_extract_channels {
+    exporter_fragment fragment{.range = {0, 2}};
+    fragment.channels.emplace(0, exporter_channel_events{});
+    fragment.channels.emplace(1, exporter_channel_events{});
+    fragment.channels.emplace(2, exporter_channel_events{});
+
+    auto const extracted = fragment.extract_channels([](channel_index_t const ch_idx) { return ch_idx != 1; });
+
+    XCTAssertEqual(extracted.range, (proc::time::range{0, 2}));
+    XCTAssertEqual(extracted.channels.size(), 2);
+    XCTAssertEqual(extracted.channels.count(0), 1);
+    XCTAssertEqual(extracted.channels.count(2), 1);
+    XCTAssertEqual(fragment.channels.size(), 1);
+    XCTAssertEqual(fragment.channels.count(1), 1);
+}
+
+- (void)test_queue_backpressure {
+    exporter_fragment_queue queue{1};
+    std::atomic<int> pushed_count = 0;
+
+    std::thread pushing_thread{[&queue, &pushed_count] {
+        queue.push(exporter_fragment{.range = {0, 1}});
+        ++pushed_count;
+        queue.push(exporter_fragment{.range = {1, 1}});
+        ++pushed_count;
+        queue.close();
+    }};
+
+    while (pushed_count == 0) {
+        std::this_thread::yield();
+    }
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+
+    XCTAssertEqual(pushed_count, 1);
+
+    XCTAssertEqual(queue.pop()->range, (proc::time::range{0, 1}));
+    XCTAssertEqual(queue.pop()->range, (proc::time::range{1, 1}));
+    XCTAssertFalse(queue.pop().has_value());
+
+    pushing_thread.join();
+
+    XCTAssertEqual(pushed_count, 2);
+}
+
+- (void)test_writing_thread {
+    exporter_fragment_queue queue{2};
+    std::vector<proc::time::range> written;
+
+    {
+        exporter_writing_thread writing_thread{queue, [&written](exporter_fragment_queue &queue) {
+                                                   while (auto fragment = queue.pop()) {
+                                                       written.emplace_back(fragment->range);
+                                                   }
+                                               }};
+
+        queue.push(exporter_fragment{.range = {0, 1}});
+        queue.push(exporter_fragment{.range = {1, 1}});
+
+        writing_thread.join();
+    }
+
+    XCTAssertEqual(written.size(), 2);
+    XCTAssertEqual(written.at(0), (proc::time::range{0, 1}));
+    XCTAssertEqual(written.at(1), (proc::time::range{1, 1}));
+}
+
+- (void)test_writing_thread_joins_when_thrown {
+    exporter_fragment_queue queue{2};
+    std::atomic<int> written_count = 0;
+
+    try {
+        exporter_writing_thread writing_thread{queue, [&written_count](exporter_fragment_queue &queue) {
+                                                   while (queue.pop()) {
+                                                       ++written_count;
+                                                   }
+                                               }};
+
+        queue.push(exporter_fragment{.range = {0, 1}});
+
+        throw std::runtime_error("process failed");
+    } catch (std::runtime_error const &) {
+    }
+
+    XCTAssertEqual(written_count, 1, @"破棄するときにキューを閉じて書き終わるのを待つ");
+}
+
+@end
@@ -0,0 +1,148 @@
+//
+//  exporter_processor_tests.mm
+//
+
+#import <XCTest/XCTest.h>
+#import <audio-playing/umbrella.hpp>
+#import <audio-processing/umbrella.hpp>
+#import "test_utils.h"
+
+using namespace yas;
+using namespace yas::playing;
+
+namespace yas::playing::exporter_processor_test {
+using channel_samples_t = std::map<channel_index_t, std::vector<int16_t>>;
+using slices_t = std::vector<std::pair<proc::time::range, channel_samples_t>>;
+
+static channel_samples_t samples(proc::time::range const &range, proc::stream const &stream) {
+    channel_samples_t samples;
+
+    for (auto const &ch_pair : stream.channels()) {
+        auto &ch_samples = samples[ch_pair.first];
+        ch_samples.resize(range.length, 0);
+
+        for (auto const &event_pair : ch_pair.second.filtered_events<int16_t, proc::signal_event>()) {
+            auto const &event_range = event_pair.first;
+            auto const *data = event_pair.second->data<int16_t>();
+
+            for (length_t idx = 0; idx < event_range.length; ++idx) {
+                ch_samples.at(event_range.frame - range.frame + idx) = data[idx];
+            }
+        }
+    }
+
+    return samples;
+}
+
+static exporter_processor::slice_length_f fixed_slice_length(length_t const length) {
+    return [length](frame_index_t const) { return length; };
+}
+
+static exporter_processor::handler_f collecting_handler(slices_t &slices) {
+    return [&slices](proc::time::range const &range, proc::stream const &stream) {
+        slices.emplace_back(range, samples(range, stream));
+        return proc::continuation::keep;
+    };
+}
+}  // namespace yas::playing::exporter_processor_test
+
+@interface exporter_processor_tests : XCTestCase
+
+@end
+
+@implementation exporter_processor_tests
+
+- (void)test_process_same_as_timeline {
+    auto const timeline = test_utils::test_timeline(0, 2);
+    proc::time::range const range{0, 8};
+
+    for (auto const &sync_source : {proc::sync_source{4, 4}, proc::sync_source{4, 2}}) {
+        exporter_processor_test::slices_t expected;
+        exporter_processor_test::slices_t processed;
+
+        timeline->process(range, sync_source, exporter_processor_test::collecting_handler(expected));
+        exporter_processor::process(timeline->tracks(), range, sync_source.sample_rate, 4,
+                                    exporter_processor_test::fixed_slice_length(sync_source.slice_length), {},
+                                    exporter_processor_test::collecting_handler(processed));
+
+        XCTAssertGreaterThan(expected.size(), 0);
+        XCTAssertEqual(processed.size(), expected.size());
+
+        for (std::size_t idx = 0; idx < std::min(processed.size(), expected.size()); ++idx) {
+            XCTAssertEqual(processed.at(idx).first, expected.at(idx).first);
+            XCTAssertTrue(processed.at(idx).second == expected.at(idx).second);
+        }
+    }
+}
+
+- (void)test_process_with_instruments {
+    auto const timeline = test_utils::test_timeline(0, 1);
+    auto const profiler = exporter_profiler::make_shared();
+    auto const track_cache = exporter_track_cache::make_shared();
+    proc::time::range const range{0, 8};
+    auto const slice_length = exporter_processor_test::fixed_slice_length(4);
+
+    profiler->set_enabled(true);
+    track_cache->set_capacity(16);
+
+    exporter_track_cache::revisions_t revisions;
+    for (auto const &track_pair : timeline->tracks()) {
+        revisions.emplace_back(track_pair.first, 1);
+    }
+
+    exporter_instruments const instruments{.profiler = profiler, .track_cache = track_cache, .revisions = revisions};
+
+    exporter_processor_test::slices_t expected;
+    exporter_processor_test::slices_t processed;
+    exporter_processor_test::slices_t cached;
+
+    exporter_processor::process(timeline->tracks(), range, 4, 4, slice_length, {},
+                                exporter_processor_test::collecting_handler(expected));
+    exporter_processor::process(timeline->tracks(), range, 4, 4, slice_length, instruments,
+                                exporter_processor_test::collecting_handler(processed));
+
+    XCTAssertTrue(processed == expected, @"計測やキャッシュをしても結果は変わらない");
+    XCTAssertEqual(profiler->report().tracks.size(), timeline->tracks().size());
+    XCTAssertGreaterThan(track_cache->size(), 0);
+
+    exporter_processor::process(timeline->tracks(), range, 4, 4, slice_length, instruments,
+                                exporter_processor_test::collecting_handler(cached));
+
+    XCTAssertTrue(cached == expected, @"キャッシュから再開しても結果は変わらない");
+}
+
+- (void)test_process_abort {
+    auto const timeline = test_utils::test_timeline(0, 1);
+    std::vector<proc::time::range> ranges;
+
+    exporter_processor::process(timeline->tracks(), {0, 8}, 4, 4, exporter_processor_test::fixed_slice_length(2), {},
+                                [&ranges](proc::time::range const &range, proc::stream const &) {
+                                    ranges.emplace_back(range);
+                                    return ranges.size() < 2 ? proc::continuation::keep : proc::continuation::abort;
+                                });
+
+    XCTAssertEqual(ranges.size(), 2);
+    XCTAssertEqual(ranges.at(0), (proc::time::range{0, 2}));
+    XCTAssertEqual(ranges.at(1), (proc::time::range{2, 2}));
+}
+
+- (void)test_process_with_slice_length_per_fragment {
+    auto const timeline = test_utils::test_timeline(0, 1);
+    std::vector<proc::time::range> ranges;
+
+    // 最初のフラグメントは1ずつ、次は3で選ぶがフラグメントの境目で切られる
+    exporter_processor::process(
+        timeline->tracks(), {0, 8}, 4, 4, [](frame_index_t const frame) { return frame < 4 ? 1 : 3; }, {},
+        [&ranges](proc::time::range const &range, proc::stream const &) {
+            ranges.emplace_back(range);
+            return proc::continuation::keep;
+        });
+
+    XCTAssertEqual(ranges.size(), 6);
+    XCTAssertEqual(ranges.at(0), (proc::time::range{0, 1}));
+    XCTAssertEqual(ranges.at(3), (proc::time::range{3, 1}));
+    XCTAssertEqual(ranges.at(4), (proc::time::range{4, 3}));
+    XCTAssertEqual(ranges.at(5), (proc::time::range{7, 1}));
+}
+
+@end
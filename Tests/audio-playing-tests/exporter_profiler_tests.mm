@@ -0,0 +1,79 @@
+//
+//  exporter_profiler_tests.mm
+//
+
+#import <XCTest/XCTest.h>
+#import <audio-playing/umbrella.hpp>
+
+using namespace yas;
+using namespace yas::playing;
+
+@interface exporter_profiler_tests : XCTestCase
+
+@end
+
+@implementation exporter_profiler_tests
+
+- (void)test_entry {
+    exporter_profile_entry entry;
+
+    XCTAssertEqual(entry.frames_per_second(), 0.0);
+
+    entry.add(100, std::chrono::milliseconds{10});
+    entry.add(100, std::chrono::milliseconds{10});
+
+    XCTAssertEqual(entry.process_count, 2);
+    XCTAssertEqual(entry.frame_count, 200);
+    XCTAssertEqual(entry.duration, std::chrono::milliseconds{20});
+    XCTAssertEqualWithAccuracy(entry.frames_per_second(), 10000.0, 0.001);
+}
+
+- (void)test_record {
+    auto const profiler = exporter_profiler::make_shared();
+
+    XCTAssertFalse(profiler->is_enabled());
+
+    profiler->set_enabled(true);
+
+    XCTAssertTrue(profiler->is_enabled());
+
+    profiler->record_track(0, 1, 10, std::chrono::nanoseconds{100});
+    profiler->record_track(1, 1, 10, std::chrono::nanoseconds{200});
+    profiler->record_module({.track_index = 1, .range = {0, 20}, .module_index = 0}, 10,
+                            std::chrono::nanoseconds{50});
+
+    auto const report = profiler->report();
+
+    XCTAssertEqual(report.tracks.size(), 1);
+    XCTAssertEqual(report.tracks.at(1).process_count, 2);
+    XCTAssertEqual(report.tracks.at(1).duration, std::chrono::nanoseconds{300});
+    XCTAssertEqual(report.fragments.size(), 2);
+    XCTAssertEqual(report.fragments.at(1).at(1).duration, std::chrono::nanoseconds{200});
+    XCTAssertEqual(report.modules.size(), 1);
+
+    profiler->reset();
+
+    XCTAssertEqual(profiler->report().tracks.size(), 0);
+    XCTAssertEqual(profiler->report().modules.size(), 0);
+    XCTAssertEqual(profiler->report().fragments.size(), 0);
+}
+
+- (void)test_to_json {
+    exporter_profile_report report;
+
+    XCTAssertEqual(report.to_json(), "{\"tracks\":[],\"modules\":[],\"fragments\":[]}");
+
+    report.tracks[0].add(2, std::chrono::seconds{1});
+    report.modules[{.track_index = 0, .range = {0, 2}, .module_index = 1}].add(2, std::chrono::seconds{1});
+    report.fragments[3][0].add(2, std::chrono::seconds{1});
+
+    std::string const entry =
+        "\"process_count\":1,\"frame_count\":2,\"duration_ns\":1000000000,\"frames_per_second\":2";
+
+    XCTAssertEqual(report.to_json(), "{\"tracks\":[{\"track\":0," + entry +
+                                         "}],\"modules\":[{\"track\":0,\"frame\":0,\"length\":2,\"module\":1," +
+                                         entry + "}],\"fragments\":[{\"fragment\":3,\"tracks\":[{\"track\":0," +
+                                         entry + "}]}]}");
+}
+
+@end
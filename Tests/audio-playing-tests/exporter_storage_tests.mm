@@ -0,0 +1,157 @@
+//
+//  exporter_storage_tests.mm
+//
+
+#import <XCTest/XCTest.h>
+#import <audio-playing/umbrella.hpp>
+#import <audio-processing/umbrella.hpp>
+
+using namespace yas;
+using namespace yas::playing;
+
+@interface exporter_storage_tests : XCTestCase
+
+@end
+
+@implementation exporter_storage_tests
+
+- (void)test_resolved {
+    exporter_storage_policy const policy{
+        .format = exporter_storage_format::rendering,
+        .channel_formats = {{0, exporter_storage_format::int16_dithered}, {1, exporter_storage_format::rendering}}};
+
+    auto const resolved = exporter_storage::resolved(policy, audio::pcm_format::float32);
+
+    XCTAssertEqual(resolved.format, exporter_storage_format::float32);
+    XCTAssertEqual(resolved.format_for_channel(0), exporter_storage_format::int16_dithered);
+    XCTAssertEqual(resolved.format_for_channel(1), exporter_storage_format::float32);
+    XCTAssertEqual(resolved.format_for_channel(2), exporter_storage_format::float32);
+
+    XCTAssertEqual(exporter_storage::resolved(policy, audio::pcm_format::fixed824).format,
+                   exporter_storage_format::as_is);
+}
+
+- (void)test_convert_float64_to_float32 {
+    auto const event = proc::signal_event::make_shared<double>(2);
+    event->data<double>()[0] = 0.5;
+    event->data<double>()[1] = -0.25;
+
+    auto const converted = exporter_storage::convert(event, exporter_storage_format::float32, 0);
+
+    XCTAssertTrue(converted->sample_type() == typeid(float));
+    XCTAssertEqual(converted->size(), 2);
+    XCTAssertEqual(converted->data<float>()[0], 0.5f);
+    XCTAssertEqual(converted->data<float>()[1], -0.25f);
+}
+
+- (void)test_convert_float32_to_int16 {
+    auto const event = proc::signal_event::make_shared<float>(4);
+    event->data<float>()[0] = 0.0f;
+    event->data<float>()[1] = 1.0f;
+    event->data<float>()[2] = -2.0f;
+    event->data<float>()[3] = 0.5f;
+
+    auto const converted = exporter_storage::convert(event, exporter_storage_format::int16, 0);
+
+    XCTAssertTrue(converted->sample_type() == typeid(int16_t));
+    XCTAssertEqual(converted->data<int16_t>()[0], 0);
+    XCTAssertEqual(converted->data<int16_t>()[1], 32767);
+    XCTAssertEqual(converted->data<int16_t>()[2], -32768);
+    XCTAssertEqual(converted->data<int16_t>()[3], 16384);
+}
+
+- (void)test_convert_int16_dithered {
+    auto const event = proc::signal_event::make_shared<float>(64);
+    for (std::size_t idx = 0; idx < 64; ++idx) {
+        event->data<float>()[idx] = 0.25f;
+    }
+
+    auto const converted0 = exporter_storage::convert(event, exporter_storage_format::int16_dithered, 1);
+    auto const converted1 = exporter_storage::convert(event, exporter_storage_format::int16_dithered, 1);
+
+    XCTAssertTrue(converted0->sample_type() == typeid(int16_t));
+
+    for (std::size_t idx = 0; idx < 64; ++idx) {
+        auto const value = converted0->data<int16_t>()[idx];
+        XCTAssertLessThanOrEqual(std::abs(value - 8192), 1);
+        XCTAssertEqual(value, converted1->data<int16_t>()[idx]);
+    }
+}
+
+- (void)test_convert_as_is {
+    auto const event = proc::signal_event::make_shared<double>(1);
+
+    XCTAssertEqual(exporter_storage::convert(event, exporter_storage_format::as_is, 0), event);
+    XCTAssertEqual(exporter_storage::convert(event, exporter_storage_format::float64, 0), event);
+
+    auto const int_event = proc::signal_event::make_shared<int16_t>(1);
+
+    XCTAssertEqual(exporter_storage::convert(int_event, exporter_storage_format::int16, 0), int_event);
+
+    auto const bool_event = proc::signal_event::make_shared<boolean>(1);
+
+    XCTAssertEqual(exporter_storage::convert(bool_event, exporter_storage_format::float32, 0), bool_event);
+}
+
+- (void)test_convert_int16_round_trip {
+    auto const event = proc::signal_event::make_shared<int16_t>(4);
+    event->data<int16_t>()[0] = -32768;
+    event->data<int16_t>()[1] = -1;
+    event->data<int16_t>()[2] = 16384;
+    event->data<int16_t>()[3] = 32767;
+
+    auto const float_event = exporter_storage::convert(event, exporter_storage_format::float32, 0);
+
+    XCTAssertEqual(float_event->data<float>()[0], -1.0f);
+    XCTAssertEqual(float_event->data<float>()[2], 0.5f);
+
+    auto const int_event = exporter_storage::convert(float_event, exporter_storage_format::int16, 0);
+
+    for (std::size_t idx = 0; idx < 4; ++idx) {
+        XCTAssertEqual(int_event->data<int16_t>()[idx], event->data<int16_t>()[idx]);
+    }
+}
+
+- (void)test_convert_int64 {
+    auto const event = proc::signal_event::make_shared<int64_t>(3);
+    event->data<int64_t>()[0] = 16384;
+    event->data<int64_t>()[1] = -65536;
+    event->data<int64_t>()[2] = 100000;
+
+    auto const float32_event = exporter_storage::convert(event, exporter_storage_format::float32, 0);
+
+    XCTAssertTrue(float32_event->sample_type() == typeid(float));
+    XCTAssertEqual(float32_event->data<float>()[0], 0.5f);
+    XCTAssertEqual(float32_event->data<float>()[1], -2.0f);
+
+    auto const float64_event = exporter_storage::convert(event, exporter_storage_format::float64, 0);
+
+    XCTAssertTrue(float64_event->sample_type() == typeid(double));
+    XCTAssertEqual(float64_event->data<double>()[0], 0.5);
+
+    auto const int16_event = exporter_storage::convert(event, exporter_storage_format::int16, 0);
+
+    XCTAssertTrue(int16_event->sample_type() == typeid(int16_t));
+    XCTAssertEqual(int16_event->data<int16_t>()[0], 16384);
+    XCTAssertEqual(int16_event->data<int16_t>()[1], -32768);
+    XCTAssertEqual(int16_event->data<int16_t>()[2], 32767);
+}
+
+- (void)test_to_manifest_string {
+    exporter_storage_policy const policy{.format = exporter_storage_format::float32,
+                                         .channel_formats = {{0, exporter_storage_format::int16_dithered}}};
+
+    XCTAssertEqual(exporter_storage::to_manifest_string(policy), "float32 0:int16_dithered");
+    XCTAssertEqual(exporter_storage::to_manifest_string({}), "as_is");
+}
+
+- (void)test_format_to_string {
+    XCTAssertEqual(to_string(exporter_storage_format::as_is), "as_is");
+    XCTAssertEqual(to_string(exporter_storage_format::rendering), "rendering");
+    XCTAssertEqual(to_string(exporter_storage_format::float32), "float32");
+    XCTAssertEqual(to_string(exporter_storage_format::float64), "float64");
+    XCTAssertEqual(to_string(exporter_storage_format::int16), "int16");
+    XCTAssertEqual(to_string(exporter_storage_format::int16_dithered), "int16_dithered");
+}
+
+@end
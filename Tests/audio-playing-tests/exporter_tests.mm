@@ -151,6 +151,52 @@ struct cpp {
     }
 }
 
+- (void)test_set_timeline_with_fragment_length {
+    std::string const &root_path = self->_cpp.root_path;
+    auto const &queue = self->_cpp.queue;
+    exporter::task_priority_t const &priority = self->_cpp.priority;
+    sample_rate_t const sample_rate = 4;
+    sample_rate_t const frag_length = 2;
+    std::string const identifier = "0";
+    path::timeline const tl_path{root_path, identifier, sample_rate, frag_length};
+
+    auto exporter = exporter::make_shared(root_path, queue, priority);
+
+    queue->wait_until_all_tasks_are_finished();
+
+    auto module0 = proc::make_signal_module<int64_t>(10);
+    module0->connect_output(proc::to_connector_index(proc::constant::output::value), 0);
+
+    auto track0 = proc::track::make_shared();
+    track0->push_back_module(module0, {-1, 4});
+
+    auto timeline = proc::timeline::make_shared({{0, track0}});
+
+    exporter->set_timeline_container(
+        timeline_container::make_shared(identifier, sample_rate, timeline, std::nullopt, frag_length));
+
+    queue->wait_until_all_tasks_are_finished();
+
+    XCTAssertTrue(file_manager::content_exists(tl_path.value()));
+    XCTAssertFalse(file_manager::content_exists(path::timeline{root_path, identifier, sample_rate}.value()),
+                   @"1秒の長さのパスには書き出さない");
+
+    auto const ch0_path = path::channel{tl_path, 0};
+
+    XCTAssertFalse(file_manager::content_exists(path::fragment{ch0_path, -2}.value()));
+    XCTAssertTrue(file_manager::content_exists(path::fragment{ch0_path, -1}.value()));
+    XCTAssertTrue(file_manager::content_exists(path::fragment{ch0_path, 0}.value()));
+    XCTAssertTrue(file_manager::content_exists(path::fragment{ch0_path, 1}.value()));
+    XCTAssertFalse(file_manager::content_exists(path::fragment{ch0_path, 2}.value()));
+
+    XCTAssertTrue(file_manager::content_exists(
+        path::signal_event{path::fragment{ch0_path, -1}, {-1, 1}, typeid(int64_t)}.value()));
+    XCTAssertTrue(
+        file_manager::content_exists(path::signal_event{path::fragment{ch0_path, 0}, {0, 2}, typeid(int64_t)}.value()));
+    XCTAssertTrue(
+        file_manager::content_exists(path::signal_event{path::fragment{ch0_path, 1}, {2, 1}, typeid(int64_t)}.value()));
+}
+
 - (void)test_set_sample_rate {
     std::string const &root_path = self->_cpp.root_path;
     auto const &queue = self->_cpp.queue;
@@ -360,9 +406,843 @@ struct cpp {
     XCTAssertFalse(file_manager::content_exists(path::fragment{ch1_path, 1}.value()));
 }
 
+- (void)test_window {
+    std::string const &root_path = self->_cpp.root_path;
+    auto const &queue = self->_cpp.queue;
+    exporter::task_priority_t const &priority = self->_cpp.priority;
+    sample_rate_t const sample_rate = 2;
+    std::string const identifier = "0";
+    path::timeline const tl_path{root_path, identifier, sample_rate};
+    path::channel const ch_path{tl_path, 0};
+
+    auto exporter = exporter::make_shared(root_path, queue, priority);
+
+    exporter->set_window(exporter_window{.preceding_count = 0, .following_count = 1});
+
+    auto module = proc::make_signal_module<int64_t>(1);
+    module->connect_output(proc::to_connector_index(proc::constant::output::value), 0);
+    auto track = proc::track::make_shared();
+    track->push_back_module(module, {0, 20});
+    auto timeline = proc::timeline::make_shared({{0, track}});
+
+    exporter->set_timeline_container(timeline_container::make_shared(identifier, sample_rate, timeline));
+
+    queue->wait_until_all_tasks_are_finished();
+
+    XCTAssertTrue(file_manager::content_exists(path::fragment{ch_path, 0}.value()));
+    XCTAssertTrue(file_manager::content_exists(path::fragment{ch_path, 1}.value()));
+    XCTAssertFalse(file_manager::content_exists(path::fragment{ch_path, 2}.value()));
+
+    exporter->set_playhead_frame(8);
+
+    queue->wait_until_all_tasks_are_finished();
+
+    XCTAssertFalse(file_manager::content_exists(path::fragment{ch_path, 0}.value()));
+    XCTAssertFalse(file_manager::content_exists(path::fragment{ch_path, 1}.value()));
+    XCTAssertFalse(file_manager::content_exists(path::fragment{ch_path, 3}.value()));
+    XCTAssertTrue(file_manager::content_exists(path::fragment{ch_path, 4}.value()));
+    XCTAssertTrue(file_manager::content_exists(path::fragment{ch_path, 5}.value()));
+    XCTAssertFalse(file_manager::content_exists(path::fragment{ch_path, 6}.value()));
+
+    exporter->set_pinned_ranges({proc::time::range{0, 2}});
+
+    queue->wait_until_all_tasks_are_finished();
+
+    XCTAssertTrue(file_manager::content_exists(path::fragment{ch_path, 0}.value()));
+    XCTAssertFalse(file_manager::content_exists(path::fragment{ch_path, 1}.value()));
+    XCTAssertTrue(file_manager::content_exists(path::fragment{ch_path, 4}.value()));
+
+    track->push_back_module(proc::make_signal_module<int64_t>(2), {10, 4});
+
+    queue->wait_until_all_tasks_are_finished();
+
+    XCTAssertFalse(file_manager::content_exists(path::fragment{ch_path, 6}.value()));
+
+    exporter->set_window(std::nullopt);
+
+    queue->wait_until_all_tasks_are_finished();
+
+    auto each = make_fast_each(frame_index_t(10));
+    while (yas_each_next(each)) {
+        XCTAssertTrue(file_manager::content_exists(path::fragment{ch_path, yas_each_index(each)}.value()));
+    }
+}
+
+- (void)test_resume_with_manifest {
+    std::string const &root_path = self->_cpp.root_path;
+    auto const &queue = self->_cpp.queue;
+    exporter::task_priority_t const &priority = self->_cpp.priority;
+    sample_rate_t const sample_rate = 2;
+    std::string const identifier = "0";
+    path::timeline const tl_path{root_path, identifier, sample_rate};
+    path::channel const ch_path{tl_path, 0};
+    auto const manifest_path_value = path::manifest{tl_path}.value();
+
+    auto make_timeline = [] {
+        auto module = proc::make_signal_module<int64_t>(1);
+        module->connect_output(proc::to_connector_index(proc::constant::output::value), 0);
+        auto track = proc::track::make_shared();
+        track->push_back_module(module, {0, 6});
+        return proc::timeline::make_shared({{0, track}});
+    };
+
+    auto put_marker = [&ch_path](fragment_index_t const frag_idx) {
+        auto const marker_path = path::fragment{ch_path, frag_idx}.value().append("marker");
+        std::ofstream stream{marker_path};
+        stream << "marker";
+    };
+
+    auto marker_exists = [&ch_path](fragment_index_t const frag_idx) {
+        return file_manager::content_exists(path::fragment{ch_path, frag_idx}.value().append("marker"));
+    };
+
+    {
+        auto exporter = exporter::make_shared(root_path, queue, priority);
+        exporter->set_timeline_container(
+            timeline_container::make_shared(identifier, sample_rate, make_timeline(), "fp0"));
+
+        queue->wait_until_all_tasks_are_finished();
+    }
+
+    auto const read_result = manifest_file::read(manifest_path_value);
+    XCTAssertTrue(read_result);
+    XCTAssertEqual(read_result.value().fingerprint, "fp0");
+    XCTAssertEqual(read_result.value().fragment_indices, (std::set<fragment_index_t>{0, 1, 2}));
+
+    put_marker(0);
+    put_marker(1);
+
+    {
+        auto exporter = exporter::make_shared(root_path, queue, priority);
+        exporter->set_timeline_container(
+            timeline_container::make_shared(identifier, sample_rate, make_timeline(), "fp0"));
+
+        queue->wait_until_all_tasks_are_finished();
+    }
+
+    XCTAssertTrue(marker_exists(0));
+    XCTAssertTrue(marker_exists(1));
+
+    auto manifest = read_result.value();
+    manifest.fragment_indices = {0, 2};
+    XCTAssertTrue(manifest_file::write(manifest_path_value, manifest));
+
+    {
+        auto exporter = exporter::make_shared(root_path, queue, priority);
+        exporter->set_timeline_container(
+            timeline_container::make_shared(identifier, sample_rate, make_timeline(), "fp0"));
+
+        queue->wait_until_all_tasks_are_finished();
+    }
+
+    XCTAssertTrue(marker_exists(0));
+    XCTAssertFalse(marker_exists(1));
+    XCTAssertTrue(file_manager::content_exists(path::fragment{ch_path, 1}.value()));
+    XCTAssertEqual(manifest_file::read(manifest_path_value).value().fragment_indices,
+                   (std::set<fragment_index_t>{0, 1, 2}));
+
+    {
+        auto exporter = exporter::make_shared(root_path, queue, priority);
+        exporter->set_timeline_container(
+            timeline_container::make_shared(identifier, sample_rate, make_timeline(), "fp1"));
+
+        queue->wait_until_all_tasks_are_finished();
+    }
+
+    XCTAssertFalse(marker_exists(0));
+    XCTAssertTrue(file_manager::content_exists(path::fragment{ch_path, 0}.value()));
+    XCTAssertEqual(manifest_file::read(manifest_path_value).value().fingerprint, "fp1");
+}
+
+- (void)test_set_same_timeline_container {
+    std::string const &root_path = self->_cpp.root_path;
+    auto const &queue = self->_cpp.queue;
+    exporter::task_priority_t const &priority = self->_cpp.priority;
+    sample_rate_t const sample_rate = 2;
+    std::string const identifier = "0";
+    path::channel const ch_path{path::timeline{root_path, identifier, sample_rate}, 0};
+
+    auto module = proc::make_signal_module<int64_t>(1);
+    module->connect_output(proc::to_connector_index(proc::constant::output::value), 0);
+    auto track = proc::track::make_shared();
+    track->push_back_module(module, {0, 2});
+    auto timeline = proc::timeline::make_shared({{0, track}});
+
+    auto exporter = exporter::make_shared(root_path, queue, priority);
+    exporter->set_timeline_container(timeline_container::make_shared(identifier, sample_rate, timeline));
+
+    queue->wait_until_all_tasks_are_finished();
+
+    auto const marker_path = path::fragment{ch_path, 0}.value().append("marker");
+    std::ofstream{marker_path} << "marker";
+
+    exporter->set_timeline_container(timeline_container::make_shared(identifier, sample_rate, timeline));
+
+    queue->wait_until_all_tasks_are_finished();
+
+    XCTAssertTrue(file_manager::content_exists(marker_path));
+}
+
+- (void)test_storage_policy {
+    std::string const &root_path = self->_cpp.root_path;
+    auto const &queue = self->_cpp.queue;
+    exporter::task_priority_t const &priority = self->_cpp.priority;
+    sample_rate_t const sample_rate = 2;
+    std::string const identifier = "0";
+    path::timeline const tl_path{root_path, identifier, sample_rate};
+    path::fragment const frag0_path{path::channel{tl_path, 0}, 0};
+    path::fragment const frag1_path{path::channel{tl_path, 1}, 0};
+
+    auto module0 = proc::make_signal_module<double>(0.5);
+    module0->connect_output(proc::to_connector_index(proc::constant::output::value), 0);
+    auto module1 = proc::make_signal_module<double>(0.5);
+    module1->connect_output(proc::to_connector_index(proc::constant::output::value), 1);
+    auto track = proc::track::make_shared();
+    track->push_back_module(module0, {0, 2});
+    track->push_back_module(module1, {0, 2});
+    auto timeline = proc::timeline::make_shared({{0, track}});
+
+    auto exporter = exporter::make_shared(root_path, queue, priority);
+    exporter->set_storage_policy(
+        {.format = exporter_storage_format::float32, .channel_formats = {{1, exporter_storage_format::as_is}}});
+    exporter->set_timeline_container(timeline_container::make_shared(identifier, sample_rate, timeline));
+
+    queue->wait_until_all_tasks_are_finished();
+
+    auto const float_path_value = path::signal_event{frag0_path, {0, 2}, typeid(float)}.value();
+    XCTAssertTrue(file_manager::content_exists(float_path_value));
+    XCTAssertFalse(file_manager::content_exists(path::signal_event{frag0_path, {0, 2}, typeid(double)}.value()));
+    XCTAssertTrue(file_manager::content_exists(path::signal_event{frag1_path, {0, 2}, typeid(double)}.value()));
+
+    float values[2] = {0.0f, 0.0f};
+    XCTAssertTrue(signal_file::read(float_path_value, values, sizeof(values)));
+    XCTAssertEqual(values[0], 0.5f);
+    XCTAssertEqual(values[1], 0.5f);
+
+    exporter->set_storage_policy({.format = exporter_storage_format::int16});
+
+    queue->wait_until_all_tasks_are_finished();
+
+    XCTAssertFalse(file_manager::content_exists(float_path_value));
+    XCTAssertTrue(file_manager::content_exists(path::signal_event{frag0_path, {0, 2}, typeid(int16_t)}.value()));
+    XCTAssertTrue(file_manager::content_exists(path::signal_event{frag1_path, {0, 2}, typeid(int16_t)}.value()));
+}
+
+- (void)test_coalesce_signal_events {
+    std::string const &root_path = self->_cpp.root_path;
+    auto const &queue = self->_cpp.queue;
+    exporter::task_priority_t const &priority = self->_cpp.priority;
+    sample_rate_t const sample_rate = 4;
+    std::string const identifier = "0";
+    path::fragment const frag_path{path::channel{path::timeline{root_path, identifier, sample_rate}, 0}, 0};
+
+    auto module0 = proc::make_signal_module<int64_t>(1);
+    module0->connect_output(proc::to_connector_index(proc::constant::output::value), 0);
+    auto module1 = proc::make_signal_module<int64_t>(2);
+    module1->connect_output(proc::to_connector_index(proc::constant::output::value), 0);
+    auto track = proc::track::make_shared();
+    track->push_back_module(module0, {0, 2});
+    track->push_back_module(module1, {2, 2});
+    auto timeline = proc::timeline::make_shared({{0, track}});
+
+    auto exporter = exporter::make_shared(root_path, queue, priority);
+    exporter->set_timeline_container(timeline_container::make_shared(identifier, sample_rate, timeline));
+
+    queue->wait_until_all_tasks_are_finished();
+
+    XCTAssertFalse(file_manager::content_exists(path::signal_event{frag_path, {0, 2}, typeid(int64_t)}.value()));
+    XCTAssertFalse(file_manager::content_exists(path::signal_event{frag_path, {2, 2}, typeid(int64_t)}.value()));
+
+    auto const signal_path_value = path::signal_event{frag_path, {0, 4}, typeid(int64_t)}.value();
+    XCTAssertTrue(file_manager::content_exists(signal_path_value));
+
+    int64_t values[4] = {0, 0, 0, 0};
+    XCTAssertTrue(signal_file::read(signal_path_value, values, sizeof(values)));
+    XCTAssertEqual(values[0], 1);
+    XCTAssertEqual(values[1], 1);
+    XCTAssertEqual(values[2], 2);
+    XCTAssertEqual(values[3], 2);
+}
+
+- (void)test_coalesce_signal_events_after_conversion {
+    std::string const &root_path = self->_cpp.root_path;
+    auto const &queue = self->_cpp.queue;
+    exporter::task_priority_t const &priority = self->_cpp.priority;
+    sample_rate_t const sample_rate = 4;
+    std::string const identifier = "0";
+    path::fragment const frag_path{path::channel{path::timeline{root_path, identifier, sample_rate}, 0}, 0};
+
+    auto module0 = proc::make_signal_module<double>(0.5);
+    module0->connect_output(proc::to_connector_index(proc::constant::output::value), 0);
+    auto module1 = proc::make_signal_module<float>(0.25f);
+    module1->connect_output(proc::to_connector_index(proc::constant::output::value), 0);
+    auto track = proc::track::make_shared();
+    track->push_back_module(module0, {0, 2});
+    track->push_back_module(module1, {2, 2});
+    auto timeline = proc::timeline::make_shared({{0, track}});
+
+    auto exporter = exporter::make_shared(root_path, queue, priority);
+    exporter->set_storage_policy({.format = exporter_storage_format::float32});
+    exporter->set_timeline_container(timeline_container::make_shared(identifier, sample_rate, timeline));
+
+    queue->wait_until_all_tasks_are_finished();
+
+    XCTAssertFalse(file_manager::content_exists(path::signal_event{frag_path, {0, 2}, typeid(float)}.value()));
+    XCTAssertFalse(file_manager::content_exists(path::signal_event{frag_path, {2, 2}, typeid(float)}.value()));
+
+    auto const signal_path_value = path::signal_event{frag_path, {0, 4}, typeid(float)}.value();
+    XCTAssertTrue(file_manager::content_exists(signal_path_value), @"float32に揃えてから1つにまとめる");
+
+    float values[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+    XCTAssertTrue(signal_file::read(signal_path_value, values, sizeof(values)));
+    XCTAssertEqual(values[0], 0.5f);
+    XCTAssertEqual(values[1], 0.5f);
+    XCTAssertEqual(values[2], 0.25f);
+    XCTAssertEqual(values[3], 0.25f);
+}
+
+- (void)test_slice_policy {
+    std::string const &root_path = self->_cpp.root_path;
+    auto const &queue = self->_cpp.queue;
+    exporter::task_priority_t const &priority = self->_cpp.priority;
+    sample_rate_t const sample_rate = 4;
+    std::string const identifier = "0";
+    path::channel const ch_path{path::timeline{root_path, identifier, sample_rate}, 0};
+
+    auto module = proc::make_signal_module<int64_t>(1);
+    module->connect_output(proc::to_connector_index(proc::constant::output::value), 0);
+    auto track = proc::track::make_shared();
+    track->push_back_module(module, {0, 8});
+    auto timeline = proc::timeline::make_shared({{0, track}});
+
+    auto exporter = exporter::make_shared(root_path, queue, priority);
+    // 再生位置のフラグメントは割り切れない3が1に切り下げられ、それ以外は2で処理する
+    exporter->set_slice_policy({.near_length = 3, .far_length = 2, .near_fragment_count = 0});
+    exporter->set_playhead_frame(0);
+    exporter->set_profiling_enabled(true);
+    exporter->set_timeline_container(timeline_container::make_shared(identifier, sample_rate, timeline));
+
+    queue->wait_until_all_tasks_are_finished();
+
+    path::fragment const frag_path_0{ch_path, 0};
+    path::fragment const frag_path_1{ch_path, 1};
+
+    XCTAssertFalse(file_manager::content_exists(path::signal_event{frag_path_0, {0, 1}, typeid(int64_t)}.value()));
+    XCTAssertFalse(file_manager::content_exists(path::signal_event{frag_path_1, {4, 2}, typeid(int64_t)}.value()));
+
+    // スライスに分けて処理してもフラグメントごとに1つのファイルにまとまる
+    auto const signal_path_value = path::signal_event{frag_path_0, {0, 4}, typeid(int64_t)}.value();
+    XCTAssertTrue(file_manager::content_exists(signal_path_value));
+    XCTAssertTrue(file_manager::content_exists(path::signal_event{frag_path_1, {4, 4}, typeid(int64_t)}.value()));
+
+    int64_t values[4] = {0, 0, 0, 0};
+    XCTAssertTrue(signal_file::read(signal_path_value, values, sizeof(values)));
+    XCTAssertEqual(values[0], 1);
+    XCTAssertEqual(values[3], 1);
+
+    auto const report = exporter->profile_report();
+
+    XCTAssertEqual(report.tracks.at(0).process_count, 6);
+    XCTAssertEqual(report.tracks.at(0).frame_count, 8);
+}
+
+- (void)test_publish_partial_fragment_near_playhead {
+    std::string const &root_path = self->_cpp.root_path;
+    auto const &queue = self->_cpp.queue;
+    exporter::task_priority_t const &priority = self->_cpp.priority;
+    sample_rate_t const sample_rate = 4;
+    std::string const identifier = "0";
+    path::channel const ch_path{path::timeline{root_path, identifier, sample_rate}, 0};
+
+    auto module = proc::make_signal_module<int64_t>(1);
+    module->connect_output(proc::to_connector_index(proc::constant::output::value), 0);
+    auto track = proc::track::make_shared();
+    track->push_back_module(module, {0, 8});
+    auto timeline = proc::timeline::make_shared({{0, track}});
+
+    auto exporter = exporter::make_shared(root_path, queue, priority);
+    exporter->set_fragment_cache_capacity(8);
+    exporter->set_slice_policy({.near_length = 1, .far_length = 0, .near_fragment_count = 0});
+    exporter->set_playhead_frame(0);
+
+    std::vector<exporter::event_t> received;
+
+    auto expectation = [self expectationWithDescription:@"export"];
+    expectation.expectedFulfillmentCount = 2;
+
+    auto canceller = exporter
+                         ->observe_event([&received, &expectation](auto const &event) {
+                             received.push_back(event);
+                             if (event.result.is_success() &&
+                                 event.result.value() == exporter::method_t::export_ended) {
+                                 [expectation fulfill];
+                             }
+                         })
+                         .end();
+
+    exporter->set_timeline_container(timeline_container::make_shared(identifier, sample_rate, timeline));
+
+    [self waitForExpectations:@[expectation] timeout:10.0];
+
+    std::vector<proc::time::range> progressed;
+    for (auto const &event : received) {
+        if (event.result.is_success() && event.result.value() == exporter::method_t::export_progressed) {
+            progressed.emplace_back(event.range.value());
+        }
+    }
+
+    // 再生位置のフラグメントだけ、処理したところまでを書き込みより先に渡す
+    XCTAssertGreaterThan(progressed.size(), 0);
+    for (auto const &range : progressed) {
+        XCTAssertEqual(range.frame, 0);
+        XCTAssertLessThan(range.length, 4);
+    }
+
+    // 最後まで揃ったものに置き換わっている
+    auto const events = exporter->fragment_cache()->find(path::fragment{ch_path, 0}.value());
+    XCTAssertTrue(events.has_value());
+    XCTAssertEqual(events->size(), 1);
+    XCTAssertEqual(events->at(0).first, (proc::time::range{0, 4}));
+
+    canceller->cancel();
+}
+
+- (void)test_channel_policy {
+    std::string const &root_path = self->_cpp.root_path;
+    auto const &queue = self->_cpp.queue;
+    exporter::task_priority_t const &priority = self->_cpp.priority;
+    sample_rate_t const sample_rate = 2;
+    std::string const identifier = "0";
+    path::timeline const tl_path{root_path, identifier, sample_rate};
+
+    auto track = proc::track::make_shared();
+
+    for (channel_index_t const ch_idx : {-1, 0, 1}) {
+        auto module = proc::make_signal_module<int64_t>(ch_idx + 10);
+        module->connect_output(proc::to_connector_index(proc::constant::output::value), ch_idx);
+        track->push_back_module(module, {0, 4});
+    }
+
+    auto timeline = proc::timeline::make_shared({{0, track}});
+
+    auto exporter = exporter::make_shared(root_path, queue, priority);
+    exporter->set_channel_policy({.mapped_channels = std::set<channel_index_t>{1}});
+    exporter->set_timeline_container(timeline_container::make_shared(identifier, sample_rate, timeline));
+
+    queue->wait_until_all_tasks_are_finished();
+
+    // 負のチャンネルは書き出さない
+    XCTAssertFalse(file_manager::content_exists(path::channel{tl_path, -1}.value()));
+
+    // 後回しにしたチャンネルも書き出しが終わるまでには書き出されている
+    for (channel_index_t const ch_idx : {0, 1}) {
+        path::channel const ch_path{tl_path, ch_idx};
+        XCTAssertTrue(file_manager::content_exists(path::fragment{ch_path, 0}.value()));
+        XCTAssertTrue(file_manager::content_exists(path::fragment{ch_path, 1}.value()));
+    }
+
+    exporter->set_channel_policy({.skips_negative_channels = false, .mapped_channels = std::set<channel_index_t>{1}});
+
+    queue->wait_until_all_tasks_are_finished();
+
+    auto const signal_path_value =
+        path::signal_event{path::fragment{path::channel{tl_path, -1}, 0}, {0, 2}, typeid(int64_t)}.value();
+    int64_t values[2] = {0, 0};
+    XCTAssertTrue(signal_file::read(signal_path_value, values, sizeof(values)));
+    XCTAssertEqual(values[0], 9);
+    XCTAssertEqual(values[1], 9);
+}
+
+- (void)test_profiling {
+    std::string const &root_path = self->_cpp.root_path;
+    auto const &queue = self->_cpp.queue;
+    exporter::task_priority_t const &priority = self->_cpp.priority;
+    sample_rate_t const sample_rate = 2;
+    std::string const identifier = "0";
+    path::channel const ch_path{path::timeline{root_path, identifier, sample_rate}, 0};
+
+    auto module0 = proc::make_signal_module<int64_t>(1);
+    module0->connect_output(proc::to_connector_index(proc::constant::output::value), 0);
+    auto module1 = proc::make_signal_module<int64_t>(2);
+    module1->connect_output(proc::to_connector_index(proc::constant::output::value), 1);
+    auto track0 = proc::track::make_shared();
+    track0->push_back_module(module0, {0, 3});
+    auto track1 = proc::track::make_shared();
+    track1->push_back_module(module1, {1, 2});
+    auto timeline = proc::timeline::make_shared({{0, track0}, {1, track1}});
+
+    auto exporter = exporter::make_shared(root_path, queue, priority);
+    exporter->set_profiling_enabled(true);
+    exporter->set_timeline_container(timeline_container::make_shared(identifier, sample_rate, timeline));
+
+    queue->wait_until_all_tasks_are_finished();
+
+    XCTAssertTrue(file_manager::content_exists(path::fragment{ch_path, 0}.value()));
+    XCTAssertTrue(file_manager::content_exists(path::fragment{ch_path, 1}.value()));
+
+    auto const report = exporter->profile_report();
+
+    XCTAssertEqual(report.tracks.size(), 2);
+    XCTAssertEqual(report.tracks.at(0).process_count, 2);
+    XCTAssertEqual(report.tracks.at(0).frame_count, 4);
+    XCTAssertEqual(report.modules.size(), 2);
+    XCTAssertEqual((report.modules.at({.track_index = 0, .range = {0, 3}, .module_index = 0}).frame_count), 3);
+    XCTAssertEqual((report.modules.at({.track_index = 1, .range = {1, 2}, .module_index = 0}).frame_count), 2);
+    XCTAssertEqual(report.fragments.size(), 2);
+
+    exporter->reset_profile_report();
+
+    XCTAssertEqual(exporter->profile_report().tracks.size(), 0);
+}
+
+- (void)test_track_cache {
+    std::string const &root_path = self->_cpp.root_path;
+    auto const &queue = self->_cpp.queue;
+    exporter::task_priority_t const &priority = self->_cpp.priority;
+    sample_rate_t const sample_rate = 2;
+    std::string const identifier = "0";
+    path::timeline const tl_path{root_path, identifier, sample_rate};
+
+    auto module0 = proc::make_signal_module<int64_t>(1);
+    module0->connect_output(proc::to_connector_index(proc::constant::output::value), 0);
+    auto module1 = proc::make_signal_module<int64_t>(2);
+    module1->connect_output(proc::to_connector_index(proc::constant::output::value), 1);
+    auto track0 = proc::track::make_shared();
+    track0->push_back_module(module0, {0, 2});
+    auto track1 = proc::track::make_shared();
+    track1->push_back_module(module1, {0, 2});
+    auto timeline = proc::timeline::make_shared({{0, track0}, {1, track1}});
+
+    auto exporter = exporter::make_shared(root_path, queue, priority);
+    exporter->set_track_cache_capacity(8);
+    exporter->set_profiling_enabled(true);
+    exporter->set_timeline_container(timeline_container::make_shared(identifier, sample_rate, timeline));
+
+    queue->wait_until_all_tasks_are_finished();
+
+    XCTAssertEqual(exporter->profile_report().tracks.size(), 2);
+
+    exporter->reset_profile_report();
+
+    auto module2 = proc::make_signal_module<int64_t>(3);
+    module2->connect_output(proc::to_connector_index(proc::constant::output::value), 1);
+    track1->push_back_module(module2, {0, 2});
+
+    queue->wait_until_all_tasks_are_finished();
+
+    // 変わっていないトラック0は処理されない
+    auto const report = exporter->profile_report();
+    XCTAssertEqual(report.tracks.size(), 1);
+    XCTAssertEqual(report.tracks.count(1), 1);
+
+    int64_t values[2] = {0, 0};
+
+    auto const ch0_path_value =
+        path::signal_event{path::fragment{path::channel{tl_path, 0}, 0}, {0, 2}, typeid(int64_t)}.value();
+    XCTAssertTrue(signal_file::read(ch0_path_value, values, sizeof(values)));
+    XCTAssertEqual(values[0], 1);
+    XCTAssertEqual(values[1], 1);
+
+    auto const ch1_path_value =
+        path::signal_event{path::fragment{path::channel{tl_path, 1}, 0}, {0, 2}, typeid(int64_t)}.value();
+    XCTAssertTrue(signal_file::read(ch1_path_value, values, sizeof(values)));
+    XCTAssertEqual(values[0], 3);
+    XCTAssertEqual(values[1], 3);
+}
+
+- (void)test_edit {
+    std::string const &root_path = self->_cpp.root_path;
+    auto const &queue = self->_cpp.queue;
+    exporter::task_priority_t const &priority = self->_cpp.priority;
+    sample_rate_t const sample_rate = 2;
+    std::string const identifier = "0";
+    path::channel const ch_path{path::timeline{root_path, identifier, sample_rate}, 1};
+
+    auto module0 = proc::make_signal_module<int64_t>(1);
+    module0->connect_output(proc::to_connector_index(proc::constant::output::value), 0);
+    auto track = proc::track::make_shared();
+    track->push_back_module(module0, {0, 4});
+    auto timeline = proc::timeline::make_shared({{0, track}});
+
+    auto exporter = exporter::make_shared(root_path, queue, priority);
+    exporter->set_profiling_enabled(true);
+    exporter->set_timeline_container(timeline_container::make_shared(identifier, sample_rate, timeline));
+
+    queue->wait_until_all_tasks_are_finished();
+
+    exporter->reset_profile_report();
+
+    exporter->begin_edit();
+    exporter->begin_edit();
+
+    auto module1 = proc::make_signal_module<int64_t>(2);
+    module1->connect_output(proc::to_connector_index(proc::constant::output::value), 1);
+    track->push_back_module(module1, {0, 1});
+
+    auto module2 = proc::make_signal_module<int64_t>(3);
+    module2->connect_output(proc::to_connector_index(proc::constant::output::value), 1);
+    track->push_back_module(module2, {3, 1});
+
+    exporter->commit_edit();
+
+    XCTAssertTrue(exporter->is_editing());
+
+    queue->wait_until_all_tasks_are_finished();
+
+    // 編集中は書き出さない
+    XCTAssertEqual(exporter->profile_report().tracks.size(), 0);
+
+    exporter->commit_edit();
+
+    XCTAssertFalse(exporter->is_editing());
+
+    queue->wait_until_all_tasks_are_finished();
+
+    // 2つのフラグメントを1回ずつ処理する
+    auto const report = exporter->profile_report();
+    XCTAssertEqual(report.tracks.at(0).process_count, 2);
+    XCTAssertEqual(report.tracks.at(0).frame_count, 4);
+
+    int64_t value = 0;
+
+    auto const frag0_path_value = path::signal_event{path::fragment{ch_path, 0}, {0, 1}, typeid(int64_t)}.value();
+    XCTAssertTrue(signal_file::read(frag0_path_value, &value, sizeof(value)));
+    XCTAssertEqual(value, 2);
+
+    auto const frag1_path_value = path::signal_event{path::fragment{ch_path, 1}, {3, 1}, typeid(int64_t)}.value();
+    XCTAssertTrue(signal_file::read(frag1_path_value, &value, sizeof(value)));
+    XCTAssertEqual(value, 3);
+}
+
+- (void)test_replace_timeline_with_diff {
+    std::string const &root_path = self->_cpp.root_path;
+    auto const &queue = self->_cpp.queue;
+    exporter::task_priority_t const &priority = self->_cpp.priority;
+    sample_rate_t const sample_rate = 2;
+    std::string const identifier = "0";
+    path::channel const ch_path{path::timeline{root_path, identifier, sample_rate}, 0};
+
+    auto module0 = proc::make_signal_module<int64_t>(1);
+    module0->connect_output(proc::to_connector_index(proc::constant::output::value), 0);
+    auto module1 = proc::make_signal_module<int64_t>(2);
+    module1->connect_output(proc::to_connector_index(proc::constant::output::value), 0);
+
+    auto pre_track0 = proc::track::make_shared();
+    pre_track0->push_back_module(module0, {0, 2});
+    auto pre_track1 = proc::track::make_shared();
+    pre_track1->push_back_module(module1, {4, 2});
+    auto pre_timeline = proc::timeline::make_shared({{0, pre_track0}, {1, pre_track1}});
+
+    auto exporter = exporter::make_shared(root_path, queue, priority);
+    exporter->set_profiling_enabled(true);
+    exporter->set_timeline_container(timeline_container::make_shared(identifier, sample_rate, pre_timeline));
+
+    queue->wait_until_all_tasks_are_finished();
+
+    XCTAssertEqual(exporter->profile_report().fragments.size(), 3);
+
+    exporter->reset_profile_report();
+
+    auto module2 = proc::make_signal_module<int64_t>(3);
+    module2->connect_output(proc::to_connector_index(proc::constant::output::value), 0);
+
+    // module0はそのまま使い、module1だけを差し替えたタイムラインを作り直す
+    auto post_track0 = proc::track::make_shared();
+    post_track0->push_back_module(module0, {0, 2});
+    auto post_track1 = proc::track::make_shared();
+    post_track1->push_back_module(module2, {4, 2});
+    auto post_timeline = proc::timeline::make_shared({{0, post_track0}, {1, post_track1}});
+
+    exporter->set_timeline_container(timeline_container::make_shared(identifier, sample_rate, post_timeline));
+
+    queue->wait_until_all_tasks_are_finished();
+
+    auto const report = exporter->profile_report();
+    XCTAssertEqual(report.fragments.size(), 1);
+    XCTAssertEqual(report.fragments.count(2), 1);
+
+    XCTAssertTrue(file_manager::content_exists(path::fragment{ch_path, 0}.value()));
+
+    int64_t values[2] = {0, 0};
+    auto const signal_path_value = path::signal_event{path::fragment{ch_path, 2}, {4, 2}, typeid(int64_t)}.value();
+    XCTAssertTrue(signal_file::read(signal_path_value, values, sizeof(values)));
+    XCTAssertEqual(values[0], 3);
+    XCTAssertEqual(values[1], 3);
+}
+
+- (void)test_replace_timeline_with_module_key {
+    std::string const &root_path = self->_cpp.root_path;
+    auto const &queue = self->_cpp.queue;
+    exporter::task_priority_t const &priority = self->_cpp.priority;
+    sample_rate_t const sample_rate = 2;
+    std::string const identifier = "0";
+    path::channel const ch_path{path::timeline{root_path, identifier, sample_rate}, 0};
+
+    // アプリ側でモジュールを作るときに内容を表すキーを付けておく
+    std::map<proc::module const *, std::string> keys;
+    auto const make_module = [&keys](int64_t const value) {
+        auto module = proc::make_signal_module<int64_t>(value);
+        module->connect_output(proc::to_connector_index(proc::constant::output::value), 0);
+        keys.insert_or_assign(module.get(), std::to_string(value));
+        return module;
+    };
+    auto const make_timeline = [&make_module](int64_t const value0, int64_t const value1) {
+        auto track0 = proc::track::make_shared();
+        track0->push_back_module(make_module(value0), {0, 2});
+        auto track1 = proc::track::make_shared();
+        track1->push_back_module(make_module(value1), {4, 2});
+        return proc::timeline::make_shared({{0, track0}, {1, track1}});
+    };
+
+    auto exporter = exporter::make_shared(root_path, queue, priority);
+    exporter->set_profiling_enabled(true);
+    exporter->set_module_key_handler([&keys](proc::module_ptr const &module) -> std::optional<std::string> {
+        if (auto const iterator = keys.find(module.get()); iterator != keys.end()) {
+            return iterator->second;
+        }
+        return std::nullopt;
+    });
+    exporter->set_timeline_container(timeline_container::make_shared(identifier, sample_rate, make_timeline(1, 2)));
+
+    queue->wait_until_all_tasks_are_finished();
+
+    XCTAssertEqual(exporter->profile_report().fragments.size(), 3);
+
+    exporter->reset_profile_report();
+
+    // 全てのモジュールを作り直しても、キーが変わったところだけを書き出す
+    exporter->set_timeline_container(timeline_container::make_shared(identifier, sample_rate, make_timeline(1, 3)));
+
+    queue->wait_until_all_tasks_are_finished();
+
+    auto const report = exporter->profile_report();
+    XCTAssertEqual(report.fragments.size(), 1);
+    XCTAssertEqual(report.fragments.count(2), 1);
+
+    int64_t values[2] = {0, 0};
+    auto const signal_path_value = path::signal_event{path::fragment{ch_path, 2}, {4, 2}, typeid(int64_t)}.value();
+    XCTAssertTrue(signal_file::read(signal_path_value, values, sizeof(values)));
+    XCTAssertEqual(values[0], 3);
+    XCTAssertEqual(values[1], 3);
+}
+
+- (void)test_history {
+    std::string const &root_path = self->_cpp.root_path;
+    auto const &queue = self->_cpp.queue;
+    exporter::task_priority_t const &priority = self->_cpp.priority;
+    sample_rate_t const sample_rate = 2;
+    std::string const identifier = "0";
+    path::timeline const tl_path{root_path, identifier, sample_rate};
+    path::fragment const frag_path{path::channel{tl_path, 0}, 0};
+    auto const signal_path_value = path::signal_event{frag_path, {0, 2}, typeid(int64_t)}.value();
+
+    auto module = proc::make_signal_module<int64_t>(1);
+    module->connect_output(proc::to_connector_index(proc::constant::output::value), 0);
+    auto track = proc::track::make_shared();
+    track->push_back_module(module, {0, 2});
+    auto timeline = proc::timeline::make_shared({{0, track}});
+
+    auto exporter = exporter::make_shared(root_path, queue, priority);
+    exporter->set_history_capacity(4);
+    exporter->set_profiling_enabled(true);
+    exporter->set_timeline_container(timeline_container::make_shared(identifier, sample_rate, timeline));
+
+    queue->wait_until_all_tasks_are_finished();
+
+    XCTAssertTrue(file_manager::content_exists(signal_path_value));
+
+    track->erase_modules_for_range({0, 2});
+
+    queue->wait_until_all_tasks_are_finished();
+
+    XCTAssertFalse(file_manager::content_exists(signal_path_value));
+    XCTAssertTrue(file_manager::content_exists(path::history{tl_path}.value()));
+
+    exporter->reset_profile_report();
+
+    // 同じモジュールを戻すと残しておいたフラグメントが使われる
+    track->push_back_module(module, {0, 2});
+
+    queue->wait_until_all_tasks_are_finished();
+
+    XCTAssertEqual(exporter->profile_report().fragments.size(), 0);
+    XCTAssertTrue(file_manager::content_exists(signal_path_value));
+
+    int64_t values[2] = {0, 0};
+    XCTAssertTrue(signal_file::read(signal_path_value, values, sizeof(values)));
+    XCTAssertEqual(values[0], 1);
+    XCTAssertEqual(values[1], 1);
+
+    // 別のモジュールであれば処理し直す
+    track->erase_modules_for_range({0, 2});
+
+    auto other_module = proc::make_signal_module<int64_t>(1);
+    other_module->connect_output(proc::to_connector_index(proc::constant::output::value), 0);
+    track->push_back_module(other_module, {0, 2});
+
+    queue->wait_until_all_tasks_are_finished();
+
+    XCTAssertEqual(exporter->profile_report().fragments.size(), 1);
+    XCTAssertTrue(file_manager::content_exists(signal_path_value));
+}
+
+- (void)test_history_with_module_key {
+    std::string const &root_path = self->_cpp.root_path;
+    auto const &queue = self->_cpp.queue;
+    exporter::task_priority_t const &priority = self->_cpp.priority;
+    sample_rate_t const sample_rate = 2;
+    std::string const identifier = "0";
+    path::timeline const tl_path{root_path, identifier, sample_rate};
+    path::fragment const frag_path{path::channel{tl_path, 0}, 0};
+    auto const signal_path_value = path::signal_event{frag_path, {0, 2}, typeid(int64_t)}.value();
+
+    std::map<proc::module const *, std::string> keys;
+    auto const make_module = [&keys](int64_t const value) {
+        auto module = proc::make_signal_module<int64_t>(value);
+        module->connect_output(proc::to_connector_index(proc::constant::output::value), 0);
+        keys.insert_or_assign(module.get(), std::to_string(value));
+        return module;
+    };
+
+    auto track = proc::track::make_shared();
+    track->push_back_module(make_module(1), {0, 2});
+    auto timeline = proc::timeline::make_shared({{0, track}});
+
+    auto exporter = exporter::make_shared(root_path, queue, priority);
+    exporter->set_history_capacity(4);
+    exporter->set_profiling_enabled(true);
+    exporter->set_module_key_handler([&keys](proc::module_ptr const &module) -> std::optional<std::string> {
+        return keys.at(module.get());
+    });
+    exporter->set_timeline_container(timeline_container::make_shared(identifier, sample_rate, timeline));
+
+    queue->wait_until_all_tasks_are_finished();
+
+    track->erase_modules_for_range({0, 2});
+    track->push_back_module(make_module(2), {0, 2});
+
+    queue->wait_until_all_tasks_are_finished();
+
+    exporter->reset_profile_report();
+
+    // 元に戻すときにモジュールを作り直しても、キーが同じなら残しておいたフラグメントが使われる
+    track->erase_modules_for_range({0, 2});
+    track->push_back_module(make_module(1), {0, 2});
+
+    queue->wait_until_all_tasks_are_finished();
+
+    XCTAssertEqual(exporter->profile_report().fragments.size(), 0);
+
+    int64_t values[2] = {0, 0};
+    XCTAssertTrue(signal_file::read(signal_path_value, values, sizeof(values)));
+    XCTAssertEqual(values[0], 1);
+    XCTAssertEqual(values[1], 1);
+}
+
 - (void)test_method_to_string {
     XCTAssertEqual(to_string(exporter::method_t::reset), "reset");
     XCTAssertEqual(to_string(exporter::method_t::export_began), "export_began");
+    XCTAssertEqual(to_string(exporter::method_t::export_progressed), "export_progressed");
     XCTAssertEqual(to_string(exporter::method_t::export_ended), "export_ended");
 }
 
@@ -372,6 +1252,9 @@ struct cpp {
     XCTAssertEqual(to_string(exporter::error_t::write_signal_failed), "write_signal_failed");
     XCTAssertEqual(to_string(exporter::error_t::write_numbers_failed), "write_numbers_failed");
     XCTAssertEqual(to_string(exporter::error_t::get_content_paths_failed), "get_content_paths_failed");
+    XCTAssertEqual(to_string(exporter::error_t::write_manifest_failed), "write_manifest_failed");
+    XCTAssertEqual(to_string(exporter::error_t::stash_fragment_failed), "stash_fragment_failed");
+    XCTAssertEqual(to_string(exporter::error_t::restore_fragment_failed), "restore_fragment_failed");
 }
 
 @end
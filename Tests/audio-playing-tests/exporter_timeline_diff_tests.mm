@@ -0,0 +1,220 @@
+//
+//  exporter_timeline_diff_tests.mm
+//
+
+#import <XCTest/XCTest.h>
+#import <audio-playing/umbrella.hpp>
+#import <audio-processing/umbrella.hpp>
+#import <cpp-utils/fast_each.h>
+
+using namespace yas;
+using namespace yas::playing;
+
+@interface exporter_timeline_diff_tests : XCTestCase
+
+@end
+
+@implementation exporter_timeline_diff_tests
+
+- (void)test_changed_ranges {
+    auto module0 = proc::make_signal_module<int64_t>(0);
+    auto module1 = proc::make_signal_module<int64_t>(1);
+    auto module2 = proc::make_signal_module<int64_t>(2);
+    auto const module_key = [&module0, &module1](proc::module_ptr const &module) -> std::string {
+        return module == module0 ? "0" : (module == module1 ? "1" : "2");
+    };
+
+    auto pre_track0 = proc::track::make_shared();
+    pre_track0->push_back_module(module0, {0, 2});
+    pre_track0->push_back_module(module1, {4, 2});
+    auto pre_track1 = proc::track::make_shared();
+    pre_track1->push_back_module(module0, {10, 1});
+
+    auto post_track0 = proc::track::make_shared();
+    post_track0->push_back_module(module0, {0, 2});
+    post_track0->push_back_module(module2, {4, 2});
+    post_track0->push_back_module(module0, {8, 1});
+    auto post_track2 = proc::track::make_shared();
+    post_track2->push_back_module(module0, {20, 3});
+
+    auto const pre = exporter_timeline_diff::make_signature("a", 2, {{0, pre_track0}, {1, pre_track1}}, module_key);
+    auto const post =
+        exporter_timeline_diff::make_signature("a", 2, {{0, post_track0}, {2, post_track2}}, module_key);
+
+    auto const ranges = exporter_timeline_diff::changed_ranges(pre, post);
+
+    XCTAssertTrue(ranges.has_value());
+    XCTAssertEqual(ranges->size(), 4);
+    XCTAssertEqual(ranges->at(0), (proc::time::range{4, 2}));
+    XCTAssertEqual(ranges->at(1), (proc::time::range{8, 1}));
+    XCTAssertEqual(ranges->at(2), (proc::time::range{10, 1}));
+    XCTAssertEqual(ranges->at(3), (proc::time::range{20, 3}));
+}
+
+- (void)test_no_changes {
+    auto module0 = proc::make_signal_module<int64_t>(0);
+
+    auto track = proc::track::make_shared();
+    track->push_back_module(module0, {0, 2});
+
+    auto const signature =
+        exporter_timeline_diff::make_signature("a", 2, {{0, track}}, [](proc::module_ptr const &) { return "0"; });
+
+    auto const ranges = exporter_timeline_diff::changed_ranges(signature, signature);
+
+    XCTAssertTrue(ranges.has_value());
+    XCTAssertEqual(ranges->size(), 0);
+}
+
+- (void)test_no_changes_with_rebuilt_modules {
+    auto const module_key = [](proc::module_ptr const &) { return "0"; };
+
+    auto pre_track = proc::track::make_shared();
+    pre_track->push_back_module(proc::make_signal_module<int64_t>(0), {0, 2});
+    auto const pre = exporter_timeline_diff::make_signature("a", 2, {{0, pre_track}}, module_key);
+
+    // 別のインスタンスでもキーが同じなら変わっていない
+    auto post_track = proc::track::make_shared();
+    post_track->push_back_module(proc::make_signal_module<int64_t>(0), {0, 2});
+    auto const post = exporter_timeline_diff::make_signature("a", 2, {{0, post_track}}, module_key);
+
+    auto const ranges = exporter_timeline_diff::changed_ranges(pre, post);
+
+    XCTAssertTrue(ranges.has_value());
+    XCTAssertEqual(ranges->size(), 0);
+}
+
+- (void)test_signature_does_not_retain_modules {
+    auto module = proc::make_signal_module<int64_t>(0);
+    std::weak_ptr<proc::module> weak_module = module;
+
+    auto track = proc::track::make_shared();
+    track->push_back_module(std::move(module), {0, 2});
+
+    auto const signature =
+        exporter_timeline_diff::make_signature("a", 2, {{0, track}}, [](proc::module_ptr const &) { return "0"; });
+
+    track = nullptr;
+
+    XCTAssertTrue(weak_module.expired());
+    XCTAssertEqual(signature.tracks.at(0).at({0, 2}), (std::vector<std::string>{"0"}));
+}
+
+- (void)test_fragment_revision {
+    auto module0 = proc::make_signal_module<int64_t>(0);
+    auto module1 = proc::make_signal_module<int64_t>(1);
+
+    auto track = proc::track::make_shared();
+    track->push_back_module(module0, {0, 2});
+    track->push_back_module(module1, {0, 2});
+    track->push_back_module(module0, {4, 2});
+
+    auto const module_key = [&module0](proc::module_ptr const &module) -> std::string {
+        return module == module0 ? "10" : "11";
+    };
+    auto const signature = exporter_timeline_diff::make_signature("a", 2, {{3, track}}, module_key);
+
+    XCTAssertEqual(exporter_timeline_diff::fragment_revision(signature, {0, 2}), "3:0:2:2=10,2=11,;");
+    XCTAssertEqual(exporter_timeline_diff::fragment_revision(signature, {2, 2}), "");
+    XCTAssertEqual(exporter_timeline_diff::fragment_revision(signature, {1, 4}), "3:0:2:2=10,2=11,;3:4:2:2=10,;");
+}
+
+- (void)test_fragment_revisions {
+    auto module0 = proc::make_signal_module<int64_t>(0);
+    auto module1 = proc::make_signal_module<int64_t>(1);
+
+    auto track = proc::track::make_shared();
+    track->push_back_module(module0, {0, 2});
+    track->push_back_module(module1, {0, 2});
+    track->push_back_module(module0, {3, 4});
+
+    auto const module_key = [&module0](proc::module_ptr const &module) -> std::string {
+        return module == module0 ? "10" : "11";
+    };
+    auto const signature = exporter_timeline_diff::make_signature("a", 2, {{3, track}}, module_key);
+
+    auto const revisions = exporter_timeline_diff::fragment_revisions(signature, {.index = 0, .length = 5}, 2);
+
+    XCTAssertEqual(revisions.size(), 5);
+    XCTAssertEqual(revisions.at(0), "3:0:2:2=10,2=11,;");
+    XCTAssertEqual(revisions.at(1), "3:3:4:2=10,;");
+    XCTAssertEqual(revisions.at(2), "3:3:4:2=10,;");
+    XCTAssertEqual(revisions.at(3), "3:3:4:2=10,;");
+    XCTAssertEqual(revisions.at(4), "");
+
+    auto each = make_fast_each(fragment_index_t(0), fragment_index_t(5));
+    while (yas_each_next(each)) {
+        auto const &frag_idx = yas_each_index(each);
+        XCTAssertEqual(revisions.at(frag_idx),
+                       exporter_timeline_diff::fragment_revision(signature, {frag_idx * 2, 2}));
+    }
+}
+
+- (void)test_update_track {
+    auto const module_key = [](proc::module_ptr const &) { return "0"; };
+
+    auto track0 = proc::track::make_shared();
+    track0->push_back_module(proc::make_signal_module<int64_t>(0), {0, 2});
+    proc::timeline::track_map_t tracks{{0, track0}};
+
+    auto signature = exporter_timeline_diff::make_signature("a", 2, tracks, module_key);
+
+    auto track1 = proc::track::make_shared();
+    track1->push_back_module(proc::make_signal_module<int64_t>(0), {4, 2});
+    tracks.emplace(1, track1);
+
+    exporter_timeline_diff::update_track(signature, 1, tracks, module_key);
+
+    XCTAssertEqual(signature.tracks.size(), 2);
+    XCTAssertEqual(signature.tracks.at(1).size(), 1);
+    XCTAssertEqual(signature.tracks.at(1).count({4, 2}), 1);
+
+    tracks.erase(0);
+
+    exporter_timeline_diff::update_track(signature, 0, tracks, module_key);
+
+    XCTAssertEqual(signature.tracks.size(), 1);
+    XCTAssertEqual(signature.tracks.count(0), 0);
+}
+
+- (void)test_update_module_set {
+    auto module0 = proc::make_signal_module<int64_t>(0);
+    auto module1 = proc::make_signal_module<int64_t>(1);
+    auto const module_key = [&module0](proc::module_ptr const &module) -> std::string {
+        return module == module0 ? "0" : "1";
+    };
+
+    auto track = proc::track::make_shared();
+    track->push_back_module(module0, {0, 2});
+    track->push_back_module(module0, {4, 2});
+    proc::timeline::track_map_t const tracks{{0, track}};
+
+    auto signature = exporter_timeline_diff::make_signature("a", 2, tracks, module_key);
+
+    track->push_back_module(module1, {4, 2});
+
+    exporter_timeline_diff::update_module_set(signature, 0, {4, 2}, tracks, module_key);
+
+    XCTAssertEqual(signature.tracks.at(0).at({0, 2}), (std::vector<std::string>{"0"}));
+    XCTAssertEqual(signature.tracks.at(0).at({4, 2}), (std::vector<std::string>{"0", "1"}));
+
+    track->erase_modules_for_range({0, 2});
+
+    exporter_timeline_diff::update_module_set(signature, 0, {0, 2}, tracks, module_key);
+
+    XCTAssertEqual(signature.tracks.at(0).count({0, 2}), 0);
+    XCTAssertEqual(signature.tracks.at(0).count({4, 2}), 1);
+}
+
+- (void)test_different_identifier_or_sample_rate {
+    auto const module_key = [](proc::module_ptr const &) { return ""; };
+    auto const signature = exporter_timeline_diff::make_signature("a", 2, {}, module_key);
+
+    auto const other_identifier = exporter_timeline_diff::make_signature("b", 2, {}, module_key);
+    auto const other_sample_rate = exporter_timeline_diff::make_signature("a", 3, {}, module_key);
+
+    XCTAssertFalse(exporter_timeline_diff::changed_ranges(signature, other_identifier).has_value());
+    XCTAssertFalse(exporter_timeline_diff::changed_ranges(signature, other_sample_rate).has_value());
+}
+
+@end
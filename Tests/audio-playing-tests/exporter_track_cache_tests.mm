@@ -0,0 +1,92 @@
+//
+//  exporter_track_cache_tests.mm
+//
+
+#import <XCTest/XCTest.h>
+#import <audio-playing/umbrella.hpp>
+#import <audio-processing/umbrella.hpp>
+
+using namespace yas;
+using namespace yas::playing;
+
+@interface exporter_track_cache_tests : XCTestCase
+
+@end
+
+@implementation exporter_track_cache_tests
+
+- (void)test_disabled {
+    auto const cache = exporter_track_cache::make_shared();
+
+    XCTAssertFalse(cache->is_enabled());
+
+    proc::stream stream{proc::sync_source{2, 2}};
+    cache->store({0, 2}, {{0, 1}}, stream);
+
+    XCTAssertEqual(cache->size(), 0);
+    XCTAssertFalse(cache->find({0, 2}, {{0, 1}}).has_value());
+}
+
+- (void)test_find_deepest_matched_track {
+    auto const cache = exporter_track_cache::make_shared();
+    cache->set_capacity(4);
+
+    proc::stream stream{proc::sync_source{2, 2}};
+    auto &channel = stream.add_channel(0);
+    auto event = proc::signal_event::make_shared<int16_t>(2);
+    event->data<int16_t>()[0] = 5;
+    channel.insert_event(proc::time::range{0, 2}, event);
+
+    cache->store({0, 2}, {{0, 1}}, stream);
+    cache->store({0, 2}, {{0, 1}, {1, 2}}, stream);
+
+    // 後から書き換えられても保持しているものには影響しない
+    event->data<int16_t>()[0] = 6;
+
+    auto const hit = cache->find({0, 2}, {{0, 1}, {1, 2}, {2, 3}});
+    XCTAssertTrue(hit.has_value());
+    XCTAssertEqual(hit->track_index, 1);
+
+    auto const &events = hit->stream->channel(0).filtered_events<proc::signal_event>();
+    XCTAssertEqual(events.size(), 1);
+    XCTAssertEqual(events.begin()->second->data<int16_t>()[0], 5);
+
+    auto const upstream_changed = cache->find({0, 2}, {{0, 1}, {1, 4}});
+    XCTAssertTrue(upstream_changed.has_value());
+    XCTAssertEqual(upstream_changed->track_index, 0);
+
+    XCTAssertFalse(cache->find({0, 2}, {{0, 5}}).has_value());
+    XCTAssertFalse(cache->find({2, 2}, {{0, 1}}).has_value());
+    XCTAssertFalse(cache->find({0, 1}, {{0, 1}}).has_value());
+}
+
+- (void)test_capacity {
+    auto const cache = exporter_track_cache::make_shared();
+    cache->set_capacity(2);
+
+    proc::stream stream{proc::sync_source{2, 2}};
+
+    cache->store({0, 2}, {{0, 1}}, stream);
+    cache->store({2, 2}, {{0, 1}}, stream);
+
+    XCTAssertTrue(cache->find({0, 2}, {{0, 1}}).has_value());
+
+    cache->store({4, 2}, {{0, 1}}, stream);
+
+    XCTAssertEqual(cache->size(), 2);
+    XCTAssertTrue(cache->find({0, 2}, {{0, 1}}).has_value());
+    XCTAssertFalse(cache->find({2, 2}, {{0, 1}}).has_value());
+    XCTAssertTrue(cache->find({4, 2}, {{0, 1}}).has_value());
+
+    cache->set_capacity(0);
+
+    XCTAssertEqual(cache->size(), 0);
+
+    cache->set_capacity(2);
+    cache->store({0, 2}, {{0, 1}}, stream);
+    cache->clear();
+
+    XCTAssertEqual(cache->size(), 0);
+}
+
+@end
@@ -0,0 +1,99 @@
+//
+//  exporter_trash_tests.mm
+//
+
+#import <XCTest/XCTest.h>
+#import <audio-playing/umbrella.hpp>
+#import <cpp-utils/file_manager.h>
+#import <fstream>
+#import "test_utils.h"
+
+using namespace yas;
+using namespace yas::playing;
+
+namespace yas::playing::exporter_trash_test {
+struct cpp {
+    std::filesystem::path const root_path = test_utils::root_path();
+    std::filesystem::path const trash_path = std::filesystem::path{test_utils::root_path()}.concat("_trash");
+};
+}  // namespace yas::playing::exporter_trash_test
+
+@interface exporter_trash_tests : XCTestCase
+
+@end
+
+@implementation exporter_trash_tests {
+    exporter_trash_test::cpp _cpp;
+}
+
+- (void)setUp {
+    file_manager::remove_content(self->_cpp.root_path);
+    file_manager::remove_content(self->_cpp.trash_path);
+}
+
+- (void)tearDown {
+    file_manager::remove_content(self->_cpp.root_path);
+    file_manager::remove_content(self->_cpp.trash_path);
+}
+
+- (void)test_move_and_collect {
+    auto const &root_path = self->_cpp.root_path;
+    auto const &trash_path = self->_cpp.trash_path;
+
+    auto const dir_path = std::filesystem::path{root_path}.append("a").append("b");
+    XCTAssertTrue(file_manager::create_directory_if_not_exists(dir_path));
+
+    for (std::size_t idx = 0; idx < 100; ++idx) {
+        std::ofstream{std::filesystem::path{dir_path}.append(std::to_string(idx))} << idx;
+    }
+
+    auto const trash = exporter_trash::make_shared(trash_path);
+
+    XCTAssertTrue(trash->move(std::filesystem::path{root_path}.append("a")));
+
+    XCTAssertFalse(file_manager::content_exists(std::filesystem::path{root_path}.append("a")));
+    XCTAssertTrue(file_manager::content_exists(root_path));
+    XCTAssertTrue(file_manager::content_exists(trash_path));
+
+    trash->collect();
+    trash->wait_until_collected();
+
+    XCTAssertFalse(file_manager::content_exists(trash_path));
+}
+
+- (void)test_move_not_exists {
+    auto const trash = exporter_trash::make_shared(self->_cpp.trash_path);
+
+    XCTAssertTrue(trash->move(std::filesystem::path{self->_cpp.root_path}.append("a")));
+    XCTAssertFalse(file_manager::content_exists(self->_cpp.trash_path));
+}
+
+- (void)test_sibling_path {
+    XCTAssertEqual(exporter_trash::sibling_path("/a/b"), "/a/b_trash");
+    XCTAssertEqual(exporter_trash::sibling_path("/a/b/"), "/a/b_trash", @"末尾の区切り文字は取り除く");
+    XCTAssertEqual(exporter_trash::sibling_path("/a/b//"), "/a/b_trash");
+    XCTAssertEqual(exporter_trash::sibling_path("a/./b/"), "a/b_trash");
+}
+
+- (void)test_collect_remaining {
+    auto const &trash_path = self->_cpp.trash_path;
+
+    // 前回消しきれずに残っていたもの
+    XCTAssertTrue(file_manager::create_directory_if_not_exists(std::filesystem::path{trash_path}.append("1")));
+
+    auto const trash = exporter_trash::make_shared(trash_path);
+
+    auto const src_path = std::filesystem::path{self->_cpp.root_path}.append("a");
+    XCTAssertTrue(file_manager::create_directory_if_not_exists(src_path));
+
+    // 名前が重ならないように移す
+    XCTAssertTrue(trash->move(src_path));
+    XCTAssertFalse(file_manager::content_exists(src_path));
+
+    trash->collect();
+    trash->wait_until_collected();
+
+    XCTAssertFalse(file_manager::content_exists(trash_path));
+}
+
+@end
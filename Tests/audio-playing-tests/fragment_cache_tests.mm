@@ -0,0 +1,142 @@
+//
+//  fragment_cache_tests.mm
+//
+
+#import <XCTest/XCTest.h>
+#import <audio-playing/umbrella.hpp>
+#import <audio-processing/umbrella.hpp>
+
+using namespace yas;
+using namespace yas::playing;
+
+namespace yas::playing::fragment_cache_test {
+static fragment_cache::signal_events_t make_events(float const value) {
+    auto const signal = proc::signal_event::make_shared<float>(2);
+    signal->data<float>()[0] = value;
+    signal->data<float>()[1] = value;
+    return {{proc::time::range{0, 2}, signal}};
+}
+}  // namespace yas::playing::fragment_cache_test
+
+@interface fragment_cache_tests : XCTestCase
+
+@end
+
+@implementation fragment_cache_tests
+
+- (void)test_initial {
+    auto const cache = fragment_cache::make_shared();
+
+    XCTAssertEqual(cache->capacity(), 0);
+    XCTAssertFalse(cache->is_enabled());
+    XCTAssertEqual(cache->size(), 0);
+}
+
+- (void)test_store_and_find {
+    auto const cache = fragment_cache::make_shared();
+    cache->set_capacity(2);
+
+    XCTAssertTrue(cache->is_enabled());
+
+    cache->store("a", fragment_cache_test::make_events(1.0f));
+
+    XCTAssertEqual(cache->size(), 1);
+
+    auto const found = cache->find("a");
+    XCTAssertTrue(found.has_value());
+    XCTAssertEqual(found->size(), 1);
+    XCTAssertEqual(found->at(0).first, (proc::time::range{0, 2}));
+    XCTAssertEqual(found->at(0).second->data<float>()[0], 1.0f);
+
+    XCTAssertFalse(cache->find("b").has_value());
+
+    // 同じキーなら置き換える
+    cache->store("a", fragment_cache_test::make_events(2.0f));
+
+    XCTAssertEqual(cache->size(), 1);
+    XCTAssertEqual(cache->find("a")->at(0).second->data<float>()[0], 2.0f);
+}
+
+- (void)test_store_disabled {
+    auto const cache = fragment_cache::make_shared();
+
+    cache->store("a", fragment_cache_test::make_events(1.0f));
+
+    XCTAssertEqual(cache->size(), 0);
+    XCTAssertFalse(cache->find("a").has_value());
+}
+
+- (void)test_evict_persisted {
+    auto const cache = fragment_cache::make_shared();
+    cache->set_capacity(1);
+
+    cache->store("a", fragment_cache_test::make_events(1.0f));
+    cache->store("b", fragment_cache_test::make_events(2.0f));
+
+    // persistされるまでは消さない
+    XCTAssertEqual(cache->size(), 2);
+
+    cache->persist("b");
+
+    // 書き終わったものから消す
+    XCTAssertEqual(cache->size(), 1);
+    XCTAssertTrue(cache->find("a").has_value());
+    XCTAssertFalse(cache->find("b").has_value());
+
+    cache->persist("a");
+
+    XCTAssertEqual(cache->size(), 1);
+    XCTAssertTrue(cache->find("a").has_value());
+}
+
+- (void)test_evict_least_recently_used {
+    auto const cache = fragment_cache::make_shared();
+    cache->set_capacity(2);
+
+    cache->store("a", fragment_cache_test::make_events(1.0f));
+    cache->persist("a");
+    cache->store("b", fragment_cache_test::make_events(2.0f));
+    cache->persist("b");
+
+    // 読まれたものは残す
+    XCTAssertTrue(cache->find("a").has_value());
+
+    cache->store("c", fragment_cache_test::make_events(3.0f));
+    cache->persist("c");
+
+    XCTAssertEqual(cache->size(), 2);
+    XCTAssertTrue(cache->find("a").has_value());
+    XCTAssertFalse(cache->find("b").has_value());
+    XCTAssertTrue(cache->find("c").has_value());
+}
+
+- (void)test_erase_and_clear {
+    auto const cache = fragment_cache::make_shared();
+    cache->set_capacity(4);
+
+    cache->store("a", fragment_cache_test::make_events(1.0f));
+    cache->store("b", fragment_cache_test::make_events(2.0f));
+
+    cache->erase("a");
+
+    XCTAssertFalse(cache->find("a").has_value());
+    XCTAssertTrue(cache->find("b").has_value());
+
+    cache->clear();
+
+    XCTAssertEqual(cache->size(), 0);
+}
+
+- (void)test_set_capacity_zero {
+    auto const cache = fragment_cache::make_shared();
+    cache->set_capacity(4);
+
+    cache->store("a", fragment_cache_test::make_events(1.0f));
+
+    cache->set_capacity(0);
+
+    XCTAssertFalse(cache->is_enabled());
+    XCTAssertEqual(cache->size(), 0);
+}
+
+@end
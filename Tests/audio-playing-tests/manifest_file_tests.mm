@@ -0,0 +1,86 @@
+//
+//  manifest_file_tests.mm
+//
+
+#import <XCTest/XCTest.h>
+#import <audio-playing/umbrella.hpp>
+#import <cpp-utils/file_manager.h>
+#import <cpp-utils/file_path.h>
+#import <fstream>
+#import "test_utils.h"
+
+using namespace yas;
+using namespace yas::playing;
+
+@interface manifest_file_tests : XCTestCase
+
+@end
+
+@implementation manifest_file_tests
+
+- (void)setUp {
+    file_manager::remove_content(test_utils::root_path());
+}
+
+- (void)tearDown {
+    file_manager::remove_content(test_utils::root_path());
+}
+
+- (void)test_write_and_read {
+    XCTAssertTrue(file_manager::create_directory_if_not_exists(test_utils::root_path()));
+
+    auto const path = file_path{test_utils::root_path()}.appending("manifest").string();
+
+    manifest_file::manifest const manifest{.identifier = "0",
+                                           .sample_rate = 48000,
+                                           .fingerprint = "a b c",
+                                           .storage = "float32 1:int16",
+                                           .fragment_indices = {-2, -1, 0, 3, 5, 6}};
+
+    XCTAssertTrue(manifest_file::write(path, manifest));
+    XCTAssertFalse(file_manager::content_exists(path + ".tmp"));
+
+    auto const result = manifest_file::read(path);
+
+    XCTAssertTrue(result);
+    XCTAssertEqual(result.value(), manifest);
+}
+
+- (void)test_write_empty {
+    XCTAssertTrue(file_manager::create_directory_if_not_exists(test_utils::root_path()));
+
+    auto const path = file_path{test_utils::root_path()}.appending("manifest").string();
+
+    manifest_file::manifest const manifest{.identifier = "1", .sample_rate = 2, .fingerprint = ""};
+
+    XCTAssertTrue(manifest_file::write(path, manifest));
+
+    auto const result = manifest_file::read(path);
+
+    XCTAssertTrue(result);
+    XCTAssertEqual(result.value(), manifest);
+}
+
+- (void)test_read_failed {
+    XCTAssertTrue(file_manager::create_directory_if_not_exists(test_utils::root_path()));
+
+    auto const path = file_path{test_utils::root_path()}.appending("manifest").string();
+
+    XCTAssertEqual(manifest_file::read(path).error(), manifest_file::read_error::open_stream_failed);
+
+    {
+        std::ofstream stream{path};
+        stream << "playing_manifest 1\n";
+    }
+
+    XCTAssertEqual(manifest_file::read(path).error(), manifest_file::read_error::invalid_version);
+
+    {
+        std::ofstream stream{path};
+        stream << "playing_manifest 2\nidentifier 0\nsample_rate 2\nfingerprint a\nstorage as_is\nfragments 2\n0 1\n";
+    }
+
+    XCTAssertEqual(manifest_file::read(path).error(), manifest_file::read_error::invalid_format);
+}
+
+@end
@@ -35,6 +35,27 @@ using namespace yas::playing;
     XCTAssertTrue((path::timeline{"/root", "0", 48000}) != (path::timeline{"/root", "0", 48001}));
 }
 
+- (void)test_timeline_with_fragment_length {
+    path::timeline tl_path{"/root", "0", 48000, 4800};
+
+    XCTAssertEqual(tl_path.fragment_length, 4800);
+    XCTAssertEqual(tl_path.resolved_fragment_length(), 4800);
+    XCTAssertEqual(tl_path.value().string(), "/root/0_48000_4800");
+    XCTAssertEqual((path::manifest{tl_path}).value().string(), "/root/0_48000_4800.manifest");
+    XCTAssertEqual((path::history{tl_path}).value().string(), "/root/0_48000_4800.history");
+
+    // 1秒の長さなら今までと同じパスになる
+    XCTAssertEqual((path::timeline{"/root", "0", 48000, 48000}).value().string(), "/root/0_48000");
+    XCTAssertEqual((path::timeline{"/root", "0", 48000}).resolved_fragment_length(), 48000);
+}
+
+- (void)test_timeline_equal_with_fragment_length {
+    XCTAssertTrue((path::timeline{"/root", "0", 48000, 4800}) == (path::timeline{"/root", "0", 48000, 4800}));
+    XCTAssertFalse((path::timeline{"/root", "0", 48000, 4800}) == (path::timeline{"/root", "0", 48000, 2400}));
+    XCTAssertFalse((path::timeline{"/root", "0", 48000, 4800}) == (path::timeline{"/root", "0", 48000}));
+    XCTAssertTrue((path::timeline{"/root", "0", 48000, 48000}) == (path::timeline{"/root", "0", 48000}));
+}
+
 - (void)test_channel {
     path::timeline tl_path{"/root", "0", 48000};
     path::channel ch_path{tl_path, 1};
@@ -139,8 +160,52 @@ using namespace yas::playing;
     XCTAssertTrue((path::number_events{frag_path_1a}) != (path::number_events{frag_path_2}));
 }
 
+- (void)test_manifest {
+    path::timeline tl_path{"/root", "0", 48000};
+    path::manifest manifest_path{tl_path};
+
+    XCTAssertEqual(manifest_path.value().string(), "/root/0_48000.manifest");
+}
+
+- (void)test_manifest_equal {
+    path::timeline const tl_path_1a{"/root", "0", 48000};
+    path::timeline const tl_path_1b{"/root", "0", 48000};
+    path::timeline const tl_path_2{"/root", "0", 44100};
+
+    XCTAssertTrue((path::manifest{tl_path_1a}) == (path::manifest{tl_path_1b}));
+    XCTAssertFalse((path::manifest{tl_path_1a}) == (path::manifest{tl_path_2}));
+
+    XCTAssertFalse((path::manifest{tl_path_1a}) != (path::manifest{tl_path_1b}));
+    XCTAssertTrue((path::manifest{tl_path_1a}) != (path::manifest{tl_path_2}));
+}
+
+- (void)test_history {
+    path::timeline tl_path{"/root", "0", 48000};
+    path::history history_path{tl_path};
+
+    XCTAssertEqual(history_path.value().string(), "/root/0_48000.history");
+    XCTAssertEqual((path::history_version{history_path, 3}).value().string(), "/root/0_48000.history/3");
+}
+
+- (void)test_history_equal {
+    path::timeline const tl_path_1a{"/root", "0", 48000};
+    path::timeline const tl_path_1b{"/root", "0", 48000};
+    path::timeline const tl_path_2{"/root", "0", 44100};
+
+    XCTAssertTrue((path::history{tl_path_1a}) == (path::history{tl_path_1b}));
+    XCTAssertFalse((path::history{tl_path_1a}) == (path::history{tl_path_2}));
+    XCTAssertTrue((path::history_version{{tl_path_1a}, 1}) == (path::history_version{{tl_path_1b}, 1}));
+    XCTAssertFalse((path::history_version{{tl_path_1a}, 1}) == (path::history_version{{tl_path_1a}, 2}));
+
+    XCTAssertFalse((path::history{tl_path_1a}) != (path::history{tl_path_1b}));
+    XCTAssertTrue((path::history_version{{tl_path_1a}, 1}) != (path::history_version{{tl_path_2}, 1}));
+}
+
 - (void)test_timeline_name {
     XCTAssertEqual(path::timeline_name("testid", 48000), "testid_48000");
+    XCTAssertEqual(path::timeline_name("testid", 48000, 0), "testid_48000");
+    XCTAssertEqual(path::timeline_name("testid", 48000, 48000), "testid_48000");
+    XCTAssertEqual(path::timeline_name("testid", 48000, 4800), "testid_48000_4800");
 }
 
 - (void)test_channel_name {
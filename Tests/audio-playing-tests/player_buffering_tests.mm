@@ -24,7 +24,7 @@ using namespace yas::playing;
 - (void)test_setup_state_initial {
     audio::pcm_buffer buffer = player_test::cpp::make_out_buffer();
 
-    self->_cpp.skip_reading();
+    self->_cpp.setup_initial();
 
     auto const &buffering = self->_cpp.buffering;
 
@@ -47,7 +47,7 @@ using namespace yas::playing;
 - (void)test_setup_state_creating {
     audio::pcm_buffer buffer = player_test::cpp::make_out_buffer();
 
-    self->_cpp.skip_reading();
+    self->_cpp.setup_initial();
 
     auto const &buffering = self->_cpp.buffering;
 
@@ -67,7 +67,7 @@ using namespace yas::playing;
 - (void)test_setup_state_rendering {
     audio::pcm_buffer buffer = player_test::cpp::make_out_buffer();
 
-    self->_cpp.skip_reading();
+    self->_cpp.setup_initial();
 
     auto const &buffering = self->_cpp.buffering;
 
@@ -179,6 +179,30 @@ using namespace yas::playing;
     XCTAssertEqual(called_current_frame, 2);
     XCTAssertEqual(called_set_all_writing.size(), 3);
     XCTAssertEqual(called_set_current_frame.size(), 1);
+
+    // ループで折り返した位置から書き込み直す
+
+    buffering->looped_frame_on_render_handler = [](frame_index_t const frame) { return frame - 80; };
+
+    self->_cpp.rendering_handler(&buffer);
+
+    XCTAssertEqual(called_current_frame, 3);
+    XCTAssertEqual(called_set_all_writing.size(), 4);
+    XCTAssertEqual(called_set_all_writing.at(3), 20);
+    XCTAssertEqual(called_set_current_frame.size(), 2);
+    XCTAssertEqual(called_set_current_frame.at(1), 20);
+
+    // シークもループの範囲に収めてから書き込む
+
+    seek_frame = 200;
+    needs_all_writing = false;
+
+    self->_cpp.rendering_handler(&buffer);
+
+    XCTAssertEqual(called_set_all_writing.size(), 5);
+    XCTAssertEqual(called_set_all_writing.at(4), 120);
+    XCTAssertEqual(called_set_current_frame.size(), 3);
+    XCTAssertEqual(called_set_current_frame.at(2), 120);
 }
 
 - (void)test_rendering_state_all_writing {
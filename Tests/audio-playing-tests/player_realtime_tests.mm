@@ -0,0 +1,334 @@
+//
+//  player_realtime_tests.mm
+//
+
+#import <XCTest/XCTest.h>
+#import <cpp-utils/file_manager.h>
+#import "player_test_utils.h"
+#import "render_guard_test_utils.h"
+
+using namespace yas;
+using namespace yas::playing;
+
+namespace yas::playing::player_realtime_test {
+struct cpp {
+    static sample_rate_t constexpr sample_rate = 4;
+    static uint32_t constexpr ch_count = 2;
+    static uint32_t constexpr length = 2;
+
+    worker_stub_ptr const worker = worker_stub::make_shared();
+    std::shared_ptr<player_test::renderer> const renderer = std::make_shared<player_test::renderer>();
+    buffering_resource_ptr const buffering = buffering_resource::make_shared(
+        3, test_utils::root_path(),
+        [](std::size_t const element_count, audio::format const &format, sample_rate_t const frag_length) {
+            return playing::make_buffering_channel(element_count, format, frag_length);
+        });
+    player_resource_ptr const resource = player_resource::make_shared(this->buffering);
+
+    player_ptr player = nullptr;
+    renderer_rendering_f rendering_handler = nullptr;
+    audio::pcm_buffer out_buffer{audio::format{{.sample_rate = sample_rate,
+                                                .pcm_format = audio::pcm_format::float32,
+                                                .channel_count = ch_count,
+                                                .interleaved = false}},
+                                 length};
+
+    void setup() {
+        this->renderer->set_rendering_handler_handler = [this](renderer_rendering_f &&handler) {
+            this->rendering_handler = std::move(handler);
+        };
+
+        this->player = player::make_shared(test_utils::root_path(), this->renderer, this->worker,
+                                           {.setup = 100, .rendering = 101}, this->resource);
+
+        this->worker->start();
+    }
+
+    // レンダリングの処理だけをガードする。ガード中はXCTAssertなどを呼ばない
+    void render() {
+        this->render(&this->out_buffer);
+    }
+
+    void render(audio::pcm_buffer *const buffer) {
+        render_guard_test::scope const guard;
+        this->rendering_handler(buffer);
+    }
+
+    // initial → creating → rendering → all_writing → advancing と進める
+    void setup_advancing() {
+        this->setup();
+        this->player->set_playing(true);
+
+        this->render();
+        this->worker->process();
+        this->render();
+        this->worker->process();
+    }
+};
+}  // namespace yas::playing::player_realtime_test
+
+@interface player_realtime_tests : XCTestCase
+
+@end
+
+@implementation player_realtime_tests {
+    player_realtime_test::cpp _cpp;
+}
+
+- (void)setUp {
+    file_manager::remove_content(test_utils::root_path());
+    render_guard_test::reset();
+}
+
+- (void)tearDown {
+    self->_cpp.player = nullptr;
+    self->_cpp.rendering_handler = nullptr;
+    file_manager::remove_content(test_utils::root_path());
+}
+
+- (void)test_detect_allocation {
+    if (render_guard_test::is_realtime_sanitized()) {
+        XCTSkip(@"RealtimeSanitizerでは見つけたところで止まる");
+    }
+
+    {
+        render_guard_test::scope const guard;
+        auto const value = std::make_unique<int>(1);
+    }
+
+    XCTAssertEqual(render_guard_test::violation_count(), 2);
+
+    auto const report = render_guard_test::report();
+    XCTAssertNotEqual(report.find("allocation size : "), std::string::npos);
+    XCTAssertNotEqual(report.find("deallocation"), std::string::npos);
+
+    render_guard_test::reset();
+
+    {
+        render_guard_test::scope const guard;
+        int value = 1;
+        value += 1;
+    }
+
+    XCTAssertEqual(render_guard_test::violation_count(), 0, @"メモリを確保しなければ記録されない");
+}
+
+- (void)test_setup_states {
+    auto &cpp = self->_cpp;
+    cpp.setup();
+    cpp.player->set_playing(true);
+
+    XCTAssertEqual(cpp.buffering->setup_state(), buffering_resource::setup_state_t::initial);
+
+    cpp.render();
+
+    XCTAssertEqual(cpp.buffering->setup_state(), buffering_resource::setup_state_t::creating);
+
+    cpp.worker->process();
+
+    XCTAssertEqual(cpp.buffering->setup_state(), buffering_resource::setup_state_t::rendering);
+    XCTAssertEqual(cpp.buffering->rendering_state(), buffering_resource::rendering_state_t::waiting);
+
+    cpp.render();
+
+    XCTAssertEqual(cpp.buffering->rendering_state(), buffering_resource::rendering_state_t::all_writing);
+
+    cpp.worker->process();
+
+    XCTAssertEqual(cpp.buffering->rendering_state(), buffering_resource::rendering_state_t::advancing);
+
+    cpp.render();
+
+    XCTAssertEqual(cpp.player->current_frame(), player_realtime_test::cpp::length);
+
+    XCTAssertEqual(render_guard_test::violation_count(), 0, @"%s", render_guard_test::report().c_str());
+    XCTAssertEqual(cpp.player->pull_render_errors().total(), 0);
+}
+
+- (void)test_advancing {
+    auto &cpp = self->_cpp;
+    cpp.setup_advancing();
+
+    XCTAssertEqual(cpp.buffering->rendering_state(), buffering_resource::rendering_state_t::advancing);
+
+    // フラグメントをまたいでエレメントを進めながら書き込む
+    for (std::size_t idx = 0; idx < 32; ++idx) {
+        cpp.render();
+        cpp.worker->process();
+    }
+
+    XCTAssertEqual(cpp.player->current_frame(), 32 * player_realtime_test::cpp::length);
+    XCTAssertEqual(cpp.buffering->rendering_state(), buffering_resource::rendering_state_t::advancing);
+
+    XCTAssertEqual(render_guard_test::violation_count(), 0, @"%s", render_guard_test::report().c_str());
+    XCTAssertEqual(cpp.player->pull_render_errors().total(), 0);
+}
+
+- (void)test_change_out_length {
+    auto &cpp = self->_cpp;
+    cpp.setup_advancing();
+
+    cpp.render();
+
+    XCTAssertEqual(cpp.player->current_frame(), player_realtime_test::cpp::length);
+
+    audio::pcm_buffer longer_buffer{cpp.out_buffer.format(), player_realtime_test::cpp::length * 2};
+
+    // 出力の長さが変わっても作り直しを待たずにそのまま鳴らす
+    cpp.render(&longer_buffer);
+
+    XCTAssertEqual(cpp.player->current_frame(), player_realtime_test::cpp::length * 3);
+    XCTAssertEqual(cpp.buffering->rendering_state(), buffering_resource::rendering_state_t::advancing);
+
+    XCTAssertEqual(render_guard_test::violation_count(), 0, @"%s", render_guard_test::report().c_str());
+    XCTAssertEqual(cpp.player->pull_render_errors().total(), 0);
+}
+
+- (void)test_seek {
+    auto &cpp = self->_cpp;
+    cpp.setup_advancing();
+
+    cpp.render();
+    cpp.worker->process();
+
+    cpp.player->seek(100);
+
+    cpp.render();
+
+    XCTAssertEqual(cpp.buffering->rendering_state(), buffering_resource::rendering_state_t::all_writing);
+    XCTAssertEqual(cpp.player->current_frame(), 100);
+
+    cpp.worker->process();
+    cpp.render();
+
+    XCTAssertEqual(cpp.buffering->rendering_state(), buffering_resource::rendering_state_t::advancing);
+    XCTAssertEqual(cpp.player->current_frame(), 100 + player_realtime_test::cpp::length);
+
+    cpp.player->seek(-7);
+
+    for (std::size_t idx = 0; idx < 8; ++idx) {
+        cpp.render();
+        cpp.worker->process();
+    }
+
+    XCTAssertEqual(cpp.player->current_frame(), -7 + 7 * player_realtime_test::cpp::length);
+
+    XCTAssertEqual(render_guard_test::violation_count(), 0, @"%s", render_guard_test::report().c_str());
+    XCTAssertEqual(cpp.player->pull_render_errors().total(), 0);
+}
+
+- (void)test_overwrite {
+    auto &cpp = self->_cpp;
+    cpp.setup_advancing();
+
+    cpp.player->overwrite(std::nullopt, {.index = 0, .length = 2});
+    cpp.player->overwrite(1, {.index = 1, .length = 1});
+
+    for (std::size_t idx = 0; idx < 8; ++idx) {
+        cpp.render();
+        cpp.worker->process();
+    }
+
+    // 最初は上書き中のエレメントを読めないので進まない
+    XCTAssertEqual(cpp.player->current_frame(), 7 * player_realtime_test::cpp::length);
+    XCTAssertEqual(cpp.buffering->rendering_state(), buffering_resource::rendering_state_t::advancing);
+
+    XCTAssertEqual(render_guard_test::violation_count(), 0, @"%s", render_guard_test::report().c_str());
+    XCTAssertEqual(cpp.player->pull_render_errors().total(), 0);
+}
+
+- (void)test_overwrite_keeping_reading {
+    auto &cpp = self->_cpp;
+    cpp.setup_advancing();
+
+    cpp.render();
+    cpp.worker->process();
+
+    XCTAssertEqual(cpp.player->current_frame(), player_realtime_test::cpp::length);
+
+    // 書き出し途中のものが届いたところで、フラグメントをまたいで読み込む
+    cpp.player->overwrite_keeping_reading(std::nullopt, {.index = 0, .length = 3});
+
+    audio::pcm_buffer longer_buffer{cpp.out_buffer.format(), player_realtime_test::cpp::length * 2};
+    cpp.render(&longer_buffer);
+
+    XCTAssertEqual(cpp.player->current_frame(), player_realtime_test::cpp::length * 3,
+                   @"読み込み中のエレメントは上書きされないので途切れない");
+
+    for (std::size_t idx = 0; idx < 8; ++idx) {
+        cpp.worker->process();
+        cpp.render();
+
+        XCTAssertEqual(cpp.player->current_frame(), frame_index_t(player_realtime_test::cpp::length * (4 + idx)));
+    }
+
+    XCTAssertEqual(cpp.buffering->rendering_state(), buffering_resource::rendering_state_t::advancing);
+
+    XCTAssertEqual(render_guard_test::violation_count(), 0, @"%s", render_guard_test::report().c_str());
+    XCTAssertEqual(cpp.player->pull_render_errors().total(), 0);
+}
+
+- (void)test_loop {
+    auto &cpp = self->_cpp;
+    cpp.setup_advancing();
+
+    // フラグメント2個分（8フレーム）をループする
+    cpp.player->set_fragment_loop_range(fragment_range{.index = 0, .length = 2});
+
+    for (std::size_t idx = 0; idx < 32; ++idx) {
+        cpp.render();
+        cpp.worker->process();
+
+        auto const current_frame = cpp.player->current_frame();
+        XCTAssertGreaterThanOrEqual(current_frame, 0);
+        XCTAssertLessThan(current_frame, 2 * player_realtime_test::cpp::sample_rate);
+    }
+
+    XCTAssertEqual(cpp.buffering->rendering_state(), buffering_resource::rendering_state_t::advancing);
+
+    XCTAssertEqual(render_guard_test::violation_count(), 0, @"%s", render_guard_test::report().c_str());
+    XCTAssertEqual(cpp.player->pull_render_errors().total(), 0);
+}
+
+- (void)test_seek_before_loop {
+    auto &cpp = self->_cpp;
+    cpp.setup_advancing();
+
+    // フラグメント1から2個分（4から12フレーム）をループする
+    cpp.player->set_fragment_loop_range(fragment_range{.index = 1, .length = 2});
+
+    cpp.render();
+    cpp.worker->process();
+
+    XCTAssertEqual(cpp.player->current_frame(), player_realtime_test::cpp::sample_rate, @"範囲より前にいたら先頭へ移る");
+
+    cpp.player->seek(-3);
+
+    for (std::size_t idx = 0; idx < 32; ++idx) {
+        cpp.render();
+        cpp.worker->process();
+
+        auto const current_frame = cpp.player->current_frame();
+        XCTAssertGreaterThanOrEqual(current_frame, player_realtime_test::cpp::sample_rate);
+        XCTAssertLessThan(current_frame, 3 * player_realtime_test::cpp::sample_rate);
+    }
+
+    XCTAssertEqual(render_guard_test::violation_count(), 0, @"%s", render_guard_test::report().c_str());
+    XCTAssertEqual(cpp.player->pull_render_errors().total(), 0);
+}
+
+- (void)test_rendering_performance {
+    auto &cpp = self->_cpp;
+    cpp.setup_advancing();
+
+    [self measureBlock:^{
+        for (std::size_t idx = 0; idx < 1000; ++idx) {
+            self->_cpp.render();
+            self->_cpp.worker->process();
+        }
+    }];
+
+    XCTAssertEqual(render_guard_test::violation_count(), 0, @"%s", render_guard_test::report().c_str());
+}
+
+@end
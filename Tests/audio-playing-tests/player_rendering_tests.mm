@@ -17,6 +17,57 @@ using namespace yas::playing;
     player_test::cpp _cpp;
 }
 
+- (void)test_interleaved_out_buffer {
+    audio::format const format{{.sample_rate = player_test::cpp::sample_rate,
+                                .pcm_format = player_test::cpp::pcm_format,
+                                .channel_count = player_test::cpp::ch_count,
+                                .interleaved = true}};
+    audio::pcm_buffer buffer{format, player_test::cpp::length};
+
+    self->_cpp.setup_initial();
+
+    std::vector<render_error> called_errors;
+    std::size_t called_setup_state = 0;
+
+    self->_cpp.resource->add_render_error_handler = [&called_errors](render_error error) {
+        called_errors.emplace_back(error);
+    };
+    self->_cpp.buffering->setup_state_handler = [&called_setup_state] {
+        ++called_setup_state;
+        return audio_buffering_setup_state::initial;
+    };
+
+    XCTAssertNoThrow(self->_cpp.rendering_handler(&buffer));
+
+    XCTAssertEqual(called_errors.size(), 1);
+    XCTAssertEqual(called_errors.at(0), render_error::interleaved_out_buffer);
+    XCTAssertEqual(called_setup_state, 0, @"エラーを数えたら何もせずに戻る");
+}
+
+- (void)test_zero_length_out_buffer {
+    audio::pcm_buffer buffer = player_test::cpp::make_out_buffer();
+    buffer.set_frame_length(0);
+
+    self->_cpp.setup_initial();
+
+    std::vector<render_error> called_errors;
+    std::size_t called_setup_state = 0;
+
+    self->_cpp.resource->add_render_error_handler = [&called_errors](render_error error) {
+        called_errors.emplace_back(error);
+    };
+    self->_cpp.buffering->setup_state_handler = [&called_setup_state] {
+        ++called_setup_state;
+        return audio_buffering_setup_state::initial;
+    };
+
+    XCTAssertNoThrow(self->_cpp.rendering_handler(&buffer));
+
+    XCTAssertEqual(called_errors.size(), 1);
+    XCTAssertEqual(called_errors.at(0), render_error::zero_length);
+    XCTAssertEqual(called_setup_state, 0);
+}
+
 - (void)test_pull {
     audio::pcm_buffer buffer = player_test::cpp::make_out_buffer();
 
@@ -70,13 +121,14 @@ using namespace yas::playing;
     auto const &resource = self->_cpp.resource;
     auto const &buffering = self->_cpp.buffering;
 
-    std::vector<player_test::resource::overwrite_requests_f> called_perform;
+    std::vector<std::pair<fragment_range, player_test::resource::overwrite_requests_f>> called_perform;
     std::size_t called_is_playing = 0;
-    std::vector<element_address> called_addresses;
+    std::vector<std::pair<element_address, fragment_range>> called_addresses;
 
     resource->perform_overwrite_requests_handler =
-        [&called_perform](player_test::resource::overwrite_requests_f const &handler) {
-            called_perform.emplace_back(handler);
+        [&called_perform](fragment_range const &reading_range,
+                          player_test::resource::overwrite_requests_f const &handler) {
+            called_perform.emplace_back(reading_range, handler);
         };
 
     resource->is_playing_handler = [&called_is_playing] {
@@ -84,24 +136,57 @@ using namespace yas::playing;
         return false;
     };
 
-    buffering->overwrite_element_handler = [&called_addresses](element_address const &address) {
-        called_addresses.emplace_back(address);
+    buffering->overwrite_element_handler = [&called_addresses](element_address const &address,
+                                                               fragment_range const &reading_range) {
+        called_addresses.emplace_back(address, reading_range);
     };
 
     self->_cpp.rendering_handler(&buffer);
 
     XCTAssertEqual(called_perform.size(), 1);
+    XCTAssertEqual(called_perform.at(0).first, (fragment_range{0, 0}), @"再生していなければ読み込む範囲はない");
     XCTAssertEqual(called_is_playing, 1);
 
-    std::vector<element_address> const requests{{1, 2}, {3, 4}};
+    std::vector<element_address> const requests{{1, 2}, {3, 4, true}};
 
     XCTAssertEqual(called_addresses.size(), 0);
 
-    called_perform.at(0)(requests);
+    called_perform.at(0).second(requests, {5, 1});
 
     XCTAssertEqual(called_addresses.size(), 2);
-    XCTAssertEqual(called_addresses.at(0), (element_address{1, 2}));
-    XCTAssertEqual(called_addresses.at(1), (element_address{3, 4}));
+    XCTAssertEqual(called_addresses.at(0).first, (element_address{1, 2}));
+    XCTAssertEqual(called_addresses.at(0).second, (fragment_range{5, 1}));
+    XCTAssertEqual(called_addresses.at(1).first, (element_address{3, 4, true}));
+    XCTAssertEqual(called_addresses.at(1).second, (fragment_range{5, 1}));
+}
+
+- (void)test_perform_overwrite_requests_while_playing {
+    audio::pcm_buffer buffer = player_test::cpp::make_out_buffer();
+
+    self->_cpp.skip_pull();
+
+    auto const &resource = self->_cpp.resource;
+    auto const &buffering = self->_cpp.buffering;
+
+    std::vector<fragment_range> called_perform;
+
+    resource->perform_overwrite_requests_handler =
+        [&called_perform](fragment_range const &reading_range, player_test::resource::overwrite_requests_f const &) {
+            called_perform.emplace_back(reading_range);
+        };
+    resource->is_playing_handler = [] { return true; };
+    resource->current_frame_handler = [] { return frame_index_t(3); };
+    resource->set_current_frame_handler = [](frame_index_t) {};
+    buffering->fragment_length_handler = [] { return 4; };
+    buffering->channel_count_handler = [] { return 1; };
+    buffering->read_into_channel_handler = [](audio::pcm_buffer *, channel_index_t, uint32_t, frame_index_t,
+                                              uint32_t) { return true; };
+    buffering->advance_handler = [](fragment_index_t) {};
+
+    self->_cpp.rendering_handler(&buffer);
+
+    XCTAssertEqual(called_perform.size(), 1);
+    XCTAssertEqual(called_perform.at(0), (fragment_range{0, 2}), @"フラグメントをまたいで読み込むところを渡す");
 }
 
 - (void)test_is_playing {
@@ -110,35 +195,39 @@ using namespace yas::playing;
     self->_cpp.skip_pull();
 
     auto const &resource = self->_cpp.resource;
-    auto const &reading = self->_cpp.reading;
+    auto const &buffering = self->_cpp.buffering;
 
     bool is_playing = false;
     std::size_t called_is_playing = 0;
-    std::size_t called_buffer = 0;
+    std::size_t called_current_frame = 0;
 
-    resource->perform_overwrite_requests_handler = [](player_test::resource::overwrite_requests_f const &) {};
+    resource->perform_overwrite_requests_handler = [](fragment_range const &,
+                                                      player_test::resource::overwrite_requests_f const &) {};
 
     resource->is_playing_handler = [&is_playing, &called_is_playing] {
         ++called_is_playing;
         return is_playing;
     };
 
-    reading->buffer_handler = [&called_buffer] {
-        ++called_buffer;
-        return nullptr;
+    resource->current_frame_handler = [&called_current_frame] {
+        ++called_current_frame;
+        return 0;
     };
+    resource->set_current_frame_handler = [](frame_index_t) {};
+    buffering->fragment_length_handler = [] { return 4; };
+    buffering->channel_count_handler = [] { return 0; };
 
     self->_cpp.rendering_handler(&buffer);
 
     XCTAssertEqual(called_is_playing, 1);
-    XCTAssertEqual(called_buffer, 0);
+    XCTAssertEqual(called_current_frame, 0);
 
     is_playing = true;
 
     self->_cpp.rendering_handler(&buffer);
 
     XCTAssertEqual(called_is_playing, 2);
-    XCTAssertEqual(called_buffer, 1);
+    XCTAssertEqual(called_current_frame, 1);
 }
 
 - (void)test_rendering {
@@ -157,9 +246,10 @@ using namespace yas::playing;
     resource->current_frame_handler = [&current_frame] { return current_frame; };
     buffering->fragment_length_handler = [] { return 4; };
     buffering->channel_count_handler = [] { return 3; };
-    buffering->read_into_buffer_handler = [&called_read_into](audio::pcm_buffer *buffer, channel_index_t ch_idx,
-                                                              frame_index_t frame_idx) {
-        player_test::cpp::fill_buffer(buffer, ch_idx, frame_idx);
+    buffering->read_into_channel_handler = [&called_read_into](audio::pcm_buffer *buffer, channel_index_t ch_idx,
+                                                               uint32_t to_frame, frame_index_t frame_idx,
+                                                               uint32_t length) {
+        player_test::cpp::fill_channel(buffer, ch_idx, to_frame, frame_idx, length);
         called_read_into.emplace_back(ch_idx, frame_idx);
         return true;
     };
@@ -194,6 +284,48 @@ using namespace yas::playing;
     XCTAssertEqual(data2[1], 2001);
 }
 
+- (void)test_rendering_before_loop {
+    auto buffer = self->_cpp.make_out_buffer();
+
+    self->_cpp.skip_playing();
+
+    auto const &resource = self->_cpp.resource;
+    auto const &buffering = self->_cpp.buffering;
+
+    std::size_t called_reset_overwrite = 0;
+    std::vector<frame_index_t> called_set_current_frame;
+    std::vector<frame_index_t> called_set_all_writing;
+    std::size_t called_read_into = 0;
+
+    resource->current_frame_handler = [] { return frame_index_t(-3); };
+    buffering->fragment_length_handler = [] { return 4; };
+    buffering->channel_count_handler = [] { return 1; };
+    buffering->looped_frame_on_render_handler = [](frame_index_t const frame) {
+        return std::max(frame, frame_index_t(4));
+    };
+    resource->reset_overwrite_requests_handler = [&called_reset_overwrite] { ++called_reset_overwrite; };
+    resource->set_current_frame_handler = [&called_set_current_frame](frame_index_t frame) {
+        called_set_current_frame.emplace_back(frame);
+    };
+    buffering->set_all_writing_handler = [&called_set_all_writing](frame_index_t frame) {
+        called_set_all_writing.emplace_back(frame);
+    };
+    buffering->read_into_channel_handler = [&called_read_into](audio::pcm_buffer *, channel_index_t, uint32_t,
+                                                               frame_index_t, uint32_t) {
+        ++called_read_into;
+        return true;
+    };
+
+    self->_cpp.rendering_handler(&buffer);
+
+    XCTAssertEqual(called_reset_overwrite, 1);
+    XCTAssertEqual(called_set_current_frame.size(), 1);
+    XCTAssertEqual(called_set_current_frame.at(0), 4);
+    XCTAssertEqual(called_set_all_writing.size(), 1);
+    XCTAssertEqual(called_set_all_writing.at(0), 4);
+    XCTAssertEqual(called_read_into, 0);
+}
+
 - (void)test_rendering_advance {
     auto buffer = self->_cpp.make_out_buffer();
 
@@ -210,9 +342,10 @@ using namespace yas::playing;
     resource->current_frame_handler = [&current_frame] { return current_frame; };
     buffering->fragment_length_handler = [] { return 1; };
     buffering->channel_count_handler = [] { return 3; };
-    buffering->read_into_buffer_handler = [&called_read_into](audio::pcm_buffer *buffer, channel_index_t ch_idx,
-                                                              frame_index_t frame_idx) {
-        player_test::cpp::fill_buffer(buffer, ch_idx, frame_idx);
+    buffering->read_into_channel_handler = [&called_read_into](audio::pcm_buffer *buffer, channel_index_t ch_idx,
+                                                               uint32_t to_frame, frame_index_t frame_idx,
+                                                               uint32_t length) {
+        player_test::cpp::fill_channel(buffer, ch_idx, to_frame, frame_idx, length);
         called_read_into.emplace_back(ch_idx, frame_idx);
         return true;
     };
@@ -273,9 +406,10 @@ using namespace yas::playing;
     resource->current_frame_handler = [&current_frame] { return current_frame; };
     buffering->fragment_length_handler = [] { return 4; };
     buffering->channel_count_handler = [] { return 1; };
-    buffering->read_into_buffer_handler = [&called_read_into](audio::pcm_buffer *buffer, channel_index_t ch_idx,
-                                                              frame_index_t frame_idx) {
-        player_test::cpp::fill_buffer(buffer, ch_idx, frame_idx);
+    buffering->read_into_channel_handler = [&called_read_into](audio::pcm_buffer *buffer, channel_index_t ch_idx,
+                                                               uint32_t to_frame, frame_index_t frame_idx,
+                                                               uint32_t length) {
+        player_test::cpp::fill_channel(buffer, ch_idx, to_frame, frame_idx, length);
         called_read_into.emplace_back(ch_idx, frame_idx);
         return true;
     };
@@ -322,15 +456,16 @@ using namespace yas::playing;
     resource->current_frame_handler = [&current_frame] { return current_frame; };
     buffering->fragment_length_handler = [] { return 1; };
     buffering->channel_count_handler = [] { return 3; };
-    buffering->read_into_buffer_handler = [&called_read_into](audio::pcm_buffer *buffer, channel_index_t ch_idx,
-                                                              frame_index_t frame_idx) {
+    buffering->read_into_channel_handler = [&called_read_into](audio::pcm_buffer *buffer, channel_index_t ch_idx,
+                                                               uint32_t to_frame, frame_index_t frame_idx,
+                                                               uint32_t length) {
         called_read_into.emplace_back(ch_idx, frame_idx);
 
         if (frame_idx != 30) {
             return false;
         }
 
-        player_test::cpp::fill_buffer(buffer, ch_idx, frame_idx);
+        player_test::cpp::fill_channel(buffer, ch_idx, to_frame, frame_idx, length);
         return true;
     };
     buffering->advance_handler = [&called_advance](fragment_index_t frag_idx) {
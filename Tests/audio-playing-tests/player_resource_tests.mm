@@ -9,29 +9,9 @@ using namespace yas;
 using namespace yas::playing;
 
 namespace yas::playing::player_resource_test {
-struct reading_resource : reading_resource_for_player_resource {
-    state_t state() const override {
-        return state_t::initial;
-    }
-
-    audio::pcm_buffer *buffer_on_render() override {
-        return nullptr;
-    }
-
-    bool needs_create_on_render(sample_rate_t const sample_rate, audio::pcm_format const pcm_format,
-                                uint32_t const length) const override {
-        return false;
-    }
-
-    void set_creating_on_render(sample_rate_t const sample_rate, audio::pcm_format const pcm_format,
-                                uint32_t const length) override {
-    }
-
-    void create_buffer_on_task() override {
-    }
-};
-
 struct buffering_resource : buffering_resource_for_player_resource {
+    render_error_counts render_errors;
+
     setup_state_t setup_state() const override {
         return setup_state_t::initial;
     }
@@ -68,13 +48,29 @@ struct buffering_resource : buffering_resource_for_player_resource {
     bool write_elements_if_needed_on_task() override {
         return false;
     }
-    void overwrite_element_on_render(element_address const &) override {
+    void overwrite_element_on_render(element_address const &, fragment_range const &) override {
     }
 
     bool read_into_buffer_on_render(audio::pcm_buffer *, channel_index_t const, frame_index_t const) override {
         return false;
     }
 
+    bool read_into_channel_on_render(audio::pcm_buffer *, channel_index_t const, uint32_t const, frame_index_t const,
+                                     uint32_t const) override {
+        return false;
+    }
+
+    bool read_into_channels_on_render(audio::pcm_buffer *, uint32_t const, frame_index_t const,
+                                      uint32_t const) override {
+        return false;
+    }
+
+    render_error_counts pull_render_errors() override {
+        auto counts = this->render_errors;
+        this->render_errors = {};
+        return counts;
+    }
+
     bool needs_all_writing_on_render() const override {
         return false;
     }
@@ -82,14 +78,27 @@ struct buffering_resource : buffering_resource_for_player_resource {
     }
     void set_identifier_request_on_main(std::string const &) override {
     }
+    void set_element_count_request_on_main(std::size_t const) override {
+    }
+    void set_fragment_length_request_on_main(sample_rate_t const) override {
+    }
+    void set_depth_policy_request_on_main(std::optional<buffering_depth_policy> const &) override {
+    }
+    void set_loop_range_request_on_main(std::optional<fragment_range> const &) override {
+    }
+    frame_index_t looped_frame_on_render(frame_index_t const frame) const override {
+        return frame;
+    }
+    frame_index_t looped_frame_on_main(frame_index_t const frame) const override {
+        return frame;
+    }
 };
 
 struct cpp {
-    std::shared_ptr<reading_resource> const reading = std::make_shared<player_resource_test::reading_resource>();
     std::shared_ptr<buffering_resource> const buffering = std::make_shared<player_resource_test::buffering_resource>();
 
     player_resource_ptr make_resource() {
-        return player_resource::make_shared(this->reading, this->buffering);
+        return player_resource::make_shared(this->buffering);
     }
 };
 }  // namespace yas::playing::player_resource_test
@@ -105,7 +114,6 @@ struct cpp {
 - (void)test_constructor {
     auto const resource = self->_cpp.make_resource();
 
-    XCTAssertEqual(resource->reading(), self->_cpp.reading);
     XCTAssertEqual(resource->buffering(), self->_cpp.buffering);
 }
 
@@ -155,13 +163,12 @@ struct cpp {
 
     std::vector<player_resource_for_player::overwrite_requests_t> called;
 
-    auto requests = [&called](player_resource_for_player::overwrite_requests_t const &requests) {
-        called.emplace_back(requests);
-    };
+    auto requests = [&called](player_resource_for_player::overwrite_requests_t const &requests,
+                              fragment_range const &) { called.emplace_back(requests); };
 
     [XCTContext runActivityNamed:@"初期状態は実行される"
                            block:[&called, &resource, &requests](id<XCTActivity> activity) {
-                               resource->perform_overwrite_requests_on_render(requests);
+                               resource->perform_overwrite_requests_on_render({.index = 0, .length = 1}, requests);
 
                                XCTAssertEqual(called.size(), 1);
                                XCTAssertEqual(called.at(0).size(), 0);
@@ -171,7 +178,7 @@ struct cpp {
 
     [XCTContext runActivityNamed:@"実行された後は何もしなければ実行されなくなる"
                            block:[&called, &resource, &requests](id<XCTActivity> activity) {
-                               resource->perform_overwrite_requests_on_render(requests);
+                               resource->perform_overwrite_requests_on_render({.index = 0, .length = 1}, requests);
 
                                XCTAssertEqual(called.size(), 0);
                            }];
@@ -183,7 +190,7 @@ struct cpp {
                                resource->add_overwrite_request_on_main(
                                    {.file_channel_index = std::nullopt, .fragment_range = {.index = 0, .length = 1}});
 
-                               resource->perform_overwrite_requests_on_render(requests);
+                               resource->perform_overwrite_requests_on_render({.index = 0, .length = 1}, requests);
 
                                XCTAssertEqual(called.size(), 1);
                                XCTAssertEqual(called.at(0).size(), 1);
@@ -196,7 +203,7 @@ struct cpp {
 
     [XCTContext runActivityNamed:@"実行された後は何もしなければ実行されなくなる"
                            block:[&called, &resource, &requests](id<XCTActivity> activity) {
-                               resource->perform_overwrite_requests_on_render(requests);
+                               resource->perform_overwrite_requests_on_render({.index = 0, .length = 1}, requests);
 
                                XCTAssertEqual(called.size(), 0);
                            }];
@@ -208,7 +215,7 @@ struct cpp {
                                resource->add_overwrite_request_on_main(
                                    {.file_channel_index = 3, .fragment_range = {.index = 4, .length = 1}});
 
-                               resource->perform_overwrite_requests_on_render(requests);
+                               resource->perform_overwrite_requests_on_render({.index = 0, .length = 1}, requests);
 
                                XCTAssertEqual(called.size(), 1);
                                XCTAssertEqual(called.at(0).size(), 2);
@@ -229,10 +236,43 @@ struct cpp {
 
                                resource->reset_overwrite_requests_on_render();
 
-                               resource->perform_overwrite_requests_on_render(requests);
+                               resource->perform_overwrite_requests_on_render({.index = 0, .length = 1}, requests);
 
                                XCTAssertEqual(called.size(), 0);
                            }];
 }
 
+- (void)test_overwrite_request_reading_range {
+    auto const resource = self->_cpp.make_resource();
+
+    std::vector<fragment_range> called;
+
+    resource->perform_overwrite_requests_on_render(
+        {.index = 2, .length = 3},
+        [&called](player_resource_for_player::overwrite_requests_t const &, fragment_range const &reading_range) {
+            called.emplace_back(reading_range);
+        });
+
+    XCTAssertEqual(called.size(), 1);
+    XCTAssertEqual(called.at(0), (fragment_range{.index = 2, .length = 3}));
+}
+
+- (void)test_render_errors {
+    auto const resource = self->_cpp.make_resource();
+
+    XCTAssertEqual(resource->pull_render_errors().total(), 0);
+
+    resource->add_render_error_on_render(render_error::interleaved_out_buffer);
+    resource->add_render_error_on_render(render_error::interleaved_out_buffer);
+    self->_cpp.buffering->render_errors.values.at(static_cast<std::size_t>(render_error::invalid_rendering_state)) = 3;
+
+    auto const counts = resource->pull_render_errors();
+
+    XCTAssertEqual(counts.count(render_error::interleaved_out_buffer), 2);
+    XCTAssertEqual(counts.count(render_error::invalid_rendering_state), 3, @"bufferingのエラーも合わせる");
+    XCTAssertEqual(counts.total(), 5);
+
+    XCTAssertEqual(resource->pull_render_errors().total(), 0, @"取り出したら0に戻る");
+}
+
 @end
@@ -16,46 +16,12 @@ using namespace yas::playing;
     player_test::cpp _cpp;
 }
 
-- (void)test_reading {
-    self->_cpp.setup_initial();
-
-    auto const reading = self->_cpp.reading;
-    auto const buffering = self->_cpp.buffering;
-    auto const worker = self->_cpp.worker;
-
-    buffering->setup_state_handler = [] { return buffering_resource::setup_state_t::initial; };
-    buffering->rendering_state_handler = [] { return buffering_resource::rendering_state_t::waiting; };
-
-    auto state = reading_resource::state_t::initial;
-    reading->state_handler = [&state] { return state; };
-
-    std::size_t called_create_buffer = 0;
-    reading->create_buffer_handler = [&called_create_buffer] { ++called_create_buffer; };
-
-    worker->start();
-
-    worker->process();
-    XCTAssertEqual(called_create_buffer, 0);
-
-    state = reading_resource::state_t::rendering;
-
-    worker->process();
-    XCTAssertEqual(called_create_buffer, 0);
-
-    state = reading_resource::state_t::creating;
-
-    worker->process();
-    XCTAssertEqual(called_create_buffer, 1);
-}
-
 - (void)test_buffering_setup {
     self->_cpp.setup_initial();
 
-    auto const reading = self->_cpp.reading;
     auto const buffering = self->_cpp.buffering;
     auto const worker = self->_cpp.worker;
 
-    reading->state_handler = [] { return reading_resource::state_t::initial; };
     buffering->rendering_state_handler = [] { return buffering_resource::rendering_state_t::waiting; };
 
     auto state = buffering_resource::setup_state_t::initial;
@@ -83,11 +49,9 @@ using namespace yas::playing;
 - (void)test_buffering_rendering {
     self->_cpp.setup_initial();
 
-    auto const reading = self->_cpp.reading;
     auto const buffering = self->_cpp.buffering;
     auto const worker = self->_cpp.worker;
 
-    reading->state_handler = [] { return reading_resource::state_t::initial; };
     buffering->setup_state_handler = [] { return buffering_resource::setup_state_t::initial; };
 
     auto state = buffering_resource::rendering_state_t::waiting;
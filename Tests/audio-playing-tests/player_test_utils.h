@@ -28,19 +28,14 @@ struct resource : player_resource_for_player {
     std::function<void(frame_index_t)> set_current_frame_handler;
     std::function<frame_index_t(void)> current_frame_handler;
     std::function<void(element_address &&)> add_overwrite_request_handler;
-    std::function<void(overwrite_requests_f const &)> perform_overwrite_requests_handler;
+    std::function<void(fragment_range const &, overwrite_requests_f const &)> perform_overwrite_requests_handler;
     std::function<void(void)> reset_overwrite_requests_handler;
+    std::function<void(render_error)> add_render_error_handler;
+    std::function<render_error_counts(void)> pull_render_errors_handler;
 
-    std::shared_ptr<reading_resource_for_player_resource> const _reading;
     std::shared_ptr<buffering_resource_for_player_resource> const _buffering;
 
-    resource(std::shared_ptr<reading_resource_for_player_resource> const &reading,
-             std::shared_ptr<buffering_resource_for_player_resource> const &buffering)
-        : _reading(reading), _buffering(buffering) {
-    }
-
-    std::shared_ptr<reading_resource_for_player_resource> const &reading() const override {
-        return this->_reading;
+    resource(std::shared_ptr<buffering_resource_for_player_resource> const &buffering) : _buffering(buffering) {
     }
 
     std::shared_ptr<buffering_resource_for_player_resource> const &buffering() const override {
@@ -79,42 +74,21 @@ struct resource : player_resource_for_player {
         this->add_overwrite_request_handler(std::move(address));
     }
 
-    void perform_overwrite_requests_on_render(overwrite_requests_f const &handler) override {
-        this->perform_overwrite_requests_handler(handler);
+    void perform_overwrite_requests_on_render(fragment_range const &reading_range,
+                                              overwrite_requests_f const &handler) override {
+        this->perform_overwrite_requests_handler(reading_range, handler);
     }
 
     void reset_overwrite_requests_on_render() override {
         this->reset_overwrite_requests_handler();
     }
-};
-
-struct reading : reading_resource_for_player_resource {
-    std::function<state_t(void)> state_handler;
-    std::function<audio::pcm_buffer *(void)> buffer_handler;
-    std::function<bool(sample_rate_t, audio::pcm_format, uint32_t)> needs_create_handler;
-    std::function<void(sample_rate_t, audio::pcm_format, uint32_t)> set_creating_handler;
-    std::function<void(void)> create_buffer_handler;
-
-    state_t state() const override {
-        return this->state_handler();
-    }
 
-    audio::pcm_buffer *buffer_on_render() override {
-        return this->buffer_handler();
+    void add_render_error_on_render(render_error const error) override {
+        this->add_render_error_handler(error);
     }
 
-    bool needs_create_on_render(sample_rate_t const sample_rate, audio::pcm_format const pcm_format,
-                                uint32_t const length) const override {
-        return this->needs_create_handler(sample_rate, pcm_format, length);
-    }
-
-    void set_creating_on_render(sample_rate_t const sample_rate, audio::pcm_format const pcm_format,
-                                uint32_t const length) override {
-        this->set_creating_handler(sample_rate, pcm_format, length);
-    }
-
-    void create_buffer_on_task() override {
-        this->create_buffer_handler();
+    render_error_counts pull_render_errors() override {
+        return this->pull_render_errors_handler();
     }
 };
 
@@ -131,11 +105,20 @@ struct buffering : buffering_resource_for_player_resource {
     std::function<void(void)> write_all_elements_handler;
     std::function<void(fragment_index_t)> advance_handler;
     std::function<bool(void)> write_elements_if_needed_handler;
-    std::function<void(element_address const &)> overwrite_element_handler;
+    std::function<void(element_address const &, fragment_range const &)> overwrite_element_handler;
     std::function<bool(audio::pcm_buffer *, channel_index_t, frame_index_t)> read_into_buffer_handler;
+    std::function<bool(audio::pcm_buffer *, channel_index_t, uint32_t, frame_index_t, uint32_t)>
+        read_into_channel_handler;
     std::function<bool(void)> needs_all_writing_handler;
     std::function<void(channel_mapping)> set_ch_mapping_request_handler;
     std::function<void(std::string)> set_identifier_request_handler;
+    std::function<void(std::size_t)> set_element_count_request_handler;
+    std::function<void(sample_rate_t)> set_fragment_length_request_handler;
+    std::function<void(std::optional<buffering_depth_policy>)> set_depth_policy_request_handler;
+    std::function<void(std::optional<fragment_range>)> set_loop_range_request_handler;
+    std::function<frame_index_t(frame_index_t)> looped_frame_on_render_handler;
+    std::function<frame_index_t(frame_index_t)> looped_frame_on_main_handler;
+    std::function<render_error_counts(void)> pull_render_errors_handler;
 
     setup_state_t setup_state() const override {
         return this->setup_state_handler();
@@ -187,8 +170,8 @@ struct buffering : buffering_resource_for_player_resource {
         return this->write_elements_if_needed_handler();
     }
 
-    void overwrite_element_on_render(element_address const &address) override {
-        this->overwrite_element_handler(address);
+    void overwrite_element_on_render(element_address const &address, fragment_range const &reading_range) override {
+        this->overwrite_element_handler(address, reading_range);
     }
 
     bool needs_all_writing_on_render() const override {
@@ -203,10 +186,59 @@ struct buffering : buffering_resource_for_player_resource {
         this->set_identifier_request_handler(identifier);
     }
 
+    void set_element_count_request_on_main(std::size_t const element_count) override {
+        this->set_element_count_request_handler(element_count);
+    }
+
+    void set_fragment_length_request_on_main(sample_rate_t const frag_length) override {
+        this->set_fragment_length_request_handler(frag_length);
+    }
+
+    void set_depth_policy_request_on_main(std::optional<buffering_depth_policy> const &policy) override {
+        this->set_depth_policy_request_handler(policy);
+    }
+
+    void set_loop_range_request_on_main(std::optional<fragment_range> const &loop_range) override {
+        this->set_loop_range_request_handler(loop_range);
+    }
+
+    frame_index_t looped_frame_on_render(frame_index_t const frame) const override {
+        return this->looped_frame_on_render_handler(frame);
+    }
+
+    frame_index_t looped_frame_on_main(frame_index_t const frame) const override {
+        return this->looped_frame_on_main_handler(frame);
+    }
+
     bool read_into_buffer_on_render(audio::pcm_buffer *buffer, channel_index_t const ch_idx,
                                     frame_index_t const frame_idx) override {
         return this->read_into_buffer_handler(buffer, ch_idx, frame_idx);
     }
+
+    bool read_into_channel_on_render(audio::pcm_buffer *buffer, channel_index_t const ch_idx, uint32_t const to_frame,
+                                     frame_index_t const frame_idx, uint32_t const length) override {
+        return this->read_into_channel_handler(buffer, ch_idx, to_frame, frame_idx, length);
+    }
+
+    // チャンネルごとの呼び出しで確認できるように、read_into_channel_handlerを順に呼ぶ
+    bool read_into_channels_on_render(audio::pcm_buffer *buffer, uint32_t const to_frame, frame_index_t const frame_idx,
+                                      uint32_t const length) override {
+        auto const ch_count = std::min(this->channel_count_handler(), std::size_t(buffer->format().channel_count()));
+
+        auto each = make_fast_each(ch_count);
+        while (yas_each_next(each)) {
+            auto const &idx = yas_each_index(each);
+            if (!this->read_into_channel_handler(buffer, idx, to_frame, frame_idx, length)) {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    render_error_counts pull_render_errors() override {
+        return this->pull_render_errors_handler();
+    }
 };
 
 struct cpp {
@@ -217,13 +249,11 @@ struct cpp {
 
     worker_stub_ptr const worker = worker_stub::make_shared();
     std::shared_ptr<player_test::renderer> const renderer = std::make_shared<player_test::renderer>();
-    std::shared_ptr<player_test::reading> const reading = std::make_shared<player_test::reading>();
     std::shared_ptr<player_test::buffering> const buffering = std::make_shared<player_test::buffering>();
-    std::shared_ptr<player_test::resource> const resource = std::make_shared<player_test::resource>(reading, buffering);
+    std::shared_ptr<player_test::resource> const resource = std::make_shared<player_test::resource>(buffering);
 
     player_ptr player = nullptr;
     renderer_rendering_f rendering_handler = nullptr;
-    audio::pcm_buffer_ptr reading_buffer = nullptr;
 
     static audio::format make_format() {
         return audio::format{{.sample_rate = sample_rate, .pcm_format = pcm_format, .channel_count = ch_count}};
@@ -233,13 +263,14 @@ struct cpp {
         return audio::pcm_buffer{make_format(), length};
     }
 
-    static void fill_buffer(audio::pcm_buffer *buffer, channel_index_t const ch_idx, frame_index_t const begin_frame) {
-        auto *data = buffer->data_ptr_at_index<int16_t>(0);
+    static void fill_channel(audio::pcm_buffer *buffer, channel_index_t const ch_idx, uint32_t const to_frame,
+                             frame_index_t const begin_frame, uint32_t const length) {
+        auto *data = buffer->data_ptr_at_index<int16_t>(ch_idx);
 
-        auto each = make_fast_each(buffer->frame_length());
+        auto each = make_fast_each(length);
         while (yas_each_next(each)) {
             auto const &idx = yas_each_index(each);
-            data[idx] = ch_idx * 1000 + begin_frame + idx;
+            data[to_frame + idx] = ch_idx * 1000 + begin_frame + idx;
         }
     }
 
@@ -257,24 +288,15 @@ struct cpp {
             player::make_shared(test_utils::root_path(), this->renderer, this->worker, priority, this->resource);
     }
 
-    void skip_reading() {
-        this->setup_initial();
-
-        auto const &reading = this->reading;
-
-        reading->state_handler = [] { return playing::reading_resource_state::rendering; };
-        reading->set_creating_handler = [](double, audio::pcm_format, uint32_t) {};
-        reading->needs_create_handler = [](double, audio::pcm_format, uint32_t) { return false; };
-    }
-
     void skip_buffering_setup() {
-        this->skip_reading();
+        this->setup_initial();
 
         auto const &buffering = this->buffering;
 
         buffering->setup_state_handler = [] { return audio_buffering_setup_state::rendering; };
         buffering->set_creating_handler = [](double, audio::pcm_format, uint32_t) {};
         buffering->needs_create_handler = [](double, audio::pcm_format, uint32_t) { return false; };
+        buffering->looped_frame_on_render_handler = [](frame_index_t const frame) { return frame; };
     }
 
     void skip_buffering_rendering() {
@@ -293,17 +315,14 @@ struct cpp {
     void skip_playing() {
         this->skip_pull();
 
-        this->reading_buffer = std::make_shared<audio::pcm_buffer>(this->make_format(), cpp::length);
-
-        this->resource->perform_overwrite_requests_handler = [](player_test::resource::overwrite_requests_f const &) {};
+        this->resource->perform_overwrite_requests_handler = [](fragment_range const &,
+                                                                player_test::resource::overwrite_requests_f const &) {};
         this->resource->is_playing_handler = [] { return true; };
-        this->reading->buffer_handler = [this] { return this->reading_buffer.get(); };
     }
 
     void reset() {
         this->player = nullptr;
         this->rendering_handler = nullptr;
-        this->reading_buffer = nullptr;
     }
 };
 }  // namespace yas::playing::player_test
@@ -25,9 +25,8 @@ using namespace yas::playing;
     player_task_priority const priority{.setup = 100, .rendering = 101};
     auto const worker = worker::make_shared();
     auto const renderer = std::make_shared<player_test::renderer>();
-    auto const reading = std::make_shared<player_test::reading>();
     auto const buffering = std::make_shared<player_test::buffering>();
-    auto const resource = std::make_shared<player_test::resource>(reading, buffering);
+    auto const resource = std::make_shared<player_test::resource>(buffering);
 
     std::vector<std::string> called_set_identifier;
     std::vector<channel_mapping> called_set_ch_mapping;
@@ -172,6 +171,27 @@ using namespace yas::playing;
     XCTAssertFalse(called_add_overwrite.at(1).file_channel_index.has_value());
     XCTAssertEqual(called_add_overwrite.at(1).fragment_range.index, 5);
     XCTAssertEqual(called_add_overwrite.at(1).fragment_range.length, 2);
+    XCTAssertFalse(called_add_overwrite.at(1).keeps_reading);
+}
+
+- (void)test_overwrite_keeping_reading {
+    self->_cpp.setup_initial();
+
+    auto const &player = self->_cpp.player;
+
+    std::vector<element_address> called_add_overwrite;
+
+    self->_cpp.resource->add_overwrite_request_handler = [&called_add_overwrite](element_address &&address) {
+        called_add_overwrite.emplace_back(address);
+    };
+
+    player->overwrite_keeping_reading(std::nullopt, {5, 2});
+
+    XCTAssertEqual(called_add_overwrite.size(), 1);
+    XCTAssertFalse(called_add_overwrite.at(0).file_channel_index.has_value());
+    XCTAssertEqual(called_add_overwrite.at(0).fragment_range.index, 5);
+    XCTAssertEqual(called_add_overwrite.at(0).fragment_range.length, 2);
+    XCTAssertTrue(called_add_overwrite.at(0).keeps_reading);
 }
 
 - (void)test_current_frame {
@@ -180,14 +200,50 @@ using namespace yas::playing;
     auto const &player = self->_cpp.player;
 
     frame_index_t frame = 0;
+    std::optional<frame_index_t> looped_frame = std::nullopt;
 
     self->_cpp.resource->current_frame_handler = [&frame] { return frame; };
+    self->_cpp.buffering->looped_frame_on_main_handler = [&looped_frame](frame_index_t const frame) {
+        return looped_frame.value_or(frame);
+    };
 
     XCTAssertEqual(player->current_frame(), 0);
 
     frame = 1;
 
     XCTAssertEqual(player->current_frame(), 1);
+
+    frame = 10;
+    looped_frame = 2;
+
+    XCTAssertEqual(player->current_frame(), 2, @"ループで折り返したタイムライン上の位置を返す");
+}
+
+- (void)test_loop_range {
+    self->_cpp.setup_initial();
+
+    auto const &player = self->_cpp.player;
+
+    std::vector<std::optional<fragment_range>> called_set_loop_range;
+
+    self->_cpp.buffering->set_loop_range_request_handler =
+        [&called_set_loop_range](std::optional<fragment_range> loop_range) {
+            called_set_loop_range.emplace_back(loop_range);
+        };
+
+    XCTAssertEqual(player->fragment_loop_range(), std::nullopt);
+
+    player->set_fragment_loop_range(fragment_range{.index = 2, .length = 3});
+
+    XCTAssertEqual(player->fragment_loop_range(), (fragment_range{.index = 2, .length = 3}));
+    XCTAssertEqual(called_set_loop_range.size(), 1);
+    XCTAssertEqual(called_set_loop_range.at(0), (fragment_range{.index = 2, .length = 3}));
+
+    player->set_fragment_loop_range(std::nullopt);
+
+    XCTAssertEqual(player->fragment_loop_range(), std::nullopt);
+    XCTAssertEqual(called_set_loop_range.size(), 2);
+    XCTAssertEqual(called_set_loop_range.at(1), std::nullopt);
 }
 
 - (void)test_identifier {
@@ -230,4 +286,75 @@ using namespace yas::playing;
     XCTAssertEqual(called_ch_mapping.at(0).indices, (std::vector<channel_index_t>{1, 2, 3}));
 }
 
+- (void)test_buffering_element_count {
+    self->_cpp.setup_initial();
+
+    auto const &player = self->_cpp.player;
+
+    std::vector<std::size_t> called;
+
+    self->_cpp.buffering->set_element_count_request_handler = [&called](std::size_t count) {
+        called.emplace_back(count);
+    };
+
+    player->set_buffering_element_count(5);
+
+    XCTAssertEqual(called.size(), 1);
+    XCTAssertEqual(called.at(0), 5);
+}
+
+- (void)test_fragment_length {
+    self->_cpp.setup_initial();
+
+    auto const &player = self->_cpp.player;
+
+    std::vector<sample_rate_t> called;
+
+    self->_cpp.buffering->set_fragment_length_request_handler = [&called](sample_rate_t frag_length) {
+        called.emplace_back(frag_length);
+    };
+
+    player->set_fragment_length(4800);
+
+    XCTAssertEqual(called.size(), 1);
+    XCTAssertEqual(called.at(0), 4800);
+}
+
+- (void)test_buffering_depth_policy {
+    self->_cpp.setup_initial();
+
+    auto const &player = self->_cpp.player;
+
+    std::vector<std::optional<buffering_depth_policy>> called;
+
+    self->_cpp.buffering->set_depth_policy_request_handler = [&called](std::optional<buffering_depth_policy> policy) {
+        called.emplace_back(policy);
+    };
+
+    player->set_buffering_depth_policy(buffering_depth_policy{.max_element_count = 8});
+    player->set_buffering_depth_policy(std::nullopt);
+
+    XCTAssertEqual(called.size(), 2);
+    XCTAssertEqual(called.at(0), (buffering_depth_policy{.max_element_count = 8}));
+    XCTAssertEqual(called.at(1), std::nullopt);
+}
+
+- (void)test_pull_render_errors {
+    self->_cpp.setup_initial();
+
+    auto const &player = self->_cpp.player;
+
+    std::size_t called = 0;
+    render_error_counts counts;
+    counts.values.at(static_cast<std::size_t>(render_error::interleaved_out_buffer)) = 2;
+
+    self->_cpp.resource->pull_render_errors_handler = [&called, &counts] {
+        ++called;
+        return counts;
+    };
+
+    XCTAssertEqual(player->pull_render_errors(), counts);
+    XCTAssertEqual(called, 1);
+}
+
 @end
@@ -70,4 +70,58 @@ using namespace yas::playing;
     XCTAssertEqual(player_utils::advancing_fragment_index(-4, 1, 3).value(), -2);
 }
 
+- (void)test_reading_fragment_range {
+    // フラグメントの中に収まる
+    XCTAssertEqual(player_utils::reading_fragment_range(0, 2, 3), (fragment_range{.index = 0, .length = 1}));
+    // フラグメントの終わりまで
+    XCTAssertEqual(player_utils::reading_fragment_range(1, 2, 3), (fragment_range{.index = 0, .length = 1}));
+    // フラグメントの境界をまたぐ
+    XCTAssertEqual(player_utils::reading_fragment_range(2, 2, 3), (fragment_range{.index = 0, .length = 2}));
+    // マイナスのフラグメントから0のフラグメントへまたぐ
+    XCTAssertEqual(player_utils::reading_fragment_range(-1, 2, 3), (fragment_range{.index = -1, .length = 2}));
+    // 複数のフラグメントをまたぐ
+    XCTAssertEqual(player_utils::reading_fragment_range(2, 5, 3), (fragment_range{.index = 0, .length = 3}));
+    // 長さが0なら読み込まない
+    XCTAssertEqual(player_utils::reading_fragment_range(2, 0, 3).length, 0);
+}
+
+- (void)test_looped_fragment_index {
+    fragment_range const loop_range{.index = 2, .length = 3};
+
+    // ループなし
+    XCTAssertEqual(player_utils::looped_fragment_index(10, std::nullopt), 10);
+    // 長さが0
+    XCTAssertEqual(player_utils::looped_fragment_index(10, fragment_range{.index = 2, .length = 0}), 10);
+    // 範囲より前は範囲の先頭
+    XCTAssertEqual(player_utils::looped_fragment_index(-1, loop_range), 2);
+    XCTAssertEqual(player_utils::looped_fragment_index(1, loop_range), 2);
+    // 範囲内
+    XCTAssertEqual(player_utils::looped_fragment_index(2, loop_range), 2);
+    XCTAssertEqual(player_utils::looped_fragment_index(4, loop_range), 4);
+    // 範囲の終わり以降は先頭へ折り返す
+    XCTAssertEqual(player_utils::looped_fragment_index(5, loop_range), 2);
+    XCTAssertEqual(player_utils::looped_fragment_index(7, loop_range), 4);
+    XCTAssertEqual(player_utils::looped_fragment_index(8, loop_range), 2);
+    // マイナスの範囲
+    XCTAssertEqual(player_utils::looped_fragment_index(0, fragment_range{.index = -2, .length = 2}), -2);
+    XCTAssertEqual(player_utils::looped_fragment_index(-3, fragment_range{.index = -2, .length = 2}), -2);
+}
+
+- (void)test_looped_frame {
+    fragment_range const loop_range{.index = 1, .length = 2};
+
+    // ループなし
+    XCTAssertEqual(player_utils::looped_frame(20, std::nullopt, 4), 20);
+    // 範囲より前は範囲の先頭
+    XCTAssertEqual(player_utils::looped_frame(3, loop_range, 4), 4);
+    XCTAssertEqual(player_utils::looped_frame(-10, loop_range, 4), 4);
+    // 範囲内
+    XCTAssertEqual(player_utils::looped_frame(11, loop_range, 4), 11);
+    // 範囲の終わり以降は先頭へ折り返す
+    XCTAssertEqual(player_utils::looped_frame(12, loop_range, 4), 4);
+    XCTAssertEqual(player_utils::looped_frame(21, loop_range, 4), 5);
+    XCTAssertEqual(player_utils::looped_frame(-4, fragment_range{.index = -2, .length = 1}, 4), -8);
+    XCTAssertEqual(player_utils::looped_frame(-9, fragment_range{.index = -2, .length = 1}, 4), -8);
+}
+
 @end
@@ -0,0 +1,70 @@
+//
+//  render_error_tests.mm
+//
+
+#import <XCTest/XCTest.h>
+#import <audio-playing/umbrella.hpp>
+#import <thread>
+
+using namespace yas;
+using namespace yas::playing;
+
+@interface render_error_tests : XCTestCase
+
+@end
+
+@implementation render_error_tests
+
+- (void)test_counts {
+    render_error_counts counts;
+
+    XCTAssertEqual(counts.total(), 0);
+
+    counts.values.at(static_cast<std::size_t>(render_error::invalid_setup_state)) = 1;
+    counts.values.at(static_cast<std::size_t>(render_error::zero_length)) = 2;
+
+    XCTAssertEqual(counts.count(render_error::invalid_setup_state), 1);
+    XCTAssertEqual(counts.count(render_error::zero_length), 2);
+    XCTAssertEqual(counts.count(render_error::interleaved_out_buffer), 0);
+    XCTAssertEqual(counts.total(), 3);
+
+    render_error_counts added;
+    added.values.at(static_cast<std::size_t>(render_error::zero_length)) = 3;
+    added += counts;
+
+    XCTAssertEqual(added.count(render_error::invalid_setup_state), 1);
+    XCTAssertEqual(added.count(render_error::zero_length), 5);
+
+    XCTAssertTrue(counts == counts);
+    XCTAssertTrue(counts != added);
+}
+
+- (void)test_counter {
+    render_error_counter counter;
+
+    XCTAssertEqual(counter.pull().total(), 0);
+
+    std::thread{[&counter] {
+        for (std::size_t idx = 0; idx < 100; ++idx) {
+            counter.add_on_render(render_error::invalid_rendering_state);
+        }
+        counter.add_on_render(render_error::interleaved_out_buffer);
+    }}.join();
+
+    auto const counts = counter.pull();
+
+    XCTAssertEqual(counts.count(render_error::invalid_rendering_state), 100);
+    XCTAssertEqual(counts.count(render_error::interleaved_out_buffer), 1);
+    XCTAssertEqual(counts.total(), 101);
+
+    XCTAssertEqual(counter.pull().total(), 0, @"取り出したら0に戻る");
+}
+
+- (void)test_to_string {
+    XCTAssertEqual(to_string(render_error::invalid_setup_state), "invalid_setup_state");
+    XCTAssertEqual(to_string(render_error::invalid_rendering_state), "invalid_rendering_state");
+    XCTAssertEqual(to_string(render_error::interleaved_out_buffer), "interleaved_out_buffer");
+    XCTAssertEqual(to_string(render_error::zero_length), "zero_length");
+}
+
+@end
@@ -0,0 +1,32 @@
+//
+//  render_guard_test_utils.h
+//
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+namespace yas::playing::render_guard_test {
+// 範囲内で現在のスレッドがoperator new/deleteを呼んだら、スタックトレースと一緒に記録する
+// 記録するときにもメモリを確保しないように、決まった数だけ用意した領域に書き込む
+// -fsanitize=realtimeでビルドしたときは、範囲内をRealtimeSanitizerのリアルタイムの処理にして、
+// ロックやファイルの読み書きなどのシステムコールも検出させる。その場合は見つけたところで止まる
+struct scope final {
+    scope();
+    ~scope();
+
+    scope(scope const &) = delete;
+    scope(scope &&) = delete;
+    scope &operator=(scope const &) = delete;
+    scope &operator=(scope &&) = delete;
+};
+
+// RealtimeSanitizerでも検出しているか
+[[nodiscard]] bool is_realtime_sanitized();
+void reset();
+// 記録しきれなかったものも含めた数
+[[nodiscard]] std::size_t violation_count();
+// 記録したものをスタックトレース付きの文字列にする。scopeの外で呼ぶ
+[[nodiscard]] std::string report();
+}  // namespace yas::playing::render_guard_test
@@ -0,0 +1,220 @@
+//
+//  render_guard_test_utils.mm
+//
+
+#include "render_guard_test_utils.h"
+
+#include <execinfo.h>
+
+#if defined(__has_feature)
+#if __has_feature(realtime_sanitizer)
+#define YAS_PLAYING_RENDER_GUARD_RTSAN
+#include <sanitizer/rtsan_interface.h>
+#endif
+#endif
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <sstream>
+
+using namespace yas;
+using namespace yas::playing;
+
+namespace yas::playing::render_guard_test {
+namespace {
+    struct violation final {
+        enum class kind_t {
+            allocation,
+            deallocation,
+        };
+
+        static std::size_t constexpr max_frame_count = 32;
+
+        kind_t kind;
+        std::size_t size;
+        std::array<void *, max_frame_count> frames;
+        int frame_count;
+    };
+
+    std::size_t constexpr max_violation_count = 16;
+
+    std::array<violation, max_violation_count> violations;
+    std::atomic<std::size_t> total_count{0};
+    thread_local bool is_guarding = false;
+
+    void record(violation::kind_t const kind, std::size_t const size) {
+        if (!is_guarding) {
+            return;
+        }
+
+        // 記録中のメモリの確保は数えない
+        is_guarding = false;
+
+        if (auto const idx = total_count.fetch_add(1); idx < max_violation_count) {
+            auto &item = violations[idx];
+            item.kind = kind;
+            item.size = size;
+            item.frame_count = ::backtrace(item.frames.data(), static_cast<int>(violation::max_frame_count));
+        }
+
+        is_guarding = true;
+    }
+
+    void *allocate(std::size_t const size) {
+        record(violation::kind_t::allocation, size);
+        return std::malloc(size == 0 ? 1 : size);
+    }
+
+    void *allocate(std::size_t const size, std::align_val_t const alignment) {
+        record(violation::kind_t::allocation, size);
+
+        void *ptr = nullptr;
+        auto const align = std::max(static_cast<std::size_t>(alignment), sizeof(void *));
+        if (::posix_memalign(&ptr, align, size == 0 ? 1 : size) != 0) {
+            return nullptr;
+        }
+        return ptr;
+    }
+
+    void deallocate(void *const ptr) {
+        if (!ptr) {
+            return;
+        }
+
+        record(violation::kind_t::deallocation, 0);
+        std::free(ptr);
+    }
+
+    void *allocate_or_throw(void *const ptr) {
+        if (!ptr) {
+            throw std::bad_alloc();
+        }
+        return ptr;
+    }
+}  // namespace
+}  // namespace yas::playing::render_guard_test
+
+render_guard_test::scope::scope() {
+    is_guarding = true;
+#ifdef YAS_PLAYING_RENDER_GUARD_RTSAN
+    __rtsan_realtime_enter();
+#endif
+}
+
+render_guard_test::scope::~scope() {
+#ifdef YAS_PLAYING_RENDER_GUARD_RTSAN
+    __rtsan_realtime_exit();
+#endif
+    is_guarding = false;
+}
+
+bool render_guard_test::is_realtime_sanitized() {
+#ifdef YAS_PLAYING_RENDER_GUARD_RTSAN
+    return true;
+#else
+    return false;
+#endif
+}
+
+void render_guard_test::reset() {
+    total_count.store(0);
+}
+
+std::size_t render_guard_test::violation_count() {
+    return total_count.load();
+}
+
+std::string render_guard_test::report() {
+    std::ostringstream stream;
+
+    auto const count = total_count.load();
+    stream << "render guard violations : " << count << std::endl;
+
+    for (std::size_t idx = 0; idx < std::min(count, max_violation_count); ++idx) {
+        auto const &item = violations[idx];
+
+        if (item.kind == violation::kind_t::allocation) {
+            stream << "[" << idx << "] allocation size : " << item.size << std::endl;
+        } else {
+            stream << "[" << idx << "] deallocation" << std::endl;
+        }
+
+        if (char **symbols = ::backtrace_symbols(item.frames.data(), item.frame_count)) {
+            for (int frame_idx = 0; frame_idx < item.frame_count; ++frame_idx) {
+                stream << "    " << symbols[frame_idx] << std::endl;
+            }
+            std::free(symbols);
+        }
+    }
+
+    return stream.str();
+}
+
+#pragma mark - operator new/delete
+
+void *operator new(std::size_t size) {
+    return render_guard_test::allocate_or_throw(render_guard_test::allocate(size));
+}
+
+void *operator new[](std::size_t size) {
+    return render_guard_test::allocate_or_throw(render_guard_test::allocate(size));
+}
+
+void *operator new(std::size_t size, std::nothrow_t const &) noexcept {
+    return render_guard_test::allocate(size);
+}
+
+void *operator new[](std::size_t size, std::nothrow_t const &) noexcept {
+    return render_guard_test::allocate(size);
+}
+
+void *operator new(std::size_t size, std::align_val_t alignment) {
+    return render_guard_test::allocate_or_throw(render_guard_test::allocate(size, alignment));
+}
+
+void *operator new[](std::size_t size, std::align_val_t alignment) {
+    return render_guard_test::allocate_or_throw(render_guard_test::allocate(size, alignment));
+}
+
+void operator delete(void *ptr) noexcept {
+    render_guard_test::deallocate(ptr);
+}
+
+void operator delete[](void *ptr) noexcept {
+    render_guard_test::deallocate(ptr);
+}
+
+void operator delete(void *ptr, std::size_t) noexcept {
+    render_guard_test::deallocate(ptr);
+}
+
+void operator delete[](void *ptr, std::size_t) noexcept {
+    render_guard_test::deallocate(ptr);
+}
+
+void operator delete(void *ptr, std::nothrow_t const &) noexcept {
+    render_guard_test::deallocate(ptr);
+}
+
+void operator delete[](void *ptr, std::nothrow_t const &) noexcept {
+    render_guard_test::deallocate(ptr);
+}
+
+void operator delete(void *ptr, std::align_val_t) noexcept {
+    render_guard_test::deallocate(ptr);
+}
+
+void operator delete[](void *ptr, std::align_val_t) noexcept {
+    render_guard_test::deallocate(ptr);
+}
+
+void operator delete(void *ptr, std::size_t, std::align_val_t) noexcept {
+    render_guard_test::deallocate(ptr);
+}
+
+void operator delete[](void *ptr, std::size_t, std::align_val_t) noexcept {
+    render_guard_test::deallocate(ptr);
+}
@@ -26,6 +26,50 @@ using namespace yas::playing;
     XCTAssertEqual(timeline_utils::fragments_range({1, 4}, 2), proc::time::range(0, 6));
 }
 
+- (void)test_to_fragment_range {
+    XCTAssertEqual(timeline_utils::to_fragment_range({0, 1}, 2), (fragment_range{.index = 0, .length = 1}));
+    XCTAssertEqual(timeline_utils::to_fragment_range({1, 2}, 2), (fragment_range{.index = 0, .length = 2}));
+    XCTAssertEqual(timeline_utils::to_fragment_range({-1, 2}, 2), (fragment_range{.index = -1, .length = 2}));
+}
+
+- (void)test_to_time_range {
+    XCTAssertEqual(timeline_utils::to_time_range({.index = 0, .length = 1}, 2), proc::time::range(0, 2));
+    XCTAssertEqual(timeline_utils::to_time_range({.index = -1, .length = 3}, 2), proc::time::range(-2, 6));
+}
+
+- (void)test_merged_fragment_ranges {
+    auto const merged = timeline_utils::merged_fragment_ranges({{.index = 5, .length = 1},
+                                                                {.index = 0, .length = 2},
+                                                                {.index = 2, .length = 1},
+                                                                {.index = 1, .length = 0},
+                                                                {.index = 4, .length = 2}});
+
+    XCTAssertEqual(merged.size(), 2);
+    XCTAssertEqual(merged.at(0), (fragment_range{.index = 0, .length = 3}));
+    XCTAssertEqual(merged.at(1), (fragment_range{.index = 4, .length = 2}));
+}
+
+- (void)test_intersected_fragment_ranges {
+    auto const intersected = timeline_utils::intersected_fragment_ranges(
+        {.index = 0, .length = 10}, {{.index = -2, .length = 3}, {.index = 5, .length = 2}, {.index = 9, .length = 5}});
+
+    XCTAssertEqual(intersected.size(), 3);
+    XCTAssertEqual(intersected.at(0), (fragment_range{.index = 0, .length = 1}));
+    XCTAssertEqual(intersected.at(1), (fragment_range{.index = 5, .length = 2}));
+    XCTAssertEqual(intersected.at(2), (fragment_range{.index = 9, .length = 1}));
+
+    XCTAssertEqual(timeline_utils::intersected_fragment_ranges({.index = 0, .length = 2}, {}).size(), 0);
+}
+
+- (void)test_to_fragment_ranges {
+    auto const ranges = timeline_utils::to_fragment_ranges({-1, 0, 1, 3, 5, 6});
+
+    XCTAssertEqual(ranges.size(), 3);
+    XCTAssertEqual(ranges.at(0), (fragment_range{.index = -1, .length = 3}));
+    XCTAssertEqual(ranges.at(1), (fragment_range{.index = 3, .length = 1}));
+    XCTAssertEqual(ranges.at(2), (fragment_range{.index = 5, .length = 2}));
+}
+
 - (void)test_char_data_from_signal_event {
     {
         auto const event = proc::signal_event::make_shared(std::vector<double>{1.0, 2.0});